@@ -1,6 +1,18 @@
 #include "coremark.h"
 #include <stdint.h>
 #include <stdio.h>
+#ifdef CFG_E203_HPM
+#include "e203_hpm.h"
+#endif
+#ifdef CFG_E203_LATH
+#include "e203_lath.h"
+#ifndef CFG_E203_LATH_SHIFT
+#define CFG_E203_LATH_SHIFT 0
+#endif
+#endif
+#ifdef CFG_SIM_MARK
+#include "e203_sim.h"
+#endif
 
 /* ========================================================================== */
 /* Hardware Performance Counter Functions                                    */
@@ -236,8 +248,19 @@ MAIN_RETURN_TYPE main(int argc, char *argv[]) {
     /* ================================================= */
     /* Performance Measurement Start                    */
     /* ================================================= */
+#ifdef CFG_SIM_MARK
+    e203_sim_mark(E203_SIM_MARK_START);
+#endif
     uint64_t my_start_cyc  = get_mcycles();
     uint64_t my_start_inst = get_minstret();
+#ifdef CFG_E203_HPM
+    e203_hpm_snap hpm_start, hpm_end, hpm;
+    e203_hpm_read(&hpm_start);
+#endif
+#ifdef CFG_E203_LATH
+    e203_lath_snap lath;
+    e203_lath_clear(CFG_E203_LATH_SHIFT);
+#endif
 
     start_time();
 #if (MULTITHREAD>1)
@@ -262,6 +285,16 @@ MAIN_RETURN_TYPE main(int argc, char *argv[]) {
     /* ================================================= */
     uint64_t my_end_cyc    = get_mcycles();
     uint64_t my_end_inst   = get_minstret();
+#ifdef CFG_SIM_MARK
+    e203_sim_mark(E203_SIM_MARK_END);
+#endif
+#ifdef CFG_E203_HPM
+    e203_hpm_read(&hpm_end);
+    e203_hpm_diff(&hpm, &hpm_end, &hpm_start);
+#endif
+#ifdef CFG_E203_LATH
+    e203_lath_read(&lath);
+#endif
 
     total_time=get_time();
 
@@ -436,6 +469,88 @@ MAIN_RETURN_TYPE main(int argc, char *argv[]) {
             ee_printf ("IPC Status                  : NEEDS OPTIMIZATION (<0.3, significant stalls)\n");
         }
 
+#ifdef CFG_E203_HPM
+        ee_printf ("\n--- E203 Event Counters (mhpmcounter) ---\n");
+        ee_printf ("Unaligned Split Accesses    : %lu\n", hpm.splt);
+        ee_printf ("Early AGU Addresses         : %lu\n", hpm.eagu);
+        ee_printf ("Write-Back Arbitration Stall: %lu\n", hpm.wbck_stall);
+
+        ee_printf ("\n--- Load Value Locality (probe, no prediction) ---\n");
+        ee_printf ("Loads Looked Up             : %lu\n", hpm.lvp_lkup);
+        ee_printf ("Would Be Predicted          : %lu\n", hpm.lvp_prdt);
+        ee_printf ("  Correct                   : %lu\n", hpm.lvp_hit);
+        ee_printf ("  Wrong                     : %lu\n", hpm.lvp_prdt - hpm.lvp_hit);
+        if (hpm.lvp_prdt > 0) {
+            ee_printf ("Hit Rate                    : %.2f %%\n", 100.0 * hpm.lvp_hit / hpm.lvp_prdt);
+        }
+        if (hpm.lvp_lkup > 0) {
+            ee_printf ("Coverage (Confident/Loads)  : %.2f %%\n", 100.0 * hpm.lvp_prdt / hpm.lvp_lkup);
+        }
+
+        ee_printf ("\n--- Data Prefetcher ---\n");
+        ee_printf ("Prefetches Issued           : %lu\n", hpm.pf_issue);
+        ee_printf ("Prefetch Buffer Hits        : %lu\n", hpm.pfb_hit);
+        ee_printf ("Useless Prefetches          : %lu\n", hpm.pf_useless);
+        if (hpm.pf_issue > 0) {
+            ee_printf ("Accuracy (Hits/Issued)      : %.2f %%\n", 100.0 * hpm.pfb_hit / hpm.pf_issue);
+        }
+
+        ee_printf ("\n--- L0 Data Cache ---\n");
+        ee_printf ("Load Hits                   : %lu\n", hpm.l0d_hit);
+        ee_printf ("Load Misses (Line Refills)  : %lu\n", hpm.l0d_miss);
+        if (hpm.l0d_hit + hpm.l0d_miss > 0) {
+            ee_printf ("Hit Rate                    : %.2f %%\n", 100.0 * hpm.l0d_hit / (hpm.l0d_hit + hpm.l0d_miss));
+        }
+
+        ee_printf ("\n--- Instruction Fetch ---\n");
+        ee_printf ("Fetch Starvation Cycles     : %lu\n", hpm.fetch_starv);
+        if (my_total_cyc > 0) {
+            ee_printf ("  of Total Cycles           : %.2f %%\n", 100.0 * hpm.fetch_starv / my_total_cyc);
+        }
+        ee_printf ("I-Cache Hits                : %lu\n", hpm.ic_hit);
+        ee_printf ("I-Cache Misses              : %lu\n", hpm.ic_miss);
+        ee_printf ("I-Cache Next Line Refills   : %lu\n", hpm.ic_pf);
+        if (hpm.ic_hit + hpm.ic_miss > 0) {
+            ee_printf ("I-Cache Hit Rate            : %.2f %%\n", 100.0 * hpm.ic_hit / (hpm.ic_hit + hpm.ic_miss));
+        }
+
+        ee_printf ("\n--- ITCM Port ---\n");
+        ee_printf ("Loads/Stores to ITCM        : %lu\n", hpm.itcm_ldst);
+        ee_printf ("Bank Conflicts (Fetch Stall): %lu\n", hpm.itcm_cfl);
+
+#endif
+
+#ifdef CFG_E203_LATH
+        ee_printf ("\n--- Load Latency Histogram (cycles) ---\n");
+        for (int r = 0; r < LATH_REGION_NUM; r++) {
+            uint32_t loads = 0;
+            uint32_t lat_sum = 0;
+            for (int b = 0; b < LATH_BUCKET_NUM; b++) {
+                loads += lath.cnt[r][b];
+                lat_sum += lath.cnt[r][b] * (b << lath.shift);
+            }
+            if (loads == 0) {
+                continue;
+            }
+            ee_printf ("%-28s: %lu loads, avg >= %.2f\n", e203_lath_region_name[r],
+                (unsigned long)loads, (double)lat_sum / loads);
+            for (int b = 0; b < LATH_BUCKET_NUM; b++) {
+                uint32_t lo = b << lath.shift;
+                if (lath.cnt[r][b] == 0) {
+                    continue;
+                }
+                if (b == LATH_BUCKET_NUM - 1) {
+                    ee_printf ("  %4lu+      : %10lu  %6.2f %%\n", (unsigned long)lo,
+                        (unsigned long)lath.cnt[r][b], 100.0 * lath.cnt[r][b] / loads);
+                } else {
+                    ee_printf ("  %4lu-%-4lu  : %10lu  %6.2f %%\n", (unsigned long)lo,
+                        (unsigned long)(lo + (1UL << lath.shift) - 1),
+                        (unsigned long)lath.cnt[r][b], 100.0 * lath.cnt[r][b] / loads);
+                }
+            }
+        }
+#endif
+
         ee_printf ("\n--- Module Execution Status ---\n");
         if (results[0].execs & ID_LIST) {
             ee_printf ("List Benchmark              : EXECUTED\n");
@@ -518,6 +633,9 @@ MAIN_RETURN_TYPE main(int argc, char *argv[]) {
         ee_printf ("\nError: Counters invalid (0). Check HW support.\n");
     }
     ee_printf ("========================================================\n");
+#ifdef CFG_SIM_MARK
+    e203_sim_mark((total_errors == 0) ? E203_SIM_MARK_PASS : E203_SIM_MARK_FAIL);
+#endif
 
     /* Cleanup - Must be after performance output to avoid UART shutdown */
 #if (MEM_METHOD==MEM_MALLOC)
@@ -20,6 +20,11 @@
 #ifndef FESDK_CORE_PORTME_H
 #define FESDK_CORE_PORTME_H
 
+// CFG_SIM_CONSOLE: print through the simulation console (e203_sim.h) instead
+// of the UART, for the simulators only. It only takes effect when
+// e203_sim_console.c is compiled and linked into the program, whose _write
+// then replaces the weak one of the SDK; nothing in this header reads it.
+
 #include <stdint.h>
 #include <stddef.h>
 
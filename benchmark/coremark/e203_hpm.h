@@ -0,0 +1,110 @@
+#ifndef E203_HPM_H
+#define E203_HPM_H
+
+#include <stdint.h>
+
+/* ========================================================================== */
+/* E203 Hardware Performance Monitor Events                                  */
+/* The cores built with E203_HAS_HPM count the EXU events into               */
+/* mhpmcounter(3+N), see the event table in the top-level README.md          */
+/* ========================================================================== */
+
+#define HPM_CSR_SPLT        0xB03   /* Unaligned access split in two         */
+#define HPM_CSR_EAGU        0xB04   /* Address issued from the early AGU     */
+#define HPM_CSR_LVP_LKUP    0xB05   /* Load looked up in the LVP probe       */
+#define HPM_CSR_LVP_PRDT    0xB06   /* A predictor would predict the load    */
+#define HPM_CSR_LVP_HIT     0xB07   /* That prediction would be correct      */
+#define HPM_CSR_PF_ISSUE    0xB08   /* Data prefetch issued                  */
+#define HPM_CSR_PFB_HIT     0xB09   /* Load served by the prefetch buffer    */
+#define HPM_CSR_PF_USELESS  0xB0A   /* Prefetched word dropped unused        */
+#define HPM_CSR_L0D_HIT     0xB0B   /* Load served by the L0 data cache      */
+#define HPM_CSR_L0D_MISS    0xB0C   /* Load missing the L0 data cache        */
+#define HPM_CSR_FETCH_STARV 0xB0D   /* EXU ready but no instruction fetched  */
+#define HPM_CSR_IC_HIT      0xB0E   /* Fetch served by the I-Cache           */
+#define HPM_CSR_IC_MISS     0xB0F   /* Fetch missing the I-Cache             */
+#define HPM_CSR_IC_PF       0xB10   /* Next line refill by the I-Cache       */
+#define HPM_CSR_WBCK_STALL  0xB11   /* Write-back arbitration stall          */
+#define HPM_CSR_ITCM_LDST   0xB12   /* Load/store to the ITCM                */
+#define HPM_CSR_ITCM_CFL    0xB13   /* Fetch stalled by ITCM bank conflict   */
+#define HPM_CSR_STK_PUSH    0xB14   /* Frame saved by the stacking engine    */
+#define HPM_CSR_STK_TCHN    0xB15   /* Interrupt tail-chained                */
+#define HPM_CSR_STK_ERR     0xB16   /* Bus error on a stacking frame access  */
+
+#define HPM_STR_(x) #x
+#define HPM_STR(x)  HPM_STR_(x)
+
+/* Read one event counter, csr must be a literal CSR number */
+#define read_hpm(csr) ({ uint32_t __v; asm volatile ("csrr %0, " HPM_STR(csr) : "=r"(__v)); __v; })
+
+typedef struct {
+    uint32_t splt;
+    uint32_t eagu;
+    uint32_t lvp_lkup;
+    uint32_t lvp_prdt;
+    uint32_t lvp_hit;
+    uint32_t pf_issue;
+    uint32_t pfb_hit;
+    uint32_t pf_useless;
+    uint32_t l0d_hit;
+    uint32_t l0d_miss;
+    uint32_t fetch_starv;
+    uint32_t ic_hit;
+    uint32_t ic_miss;
+    uint32_t ic_pf;
+    uint32_t wbck_stall;
+    uint32_t itcm_ldst;
+    uint32_t itcm_cfl;
+    uint32_t stk_push;
+    uint32_t stk_tchn;
+    uint32_t stk_err;
+} e203_hpm_snap;
+
+/* Take a snapshot of all the event counters */
+static inline void e203_hpm_read(e203_hpm_snap *s) {
+    s->splt     = read_hpm(HPM_CSR_SPLT);
+    s->eagu     = read_hpm(HPM_CSR_EAGU);
+    s->lvp_lkup = read_hpm(HPM_CSR_LVP_LKUP);
+    s->lvp_prdt = read_hpm(HPM_CSR_LVP_PRDT);
+    s->lvp_hit  = read_hpm(HPM_CSR_LVP_HIT);
+    s->pf_issue   = read_hpm(HPM_CSR_PF_ISSUE);
+    s->pfb_hit    = read_hpm(HPM_CSR_PFB_HIT);
+    s->pf_useless = read_hpm(HPM_CSR_PF_USELESS);
+    s->l0d_hit    = read_hpm(HPM_CSR_L0D_HIT);
+    s->l0d_miss   = read_hpm(HPM_CSR_L0D_MISS);
+    s->fetch_starv = read_hpm(HPM_CSR_FETCH_STARV);
+    s->ic_hit      = read_hpm(HPM_CSR_IC_HIT);
+    s->ic_miss     = read_hpm(HPM_CSR_IC_MISS);
+    s->ic_pf       = read_hpm(HPM_CSR_IC_PF);
+    s->wbck_stall  = read_hpm(HPM_CSR_WBCK_STALL);
+    s->itcm_ldst   = read_hpm(HPM_CSR_ITCM_LDST);
+    s->itcm_cfl    = read_hpm(HPM_CSR_ITCM_CFL);
+    s->stk_push    = read_hpm(HPM_CSR_STK_PUSH);
+    s->stk_tchn    = read_hpm(HPM_CSR_STK_TCHN);
+    s->stk_err     = read_hpm(HPM_CSR_STK_ERR);
+}
+
+/* Event counts between two snapshots (the counters wrap at 32 bits) */
+static inline void e203_hpm_diff(e203_hpm_snap *d, const e203_hpm_snap *end, const e203_hpm_snap *start) {
+    d->splt     = end->splt     - start->splt;
+    d->eagu     = end->eagu     - start->eagu;
+    d->lvp_lkup = end->lvp_lkup - start->lvp_lkup;
+    d->lvp_prdt = end->lvp_prdt - start->lvp_prdt;
+    d->lvp_hit  = end->lvp_hit  - start->lvp_hit;
+    d->pf_issue   = end->pf_issue   - start->pf_issue;
+    d->pfb_hit    = end->pfb_hit    - start->pfb_hit;
+    d->pf_useless = end->pf_useless - start->pf_useless;
+    d->l0d_hit    = end->l0d_hit    - start->l0d_hit;
+    d->l0d_miss   = end->l0d_miss   - start->l0d_miss;
+    d->fetch_starv = end->fetch_starv - start->fetch_starv;
+    d->ic_hit      = end->ic_hit      - start->ic_hit;
+    d->ic_miss     = end->ic_miss     - start->ic_miss;
+    d->ic_pf       = end->ic_pf       - start->ic_pf;
+    d->wbck_stall  = end->wbck_stall  - start->wbck_stall;
+    d->itcm_ldst   = end->itcm_ldst   - start->itcm_ldst;
+    d->itcm_cfl    = end->itcm_cfl    - start->itcm_cfl;
+    d->stk_push    = end->stk_push    - start->stk_push;
+    d->stk_tchn    = end->stk_tchn    - start->stk_tchn;
+    d->stk_err     = end->stk_err     - start->stk_err;
+}
+
+#endif
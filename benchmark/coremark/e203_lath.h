@@ -0,0 +1,63 @@
+#ifndef E203_LATH_H
+#define E203_LATH_H
+
+#include <stdint.h>
+
+/* ========================================================================== */
+/* E203 Load Latency Histogram                                               */
+/* The cores built with E203_HAS_LAT_HIST count the latency of each load on  */
+/* the AGU ICB channel into a bucket of its address region, see              */
+/* e203_exu_lath.v and the top-level README.md                               */
+/* ========================================================================== */
+
+#define LATH_CSR_SEL        0xBC0   /* Counter index {region, bucket}        */
+#define LATH_CSR_DAT        0xBC1   /* Counter selected by LATH_SEL          */
+#define LATH_CSR_CFG        0xBC2   /* Bucket shift                          */
+#define LATH_CSR_BASE0      0xBC4   /* Region base address (0xBC4+r)         */
+#define LATH_CSR_MASK0      0xBC8   /* Region address mask (0xBC8+r)         */
+
+#define LATH_REGION_NUM     4
+#define LATH_BUCKET_NUM     8
+
+#define LATH_STR_(x) #x
+#define LATH_STR(x)  LATH_STR_(x)
+
+#define lath_read(csr)     ({ uint32_t __v; asm volatile ("csrr %0, " LATH_STR(csr) : "=r"(__v)); __v; })
+#define lath_write(csr, v) asm volatile ("csrw " LATH_STR(csr) ", %0" :: "r"((uint32_t)(v)))
+
+static const char *const e203_lath_region_name[LATH_REGION_NUM] = {
+    "Region 0 (DTCM)",
+    "Region 1 (ITCM)",
+    "Region 2 (External)",
+    "Region 3 (Peripheral)",
+};
+
+typedef struct {
+    uint32_t shift;
+    uint32_t cnt[LATH_REGION_NUM][LATH_BUCKET_NUM];
+} e203_lath_snap;
+
+/* Set the bucket width to (1 << shift) cycles and clear all the counters */
+static inline void e203_lath_clear(uint32_t shift) {
+    uint32_t i;
+
+    lath_write(LATH_CSR_CFG, shift);
+    for (i = 0; i < LATH_REGION_NUM * LATH_BUCKET_NUM; i++) {
+        lath_write(LATH_CSR_SEL, i);
+        lath_write(LATH_CSR_DAT, 0);
+    }
+}
+
+static inline void e203_lath_read(e203_lath_snap *s) {
+    uint32_t r, b;
+
+    s->shift = lath_read(LATH_CSR_CFG);
+    for (r = 0; r < LATH_REGION_NUM; r++) {
+        for (b = 0; b < LATH_BUCKET_NUM; b++) {
+            lath_write(LATH_CSR_SEL, r * LATH_BUCKET_NUM + b);
+            s->cnt[r][b] = lath_read(LATH_CSR_DAT);
+        }
+    }
+}
+
+#endif
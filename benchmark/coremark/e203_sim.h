@@ -0,0 +1,40 @@
+#ifndef E203_SIM_H
+#define E203_SIM_H
+
+#include <stdint.h>
+
+/* ========================================================================== */
+/* Simulation Markers                                                        */
+/* A write of an id to the marker CSR tells the simulators where the program */
+/* is: e203sim and the RTL harnesses checkpoint or stop there, see sim/ in   */
+/* the top-level README.md. The core ignores the write (the CSR reads 0).    */
+/* ========================================================================== */
+
+#define E203_SIM_MARK_CSR   0x7FF
+
+#define E203_SIM_MARK_START 1   /* Past the initialization, before the timed loop */
+#define E203_SIM_MARK_END   2   /* After the timed loop                           */
+#define E203_SIM_MARK_PASS  3   /* The self-check passed (the CoreMark CRCs, ...) */
+#define E203_SIM_MARK_FAIL  4   /* The self-check failed                          */
+
+#define E203_SIM_STR_(x) #x
+#define E203_SIM_STR(x)  E203_SIM_STR_(x)
+
+#define e203_sim_mark(id) \
+    asm volatile ("csrw " E203_SIM_STR(E203_SIM_MARK_CSR) ", %0" :: "r"((uint32_t)(id)) : "memory")
+
+/* ========================================================================== */
+/* Simulation Console                                                        */
+/* A write of a byte to the console CSR prints it on the host in one cycle:  */
+/* e203sim adds it to the UART output, the RTL harness gets it through DPI.  */
+/* The core ignores the write, so the bytes are lost on the FPGA. Built with */
+/* CFG_SIM_CONSOLE, e203_sim_console.c sends the printf output this way     */
+/* instead of through the UART.                                              */
+/* ========================================================================== */
+
+#define E203_SIM_CONSOLE_CSR 0x7FE
+
+#define e203_sim_putc(c) \
+    asm volatile ("csrw " E203_SIM_STR(E203_SIM_CONSOLE_CSR) ", %0" :: "r"((uint32_t)(uint8_t)(c)))
+
+#endif
@@ -0,0 +1,31 @@
+#ifdef CFG_SIM_CONSOLE
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "e203_sim.h"
+
+/* ========================================================================== */
+/* Simulation Console Output                                                 */
+/* Replaces the weak _write of the HBird SDK stubs, which waits on the UART */
+/* FIFO while every byte is shifted out at the baud rate (over a thousand    */
+/* core cycles a byte). Every byte is one CSR write instead.                 */
+/*                                                                           */
+/* It is kept out of core_portme.c on purpose: this object links after the   */
+/* CoreMark objects, so their code and data stay at the same addresses and   */
+/* the measured region runs exactly as in the UART build.                    */
+/* ========================================================================== */
+
+ssize_t _write(int fd, const void *ptr, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)ptr;
+    size_t i;
+
+    (void)fd;
+    for (i = 0; i < len; i++) {
+        e203_sim_putc(p[i]);
+    }
+    return (ssize_t)len;
+}
+
+#endif
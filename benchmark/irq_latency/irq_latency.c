@@ -0,0 +1,243 @@
+/*
+ * IRQ Latency: the cycle-accurate interrupt entry/exit latency of the E203
+ *
+ * The machine software interrupt (the CLINT msip) is raised by a store, so
+ * the cycle it is raised is known exactly. The handler entry, reached
+ * directly from mtvec, reads mcycle as its first instruction after the
+ * register save, and the handler exit reads it just before the restore, so
+ * the program measures:
+ *   Entry : msip store -> first handler instruction (incl. the save)
+ *   Exit  : last handler instruction (before the restore) -> back in main
+ *   Chain : exit of one handler -> entry of the next one, when the handler
+ *           raises msip again before it returns (back-to-back interrupts)
+ *
+ * Build it with CFG_E203_HW_STACK for a core built with E203_HAS_HW_STACK:
+ * the entry then does not save/restore ra, t0-t6, a0-a7 by itself, since
+ * the hardware stacking engine does. Run both builds to compare them.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include "hbird_sdk_soc.h"
+
+#ifdef CFG_E203_HPM
+#include "../coremark/e203_hpm.h"
+#endif
+
+#ifndef IRQ_CLINT_MSIP
+#define IRQ_CLINT_MSIP   0x02000000UL
+#endif
+
+#ifndef IRQ_RUNS
+#define IRQ_RUNS         64
+#endif
+
+#ifndef IRQ_CHAIN
+#define IRQ_CHAIN        4
+#endif
+
+#define MSIP  (*(volatile uint32_t *)IRQ_CLINT_MSIP)
+
+#define read_mcycle() ({ uint32_t __v; __asm__ volatile ("csrr %0, mcycle" : "=r"(__v)); __v; })
+
+/* Written by the handler, read by main */
+static volatile uint32_t irq_t_entry[IRQ_CHAIN + 1];
+static volatile uint32_t irq_t_exit[IRQ_CHAIN + 1];
+static volatile uint32_t irq_cnt;
+static volatile uint32_t irq_chain;
+
+/* Called from the entry below, the first and the last statements are the
+ * timestamps, everything in between is the handler body */
+void irq_latency_handler(uint32_t t_entry)
+{
+    uint32_t n = irq_cnt;
+
+    irq_t_entry[n] = t_entry;
+    irq_cnt = n + 1;
+
+    /* Raise the next one before returning, it is taken right at the mret */
+    MSIP = (n < irq_chain) ? 1 : 0;
+
+    irq_t_exit[n] = read_mcycle();
+}
+
+/*
+ * The trap entry: mcycle is read first (into a0, the argument), then the
+ * handler is called. Without the hardware stacking, the caller-saved
+ * registers are saved/restored here, the mcycle read is after the save.
+ */
+__asm__ (
+    "  .section .text.irq_latency_entry, \"ax\"\n"
+    "  .align 6\n"
+    "  .globl irq_latency_entry\n"
+    "irq_latency_entry:\n"
+#ifndef CFG_E203_HW_STACK
+    "  addi sp, sp, -64\n"
+    "  sw   ra,  0(sp)\n"
+    "  sw   t0,  4(sp)\n"
+    "  sw   t1,  8(sp)\n"
+    "  sw   t2, 12(sp)\n"
+    "  sw   a0, 16(sp)\n"
+    "  sw   a1, 20(sp)\n"
+    "  sw   a2, 24(sp)\n"
+    "  sw   a3, 28(sp)\n"
+    "  sw   a4, 32(sp)\n"
+    "  sw   a5, 36(sp)\n"
+    "  sw   a6, 40(sp)\n"
+    "  sw   a7, 44(sp)\n"
+    "  sw   t3, 48(sp)\n"
+    "  sw   t4, 52(sp)\n"
+    "  sw   t5, 56(sp)\n"
+    "  sw   t6, 60(sp)\n"
+#endif
+    "  csrr a0, mcycle\n"
+    "  call irq_latency_handler\n"
+#ifndef CFG_E203_HW_STACK
+    "  lw   ra,  0(sp)\n"
+    "  lw   t0,  4(sp)\n"
+    "  lw   t1,  8(sp)\n"
+    "  lw   t2, 12(sp)\n"
+    "  lw   a0, 16(sp)\n"
+    "  lw   a1, 20(sp)\n"
+    "  lw   a2, 24(sp)\n"
+    "  lw   a3, 28(sp)\n"
+    "  lw   a4, 32(sp)\n"
+    "  lw   a5, 36(sp)\n"
+    "  lw   a6, 40(sp)\n"
+    "  lw   a7, 44(sp)\n"
+    "  lw   t3, 48(sp)\n"
+    "  lw   t4, 52(sp)\n"
+    "  lw   t5, 56(sp)\n"
+    "  lw   t6, 60(sp)\n"
+    "  addi sp, sp, 64\n"
+#endif
+    "  mret\n"
+    "  .text\n"
+);
+
+extern void irq_latency_entry(void);
+
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+    uint32_t sum;
+} lat_stat;
+
+static void lat_init(lat_stat *s)
+{
+    s->min = 0xFFFFFFFFUL;
+    s->max = 0;
+    s->sum = 0;
+}
+
+static void lat_add(lat_stat *s, uint32_t v)
+{
+    if (v < s->min) s->min = v;
+    if (v > s->max) s->max = v;
+    s->sum += v;
+}
+
+static void lat_print(const char *name, const lat_stat *s, uint32_t n)
+{
+    printf("%-28s: min %4lu  max %4lu  avg %7.2f\n", name,
+        (unsigned long)s->min, (unsigned long)s->max, (double)s->sum / n);
+}
+
+/* Raise one interrupt (which may chain), return the cycle it was raised */
+static uint32_t __attribute__((noinline)) irq_fire(uint32_t chain, uint32_t *t_back)
+{
+    uint32_t t0;
+
+    irq_cnt = 0;
+    irq_chain = chain;
+    __RWMB();
+
+    t0 = read_mcycle();
+    MSIP = 1;
+    /* The interrupt is taken around here, wait until all of them are done */
+    while (irq_cnt <= chain) {
+    }
+    *t_back = read_mcycle();
+    return t0;
+}
+
+int main(void)
+{
+    lat_stat lat_entry, lat_exit, lat_chain;
+    uint32_t run, k;
+    uint32_t chain_num = 0;
+    uint32_t mtvec_old;
+#ifdef CFG_E203_HPM
+    e203_hpm_snap hpm_start, hpm_end, hpm;
+#endif
+
+    lat_init(&lat_entry);
+    lat_init(&lat_exit);
+    lat_init(&lat_chain);
+
+    __asm__ volatile ("csrr %0, mtvec" : "=r"(mtvec_old));
+    __asm__ volatile ("csrw mtvec, %0" :: "r"((uint32_t)irq_latency_entry));
+    __asm__ volatile ("csrs mie, %0" :: "r"(1UL << 3));     /* MSIE */
+    __asm__ volatile ("csrs mstatus, %0" :: "r"(1UL << 3)); /* MIE  */
+
+    /* Warm up the I-side and the handler path */
+    for (run = 0; run < 4; run++) {
+        uint32_t t_back;
+        irq_fire(IRQ_CHAIN, &t_back);
+    }
+
+#ifdef CFG_E203_HPM
+    e203_hpm_read(&hpm_start);
+#endif
+    for (run = 0; run < IRQ_RUNS; run++) {
+        uint32_t t_back;
+        uint32_t t0 = irq_fire(IRQ_CHAIN, &t_back);
+
+        lat_add(&lat_entry, irq_t_entry[0] - t0);
+        lat_add(&lat_exit, t_back - irq_t_exit[IRQ_CHAIN]);
+        for (k = 0; k < IRQ_CHAIN; k++) {
+            lat_add(&lat_chain, irq_t_entry[k + 1] - irq_t_exit[k]);
+            chain_num++;
+        }
+    }
+#ifdef CFG_E203_HPM
+    e203_hpm_read(&hpm_end);
+    e203_hpm_diff(&hpm, &hpm_end, &hpm_start);
+#endif
+
+    __asm__ volatile ("csrc mstatus, %0" :: "r"(1UL << 3));
+    __asm__ volatile ("csrc mie, %0" :: "r"(1UL << 3));
+    __asm__ volatile ("csrw mtvec, %0" :: "r"(mtvec_old));
+
+    printf("\n--- IRQ Latency (%u runs, %u chained each, cycles) ---\n",
+        (unsigned)IRQ_RUNS, (unsigned)IRQ_CHAIN);
+#ifdef CFG_E203_HW_STACK
+    printf("Register Save               : hardware\n");
+#else
+    printf("Register Save               : software\n");
+#endif
+    lat_print("Entry (msip -> handler)", &lat_entry, IRQ_RUNS);
+    lat_print("Exit (handler -> main)", &lat_exit, IRQ_RUNS);
+    if (chain_num > 0) {
+        lat_print("Chain (handler -> handler)", &lat_chain, chain_num);
+    }
+#ifdef CFG_E203_HPM
+    printf("Frames Saved by Hardware    : %lu\n", (unsigned long)hpm.stk_push);
+    printf("Tail-Chained Interrupts     : %lu\n", (unsigned long)hpm.stk_tchn);
+    printf("Frame Bus Errors            : %lu\n", (unsigned long)hpm.stk_err);
+#endif
+#ifdef CFG_E203_HW_STACK
+    /* STK_STA: a frame access of the stacking engine got a bus error */
+    {
+        uint32_t stk_sta, stk_badaddr;
+        __asm__ volatile ("csrr %0, 0xBD0" : "=r"(stk_sta));
+        __asm__ volatile ("csrr %0, 0xBD1" : "=r"(stk_badaddr));
+        if (stk_sta != 0) {
+            printf("ERROR: frame bus error, STK_STA %lx at %08lx\n",
+                (unsigned long)stk_sta, (unsigned long)stk_badaddr);
+            return 1;
+        }
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * Micro Suite: the cycle cost of each pipeline hazard of the E203
+ *
+ * Every kernel of micro_kernels.S is run MICRO_ITERS times, its mcycle and
+ * minstret deltas minus the ones of the empty loop give the cycles and the
+ * instructions of one body, which are checked against the expected cycles
+ * below. A pipeline change that moves any of them shows up as a FAIL of
+ * that kernel, with the hazard named.
+ *
+ * The expected cycles are for the default core with the load-use
+ * forwarding, the code in ITCM and the data in DTCM. The rows as shipped
+ * follow the dispatch rules of the sim/ e203 model (one LSU outstanding
+ * command, the OITF drain, the fetch bubbles), which gives the same
+ * cycles, and are not measured on the RTL yet. So the kernels are only
+ * compared (ok/DIFF) and nothing fails, until the rows are measured:
+ * build with MICRO_CALIBRATE to print them as the table rows, paste them
+ * below, and build with MICRO_RTL_TABLE from then on, where a body passes
+ * only within MICRO_TOL (1) cycle of its row.
+ *
+ * Build with MICRO_UNALGN for a core with E203_HAS_UNALGN_SPLIT: the
+ * unaligned lw and sw are first checked for their data, then timed as two
+ * more kernels.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "hbird_sdk_soc.h"
+#ifdef CFG_SIM_MARK
+#include "../coremark/e203_sim.h"
+#endif
+
+#ifndef MICRO_ITERS
+#define MICRO_ITERS      128
+#endif
+
+typedef void (*micro_fn)(uint32_t iters, uint32_t *buf);
+
+#define MICRO_DECL(name) extern void micro_##name(uint32_t iters, uint32_t *buf)
+
+MICRO_DECL(empty);
+MICRO_DECL(alu);
+MICRO_DECL(lu0);
+MICRO_DECL(lu1);
+MICRO_DECL(lu2);
+MICRO_DECL(chase);
+MICRO_DECL(ld_st);
+MICRO_DECL(ld_br);
+MICRO_DECL(ld_jalr);
+MICRO_DECL(waw);
+MICRO_DECL(csr);
+MICRO_DECL(fence);
+MICRO_DECL(mul);
+MICRO_DECL(div);
+MICRO_DECL(br_fwd);
+MICRO_DECL(br_loop);
+#ifdef MICRO_UNALGN
+MICRO_DECL(ua_lw);
+MICRO_DECL(ua_sw);
+#endif
+
+extern char micro_jalr_tgt[];
+
+typedef struct {
+    const char *name;
+    micro_fn fn;
+    uint32_t exp_cyc;   /* Expected cycles of one body */
+    const char *what;
+} micro_kernel;
+
+static const micro_kernel micro_table[] = {
+    { "alu",     micro_alu,       8, "8 independent addi" },
+    { "lu0",     micro_lu0,      16, "8x lw + use at distance 0" },
+    { "lu1",     micro_lu1,      24, "8x lw + use at distance 1" },
+    { "lu2",     micro_lu2,      32, "8x lw + use at distance 2" },
+    { "chase",   micro_chase,    15, "8 chained lw (pointer chase)" },
+    { "ld_st",   micro_ld_st,    31, "8x lw -> sw data" },
+    { "ld_br",   micro_ld_br,    16, "8x lw -> beqz (not taken)" },
+    { "ld_jalr", micro_ld_jalr,   4, "lw -> jalr" },
+    { "waw",     micro_waw,      24, "8x lw + addi to the same rd" },
+    { "csr",     micro_csr,      24, "8x lw + csrr" },
+    { "fence",   micro_fence,    24, "8 fence" },
+    { "mul",     micro_mul,     137, "8 dependent mul" },
+    { "div",     micro_div,     266, "8 dependent div" },
+    { "br_fwd",  micro_br_fwd,   24, "8 taken forward beqz" },
+    { "br_loop", micro_br_loop,  26, "8-trip inner loop" },
+#ifdef MICRO_UNALGN
+    { "ua_lw",   micro_ua_lw,    24, "8 lw across a word (offset 2)" },
+    { "ua_sw",   micro_ua_sw,    24, "8 sw across a word (offset 3)" },
+#endif
+};
+
+#define MICRO_NUM  (sizeof(micro_table) / sizeof(micro_table[0]))
+
+#define read_mcycle()   ({ uint32_t __v; __asm__ volatile ("csrr %0, mcycle" : "=r"(__v)); __v; })
+#define read_minstret() ({ uint32_t __v; __asm__ volatile ("csrr %0, minstret" : "=r"(__v)); __v; })
+
+static uint32_t micro_buf[6] __attribute__((aligned(16)));
+
+static void micro_run(micro_fn fn, uint32_t *cyc, uint32_t *inst)
+{
+    uint32_t c0, i0, c1, i1;
+
+    /* Warm up the fetch path first */
+    fn(2, micro_buf);
+
+    i0 = read_minstret();
+    c0 = read_mcycle();
+    fn(MICRO_ITERS, micro_buf);
+    c1 = read_mcycle();
+    i1 = read_minstret();
+
+    *cyc = c1 - c0;
+    *inst = i1 - i0;
+}
+
+#ifdef MICRO_UNALGN
+/* The data of an unaligned lw at offset 2 and of an unaligned sw at offset
+ * 3, both across the word boundary of buf[4] and buf[5] */
+static int micro_unalgn_check(void)
+{
+    uint8_t *p = (uint8_t *)&micro_buf[4];
+    uint32_t v;
+    int lw_ok, sw_ok;
+
+    micro_buf[4] = 0x33221100;
+    micro_buf[5] = 0x77665544;
+    __asm__ volatile ("lw %0, 0(%1)" : "=r"(v) : "r"(p + 2) : "memory");
+    lw_ok = (v == 0x55443322);
+    printf("ua_lw    data 0x%08lx, exp 0x55443322  %s\n", (unsigned long)v,
+        lw_ok ? "PASS" : "FAIL");
+
+    __asm__ volatile ("sw %0, 0(%1)" : : "r"(0xddccbbaa), "r"(p + 3) : "memory");
+    sw_ok = (micro_buf[4] == 0xaa221100) && (micro_buf[5] == 0x77ddccbb);
+    printf("ua_sw    data 0x%08lx 0x%08lx, exp 0xaa221100 0x77ddccbb  %s\n",
+        (unsigned long)micro_buf[4], (unsigned long)micro_buf[5], sw_ok ? "PASS" : "FAIL");
+    return lw_ok && sw_ok;
+}
+#endif
+
+/* The cycles must match the expected ones, only the rounding of the
+ * empty loop subtracted may move them by one */
+#define MICRO_TOL        1
+
+static int micro_check(uint32_t cyc, uint32_t exp_cyc)
+{
+    uint32_t diff = (cyc > exp_cyc) ? (cyc - exp_cyc) : (exp_cyc - cyc);
+
+    return diff <= MICRO_TOL;
+}
+
+int main(void)
+{
+    uint32_t base_cyc, base_inst;
+    uint32_t k;
+    int fail = 0;
+
+    micro_buf[0] = (uint32_t)(uintptr_t)&micro_buf[0];
+    micro_buf[1] = 1;
+    micro_buf[2] = (uint32_t)(uintptr_t)micro_jalr_tgt;
+    micro_buf[3] = 0;
+
+#ifdef MICRO_UNALGN
+    fail |= !micro_unalgn_check();
+#endif
+    micro_run(micro_empty, &base_cyc, &base_inst);
+
+    printf("\n--- Micro Suite (%u iterations, cycles per body) ---\n", (unsigned)MICRO_ITERS);
+#ifndef MICRO_CALIBRATE
+    printf("%-8s %5s %7s %5s %5s  %s\n", "Kernel", "Insts", "Cycles", "CPI", "Exp", "Result");
+#endif
+
+    for (k = 0; k < MICRO_NUM; k++) {
+        const micro_kernel *m = &micro_table[k];
+        uint32_t cyc, inst, body_cyc, body_inst;
+
+        micro_run(m->fn, &cyc, &inst);
+
+        /* Rounded to the nearest per body */
+        body_cyc  = (cyc - base_cyc + MICRO_ITERS / 2) / MICRO_ITERS;
+        body_inst = (inst - base_inst + MICRO_ITERS / 2) / MICRO_ITERS;
+
+#ifdef MICRO_CALIBRATE
+        printf("    { \"%s\",%*s micro_%s,%*s %3lu, \"%s\" }, /* %lu insts */\n", m->name,
+            (int)(7 - strlen(m->name)), "", m->name, (int)(7 - strlen(m->name)), "",
+            (unsigned long)body_cyc, m->what, (unsigned long)body_inst);
+#else
+        int ok = micro_check(body_cyc, m->exp_cyc);
+#ifdef MICRO_RTL_TABLE
+        const char *res = ok ? "PASS" : "FAIL";
+        fail |= !ok;
+#else
+        const char *res = ok ? "ok" : "DIFF";
+#endif
+        printf("%-8s %5lu %7lu %5.2f %5lu  %s  (%s)\n", m->name,
+            (unsigned long)body_inst, (unsigned long)body_cyc,
+            body_inst ? (double)body_cyc / body_inst : 0.0,
+            (unsigned long)m->exp_cyc, res, m->what);
+#endif
+    }
+
+#ifndef MICRO_CALIBRATE
+#ifndef MICRO_RTL_TABLE
+    printf("Micro Suite cycles          : not checked, the table is not measured on the RTL\n");
+#endif
+    printf("Micro Suite                 : %s\n", fail ? "FAIL" : "PASS");
+#endif
+#ifdef CFG_SIM_MARK
+    e203_sim_mark(fail ? E203_SIM_MARK_FAIL : E203_SIM_MARK_PASS);
+#endif
+    return fail;
+}
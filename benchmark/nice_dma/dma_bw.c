@@ -0,0 +1,143 @@
+/*
+ * DMA Bandwidth: memcpy/memset through the NICE DMA engine vs. the CPU
+ *
+ * Each block size below is copied and filled RUNS times with the C library
+ * memcpy/memset (the lw/sw loop on the AGU) and with the e203_dma.h
+ * wrappers (the e203_nice_dma engine on the NICE memory port), and the
+ * bytes per cycle of both are printed. Every DMA result is checked against
+ * the expected data. Run it on a core built with E203_HAS_NICE and
+ * e203_nice_dma as its NICE coprocessor.
+ *
+ * The buffers are in DMA_SRC_ADDR/DMA_DST_ADDR if given (e.g., to measure
+ * the external memory), otherwise they are static arrays.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "hbird_sdk_soc.h"
+#include "e203_dma.h"
+
+#ifndef DMA_BUF_SIZE
+#define DMA_BUF_SIZE     4096
+#endif
+
+#ifndef DMA_RUNS
+#define DMA_RUNS         16
+#endif
+
+#ifdef DMA_SRC_ADDR
+#define dma_src  ((uint8_t *)DMA_SRC_ADDR)
+#define dma_dst  ((uint8_t *)DMA_DST_ADDR)
+#else
+static uint8_t dma_src[DMA_BUF_SIZE] __attribute__((aligned(4)));
+static uint8_t dma_dst[DMA_BUF_SIZE] __attribute__((aligned(4)));
+#endif
+
+static const uint32_t dma_sizes[] = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+
+#define DMA_SIZE_NUM  (sizeof(dma_sizes) / sizeof(dma_sizes[0]))
+
+#define read_mcycle() ({ uint32_t __v; __asm__ volatile ("csrr %0, mcycle" : "=r"(__v)); __v; })
+
+typedef void *(*cpy_fn)(void *, const void *, size_t);
+typedef void *(*set_fn)(void *, int, size_t);
+
+static void *dma_cpy_fn(void *d, const void *s, size_t n) { return e203_dma_memcpy(d, s, n); }
+static void *dma_set_fn(void *d, int c, size_t n) { return e203_dma_memset(d, c, n); }
+
+static uint32_t time_cpy(cpy_fn fn, uint32_t size)
+{
+    uint32_t run, t0, t1;
+
+    t0 = read_mcycle();
+    for (run = 0; run < DMA_RUNS; run++) {
+        fn(dma_dst, dma_src, size);
+    }
+    t1 = read_mcycle();
+    return t1 - t0;
+}
+
+static uint32_t time_set(set_fn fn, uint32_t size)
+{
+    uint32_t run, t0, t1;
+
+    t0 = read_mcycle();
+    for (run = 0; run < DMA_RUNS; run++) {
+        fn(dma_dst, (int)run, size);
+    }
+    t1 = read_mcycle();
+    return t1 - t0;
+}
+
+static void print_bw(const char *name, uint32_t size, uint32_t cyc_cpu, uint32_t cyc_dma)
+{
+    double bytes = (double)size * DMA_RUNS;
+
+    printf("%-6s %6lu : CPU %6.3f  DMA %6.3f B/cycle  (x%.2f)\n", name,
+        (unsigned long)size, bytes / cyc_cpu, bytes / cyc_dma,
+        (double)cyc_cpu / cyc_dma);
+}
+
+/* The unaligned head/tail and the odd sizes go through the wrappers too */
+static int check(void)
+{
+    uint32_t i, ofs, len;
+    int err = 0;
+
+    for (i = 0; i < DMA_BUF_SIZE; i++) {
+        dma_src[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    for (ofs = 0; ofs < 4; ofs++) {
+        for (len = 33; len < 300; len += 37) {
+            memset(dma_dst, 0xA5, len + 8);
+            e203_dma_memcpy(dma_dst + ofs, dma_src + ofs, len);
+            if (memcmp(dma_dst + ofs, dma_src + ofs, len) != 0) {
+                printf("ERROR: dma memcpy ofs %lu len %lu\n", (unsigned long)ofs, (unsigned long)len);
+                err = 1;
+            }
+            if (dma_dst[ofs + len] != 0xA5) {
+                printf("ERROR: dma memcpy overrun ofs %lu len %lu\n", (unsigned long)ofs, (unsigned long)len);
+                err = 1;
+            }
+
+            e203_dma_memset(dma_dst + ofs, 0x5A, len);
+            for (i = 0; i < len; i++) {
+                if (dma_dst[ofs + i] != 0x5A) {
+                    printf("ERROR: dma memset ofs %lu len %lu\n", (unsigned long)ofs, (unsigned long)len);
+                    err = 1;
+                    break;
+                }
+            }
+        }
+    }
+    return err;
+}
+
+int main(void)
+{
+    uint32_t k;
+
+    printf("\n--- NICE DMA Bandwidth (%u runs each) ---\n", (unsigned)DMA_RUNS);
+
+    if (check()) {
+        return 1;
+    }
+
+    for (k = 0; k < DMA_SIZE_NUM; k++) {
+        uint32_t size = dma_sizes[k];
+        if (size > DMA_BUF_SIZE) {
+            break;
+        }
+        print_bw("memcpy", size, time_cpy(memcpy, size), time_cpy(dma_cpy_fn, size));
+    }
+    for (k = 0; k < DMA_SIZE_NUM; k++) {
+        uint32_t size = dma_sizes[k];
+        if (size > DMA_BUF_SIZE) {
+            break;
+        }
+        print_bw("memset", size, time_set(memset, size), time_set(dma_set_fn, size));
+    }
+
+    return 0;
+}
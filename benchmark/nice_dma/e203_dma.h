@@ -0,0 +1,112 @@
+#ifndef E203_DMA_H
+#define E203_DMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* ========================================================================== */
+/* E203 NICE DMA Engine                                                      */
+/* The instructions of e203_nice_dma (custom-3, R-type), and the             */
+/* memcpy/memset wrappers handling the unaligned head and tail in software   */
+/* ========================================================================== */
+
+/* Blocks below this size are faster with the plain loads/stores */
+#ifndef E203_DMA_MIN_BYTES
+#define E203_DMA_MIN_BYTES  32
+#endif
+
+/* dma.len rd, rs1, rs2: set the block length (bytes) and the source (or
+ * the fill word of dma.set), returns the ticket of the block */
+static inline uint32_t e203_dma_len(uint32_t len, uint32_t src)
+{
+    uint32_t tkt;
+    __asm__ volatile (".insn r 0x7b, 0x7, 0x01, %0, %1, %2"
+        : "=r"(tkt) : "r"(len), "r"(src) : "memory");
+    return tkt;
+}
+
+/* dma.cpy rd, rs1, rs2: copy the block of the ticket to dst, returns the
+ * bytes copied when done, or 0 if another dma.len came in between */
+static inline uint32_t e203_dma_cpy(void *dst, uint32_t tkt)
+{
+    uint32_t n;
+    __asm__ volatile (".insn r 0x7b, 0x7, 0x02, %0, %1, %2"
+        : "=r"(n) : "r"(dst), "r"(tkt) : "memory");
+    return n;
+}
+
+/* dma.set rd, rs1, rs2: fill the block of the ticket at dst, returns the
+ * bytes filled when done, or 0 if another dma.len came in between */
+static inline uint32_t e203_dma_set(void *dst, uint32_t tkt)
+{
+    uint32_t n;
+    __asm__ volatile (".insn r 0x7b, 0x7, 0x03, %0, %1, %2"
+        : "=r"(n) : "r"(dst), "r"(tkt) : "memory");
+    return n;
+}
+
+/* The DMA writes around the L0 data cache, the fence invalidates it. The
+ * dependency on n makes sure the block is done before the fence */
+static inline void e203_dma_sync(uint32_t n)
+{
+    __asm__ volatile ("fence" :: "r"(n) : "memory");
+}
+
+static inline void *e203_dma_memcpy(void *dst, const void *src, size_t len)
+{
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    size_t head, body;
+    uint32_t n;
+
+    /* Only the blocks with the same word alignment go through the DMA */
+    if ((len < E203_DMA_MIN_BYTES) || ((((uintptr_t)d) ^ ((uintptr_t)s)) & 3)) {
+        return memcpy(dst, src, len);
+    }
+
+    head = (4 - ((uintptr_t)d & 3)) & 3;
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    len -= head;
+
+    /* The pair is issued again if an interrupt handler (or another task)
+     * used the DMA between the dma.len and the dma.cpy */
+    body = len & ~(size_t)3;
+    do {
+        n = e203_dma_cpy(d, e203_dma_len((uint32_t)body, (uint32_t)(uintptr_t)s));
+    } while ((n == 0) && (body != 0));
+    e203_dma_sync(n);
+
+    memcpy(d + body, s + body, len - body);
+    return dst;
+}
+
+static inline void *e203_dma_memset(void *dst, int c, size_t len)
+{
+    uint8_t *d = (uint8_t *)dst;
+    uint32_t word = (uint8_t)c * 0x01010101UL;
+    size_t head, body;
+    uint32_t n;
+
+    if (len < E203_DMA_MIN_BYTES) {
+        return memset(dst, c, len);
+    }
+
+    head = (4 - ((uintptr_t)d & 3)) & 3;
+    memset(d, c, head);
+    d += head;
+    len -= head;
+
+    body = len & ~(size_t)3;
+    do {
+        n = e203_dma_set(d, e203_dma_len((uint32_t)body, word));
+    } while ((n == 0) && (body != 0));
+    e203_dma_sync(n);
+
+    memset(d + body, c, len - body);
+    return dst;
+}
+
+#endif
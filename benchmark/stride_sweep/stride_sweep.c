@@ -0,0 +1,105 @@
+/*
+ * Stride Sweep: the load latency hidden by the E203 data prefetcher
+ *
+ * A buffer in the external memory is walked with a fixed stride, one load
+ * per iteration with a few ALU instructions in between (the idle cycles of
+ * the AGU ICB channel the prefetcher issues on). The sweep is run over the
+ * strides below, so the average cycles per load can be compared between a
+ * core built with and without E203_HAS_DPF.
+ *
+ * SWEEP_BUF_ADDR must be in the prefetchable region of the core
+ * (PF_REGION_BASE/PF_REGION_MASK of e203_exu_dpf), and not in the DTCM,
+ * otherwise nothing is prefetched.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include "hbird_sdk_soc.h"
+
+#ifdef CFG_E203_HPM
+#include "../coremark/e203_hpm.h"
+#endif
+
+#ifndef SWEEP_BUF_ADDR
+#define SWEEP_BUF_ADDR   0xA0100000UL
+#endif
+
+#ifndef SWEEP_BUF_SIZE
+#define SWEEP_BUF_SIZE   (64 * 1024)
+#endif
+
+#ifndef SWEEP_LOADS
+#define SWEEP_LOADS      1024
+#endif
+
+static const uint32_t sweep_strides[] = { 4, 8, 12, 16, 32, 64, 128, 256 };
+
+#define SWEEP_NUM  (sizeof(sweep_strides) / sizeof(sweep_strides[0]))
+
+/* Walk the buffer once, the stride is in bytes */
+static uint32_t __attribute__((noinline)) sweep_walk(volatile uint32_t *buf, uint32_t stride, uint32_t loads)
+{
+    uint32_t sum = 0;
+    uint32_t ofst = 0;
+    uint32_t i;
+
+    for (i = 0; i < loads; i++) {
+        sum += buf[ofst >> 2];
+        sum ^= (sum << 3);
+        ofst += stride;
+        if (ofst >= SWEEP_BUF_SIZE) {
+            ofst -= SWEEP_BUF_SIZE;
+        }
+    }
+    return sum;
+}
+
+int main(void)
+{
+    volatile uint32_t *buf = (volatile uint32_t *)SWEEP_BUF_ADDR;
+    uint32_t i;
+    uint32_t n;
+
+    for (i = 0; i < SWEEP_BUF_SIZE / 4; i++) {
+        buf[i] = i * 0x9E3779B9UL;
+    }
+
+    printf("\n--- Stride Sweep (%u loads per stride) ---\n", (unsigned)SWEEP_LOADS);
+    printf("Buffer                      : 0x%08lx, %u bytes\n", (unsigned long)SWEEP_BUF_ADDR, (unsigned)SWEEP_BUF_SIZE);
+#ifdef CFG_E203_HPM
+    printf("Stride  Cycles/Load  Checksum    Issued   PB Hits  Useless\n");
+#else
+    printf("Stride  Cycles/Load  Checksum\n");
+#endif
+
+    for (n = 0; n < SWEEP_NUM; n++) {
+        uint32_t stride = sweep_strides[n];
+        uint64_t t0, t1;
+        uint32_t sum;
+#ifdef CFG_E203_HPM
+        e203_hpm_snap hpm_start, hpm_end, hpm;
+#endif
+
+        /* Warm up the I-side and train the prefetcher, then measure */
+        sweep_walk(buf, stride, 16);
+        __RWMB();
+
+#ifdef CFG_E203_HPM
+        e203_hpm_read(&hpm_start);
+#endif
+        t0 = __get_rv_cycle();
+        sum = sweep_walk(buf, stride, SWEEP_LOADS);
+        t1 = __get_rv_cycle();
+#ifdef CFG_E203_HPM
+        e203_hpm_read(&hpm_end);
+        e203_hpm_diff(&hpm, &hpm_end, &hpm_start);
+        printf("%6lu  %11.2f  0x%08lx  %7lu  %7lu  %7lu\n",
+            (unsigned long)stride, (double)(t1 - t0) / SWEEP_LOADS, (unsigned long)sum,
+            (unsigned long)hpm.pf_issue, (unsigned long)hpm.pfb_hit, (unsigned long)hpm.pf_useless);
+#else
+        printf("%6lu  %11.2f  0x%08lx\n",
+            (unsigned long)stride, (double)(t1 - t0) / SWEEP_LOADS, (unsigned long)sum);
+#endif
+    }
+
+    return 0;
+}
@@ -94,6 +94,17 @@ module e203_exu(
   input  [`E203_RFIDX_WIDTH-1:0] i_rs1idx,   // The RS1 index
   input  [`E203_RFIDX_WIDTH-1:0] i_rs2idx,   // The RS2 index
 
+  `ifdef E203_HAS_ICACHE//{
+  // The events from the I-Cache (e203_ifu_icache) to be counted by HPM
+  input  icache_hit_evt,
+  input  icache_miss_evt,
+  input  icache_pf_evt,
+  `endif//}
+
+  `ifdef E203_HAS_ITCM_BNK//{
+  // The event from the banked ITCM (e203_itcm_bnk) to be counted by HPM
+  input  itcm_bnk_cfl_evt,
+  `endif//}
 
 
   //////////////////////////////////////////////////////////////
@@ -205,6 +216,73 @@ module e203_exu(
   );
 
 
+  //////////////////////////////////////////////////////////////
+  // The IR stage seen by the EXU, it is the IR stage from IFU itself
+  //   unless the Instruction Fetch Queue is between them
+  wire exu_i_valid;
+  wire exu_i_ready;
+  wire [`E203_INSTR_SIZE-1:0] exu_i_ir;
+  wire [`E203_PC_SIZE-1:0] exu_i_pc;
+  wire exu_i_pc_vld;
+  wire exu_i_misalgn;
+  wire exu_i_buserr;
+  wire exu_i_prdt_taken;
+  wire exu_i_muldiv_b2b;
+  wire [`E203_RFIDX_WIDTH-1:0] exu_i_rs1idx;
+  wire [`E203_RFIDX_WIDTH-1:0] exu_i_rs2idx;
+
+  wire ifq_empty;
+
+  `ifdef E203_HAS_IFQ//{
+  e203_exu_ifq u_e203_exu_ifq(
+    .i_valid             (i_valid     ),
+    .i_ready             (i_ready     ),
+    .i_ir                (i_ir        ),
+    .i_pc                (i_pc        ),
+    .i_pc_vld            (i_pc_vld    ),
+    .i_misalgn           (i_misalgn   ),
+    .i_buserr            (i_buserr    ),
+    .i_prdt_taken        (i_prdt_taken),
+    .i_muldiv_b2b        (i_muldiv_b2b),
+    .i_rs1idx            (i_rs1idx    ),
+    .i_rs2idx            (i_rs2idx    ),
+
+    .o_valid             (exu_i_valid     ),
+    .o_ready             (exu_i_ready     ),
+    .o_ir                (exu_i_ir        ),
+    .o_pc                (exu_i_pc        ),
+    .o_pc_vld            (exu_i_pc_vld    ),
+    .o_misalgn           (exu_i_misalgn   ),
+    .o_buserr            (exu_i_buserr    ),
+    .o_prdt_taken        (exu_i_prdt_taken),
+    .o_muldiv_b2b        (exu_i_muldiv_b2b),
+    .o_rs1idx            (exu_i_rs1idx    ),
+    .o_rs2idx            (exu_i_rs2idx    ),
+
+    .pipe_flush_req      (pipe_flush_req),
+    .pipe_flush_ack      (pipe_flush_ack),
+
+    .ifq_empty           (ifq_empty),
+
+    .clk                 (clk  ),
+    .rst_n               (rst_n) 
+  );
+  `else//}{
+  assign exu_i_valid      = i_valid;
+  assign i_ready          = exu_i_ready;
+  assign exu_i_ir         = i_ir;
+  assign exu_i_pc         = i_pc;
+  assign exu_i_pc_vld     = i_pc_vld;
+  assign exu_i_misalgn    = i_misalgn;
+  assign exu_i_buserr     = i_buserr;
+  assign exu_i_prdt_taken = i_prdt_taken;
+  assign exu_i_muldiv_b2b = i_muldiv_b2b;
+  assign exu_i_rs1idx     = i_rs1idx;
+  assign exu_i_rs2idx     = i_rs2idx;
+
+  assign ifq_empty = 1'b1;
+  `endif//}
+
   //////////////////////////////////////////////////////////////
   // Instantiate the Regfile
   wire [`E203_XLEN-1:0] rf_rs1;
@@ -214,10 +292,43 @@ module e203_exu(
   wire [`E203_XLEN-1:0] rf_wbck_wdat;
   wire [`E203_RFIDX_WIDTH-1:0] rf_wbck_rdidx;
 
+  // The regfile read indexes, from the IR stage unless the Hardware Stacking
+  //   Engine is reading the frame registers
+  wire [`E203_RFIDX_WIDTH-1:0] rf_rs1idx;
+  wire [`E203_RFIDX_WIDTH-1:0] rf_rs2idx;
+  wire stk_hold;
+  wire stk_irq_blk;
+
+  `ifdef E203_HAS_RF_2W//{
+  // The 2nd write port, for the Long-pipe write-back
+  wire rf_wbck1_ena;
+  wire [`E203_XLEN-1:0] rf_wbck1_wdat;
+  wire [`E203_RFIDX_WIDTH-1:0] rf_wbck1_rdidx;
+
+  e203_exu_regfile_2w u_e203_exu_regfile(
+    .read_src1_idx (rf_rs1idx ),
+    .read_src2_idx (rf_rs2idx ),
+    .read_src1_dat (rf_rs1),
+    .read_src2_dat (rf_rs2),
+    
+    .x1_r          (rf2ifu_x1),
+                    
+    .wbck0_dest_wen (rf_wbck_ena),
+    .wbck0_dest_idx (rf_wbck_rdidx),
+    .wbck0_dest_dat (rf_wbck_wdat),
 
+    .wbck1_dest_wen (rf_wbck1_ena),
+    .wbck1_dest_idx (rf_wbck1_rdidx),
+    .wbck1_dest_dat (rf_wbck1_wdat),
+                                 
+    .test_mode     (test_mode),
+    .clk           (clk          ),
+    .rst_n         (rst_n        ) 
+  );
+  `else//}{
   e203_exu_regfile u_e203_exu_regfile(
-    .read_src1_idx (i_rs1idx ),
-    .read_src2_idx (i_rs2idx ),
+    .read_src1_idx (rf_rs1idx ),
+    .read_src2_idx (rf_rs2idx ),
     .read_src1_dat (rf_rs1),
     .read_src2_dat (rf_rs2),
     
@@ -231,6 +342,7 @@ module e203_exu(
     .clk           (clk          ),
     .rst_n         (rst_n        ) 
   );
+  `endif//}
 
   wire dec_rs1en;
   wire dec_rs2en;
@@ -249,6 +361,11 @@ module e203_exu(
   wire dec_misalgn;
   wire dec_buserr;
   wire dec_ilegl;
+  wire dec_mulhsu;
+  wire dec_div   ;
+  wire dec_rem   ;
+  wire dec_divu  ;
+  wire dec_remu  ;
 
   `ifdef E203_HAS_NICE//{
   wire nice_cmt_off_ilgl;
@@ -260,12 +377,12 @@ module e203_exu(
   e203_exu_decode u_e203_exu_decode (
     .dbg_mode     (dbg_mode),
 
-    .i_instr      (i_ir    ),
-    .i_pc         (i_pc    ),
-    .i_misalgn    (i_misalgn),
-    .i_buserr     (i_buserr ),
-    .i_prdt_taken (i_prdt_taken), 
-    .i_muldiv_b2b (i_muldiv_b2b), 
+    .i_instr      (exu_i_ir    ),
+    .i_pc         (exu_i_pc    ),
+    .i_misalgn    (exu_i_misalgn),
+    .i_buserr     (exu_i_buserr ),
+    .i_prdt_taken (exu_i_prdt_taken), 
+    .i_muldiv_b2b (exu_i_muldiv_b2b), 
       
     .dec_rv32  (),
     .dec_bjp   (),
@@ -281,12 +398,12 @@ module e203_exu(
     .nice_cmt_off_ilgl_o(nice_cmt_off_ilgl),      
   `endif//}
 
-    .dec_mulhsu  (dec2ifu_mulhsu),
+    .dec_mulhsu  (dec_mulhsu),
     .dec_mul     (),
-    .dec_div     (dec2ifu_div   ),
-    .dec_rem     (dec2ifu_rem   ),
-    .dec_divu    (dec2ifu_divu  ),
-    .dec_remu    (dec2ifu_remu  ),
+    .dec_div     (dec_div   ),
+    .dec_rem     (dec_rem   ),
+    .dec_divu    (dec_divu  ),
+    .dec_remu    (dec_remu  ),
 
 
     .dec_info  (dec_info ),
@@ -346,11 +463,28 @@ module e203_exu(
 
   wire disp_oitf_ena;
 
+  // The OITF empty of the EXU itself, the one to IFU also covers the queue
+  wire exu_oitf_empty;
+
   wire wfi_halt_exu_req;
   wire wfi_halt_exu_ack;
 
   wire amo_wait;
 
+  //////////////////////////////////////////////////////////////
+  // The LSU write-back seen by the Long-pipe Write-Back and the Dispatch,
+  //   it is the LSU Write-Back Interface itself unless some unit between
+  //   them needs to merge or re-order the responses
+  wire lsu_wbck_valid;
+  wire lsu_wbck_ready;
+  wire [`E203_XLEN-1:0] lsu_wbck_wdat;
+  wire [`E203_ITAG_WIDTH -1:0] lsu_wbck_itag;
+  wire lsu_wbck_err;
+  wire lsu_cmt_ld;
+  wire lsu_cmt_st;
+  wire [`E203_ADDR_SIZE-1:0] lsu_cmt_badaddr;
+  wire lsu_cmt_buserr;
+
   // Extract LSU writeback rdidx from OITF for forwarding
   wire [`E203_RFIDX_WIDTH-1:0] lsu_o_wbck_rdidx;
   assign lsu_o_wbck_rdidx = oitf_ret_rdidx;
@@ -359,22 +493,26 @@ module e203_exu(
   wire lsu_o_wbck_rdwen;
   assign lsu_o_wbck_rdwen = oitf_ret_rdwen;
 
+  // The dispatch is held while the Hardware Stacking Engine is busy
+  wire disp_i_ready;
+  assign exu_i_ready = disp_i_ready & (~stk_hold);
+
   e203_exu_disp u_e203_exu_disp(
     .wfi_halt_exu_req    (wfi_halt_exu_req),
     .wfi_halt_exu_ack    (wfi_halt_exu_ack),
-    .oitf_empty          (oitf_empty),
+    .oitf_empty          (exu_oitf_empty),
 
     .amo_wait            (amo_wait),
 
-    .disp_i_valid        (i_valid         ),
-    .disp_i_ready        (i_ready         ),
+    .disp_i_valid        (exu_i_valid & (~stk_hold)),
+    .disp_i_ready        (disp_i_ready    ),
 
     .disp_i_rs1x0        (dec_rs1x0       ),
     .disp_i_rs2x0        (dec_rs2x0       ),
     .disp_i_rs1en        (dec_rs1en       ),
     .disp_i_rs2en        (dec_rs2en       ),
-    .disp_i_rs1idx       (i_rs1idx      ),
-    .disp_i_rs2idx       (i_rs2idx      ),
+    .disp_i_rs1idx       (exu_i_rs1idx  ),
+    .disp_i_rs2idx       (exu_i_rs2idx  ),
     .disp_i_rdwen        (dec_rdwen       ),
     .disp_i_rdidx        (dec_rdidx       ),
     .disp_i_info         (dec_info        ),
@@ -387,9 +525,9 @@ module e203_exu(
     .disp_i_ilegl        (dec_ilegl      ),
 
     // [NEW] LSU writeback signals for Load-Use Forwarding
-    .lsu_o_valid         (lsu_o_valid     ),
+    .lsu_o_valid         (lsu_wbck_valid  ),
     .lsu_o_wbck_rdidx    (lsu_o_wbck_rdidx),
-    .lsu_o_wbck_wdat     (lsu_o_wbck_wdat ),
+    .lsu_o_wbck_wdat     (lsu_wbck_wdat   ),
     .lsu_o_wbck_rdwen    (lsu_o_wbck_rdwen),
 
     .disp_o_alu_valid    (disp_alu_valid   ),
@@ -477,7 +615,7 @@ module e203_exu(
     .oitfrd_match_disprs3 (oitfrd_match_disprs3),
     .oitfrd_match_disprd  (oitfrd_match_disprd ),
 
-    .oitf_empty           (oitf_empty    ),
+    .oitf_empty           (exu_oitf_empty),
 
     .clk                  (clk           ),
     .rst_n                (rst_n         ) 
@@ -490,6 +628,13 @@ module e203_exu(
   wire [`E203_XLEN-1:0] alu_wbck_o_wdat;
   wire [`E203_RFIDX_WIDTH-1:0] alu_wbck_o_rdidx;
 
+  // The write-back from the ALU itself, before the restored registers of
+  //   the Hardware Stacking Engine are merged into it
+  wire alu_wbck_valid;
+  wire alu_wbck_ready;
+  wire [`E203_XLEN-1:0] alu_wbck_wdat;
+  wire [`E203_RFIDX_WIDTH-1:0] alu_wbck_rdidx;
+
   wire alu_cmt_valid;
   wire alu_cmt_ready;
   wire alu_cmt_pc_vld;
@@ -539,6 +684,78 @@ module e203_exu(
   wire [`E203_ITAG_WIDTH-1:0] nice_o_itag;
   `endif//}
 
+  // The AGU ICB command generated by the ALU, before it goes to LSU-ctrl
+  wire                         alu_agu_icb_cmd_valid;
+  wire                         alu_agu_icb_cmd_ready;
+  wire [`E203_ADDR_SIZE-1:0]   alu_agu_icb_cmd_addr;
+  wire                         alu_agu_icb_cmd_read;
+  wire [`E203_XLEN-1:0]        alu_agu_icb_cmd_wdata;
+  wire [`E203_XLEN/8-1:0]      alu_agu_icb_cmd_wmask;
+  wire                         alu_agu_icb_cmd_lock;
+  wire                         alu_agu_icb_cmd_excl;
+  wire [1:0]                   alu_agu_icb_cmd_size;
+  wire                         alu_agu_icb_cmd_back2agu;
+  wire                         alu_agu_icb_cmd_usign;
+  wire [`E203_ITAG_WIDTH -1:0] alu_agu_icb_cmd_itag;
+
+  wire [`E203_ADDR_SIZE-1:0]   alu_agu_addr;
+
+  wire                         alu_agu_icb_rsp_valid;
+  wire                         alu_agu_icb_rsp_ready;
+  wire                         alu_agu_icb_rsp_err  ;
+  wire                         alu_agu_icb_rsp_excl_ok;
+  wire [`E203_XLEN-1:0]        alu_agu_icb_rsp_rdata;
+
+  wire [`E203_XLEN-1:0] alu_i_imm;
+
+  // The plain load/store (i.e., not the AMO or LR/SC) dispatched to the AGU,
+  //   whose address is just rs1 + imm and issued as a single ICB command
+  wire disp_alu_agu = (disp_alu_info[`E203_DECINFO_GRP] == `E203_DECINFO_GRP_AGU);
+  wire disp_alu_ldst = disp_alu_agu
+                     & (~disp_alu_info[`E203_DECINFO_AGU_AMO])
+                     & (~disp_alu_info[`E203_DECINFO_AGU_EXCL]);
+
+  `ifdef E203_HAS_UNALGN_SPLIT//{
+  // The unaligned load/store (except the AMO and LR/SC) is dispatched to
+  //   the AGU with its immediate pulled back to the word boundary, so
+  //   the AGU never raise the misaligned exception for it, and the
+  //   e203_exu_unalgn will recover the offset and split the access
+  wire [1:0] disp_alu_agu_size = disp_alu_info[`E203_DECINFO_AGU_SIZE];
+  wire [1:0] disp_alu_agu_ofst = disp_alu_rs1[1:0] + disp_alu_imm[1:0];
+  wire disp_alu_agu_unalgn = disp_alu_ldst
+                           & ( ((disp_alu_agu_size == 2'b01) & disp_alu_agu_ofst[0])
+                             | ((disp_alu_agu_size == 2'b10) & (|disp_alu_agu_ofst))
+                             );
+
+  assign alu_i_imm = disp_alu_agu_unalgn ? (disp_alu_imm - {{`E203_XLEN-2{1'b0}}, disp_alu_agu_ofst})
+                                         : disp_alu_imm;
+  `else//}{
+  assign alu_i_imm = disp_alu_imm;
+  `endif//}
+
+  wire eagu_evt;
+
+  `ifdef E203_HAS_EARLY_AGU//{
+  // The early AGU: the address of a plain load/store whose base register is
+  //   not pending in the OITF is computed by a dedicated adder straight from
+  //   the regfile read port and the (offset adjusted) immediate, instead of
+  //   through the dispatch operand mux (with the load forwarding) and the
+  //   ALU shared datapath adder. The base is then the regfile value anyway,
+  //   so both adders give the same address, this only takes the forwarding
+  //   mux and the shared adder out of the regfile-to-ICB address path.
+  wire eagu_sel = disp_alu_ldst & (~oitfrd_match_disprs1);
+  wire [`E203_XLEN-1:0] eagu_rs1 = rf_rs1 & {`E203_XLEN{~dec_rs1x0}};
+  wire [`E203_ADDR_SIZE-1:0] eagu_addr = eagu_rs1[`E203_ADDR_SIZE-1:0] + alu_i_imm[`E203_ADDR_SIZE-1:0];
+
+  assign alu_agu_icb_cmd_addr = eagu_sel ? eagu_addr : alu_agu_addr;
+
+  assign eagu_evt = eagu_sel & alu_agu_icb_cmd_valid & alu_agu_icb_cmd_ready;
+  `else//}{
+  assign alu_agu_icb_cmd_addr = alu_agu_addr;
+
+  assign eagu_evt = 1'b0;
+  `endif//}
+
   e203_exu_alu u_e203_exu_alu(
 
 
@@ -567,10 +784,10 @@ module e203_exu(
     .i_rdwen             (disp_alu_rdwen   ),
     .i_rdidx             (disp_alu_rdidx   ),
     .i_info              (disp_alu_info    ),
-    .i_pc                (i_pc    ),
-    .i_pc_vld            (i_pc_vld),
-    .i_instr             (i_ir    ),
-    .i_imm               (disp_alu_imm     ),
+    .i_pc                (exu_i_pc    ),
+    .i_pc_vld            (exu_i_pc_vld),
+    .i_instr             (exu_i_ir    ),
+    .i_imm               (alu_i_imm        ),
     .i_misalgn           (disp_alu_misalgn    ),
     .i_buserr            (disp_alu_buserr     ),
     .i_ilegl             (disp_alu_ilegl      ),
@@ -578,7 +795,7 @@ module e203_exu(
     .flush_pulse         (flush_pulse    ),
     .flush_req           (flush_req      ),
 
-    .oitf_empty          (oitf_empty),
+    .oitf_empty          (exu_oitf_empty),
     .amo_wait            (amo_wait),
 
     .cmt_o_valid         (alu_cmt_valid      ),
@@ -606,10 +823,10 @@ module e203_exu(
     .cmt_o_buserr        (alu_cmt_buserr),
     .cmt_o_badaddr       (alu_cmt_badaddr),
 
-    .wbck_o_valid        (alu_wbck_o_valid ), 
-    .wbck_o_ready        (alu_wbck_o_ready ),
-    .wbck_o_wdat         (alu_wbck_o_wdat  ),
-    .wbck_o_rdidx        (alu_wbck_o_rdidx ),
+    .wbck_o_valid        (alu_wbck_valid ), 
+    .wbck_o_ready        (alu_wbck_ready ),
+    .wbck_o_wdat         (alu_wbck_wdat  ),
+    .wbck_o_rdidx        (alu_wbck_rdidx ),
 
     .csr_ena             (csr_ena),
     .csr_idx             (csr_idx),
@@ -618,25 +835,25 @@ module e203_exu(
     .read_csr_dat        (read_csr_dat),
     .wbck_csr_dat        (wbck_csr_dat),
 
-    .agu_icb_cmd_valid   (agu_icb_cmd_valid ),
-    .agu_icb_cmd_ready   (agu_icb_cmd_ready ),
-    .agu_icb_cmd_addr    (agu_icb_cmd_addr ),
-    .agu_icb_cmd_read    (agu_icb_cmd_read   ),
-    .agu_icb_cmd_wdata   (agu_icb_cmd_wdata ),
-    .agu_icb_cmd_wmask   (agu_icb_cmd_wmask ),
-    .agu_icb_cmd_lock    (agu_icb_cmd_lock),
-    .agu_icb_cmd_excl    (agu_icb_cmd_excl),
-    .agu_icb_cmd_size    (agu_icb_cmd_size),
+    .agu_icb_cmd_valid   (alu_agu_icb_cmd_valid ),
+    .agu_icb_cmd_ready   (alu_agu_icb_cmd_ready ),
+    .agu_icb_cmd_addr    (alu_agu_addr ),
+    .agu_icb_cmd_read    (alu_agu_icb_cmd_read ),
+    .agu_icb_cmd_wdata   (alu_agu_icb_cmd_wdata ),
+    .agu_icb_cmd_wmask   (alu_agu_icb_cmd_wmask ),
+    .agu_icb_cmd_lock    (alu_agu_icb_cmd_lock),
+    .agu_icb_cmd_excl    (alu_agu_icb_cmd_excl),
+    .agu_icb_cmd_size    (alu_agu_icb_cmd_size),
    
-    .agu_icb_cmd_back2agu(agu_icb_cmd_back2agu ),
-    .agu_icb_cmd_usign   (agu_icb_cmd_usign),
-    .agu_icb_cmd_itag    (agu_icb_cmd_itag),
+    .agu_icb_cmd_back2agu(alu_agu_icb_cmd_back2agu ),
+    .agu_icb_cmd_usign   (alu_agu_icb_cmd_usign),
+    .agu_icb_cmd_itag    (alu_agu_icb_cmd_itag),
   
-    .agu_icb_rsp_valid   (agu_icb_rsp_valid ),
-    .agu_icb_rsp_ready   (agu_icb_rsp_ready ),
-    .agu_icb_rsp_err     (agu_icb_rsp_err   ),
-    .agu_icb_rsp_excl_ok (agu_icb_rsp_excl_ok),
-    .agu_icb_rsp_rdata   (agu_icb_rsp_rdata),
+    .agu_icb_rsp_valid   (alu_agu_icb_rsp_valid ),
+    .agu_icb_rsp_ready   (alu_agu_icb_rsp_ready ),
+    .agu_icb_rsp_err     (alu_agu_icb_rsp_err   ),
+    .agu_icb_rsp_excl_ok (alu_agu_icb_rsp_excl_ok),
+    .agu_icb_rsp_rdata   (alu_agu_icb_rsp_rdata),
 
     
 
@@ -666,6 +883,392 @@ module e203_exu(
     .rst_n               (rst_n        ) 
   );
 
+  //////////////////////////////////////////////////////////////
+  // The AGU ICB command after the splitter, and the LSU write-back before
+  //   it, both between the splitter and the data prefetcher
+  wire                         splt_icb_cmd_valid;
+  wire                         splt_icb_cmd_ready;
+  wire [`E203_ADDR_SIZE-1:0]   splt_icb_cmd_addr;
+  wire                         splt_icb_cmd_read;
+  wire [`E203_XLEN-1:0]        splt_icb_cmd_wdata;
+  wire [`E203_XLEN/8-1:0]      splt_icb_cmd_wmask;
+  wire                         splt_icb_cmd_lock;
+  wire                         splt_icb_cmd_excl;
+  wire [1:0]                   splt_icb_cmd_size;
+  wire                         splt_icb_cmd_back2agu;
+  wire                         splt_icb_cmd_usign;
+  wire [`E203_ITAG_WIDTH -1:0] splt_icb_cmd_itag;
+
+  wire dpf_wbck_valid;
+  wire dpf_wbck_ready;
+  wire [`E203_XLEN-1:0] dpf_wbck_wdat;
+  wire [`E203_ITAG_WIDTH -1:0] dpf_wbck_itag;
+  wire dpf_wbck_err;
+  wire dpf_cmt_ld;
+  wire dpf_cmt_st;
+  wire [`E203_ADDR_SIZE-1:0] dpf_cmt_badaddr;
+  wire dpf_cmt_buserr;
+
+  // The splitter keeps the command attributes and the write-back tags
+  assign splt_icb_cmd_read     = alu_agu_icb_cmd_read;
+  assign splt_icb_cmd_lock     = alu_agu_icb_cmd_lock;
+  assign splt_icb_cmd_excl     = alu_agu_icb_cmd_excl;
+  assign splt_icb_cmd_back2agu = alu_agu_icb_cmd_back2agu;
+  assign splt_icb_cmd_itag     = alu_agu_icb_cmd_itag;
+
+  assign lsu_wbck_itag = dpf_wbck_itag;
+  assign lsu_cmt_ld    = dpf_cmt_ld;
+  assign lsu_cmt_st    = dpf_cmt_st;
+
+  //////////////////////////////////////////////////////////////
+  // Instantiate the Unaligned Load/Store Splitter
+  wire splt_icb_cmd_2nd;
+  wire splt_evt;
+
+  `ifdef E203_HAS_UNALGN_SPLIT//{
+  e203_exu_unalgn u_e203_exu_unalgn(
+    .i_unalgn            (disp_alu_valid & disp_alu_agu_unalgn),
+    .i_unalgn_ofst       (disp_alu_agu_ofst),
+
+    .i_icb_cmd_valid     (alu_agu_icb_cmd_valid),
+    .i_icb_cmd_ready     (alu_agu_icb_cmd_ready),
+    .i_icb_cmd_addr      (alu_agu_icb_cmd_addr ),
+    .i_icb_cmd_read      (alu_agu_icb_cmd_read ),
+    .i_icb_cmd_wdata     (alu_agu_icb_cmd_wdata),
+    .i_icb_cmd_wmask     (alu_agu_icb_cmd_wmask),
+    .i_icb_cmd_size      (alu_agu_icb_cmd_size ),
+    .i_icb_cmd_usign     (alu_agu_icb_cmd_usign),
+    .i_icb_cmd_itag      (alu_agu_icb_cmd_itag ),
+
+    .o_icb_cmd_valid     (splt_icb_cmd_valid),
+    .o_icb_cmd_ready     (splt_icb_cmd_ready),
+    .o_icb_cmd_addr      (splt_icb_cmd_addr ),
+    .o_icb_cmd_wdata     (splt_icb_cmd_wdata),
+    .o_icb_cmd_wmask     (splt_icb_cmd_wmask),
+    .o_icb_cmd_size      (splt_icb_cmd_size ),
+    .o_icb_cmd_usign     (splt_icb_cmd_usign),
+
+    .lsu_i_valid         (dpf_wbck_valid   ),
+    .lsu_i_ready         (dpf_wbck_ready   ),
+    .lsu_i_wdat          (dpf_wbck_wdat    ),
+    .lsu_i_itag          (dpf_wbck_itag    ),
+    .lsu_i_err           (dpf_wbck_err     ),
+    .lsu_i_badaddr       (dpf_cmt_badaddr  ),
+    .lsu_i_buserr        (dpf_cmt_buserr   ),
+
+    .lsu_o_valid         (lsu_wbck_valid   ),
+    .lsu_o_ready         (lsu_wbck_ready   ),
+    .lsu_o_wdat          (lsu_wbck_wdat    ),
+    .lsu_o_err           (lsu_wbck_err     ),
+    .lsu_o_badaddr       (lsu_cmt_badaddr  ),
+    .lsu_o_buserr        (lsu_cmt_buserr   ),
+
+    .splt_2nd            (splt_icb_cmd_2nd),
+    .splt_evt            (splt_evt),
+
+    .clk                 (clk  ),
+    .rst_n               (rst_n) 
+  );
+  `else//}{
+  assign splt_icb_cmd_valid    = alu_agu_icb_cmd_valid;
+  assign alu_agu_icb_cmd_ready = splt_icb_cmd_ready;
+  assign splt_icb_cmd_addr     = alu_agu_icb_cmd_addr ;
+  assign splt_icb_cmd_wdata    = alu_agu_icb_cmd_wdata;
+  assign splt_icb_cmd_wmask    = alu_agu_icb_cmd_wmask;
+  assign splt_icb_cmd_size     = alu_agu_icb_cmd_size ;
+  assign splt_icb_cmd_usign    = alu_agu_icb_cmd_usign;
+
+  assign lsu_wbck_valid  = dpf_wbck_valid;
+  assign dpf_wbck_ready  = lsu_wbck_ready;
+  assign lsu_wbck_wdat   = dpf_wbck_wdat;
+  assign lsu_wbck_err    = dpf_wbck_err;
+  assign lsu_cmt_badaddr = dpf_cmt_badaddr;
+  assign lsu_cmt_buserr  = dpf_cmt_buserr;
+
+  assign splt_icb_cmd_2nd = 1'b0;
+  assign splt_evt = 1'b0;
+  `endif//}
+
+  //////////////////////////////////////////////////////////////
+  // The AGU ICB command after the data prefetcher, and the LSU write-back
+  //   before it, both between the data prefetcher and the L0 data cache
+  wire                         dpf_icb_cmd_valid;
+  wire                         dpf_icb_cmd_ready;
+  wire [`E203_ADDR_SIZE-1:0]   dpf_icb_cmd_addr;
+  wire                         dpf_icb_cmd_read;
+  wire [`E203_XLEN-1:0]        dpf_icb_cmd_wdata;
+  wire [`E203_XLEN/8-1:0]      dpf_icb_cmd_wmask;
+  wire                         dpf_icb_cmd_lock;
+  wire                         dpf_icb_cmd_excl;
+  wire [1:0]                   dpf_icb_cmd_size;
+  wire                         dpf_icb_cmd_back2agu;
+  wire                         dpf_icb_cmd_usign;
+  wire [`E203_ITAG_WIDTH -1:0] dpf_icb_cmd_itag;
+
+  wire                         dpf_icb_rsp_valid;
+  wire                         dpf_icb_rsp_ready;
+  wire                         dpf_icb_rsp_err  ;
+  wire                         dpf_icb_rsp_excl_ok;
+  wire [`E203_XLEN-1:0]        dpf_icb_rsp_rdata;
+
+  wire l0d_wbck_valid;
+  wire l0d_wbck_ready;
+  wire [`E203_XLEN-1:0] l0d_wbck_wdat;
+  wire [`E203_ITAG_WIDTH -1:0] l0d_wbck_itag;
+  wire l0d_wbck_err;
+  wire l0d_cmt_ld;
+  wire l0d_cmt_st;
+  wire [`E203_ADDR_SIZE-1:0] l0d_cmt_badaddr;
+  wire l0d_cmt_buserr;
+
+  // The fence dispatched, to drop the data buffered on the AGU ICB channel
+  wire disp_alu_fence = (disp_alu_info[`E203_DECINFO_GRP] == `E203_DECINFO_GRP_BJP)
+                      & disp_alu_info[`E203_DECINFO_BJP_FENCE];
+  wire disp_alu_fence_ena = disp_alu_valid & disp_alu_ready & disp_alu_fence;
+
+  //////////////////////////////////////////////////////////////
+  // Instantiate the Data Prefetcher
+  //   It is trained with the PC of the plain load being dispatched, which
+  //   is the one issuing its (1st) ICB command in the same cycle
+  wire pf_issue_evt;
+  wire pfb_hit_evt;
+  wire pf_useless_evt;
+
+  `ifdef E203_HAS_DPF//{
+  e203_exu_dpf u_e203_exu_dpf(
+    .i_ldst_pc_vld       (disp_alu_valid & disp_alu_ldst),
+    .i_ldst_pc           (disp_alu_pc),
+    .pf_flush            (disp_alu_fence_ena),
+    .amo_wait            (amo_wait),
+
+    .i_icb_cmd_valid     (splt_icb_cmd_valid   ),
+    .i_icb_cmd_ready     (splt_icb_cmd_ready   ),
+    .i_icb_cmd_addr      (splt_icb_cmd_addr    ),
+    .i_icb_cmd_read      (splt_icb_cmd_read    ),
+    .i_icb_cmd_wdata     (splt_icb_cmd_wdata   ),
+    .i_icb_cmd_wmask     (splt_icb_cmd_wmask   ),
+    .i_icb_cmd_lock      (splt_icb_cmd_lock    ),
+    .i_icb_cmd_excl      (splt_icb_cmd_excl    ),
+    .i_icb_cmd_size      (splt_icb_cmd_size    ),
+    .i_icb_cmd_back2agu  (splt_icb_cmd_back2agu),
+    .i_icb_cmd_usign     (splt_icb_cmd_usign   ),
+    .i_icb_cmd_itag      (splt_icb_cmd_itag    ),
+    .i_icb_cmd_2nd       (splt_icb_cmd_2nd     ),
+
+    .i_icb_rsp_valid     (alu_agu_icb_rsp_valid  ),
+    .i_icb_rsp_ready     (alu_agu_icb_rsp_ready  ),
+    .i_icb_rsp_err       (alu_agu_icb_rsp_err    ),
+    .i_icb_rsp_excl_ok   (alu_agu_icb_rsp_excl_ok),
+    .i_icb_rsp_rdata     (alu_agu_icb_rsp_rdata  ),
+
+    .o_icb_cmd_valid     (dpf_icb_cmd_valid   ),
+    .o_icb_cmd_ready     (dpf_icb_cmd_ready   ),
+    .o_icb_cmd_addr      (dpf_icb_cmd_addr    ),
+    .o_icb_cmd_read      (dpf_icb_cmd_read    ),
+    .o_icb_cmd_wdata     (dpf_icb_cmd_wdata   ),
+    .o_icb_cmd_wmask     (dpf_icb_cmd_wmask   ),
+    .o_icb_cmd_lock      (dpf_icb_cmd_lock    ),
+    .o_icb_cmd_excl      (dpf_icb_cmd_excl    ),
+    .o_icb_cmd_size      (dpf_icb_cmd_size    ),
+    .o_icb_cmd_back2agu  (dpf_icb_cmd_back2agu),
+    .o_icb_cmd_usign     (dpf_icb_cmd_usign   ),
+    .o_icb_cmd_itag      (dpf_icb_cmd_itag    ),
+
+    .o_icb_rsp_valid     (dpf_icb_rsp_valid  ),
+    .o_icb_rsp_ready     (dpf_icb_rsp_ready  ),
+    .o_icb_rsp_err       (dpf_icb_rsp_err    ),
+    .o_icb_rsp_excl_ok   (dpf_icb_rsp_excl_ok),
+    .o_icb_rsp_rdata     (dpf_icb_rsp_rdata  ),
+
+    .lsu_i_valid         (l0d_wbck_valid   ),
+    .lsu_i_ready         (l0d_wbck_ready   ),
+    .lsu_i_wdat          (l0d_wbck_wdat    ),
+    .lsu_i_itag          (l0d_wbck_itag    ),
+    .lsu_i_err           (l0d_wbck_err     ),
+    .lsu_i_ld            (l0d_cmt_ld       ),
+    .lsu_i_st            (l0d_cmt_st       ),
+    .lsu_i_badaddr       (l0d_cmt_badaddr  ),
+    .lsu_i_buserr        (l0d_cmt_buserr   ),
+
+    .lsu_o_valid         (dpf_wbck_valid   ),
+    .lsu_o_ready         (dpf_wbck_ready   ),
+    .lsu_o_wdat          (dpf_wbck_wdat    ),
+    .lsu_o_itag          (dpf_wbck_itag    ),
+    .lsu_o_err           (dpf_wbck_err     ),
+    .lsu_o_ld            (dpf_cmt_ld       ),
+    .lsu_o_st            (dpf_cmt_st       ),
+    .lsu_o_badaddr       (dpf_cmt_badaddr  ),
+    .lsu_o_buserr        (dpf_cmt_buserr   ),
+
+    .pf_issue_evt        (pf_issue_evt  ),
+    .pfb_hit_evt         (pfb_hit_evt   ),
+    .pf_useless_evt      (pf_useless_evt),
+
+    .clk                 (clk  ),
+    .rst_n               (rst_n) 
+  );
+  `else//}{
+  assign dpf_icb_cmd_valid     = splt_icb_cmd_valid;
+  assign splt_icb_cmd_ready    = dpf_icb_cmd_ready;
+  assign dpf_icb_cmd_addr      = splt_icb_cmd_addr    ;
+  assign dpf_icb_cmd_read      = splt_icb_cmd_read    ;
+  assign dpf_icb_cmd_wdata     = splt_icb_cmd_wdata   ;
+  assign dpf_icb_cmd_wmask     = splt_icb_cmd_wmask   ;
+  assign dpf_icb_cmd_lock      = splt_icb_cmd_lock    ;
+  assign dpf_icb_cmd_excl      = splt_icb_cmd_excl    ;
+  assign dpf_icb_cmd_size      = splt_icb_cmd_size    ;
+  assign dpf_icb_cmd_back2agu  = splt_icb_cmd_back2agu;
+  assign dpf_icb_cmd_usign     = splt_icb_cmd_usign   ;
+  assign dpf_icb_cmd_itag      = splt_icb_cmd_itag    ;
+
+  assign alu_agu_icb_rsp_valid   = dpf_icb_rsp_valid;
+  assign dpf_icb_rsp_ready       = alu_agu_icb_rsp_ready;
+  assign alu_agu_icb_rsp_err     = dpf_icb_rsp_err;
+  assign alu_agu_icb_rsp_excl_ok = dpf_icb_rsp_excl_ok;
+  assign alu_agu_icb_rsp_rdata   = dpf_icb_rsp_rdata;
+
+  assign dpf_wbck_valid  = l0d_wbck_valid;
+  assign l0d_wbck_ready  = dpf_wbck_ready;
+  assign dpf_wbck_wdat   = l0d_wbck_wdat;
+  assign dpf_wbck_itag   = l0d_wbck_itag;
+  assign dpf_wbck_err    = l0d_wbck_err;
+  assign dpf_cmt_ld      = l0d_cmt_ld;
+  assign dpf_cmt_st      = l0d_cmt_st;
+  assign dpf_cmt_badaddr = l0d_cmt_badaddr;
+  assign dpf_cmt_buserr  = l0d_cmt_buserr;
+
+  assign pf_issue_evt   = 1'b0;
+  assign pfb_hit_evt    = 1'b0;
+  assign pf_useless_evt = 1'b0;
+  `endif//}
+
+  //////////////////////////////////////////////////////////////
+  // Instantiate the L0 Data Cache
+  wire l0d_hit_evt;
+  wire l0d_miss_evt;
+
+  // The AGU ICB command after the L0 data cache, before it goes to LSU-ctrl
+  wire                         l0d_icb_cmd_valid;
+  wire                         l0d_icb_cmd_ready;
+  wire [`E203_ADDR_SIZE-1:0]   l0d_icb_cmd_addr;
+  wire                         l0d_icb_cmd_read;
+  wire [`E203_XLEN-1:0]        l0d_icb_cmd_wdata;
+  wire [`E203_XLEN/8-1:0]      l0d_icb_cmd_wmask;
+  wire                         l0d_icb_cmd_lock;
+  wire                         l0d_icb_cmd_excl;
+  wire [1:0]                   l0d_icb_cmd_size;
+  wire                         l0d_icb_cmd_back2agu;
+  wire                         l0d_icb_cmd_usign;
+  wire [`E203_ITAG_WIDTH -1:0] l0d_icb_cmd_itag;
+
+  wire                         l0d_icb_rsp_valid;
+  wire                         l0d_icb_rsp_ready;
+  wire                         l0d_icb_rsp_err  ;
+  wire                         l0d_icb_rsp_excl_ok;
+  wire [`E203_XLEN-1:0]        l0d_icb_rsp_rdata;
+
+  `ifdef E203_HAS_L0D//{
+  e203_exu_l0d u_e203_exu_l0d(
+    .l0d_flush           (disp_alu_fence_ena),
+
+    .i_icb_cmd_valid     (dpf_icb_cmd_valid   ),
+    .i_icb_cmd_ready     (dpf_icb_cmd_ready   ),
+    .i_icb_cmd_addr      (dpf_icb_cmd_addr    ),
+    .i_icb_cmd_read      (dpf_icb_cmd_read    ),
+    .i_icb_cmd_wdata     (dpf_icb_cmd_wdata   ),
+    .i_icb_cmd_wmask     (dpf_icb_cmd_wmask   ),
+    .i_icb_cmd_lock      (dpf_icb_cmd_lock    ),
+    .i_icb_cmd_excl      (dpf_icb_cmd_excl    ),
+    .i_icb_cmd_size      (dpf_icb_cmd_size    ),
+    .i_icb_cmd_back2agu  (dpf_icb_cmd_back2agu),
+    .i_icb_cmd_usign     (dpf_icb_cmd_usign   ),
+    .i_icb_cmd_itag      (dpf_icb_cmd_itag    ),
+
+    .i_icb_rsp_valid     (dpf_icb_rsp_valid  ),
+    .i_icb_rsp_ready     (dpf_icb_rsp_ready  ),
+    .i_icb_rsp_err       (dpf_icb_rsp_err    ),
+    .i_icb_rsp_excl_ok   (dpf_icb_rsp_excl_ok),
+    .i_icb_rsp_rdata     (dpf_icb_rsp_rdata  ),
+
+    .o_icb_cmd_valid     (l0d_icb_cmd_valid   ),
+    .o_icb_cmd_ready     (l0d_icb_cmd_ready   ),
+    .o_icb_cmd_addr      (l0d_icb_cmd_addr    ),
+    .o_icb_cmd_read      (l0d_icb_cmd_read    ),
+    .o_icb_cmd_wdata     (l0d_icb_cmd_wdata   ),
+    .o_icb_cmd_wmask     (l0d_icb_cmd_wmask   ),
+    .o_icb_cmd_lock      (l0d_icb_cmd_lock    ),
+    .o_icb_cmd_excl      (l0d_icb_cmd_excl    ),
+    .o_icb_cmd_size      (l0d_icb_cmd_size    ),
+    .o_icb_cmd_back2agu  (l0d_icb_cmd_back2agu),
+    .o_icb_cmd_usign     (l0d_icb_cmd_usign   ),
+    .o_icb_cmd_itag      (l0d_icb_cmd_itag    ),
+
+    .o_icb_rsp_valid     (l0d_icb_rsp_valid  ),
+    .o_icb_rsp_ready     (l0d_icb_rsp_ready  ),
+    .o_icb_rsp_err       (l0d_icb_rsp_err    ),
+    .o_icb_rsp_excl_ok   (l0d_icb_rsp_excl_ok),
+    .o_icb_rsp_rdata     (l0d_icb_rsp_rdata  ),
+
+    .lsu_i_valid         (lsu_o_valid      ),
+    .lsu_i_ready         (lsu_o_ready      ),
+    .lsu_i_wdat          (lsu_o_wbck_wdat  ),
+    .lsu_i_itag          (lsu_o_wbck_itag  ),
+    .lsu_i_err           (lsu_o_wbck_err   ),
+    .lsu_i_ld            (lsu_o_cmt_ld     ),
+    .lsu_i_st            (lsu_o_cmt_st     ),
+    .lsu_i_badaddr       (lsu_o_cmt_badaddr),
+    .lsu_i_buserr        (lsu_o_cmt_buserr ),
+
+    .lsu_o_valid         (l0d_wbck_valid   ),
+    .lsu_o_ready         (l0d_wbck_ready   ),
+    .lsu_o_wdat          (l0d_wbck_wdat    ),
+    .lsu_o_itag          (l0d_wbck_itag    ),
+    .lsu_o_err           (l0d_wbck_err     ),
+    .lsu_o_ld            (l0d_cmt_ld       ),
+    .lsu_o_st            (l0d_cmt_st       ),
+    .lsu_o_badaddr       (l0d_cmt_badaddr  ),
+    .lsu_o_buserr        (l0d_cmt_buserr   ),
+
+    .l0d_hit_evt         (l0d_hit_evt ),
+    .l0d_miss_evt        (l0d_miss_evt),
+
+    .clk                 (clk  ),
+    .rst_n               (rst_n) 
+  );
+  `else//}{
+  assign l0d_icb_cmd_valid     = dpf_icb_cmd_valid;
+  assign dpf_icb_cmd_ready     = l0d_icb_cmd_ready;
+  assign l0d_icb_cmd_addr      = dpf_icb_cmd_addr    ;
+  assign l0d_icb_cmd_read      = dpf_icb_cmd_read    ;
+  assign l0d_icb_cmd_wdata     = dpf_icb_cmd_wdata   ;
+  assign l0d_icb_cmd_wmask     = dpf_icb_cmd_wmask   ;
+  assign l0d_icb_cmd_lock      = dpf_icb_cmd_lock    ;
+  assign l0d_icb_cmd_excl      = dpf_icb_cmd_excl    ;
+  assign l0d_icb_cmd_size      = dpf_icb_cmd_size    ;
+  assign l0d_icb_cmd_back2agu  = dpf_icb_cmd_back2agu;
+  assign l0d_icb_cmd_usign     = dpf_icb_cmd_usign   ;
+  assign l0d_icb_cmd_itag      = dpf_icb_cmd_itag    ;
+
+  assign dpf_icb_rsp_valid     = l0d_icb_rsp_valid;
+  assign l0d_icb_rsp_ready     = dpf_icb_rsp_ready;
+  assign dpf_icb_rsp_err       = l0d_icb_rsp_err;
+  assign dpf_icb_rsp_excl_ok   = l0d_icb_rsp_excl_ok;
+  assign dpf_icb_rsp_rdata     = l0d_icb_rsp_rdata;
+
+  assign l0d_wbck_valid  = lsu_o_valid;
+  assign lsu_o_ready     = l0d_wbck_ready;
+  assign l0d_wbck_wdat   = lsu_o_wbck_wdat;
+  assign l0d_wbck_itag   = lsu_o_wbck_itag;
+  assign l0d_wbck_err    = lsu_o_wbck_err;
+  assign l0d_cmt_ld      = lsu_o_cmt_ld;
+  assign l0d_cmt_st      = lsu_o_cmt_st;
+  assign l0d_cmt_badaddr = lsu_o_cmt_badaddr;
+  assign l0d_cmt_buserr  = lsu_o_cmt_buserr;
+
+  assign l0d_hit_evt  = 1'b0;
+  assign l0d_miss_evt = 1'b0;
+  `endif//}
+
   //////////////////////////////////////////////////////////////
   // Instantiate the Long-pipe Write-Back
   wire longp_wbck_o_valid;
@@ -686,15 +1289,15 @@ module e203_exu(
 
   e203_exu_longpwbck u_e203_exu_longpwbck(
 
-    .lsu_wbck_i_valid   (lsu_o_valid ),
-    .lsu_wbck_i_ready   (lsu_o_ready ),
-    .lsu_wbck_i_wdat    (lsu_o_wbck_wdat  ),
-    .lsu_wbck_i_itag    (lsu_o_wbck_itag  ),
-    .lsu_wbck_i_err     (lsu_o_wbck_err   ),
-    .lsu_cmt_i_ld       (lsu_o_cmt_ld     ),
-    .lsu_cmt_i_st       (lsu_o_cmt_st     ),
-    .lsu_cmt_i_badaddr  (lsu_o_cmt_badaddr),
-    .lsu_cmt_i_buserr   (lsu_o_cmt_buserr ),
+    .lsu_wbck_i_valid   (lsu_wbck_valid ),
+    .lsu_wbck_i_ready   (lsu_wbck_ready ),
+    .lsu_wbck_i_wdat    (lsu_wbck_wdat  ),
+    .lsu_wbck_i_itag    (lsu_wbck_itag    ),
+    .lsu_wbck_i_err     (lsu_wbck_err     ),
+    .lsu_cmt_i_ld       (lsu_cmt_ld       ),
+    .lsu_cmt_i_st       (lsu_cmt_st       ),
+    .lsu_cmt_i_badaddr  (lsu_cmt_badaddr  ),
+    .lsu_cmt_i_buserr   (lsu_cmt_buserr   ),
 
     .longp_wbck_o_valid   (longp_wbck_o_valid ), 
     .longp_wbck_o_ready   (longp_wbck_o_ready ),
@@ -716,7 +1319,7 @@ module e203_exu(
     .oitf_ret_rdwen      (oitf_ret_rdwen),
     .oitf_ret_rdfpu      (oitf_ret_rdfpu),
     .oitf_ret_pc         (oitf_ret_pc),
-    .oitf_empty          (oitf_empty    ),
+    .oitf_empty          (exu_oitf_empty),
     .oitf_ret_ptr        (oitf_ret_ptr  ),
     .oitf_ret_ena        (oitf_ret_ena  ),
 
@@ -733,8 +1336,50 @@ module e203_exu(
   );
 
 
+  //////////////////////////////////////////////////////////////
+  // Instantiate the Load Value Locality Probe
+  //   The load is written back in order with the OITF, so the PC of the
+  //   retiring OITF entry is the PC of the load being written back
+  wire lvp_lkup_evt;
+  wire lvp_prdt_evt;
+  wire lvp_hit_evt;
+
+  `ifdef E203_HAS_LV_PROBE//{
+  e203_exu_lvprobe u_e203_exu_lvprobe(
+    .lvp_i_valid         (lsu_wbck_valid & lsu_wbck_ready & lsu_cmt_ld
+                         & oitf_ret_rdwen & (~lsu_wbck_err)),
+    .lvp_i_pc            (oitf_ret_pc  ),
+    .lvp_i_wdat          (lsu_wbck_wdat),
+
+    .lvp_lkup_evt        (lvp_lkup_evt),
+    .lvp_prdt_evt        (lvp_prdt_evt),
+    .lvp_hit_evt         (lvp_hit_evt ),
+
+    .clk                 (clk  ),
+    .rst_n               (rst_n) 
+  );
+  `else//}{
+  assign lvp_lkup_evt = 1'b0;
+  assign lvp_prdt_evt = 1'b0;
+  assign lvp_hit_evt  = 1'b0;
+  `endif//}
+
   //////////////////////////////////////////////////////////////
   // Instantiate the Final Write-Back
+  `ifdef E203_HAS_RF_2W//{
+  // Each of the ALU and Long-pipe write-backs has its own regfile write
+  //   port, so neither of them is ever back-pressured
+  assign alu_wbck_o_ready   = 1'b1;
+  assign longp_wbck_o_ready = 1'b1;
+
+  assign rf_wbck_ena    = alu_wbck_o_valid;
+  assign rf_wbck_wdat   = alu_wbck_o_wdat;
+  assign rf_wbck_rdidx  = alu_wbck_o_rdidx;
+
+  assign rf_wbck1_ena   = longp_wbck_o_valid & (~longp_wbck_o_rdfpu);
+  assign rf_wbck1_wdat  = longp_wbck_o_wdat[`E203_XLEN-1:0];
+  assign rf_wbck1_rdidx = longp_wbck_o_rdidx;
+  `else//}{
   e203_exu_wbck u_e203_exu_wbck(
 
     .alu_wbck_i_valid   (alu_wbck_o_valid ), 
@@ -757,6 +1402,7 @@ module e203_exu(
     .clk                 (clk          ),
     .rst_n               (rst_n        ) 
   );
+  `endif//}
 
   //////////////////////////////////////////////////////////////
   // Instantiate the Commit
@@ -809,7 +1455,7 @@ module e203_exu(
     .tmr_irq_r               (tmr_irq_r),
     .evt_r                   (evt_r    ),
 
-    .status_mie_r            (status_mie_r),
+    .status_mie_r            (status_mie_r & (~stk_irq_blk)),
     .mtie_r                  (mtie_r      ),
     .msie_r                  (msie_r      ),
     .meie_r                  (meie_r      ),
@@ -855,7 +1501,7 @@ module e203_exu(
     .dbg_ebreakm_r         (dbg_ebreakm_r),
 
 
-    .oitf_empty            (oitf_empty),
+    .oitf_empty            (exu_oitf_empty),
     .u_mode                (u_mode),
     .s_mode                (s_mode),
     .h_mode                (h_mode),
@@ -895,6 +1541,129 @@ module e203_exu(
     .rst_n                   (rst_n        ) 
   );
 
+  //////////////////////////////////////////////////////////////
+  // Instantiate the Hardware Stacking Engine
+  wire stk_push_evt;
+  wire stk_tchn_evt;
+  wire stk_err_evt;
+  wire [`E203_XLEN-1:0] stk_csr_dat;
+
+  `ifdef E203_HAS_HW_STACK//{
+  e203_exu_stk u_e203_exu_stk(
+    .trap_ena            (cmt_cause_ena),
+    .trap_irq            (cmt_cause[`E203_XLEN-1]),
+    .mret_ena            (cmt_mret_ena),
+    .irq_pend            ((ext_irq_r & meie_r) | (sft_irq_r & msie_r) | (tmr_irq_r & mtie_r)),
+
+    .oitf_empty          (exu_oitf_empty),
+
+    .stk_hold            (stk_hold),
+    .stk_irq_blk         (stk_irq_blk),
+
+    .i_rs1idx            (exu_i_rs1idx),
+    .i_rs2idx            (exu_i_rs2idx),
+    .rf_rs1idx           (rf_rs1idx),
+    .rf_rs2idx           (rf_rs2idx),
+    .rf_rs1              (rf_rs1),
+    .rf_rs2              (rf_rs2),
+
+    .i_wbck_valid        (alu_wbck_valid),
+    .i_wbck_ready        (alu_wbck_ready),
+    .i_wbck_wdat         (alu_wbck_wdat ),
+    .i_wbck_rdidx        (alu_wbck_rdidx),
+
+    .o_wbck_valid        (alu_wbck_o_valid),
+    .o_wbck_ready        (alu_wbck_o_ready),
+    .o_wbck_wdat         (alu_wbck_o_wdat ),
+    .o_wbck_rdidx        (alu_wbck_o_rdidx),
+
+    .i_icb_cmd_valid     (l0d_icb_cmd_valid   ),
+    .i_icb_cmd_ready     (l0d_icb_cmd_ready   ),
+    .i_icb_cmd_addr      (l0d_icb_cmd_addr    ),
+    .i_icb_cmd_read      (l0d_icb_cmd_read    ),
+    .i_icb_cmd_wdata     (l0d_icb_cmd_wdata   ),
+    .i_icb_cmd_wmask     (l0d_icb_cmd_wmask   ),
+    .i_icb_cmd_lock      (l0d_icb_cmd_lock    ),
+    .i_icb_cmd_excl      (l0d_icb_cmd_excl    ),
+    .i_icb_cmd_size      (l0d_icb_cmd_size    ),
+    .i_icb_cmd_back2agu  (l0d_icb_cmd_back2agu),
+    .i_icb_cmd_usign     (l0d_icb_cmd_usign   ),
+    .i_icb_cmd_itag      (l0d_icb_cmd_itag    ),
+
+    .i_icb_rsp_valid     (l0d_icb_rsp_valid  ),
+    .i_icb_rsp_ready     (l0d_icb_rsp_ready  ),
+    .i_icb_rsp_err       (l0d_icb_rsp_err    ),
+    .i_icb_rsp_excl_ok   (l0d_icb_rsp_excl_ok),
+    .i_icb_rsp_rdata     (l0d_icb_rsp_rdata  ),
+
+    .o_icb_cmd_valid     (agu_icb_cmd_valid   ),
+    .o_icb_cmd_ready     (agu_icb_cmd_ready   ),
+    .o_icb_cmd_addr      (agu_icb_cmd_addr    ),
+    .o_icb_cmd_read      (agu_icb_cmd_read    ),
+    .o_icb_cmd_wdata     (agu_icb_cmd_wdata   ),
+    .o_icb_cmd_wmask     (agu_icb_cmd_wmask   ),
+    .o_icb_cmd_lock      (agu_icb_cmd_lock    ),
+    .o_icb_cmd_excl      (agu_icb_cmd_excl    ),
+    .o_icb_cmd_size      (agu_icb_cmd_size    ),
+    .o_icb_cmd_back2agu  (agu_icb_cmd_back2agu),
+    .o_icb_cmd_usign     (agu_icb_cmd_usign   ),
+    .o_icb_cmd_itag      (agu_icb_cmd_itag    ),
+
+    .o_icb_rsp_valid     (agu_icb_rsp_valid  ),
+    .o_icb_rsp_ready     (agu_icb_rsp_ready  ),
+    .o_icb_rsp_err       (agu_icb_rsp_err    ),
+    .o_icb_rsp_excl_ok   (agu_icb_rsp_excl_ok),
+    .o_icb_rsp_rdata     (agu_icb_rsp_rdata  ),
+
+    .csr_ena             (csr_ena),
+    .csr_wr_en           (csr_wr_en),
+    .csr_idx             (csr_idx),
+    .wbck_csr_dat        (wbck_csr_dat),
+    .stk_csr_dat         (stk_csr_dat),
+
+    .stk_push_evt        (stk_push_evt),
+    .stk_tchn_evt        (stk_tchn_evt),
+    .stk_err_evt         (stk_err_evt),
+
+    .clk                 (clk  ),
+    .rst_n               (rst_n) 
+  );
+  `else//}{
+  assign stk_hold  = 1'b0;
+  assign stk_irq_blk = 1'b0;
+  assign rf_rs1idx = exu_i_rs1idx;
+  assign rf_rs2idx = exu_i_rs2idx;
+
+  assign alu_wbck_o_valid = alu_wbck_valid;
+  assign alu_wbck_ready   = alu_wbck_o_ready;
+  assign alu_wbck_o_wdat  = alu_wbck_wdat;
+  assign alu_wbck_o_rdidx = alu_wbck_rdidx;
+
+  assign agu_icb_cmd_valid     = l0d_icb_cmd_valid;
+  assign l0d_icb_cmd_ready     = agu_icb_cmd_ready;
+  assign agu_icb_cmd_addr      = l0d_icb_cmd_addr    ;
+  assign agu_icb_cmd_read      = l0d_icb_cmd_read    ;
+  assign agu_icb_cmd_wdata     = l0d_icb_cmd_wdata   ;
+  assign agu_icb_cmd_wmask     = l0d_icb_cmd_wmask   ;
+  assign agu_icb_cmd_lock      = l0d_icb_cmd_lock    ;
+  assign agu_icb_cmd_excl      = l0d_icb_cmd_excl    ;
+  assign agu_icb_cmd_size      = l0d_icb_cmd_size    ;
+  assign agu_icb_cmd_back2agu  = l0d_icb_cmd_back2agu;
+  assign agu_icb_cmd_usign     = l0d_icb_cmd_usign   ;
+  assign agu_icb_cmd_itag      = l0d_icb_cmd_itag    ;
+
+  assign l0d_icb_rsp_valid     = agu_icb_rsp_valid;
+  assign agu_icb_rsp_ready     = l0d_icb_rsp_ready;
+  assign l0d_icb_rsp_err       = agu_icb_rsp_err;
+  assign l0d_icb_rsp_excl_ok   = agu_icb_rsp_excl_ok;
+  assign l0d_icb_rsp_rdata     = agu_icb_rsp_rdata;
+
+  assign stk_csr_dat = `E203_XLEN'b0;
+  assign stk_push_evt = 1'b0;
+  assign stk_tchn_evt = 1'b0;
+  assign stk_err_evt  = 1'b0;
+  `endif//}
+
     
     // The Decode to IFU read-en used for the branch dependency check
     //   only need to check the integer regfile, so here we need to exclude
@@ -904,9 +1673,25 @@ module e203_exu(
   assign dec2ifu_rdidx = dec_rdidx;
   assign rf2ifu_rs1    = rf_rs1;
 
+    // The IFU checks the branch dependency and the muldiv back-to-back
+    //   against its own IR, which is the decoded instruction only when the
+    //   fetch queue is empty. Otherwise the older queued instructions are
+    //   regarded as pending in the OITF, so the IFU waits for the JALR rs1
+    //   until the queue is drained, and no back-to-back is flagged.
+    //   While the Hardware Stacking Engine holds the dispatch, the regfile
+    //   read ports are taken by it, so the IFU also waits.
+  assign oitf_empty     = exu_oitf_empty & ifq_empty & (~stk_hold);
+  assign dec2ifu_mulhsu = dec_mulhsu & ifq_empty;
+  assign dec2ifu_div    = dec_div    & ifq_empty;
+  assign dec2ifu_rem    = dec_rem    & ifq_empty;
+  assign dec2ifu_divu   = dec_divu   & ifq_empty;
+  assign dec2ifu_remu   = dec_remu   & ifq_empty;
+
 
 
 
+  wire [`E203_XLEN-1:0] csr_read_dat;
+
   e203_exu_csr u_e203_exu_csr(
     .csr_access_ilgl     (csr_access_ilgl),
   `ifdef E203_HAS_NICE//{
@@ -922,7 +1707,7 @@ module e203_exu(
     .csr_idx             (csr_idx),
     .csr_rd_en           (csr_rd_en),
     .csr_wr_en           (csr_wr_en),
-    .read_csr_dat        (read_csr_dat),
+    .read_csr_dat        (csr_read_dat),
     .wbck_csr_dat        (wbck_csr_dat),
    
     .cmt_badaddr           (cmt_badaddr    ), 
@@ -974,7 +1759,129 @@ module e203_exu(
     .rst_n         (rst_n        ) 
   );
 
-  assign exu_active = (~oitf_empty) | i_valid | excp_active;
+  //////////////////////////////////////////////////////////////
+  // Instantiate the Hardware Performance Monitor
+  //   Each event below is counted into the mhpmcounter(3+N) CSR
+  //     N=0 : unaligned load/store split into two ICB transactions
+  //     N=1 : load/store address issued from the early AGU
+  //     N=2 : load looked up in the load value locality probe
+  //     N=3 : confident entry, a predictor would predict the load
+  //     N=4 : that prediction would have been correct
+  //     N=5 : data prefetch issued
+  //     N=6 : load served by the prefetch buffer
+  //     N=7 : prefetched word dropped without being used
+  //     N=8 : load served by the L0 data cache
+  //     N=9 : load missing the L0 data cache (line refilled)
+  //     N=10: fetch starvation, the EXU is ready but no instruction comes
+  //     N=11: fetch served by the I-Cache
+  //     N=12: fetch missing the I-Cache (line refilled)
+  //     N=13: next line refill started by the I-Cache
+  //     N=14: write-back arbitration stall, a write-back is back-pressured
+  //     N=15: load/store to the ITCM, which competes with the fetch
+  //     N=16: ITCM bank conflict, a fetch stalled by a load/store in its bank
+  //     N=17: register frame saved by the hardware stacking engine
+  //     N=18: interrupt tail-chained on the frame of the last one
+  //     N=19: bus error on a frame transaction of the stacking engine
+  wire fetch_starv_evt = (~exu_i_valid) & exu_i_ready;
+
+  `ifndef E203_HAS_ICACHE//{
+  wire icache_hit_evt  = 1'b0;
+  wire icache_miss_evt = 1'b0;
+  wire icache_pf_evt   = 1'b0;
+  `endif//}
+
+  wire wbck_stall_evt = (alu_wbck_o_valid & (~alu_wbck_o_ready))
+                      | (longp_wbck_o_valid & (~longp_wbck_o_ready));
+
+  `ifdef E203_HAS_ITCM//{
+  wire [`E203_ADDR_SIZE-1:0] itcm_addr_base = `E203_ITCM_ADDR_BASE;
+  wire itcm_ldst_evt = agu_icb_cmd_valid & agu_icb_cmd_ready
+                     & (agu_icb_cmd_addr[`E203_ITCM_BASE_REGION] == itcm_addr_base[`E203_ITCM_BASE_REGION]);
+  `else//}{
+  wire itcm_ldst_evt = 1'b0;
+  `endif//}
+
+  `ifndef E203_HAS_ITCM_BNK//{
+  wire itcm_bnk_cfl_evt = 1'b0;
+  `endif//}
+
+  localparam HPM_EVT_NUM = 20;
+  wire [HPM_EVT_NUM-1:0] hpm_evt = {
+                                     stk_err_evt
+                                   , stk_tchn_evt
+                                   , stk_push_evt
+                                   , itcm_bnk_cfl_evt
+                                   , itcm_ldst_evt
+                                   , wbck_stall_evt
+                                   , icache_pf_evt
+                                   , icache_miss_evt
+                                   , icache_hit_evt
+                                   , fetch_starv_evt
+                                   , l0d_miss_evt
+                                   , l0d_hit_evt
+                                   , pf_useless_evt
+                                   , pfb_hit_evt
+                                   , pf_issue_evt
+                                   , lvp_hit_evt
+                                   , lvp_prdt_evt
+                                   , lvp_lkup_evt
+                                   , eagu_evt
+                                   , splt_evt
+                                   };
+
+  wire [`E203_XLEN-1:0] hpm_csr_dat;
+
+  `ifdef E203_HAS_HPM//{
+  e203_exu_hpm # (
+    .EVT_NUM (HPM_EVT_NUM)
+  ) u_e203_exu_hpm(
+    .hpm_evt             (hpm_evt),
+
+    .csr_ena             (csr_ena),
+    .csr_wr_en           (csr_wr_en),
+    .csr_idx             (csr_idx),
+    .wbck_csr_dat        (wbck_csr_dat),
+    .hpm_csr_dat         (hpm_csr_dat),
+
+    .clk                 (clk  ),
+    .rst_n               (rst_n) 
+  );
+  `else//}{
+  assign hpm_csr_dat = `E203_XLEN'b0;
+  `endif//}
+
+  //////////////////////////////////////////////////////////////
+  // Instantiate the Load Latency Histogram on the AGU ICB channel
+  wire [`E203_XLEN-1:0] lath_csr_dat;
+
+  `ifdef E203_HAS_LAT_HIST//{
+  e203_exu_lath u_e203_exu_lath(
+    .agu_icb_cmd_valid   (agu_icb_cmd_valid),
+    .agu_icb_cmd_ready   (agu_icb_cmd_ready),
+    .agu_icb_cmd_addr    (agu_icb_cmd_addr ),
+    .agu_icb_cmd_read    (agu_icb_cmd_read ),
+
+    .agu_icb_rsp_valid   (agu_icb_rsp_valid),
+    .agu_icb_rsp_ready   (agu_icb_rsp_ready),
+    .lsu_o_valid         (lsu_o_valid      ),
+    .lsu_o_ready         (lsu_o_ready      ),
+
+    .csr_ena             (csr_ena),
+    .csr_wr_en           (csr_wr_en),
+    .csr_idx             (csr_idx),
+    .wbck_csr_dat        (wbck_csr_dat),
+    .lath_csr_dat        (lath_csr_dat),
+
+    .clk                 (clk  ),
+    .rst_n               (rst_n) 
+  );
+  `else//}{
+  assign lath_csr_dat = `E203_XLEN'b0;
+  `endif//}
+
+  assign read_csr_dat = csr_read_dat | hpm_csr_dat | lath_csr_dat | stk_csr_dat;
+
+  assign exu_active = (~exu_oitf_empty) | exu_i_valid | excp_active | stk_hold;
 
 
 endmodule                                      
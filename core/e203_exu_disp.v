@@ -194,15 +194,25 @@ module e203_exu_disp(
   // 4. disp_i_rs1en: Current instruction actually reads RS1.
   // 5. ~disp_i_rs1x0: Not register x0 (RISC-V spec: x0 always reads as 0).
 
+  // E203_NO_LOAD_FWD leaves the forwarding out (the original dispatch), so
+  // the two can be compared on the same tree
+  `ifdef E203_NO_LOAD_FWD//{
+  wire fwd_ena = 1'b0;
+  `else//}{
+  wire fwd_ena = 1'b1;
+  `endif//}
+
   // Check if RS1 can be forwarded
-  wire rs1_fwd_match = lsu_o_valid
+  wire rs1_fwd_match = fwd_ena
+                     & lsu_o_valid
                      & lsu_o_wbck_rdwen                   // CRITICAL FIX: Check write enable!
                      & (lsu_o_wbck_rdidx == disp_i_rs1idx)
                      & disp_i_rs1en
                      & (~disp_i_rs1x0);
 
   // Check if RS2 can be forwarded
-  wire rs2_fwd_match = lsu_o_valid
+  wire rs2_fwd_match = fwd_ena
+                     & lsu_o_valid
                      & lsu_o_wbck_rdwen                   // CRITICAL FIX: Check write enable!
                      & (lsu_o_wbck_rdidx == disp_i_rs2idx)
                      & disp_i_rs2en
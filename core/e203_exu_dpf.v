@@ -0,0 +1,374 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The Data Prefetcher, a PC-indexed stride prefetcher with a small fully
+//  associative prefetch buffer, sitting on the AGU ICB channel between the
+//  AGU and the LSU-ctrl.
+//
+//  * The Reference Prediction Table (RPT) is trained by the load commands
+//    (the 1st half only of a split unaligned access, the 2nd one is 4
+//    bytes off), it records the last address and the stride of each load
+//    PC, and
+//    once the same stride is seen twice in a row, a prefetch of the next
+//    word (last address + stride) is requested.
+//  * The prefetch is issued as a word read on the idle cycles of the ICB
+//    command channel, with the back2agu set, so its response comes back
+//    via the AGU ICB response channel and never disturbs the LSU
+//    write-back. The AMO, which also uses the AGU response channel, is
+//    never outstanding together with a prefetch. Once presented, the
+//    prefetch command is held, with its address, until it is accepted,
+//    and the demand commands wait behind it.
+//  * A load command hitting the prefetch buffer is served locally, and its
+//    response is injected into the LSU write-back in order (i.e., only
+//    after all the older loads/stores have been written back).
+//  * A store command invalidates the matched entry (and kills the matched
+//    outstanding prefetch), the fence flushes the whole buffer, so the
+//    software can use fence to make the buffer see the data written by
+//    other bus masters.
+//
+//  Only the words inside the prefetchable region (the addresses with
+//  (addr & PF_REGION_MASK) == PF_REGION_BASE, e.g., the external memory)
+//  are prefetched, so the peripherals are never touched speculatively.
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_exu_dpf #(
+  parameter RPT_ENTRY_NUM = 4,
+  parameter RPT_IDX_W = 2,
+  parameter RPT_TAG_W = 8,
+  parameter PFB_ENTRY_NUM = 4,
+  parameter PFB_PTR_W = 2,
+  parameter PF_REGION_BASE = 32'hA000_0000,
+  parameter PF_REGION_MASK = 32'hF000_0000
+)(
+  // The command is from a plain load/store with its PC
+  input  i_ldst_pc_vld,
+  input  [`E203_PC_SIZE-1:0] i_ldst_pc,
+  // Flush the prefetch buffer (e.g., the fence)
+  input  pf_flush,
+  input  amo_wait,
+
+  //////////////////////////////////////////////////////////////
+  // The AGU ICB Interface from AGU
+  input                          i_icb_cmd_valid,
+  output                         i_icb_cmd_ready,
+  input  [`E203_ADDR_SIZE-1:0]   i_icb_cmd_addr,
+  input                          i_icb_cmd_read,
+  input  [`E203_XLEN-1:0]        i_icb_cmd_wdata,
+  input  [`E203_XLEN/8-1:0]      i_icb_cmd_wmask,
+  input                          i_icb_cmd_lock,
+  input                          i_icb_cmd_excl,
+  input  [1:0]                   i_icb_cmd_size,
+  input                          i_icb_cmd_back2agu,
+  input                          i_icb_cmd_usign,
+  input  [`E203_ITAG_WIDTH -1:0] i_icb_cmd_itag,
+  // The command is the 2nd half of a split unaligned access
+  input                          i_icb_cmd_2nd,
+
+  output                         i_icb_rsp_valid,
+  input                          i_icb_rsp_ready,
+  output                         i_icb_rsp_err  ,
+  output                         i_icb_rsp_excl_ok,
+  output [`E203_XLEN-1:0]        i_icb_rsp_rdata,
+
+  //////////////////////////////////////////////////////////////
+  // The AGU ICB Interface to LSU-ctrl
+  output                         o_icb_cmd_valid,
+  input                          o_icb_cmd_ready,
+  output [`E203_ADDR_SIZE-1:0]   o_icb_cmd_addr,
+  output                         o_icb_cmd_read,
+  output [`E203_XLEN-1:0]        o_icb_cmd_wdata,
+  output [`E203_XLEN/8-1:0]      o_icb_cmd_wmask,
+  output                         o_icb_cmd_lock,
+  output                         o_icb_cmd_excl,
+  output [1:0]                   o_icb_cmd_size,
+  output                         o_icb_cmd_back2agu,
+  output                         o_icb_cmd_usign,
+  output [`E203_ITAG_WIDTH -1:0] o_icb_cmd_itag,
+
+  input                          o_icb_rsp_valid,
+  output                         o_icb_rsp_ready,
+  input                          o_icb_rsp_err  ,
+  input                          o_icb_rsp_excl_ok,
+  input  [`E203_XLEN-1:0]        o_icb_rsp_rdata,
+
+  //////////////////////////////////////////////////////////////
+  // The LSU Write-Back Interface from LSU-ctrl
+  input  lsu_i_valid,
+  output lsu_i_ready,
+  input  [`E203_XLEN-1:0] lsu_i_wdat,
+  input  [`E203_ITAG_WIDTH -1:0] lsu_i_itag,
+  input  lsu_i_err ,
+  input  lsu_i_ld,
+  input  lsu_i_st,
+  input  [`E203_ADDR_SIZE -1:0] lsu_i_badaddr,
+  input  lsu_i_buserr ,
+
+  //////////////////////////////////////////////////////////////
+  // The LSU Write-Back Interface to the upstream
+  output lsu_o_valid,
+  input  lsu_o_ready,
+  output [`E203_XLEN-1:0] lsu_o_wdat,
+  output [`E203_ITAG_WIDTH -1:0] lsu_o_itag,
+  output lsu_o_err ,
+  output lsu_o_ld,
+  output lsu_o_st,
+  output [`E203_ADDR_SIZE -1:0] lsu_o_badaddr,
+  output lsu_o_buserr ,
+
+  output pf_issue_evt,   // A prefetch is issued
+  output pfb_hit_evt,    // A load is served by the prefetch buffer
+  output pf_useless_evt, // A prefetched word is dropped without being used
+
+  input  clk,
+  input  rst_n
+  );
+
+  localparam WADDR_W = `E203_ADDR_SIZE-2;
+
+  wire [WADDR_W-1:0] i_waddr = i_icb_cmd_addr[`E203_ADDR_SIZE-1:2];
+
+  wire i_dmd_ld = i_icb_cmd_read & (~i_icb_cmd_back2agu) & (~i_icb_cmd_lock) & (~i_icb_cmd_excl);
+  wire i_st     = (~i_icb_cmd_read);
+
+  //////////////////////////////////////////////////////////////
+  // The Prefetch Buffer
+  wire [PFB_ENTRY_NUM-1:0] pfb_vld_r;
+  wire [PFB_ENTRY_NUM-1:0] pfb_used_r;
+  wire [WADDR_W-1:0]    pfb_waddr_r [PFB_ENTRY_NUM-1:0];
+  wire [`E203_XLEN-1:0] pfb_data_r  [PFB_ENTRY_NUM-1:0];
+
+  wire [PFB_ENTRY_NUM-1:0] pfb_i_hit_vec;
+  wire [PFB_ENTRY_NUM-1:0] pfb_req_hit_vec;
+  wire [`E203_XLEN-1:0] pfb_i_rdat_vec [PFB_ENTRY_NUM:0];
+  assign pfb_i_rdat_vec[0] = `E203_XLEN'b0;
+
+  wire [WADDR_W-1:0] pf_req_waddr_r;
+
+  genvar i;
+  generate //{
+    for (i=0; i<PFB_ENTRY_NUM; i=i+1) begin:pfb_cam//{
+      assign pfb_i_hit_vec[i]   = pfb_vld_r[i] & (pfb_waddr_r[i] == i_waddr);
+      assign pfb_req_hit_vec[i] = pfb_vld_r[i] & (pfb_waddr_r[i] == pf_req_waddr_r);
+      assign pfb_i_rdat_vec[i+1] = pfb_i_rdat_vec[i] | ({`E203_XLEN{pfb_i_hit_vec[i]}} & pfb_data_r[i]);
+    end//}
+  endgenerate//}
+
+  wire pfb_i_hit = (|pfb_i_hit_vec);
+  wire [`E203_XLEN-1:0] pfb_i_rdat = pfb_i_rdat_vec[PFB_ENTRY_NUM];
+
+  //////////////////////////////////////////////////////////////
+  // The command channel
+  wire pf_out_r;
+  wire pf_hold_r;
+  wire pf_req_vld_r;
+  wire lrsp_vld_r;
+  wire [2:0] dmd_outs_r;
+
+  // The load hitting the buffer, it is served locally only when all the
+  //   older commands have been written back, to keep the write-back in order
+  wire i_pfb_ld  = i_dmd_ld & pfb_i_hit;
+  wire i_lcl_acc = i_icb_cmd_valid & i_pfb_ld & (dmd_outs_r == 3'b0) & (~lrsp_vld_r);
+
+  wire i_pass = i_icb_cmd_valid & (~i_pfb_ld)
+              // The prefetch presented is held until it is accepted
+              & (~pf_hold_r)
+              // The younger command cannot go before the local response
+              & (~(lrsp_vld_r & (~i_icb_cmd_back2agu)))
+              // The AMO response cannot be mixed with the prefetch response
+              & (~(pf_out_r & i_icb_cmd_back2agu));
+
+  wire pf_req_in_pfb = (|pfb_req_hit_vec);
+  // A new prefetch goes out on an idle cycle, and then stays valid with
+  //   the same address until the handshake (the ICB rule)
+  wire pf_issue_new = (~pf_hold_r) & (~i_icb_cmd_valid) & pf_req_vld_r & (~pf_req_in_pfb)
+                    & (~pf_out_r) & (~amo_wait);
+  wire pf_issue = pf_hold_r | pf_issue_new;
+
+  assign o_icb_cmd_valid    = i_pass | pf_issue;
+  assign i_icb_cmd_ready    = i_lcl_acc | (i_pass & o_icb_cmd_ready);
+
+  assign o_icb_cmd_addr     = pf_issue ? {pf_req_waddr_r, 2'b0} : i_icb_cmd_addr;
+  assign o_icb_cmd_read     = pf_issue | i_icb_cmd_read;
+  assign o_icb_cmd_wdata    = i_icb_cmd_wdata;
+  assign o_icb_cmd_wmask    = i_icb_cmd_wmask;
+  assign o_icb_cmd_lock     = (~pf_issue) & i_icb_cmd_lock;
+  assign o_icb_cmd_excl     = (~pf_issue) & i_icb_cmd_excl;
+  assign o_icb_cmd_size     = pf_issue ? 2'b10 : i_icb_cmd_size;
+  assign o_icb_cmd_back2agu = pf_issue | i_icb_cmd_back2agu;
+  assign o_icb_cmd_usign    = pf_issue | i_icb_cmd_usign;
+  assign o_icb_cmd_itag     = i_icb_cmd_itag;
+
+  wire o_icb_cmd_hsked = o_icb_cmd_valid & o_icb_cmd_ready;
+  wire i_pass_hsked    = i_pass & o_icb_cmd_ready;
+  wire pf_issue_hsked  = pf_issue & o_icb_cmd_ready;
+  wire st_pass_hsked   = i_pass_hsked & i_st;
+
+  assign pf_issue_evt = pf_issue_hsked;
+
+  wire pf_hold_set = pf_issue_new & (~o_icb_cmd_ready);
+  wire pf_hold_clr = pf_hold_r & o_icb_cmd_ready;
+  wire pf_hold_ena = pf_hold_set | pf_hold_clr;
+  wire pf_hold_nxt = pf_hold_set | (~pf_hold_clr);
+  sirv_gnrl_dfflr #(1) pf_hold_dfflr (pf_hold_ena, pf_hold_nxt, pf_hold_r, clk, rst_n);
+  assign pfb_hit_evt  = i_lcl_acc;
+
+  // The outstanding commands to be written back via the LSU write-back
+  wire dmd_outs_inc = i_pass_hsked & (~i_icb_cmd_back2agu);
+  wire dmd_outs_dec = lsu_i_valid & lsu_i_ready;
+  wire dmd_outs_ena = dmd_outs_inc ^ dmd_outs_dec;
+  wire [2:0] dmd_outs_nxt = dmd_outs_inc ? (dmd_outs_r + 3'b1) : (dmd_outs_r - 3'b1);
+  sirv_gnrl_dfflr #(3) dmd_outs_dfflr (dmd_outs_ena, dmd_outs_nxt, dmd_outs_r, clk, rst_n);
+
+  //////////////////////////////////////////////////////////////
+  // The Reference Prediction Table
+  wire [RPT_IDX_W-1:0] rpt_idx = i_ldst_pc[RPT_IDX_W:1];
+  wire [RPT_TAG_W-1:0] rpt_tag = i_ldst_pc[RPT_IDX_W+RPT_TAG_W:RPT_IDX_W+1];
+
+  wire [RPT_ENTRY_NUM-1:0] rpt_vld_r;
+  wire [RPT_TAG_W-1:0] rpt_tag_r   [RPT_ENTRY_NUM-1:0];
+  wire [WADDR_W-1:0]   rpt_waddr_r [RPT_ENTRY_NUM-1:0];
+  wire [WADDR_W-1:0]   rpt_strd_r  [RPT_ENTRY_NUM-1:0];
+  wire [1:0]           rpt_conf_r  [RPT_ENTRY_NUM-1:0];
+
+  wire [WADDR_W-1:0] rpt_sel_waddr = rpt_waddr_r[rpt_idx];
+  wire [WADDR_W-1:0] rpt_sel_strd  = rpt_strd_r[rpt_idx];
+  wire [1:0]         rpt_sel_conf  = rpt_conf_r[rpt_idx];
+  wire rpt_sel_hit = rpt_vld_r[rpt_idx] & (rpt_tag_r[rpt_idx] == rpt_tag);
+
+  wire rpt_train = i_icb_cmd_valid & i_icb_cmd_ready & i_dmd_ld & i_ldst_pc_vld & (~i_icb_cmd_2nd);
+
+  wire [WADDR_W-1:0] rpt_strd_nxt = rpt_sel_hit ? (i_waddr - rpt_sel_waddr) : {WADDR_W{1'b0}};
+  wire rpt_strd_same = rpt_sel_hit & (rpt_strd_nxt == rpt_sel_strd) & (|rpt_sel_strd);
+  wire [1:0] rpt_conf_nxt = (~rpt_strd_same)        ? 2'b00
+                          : (rpt_sel_conf == 2'b11) ? 2'b11
+                          : (rpt_sel_conf + 2'b01);
+
+  generate //{
+    for (i=0; i<RPT_ENTRY_NUM; i=i+1) begin:rpt_ent//{
+      wire ent_ena = rpt_train & (rpt_idx == i);
+
+      sirv_gnrl_dfflr #(1)         rpt_vld_dfflr  (ent_ena, 1'b1        , rpt_vld_r[i]  , clk, rst_n);
+      sirv_gnrl_dffl  #(RPT_TAG_W) rpt_tag_dffl   (ent_ena, rpt_tag     , rpt_tag_r[i]  , clk);
+      sirv_gnrl_dffl  #(WADDR_W)   rpt_waddr_dffl (ent_ena, i_waddr     , rpt_waddr_r[i], clk);
+      sirv_gnrl_dffl  #(WADDR_W)   rpt_strd_dffl  (ent_ena, rpt_strd_nxt, rpt_strd_r[i] , clk);
+      sirv_gnrl_dffl  #(2)         rpt_conf_dffl  (ent_ena, rpt_conf_nxt, rpt_conf_r[i] , clk);
+    end//}
+  endgenerate//}
+
+  //////////////////////////////////////////////////////////////
+  // The prefetch request, the newest one overrides the pending one, but
+  //   not the one being presented
+  wire [WADDR_W-1:0] pf_new_waddr = i_waddr + rpt_strd_nxt;
+  wire pf_new_in_region = (({pf_new_waddr, 2'b0} & PF_REGION_MASK) == PF_REGION_BASE);
+  wire pf_req_set = rpt_train & rpt_strd_same & (rpt_sel_conf != 2'b00) & pf_new_in_region
+                  & (~pf_hold_r);
+  wire pf_req_clr = pf_issue_hsked | (pf_req_vld_r & pf_req_in_pfb) | pf_flush;
+  wire pf_req_ena = pf_req_set | pf_req_clr;
+  wire pf_req_nxt = pf_req_set | (~pf_req_clr);
+  sirv_gnrl_dfflr #(1) pf_req_vld_dfflr (pf_req_ena, pf_req_nxt, pf_req_vld_r, clk, rst_n);
+  sirv_gnrl_dffl #(WADDR_W) pf_req_waddr_dffl (pf_req_set, pf_new_waddr, pf_req_waddr_r, clk);
+
+  //////////////////////////////////////////////////////////////
+  // The outstanding prefetch
+  wire pf_out_kill_r;
+  wire [WADDR_W-1:0] pf_out_waddr_r;
+
+  // The prefetch response comes back via the AGU ICB response channel
+  wire pf_rsp = o_icb_rsp_valid & pf_out_r;
+  assign i_icb_rsp_valid   = o_icb_rsp_valid & (~pf_out_r);
+  assign o_icb_rsp_ready   = pf_out_r | i_icb_rsp_ready;
+  assign i_icb_rsp_err     = o_icb_rsp_err;
+  assign i_icb_rsp_excl_ok = o_icb_rsp_excl_ok;
+  assign i_icb_rsp_rdata   = o_icb_rsp_rdata;
+
+  wire pf_out_set = pf_issue_hsked;
+  wire pf_out_clr = pf_rsp;
+  wire pf_out_ena = pf_out_set | pf_out_clr;
+  wire pf_out_nxt = pf_out_set | (~pf_out_clr);
+  sirv_gnrl_dfflr #(1) pf_out_dfflr (pf_out_ena, pf_out_nxt, pf_out_r, clk, rst_n);
+  sirv_gnrl_dffl #(WADDR_W) pf_out_waddr_dffl (pf_out_set, pf_req_waddr_r, pf_out_waddr_r, clk);
+
+  // A store to the same word (or the flush) makes the prefetched data
+  //   stale, also while the prefetch is presented (then only the flush,
+  //   no store passes it)
+  wire pf_out_kill_now = pf_flush | (st_pass_hsked & (i_waddr == pf_out_waddr_r));
+  wire pf_out_kill_set = (pf_out_r | pf_issue) & pf_out_kill_now;
+  wire pf_out_kill_clr = pf_issue_new;
+  wire pf_out_kill_ena = pf_out_kill_set | pf_out_kill_clr;
+  wire pf_out_kill_nxt = pf_out_kill_set | (~pf_out_kill_clr);
+  sirv_gnrl_dfflr #(1) pf_out_kill_dfflr (pf_out_kill_ena, pf_out_kill_nxt, pf_out_kill_r, clk, rst_n);
+
+  wire pfb_alloc = pf_rsp & (~o_icb_rsp_err) & (~pf_out_kill_r) & (~pf_out_kill_now);
+
+  //////////////////////////////////////////////////////////////
+  // Update the Prefetch Buffer, allocated in the round-robin order
+  wire [PFB_PTR_W-1:0] pfb_ptr_r;
+  wire [PFB_PTR_W-1:0] pfb_ptr_nxt = (pfb_ptr_r == (PFB_ENTRY_NUM-1)) ? {PFB_PTR_W{1'b0}} : (pfb_ptr_r + 1'b1);
+  sirv_gnrl_dfflr #(PFB_PTR_W) pfb_ptr_dfflr (pfb_alloc, pfb_ptr_nxt, pfb_ptr_r, clk, rst_n);
+
+  wire [PFB_ENTRY_NUM-1:0] pfb_useless_vec;
+
+  generate //{
+    for (i=0; i<PFB_ENTRY_NUM; i=i+1) begin:pfb_ent//{
+      wire ent_alloc = pfb_alloc & (pfb_ptr_r == i);
+      wire ent_inv   = pf_flush | (st_pass_hsked & pfb_i_hit_vec[i]);
+      wire ent_hit   = i_lcl_acc & pfb_i_hit_vec[i];
+
+      wire vld_ena = ent_alloc | ent_inv;
+      wire vld_nxt = ent_alloc;
+      sirv_gnrl_dfflr #(1) pfb_vld_dfflr (vld_ena, vld_nxt, pfb_vld_r[i], clk, rst_n);
+
+      wire used_ena = ent_alloc | ent_hit;
+      wire used_nxt = ent_hit;
+      sirv_gnrl_dfflr #(1) pfb_used_dfflr (used_ena, used_nxt, pfb_used_r[i], clk, rst_n);
+
+      sirv_gnrl_dffl #(WADDR_W)    pfb_waddr_dffl (ent_alloc, pf_out_waddr_r , pfb_waddr_r[i], clk);
+      sirv_gnrl_dffl #(`E203_XLEN) pfb_data_dffl  (ent_alloc, o_icb_rsp_rdata, pfb_data_r[i] , clk);
+
+      // The valid entry is replaced or invalidated before it is ever used
+      assign pfb_useless_vec[i] = pfb_vld_r[i] & (~pfb_used_r[i]) & (ent_alloc | ent_inv);
+    end//}
+  endgenerate//}
+
+  assign pf_useless_evt = (|pfb_useless_vec);
+
+  //////////////////////////////////////////////////////////////
+  // The local response of the load served by the buffer
+  wire [`E203_XLEN-1:0] lrsp_sft = pfb_i_rdat >> {i_icb_cmd_addr[1:0], 3'b0};
+  wire [`E203_XLEN-1:0] lrsp_wdat_nxt =
+        (i_icb_cmd_size == 2'b00) ? {{24{(~i_icb_cmd_usign) & lrsp_sft[7]}} , lrsp_sft[7:0]}
+      : (i_icb_cmd_size == 2'b01) ? {{16{(~i_icb_cmd_usign) & lrsp_sft[15]}}, lrsp_sft[15:0]}
+      : lrsp_sft;
+
+  wire [`E203_XLEN-1:0] lrsp_wdat_r;
+  wire [`E203_ITAG_WIDTH-1:0] lrsp_itag_r;
+  wire [`E203_ADDR_SIZE-1:0] lrsp_addr_r;
+
+  wire lrsp_hsked = lrsp_vld_r & lsu_o_ready;
+  wire lrsp_vld_set = i_lcl_acc;
+  wire lrsp_vld_clr = lrsp_hsked;
+  wire lrsp_vld_ena = lrsp_vld_set | lrsp_vld_clr;
+  wire lrsp_vld_nxt = lrsp_vld_set | (~lrsp_vld_clr);
+  sirv_gnrl_dfflr #(1) lrsp_vld_dfflr (lrsp_vld_ena, lrsp_vld_nxt, lrsp_vld_r, clk, rst_n);
+
+  sirv_gnrl_dffl #(`E203_XLEN)       lrsp_wdat_dffl (i_lcl_acc, lrsp_wdat_nxt , lrsp_wdat_r, clk);
+  sirv_gnrl_dffl #(`E203_ITAG_WIDTH) lrsp_itag_dffl (i_lcl_acc, i_icb_cmd_itag, lrsp_itag_r, clk);
+  sirv_gnrl_dffl #(`E203_ADDR_SIZE)  lrsp_addr_dffl (i_lcl_acc, i_icb_cmd_addr, lrsp_addr_r, clk);
+
+  // No command is passed down while the local response is pending, so
+  //   the LSU-ctrl cannot have its write-back valid at the same time
+  assign lsu_o_valid   = lrsp_vld_r | lsu_i_valid;
+  assign lsu_i_ready   = (~lrsp_vld_r) & lsu_o_ready;
+  assign lsu_o_wdat    = lrsp_vld_r ? lrsp_wdat_r : lsu_i_wdat;
+  assign lsu_o_itag    = lrsp_vld_r ? lrsp_itag_r : lsu_i_itag;
+  assign lsu_o_err     = (~lrsp_vld_r) & lsu_i_err;
+  assign lsu_o_ld      = lrsp_vld_r | lsu_i_ld;
+  assign lsu_o_st      = (~lrsp_vld_r) & lsu_i_st;
+  assign lsu_o_badaddr = lrsp_vld_r ? lrsp_addr_r : lsu_i_badaddr;
+  assign lsu_o_buserr  = (~lrsp_vld_r) & lsu_i_buserr;
+
+endmodule
@@ -0,0 +1,55 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The Hardware Performance Monitor, which counts the micro-architecture
+//  events of the EXU into the standard mhpmcounter3..31 CSRs.
+//
+//  Each bit of hpm_evt is a one-cycle event pulse, the N-th bit is
+//  counted into mhpmcounter(3+N) (CSR 0xB03+N). The counters are 32 bits
+//  wide and can be written (e.g., cleared) by the CSR instructions, the
+//  read data is OR-ed into the CSR read-data of e203_exu_csr, which
+//  returns zero for these CSR indexes.
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_exu_hpm #(
+  parameter EVT_NUM = 1
+)(
+  input  [EVT_NUM-1:0] hpm_evt,
+
+  //////////////////////////////////////////////////////////////
+  // The CSR access from the ALU
+  input  csr_ena,
+  input  csr_wr_en,
+  input  [12-1:0] csr_idx,
+  input  [`E203_XLEN-1:0] wbck_csr_dat,
+  output [`E203_XLEN-1:0] hpm_csr_dat,
+
+  input  clk,
+  input  rst_n
+  );
+
+  wire [`E203_XLEN-1:0] hpm_rdat [EVT_NUM:0];
+  assign hpm_rdat[0] = `E203_XLEN'b0;
+
+  genvar i;
+  generate //{
+    for (i=0; i<EVT_NUM; i=i+1) begin:hpm_cnt//{
+      wire sel_cnt = (csr_idx == (12'hB03 + i));
+      wire wr_cnt  = sel_cnt & csr_ena & csr_wr_en;
+
+      wire [`E203_XLEN-1:0] cnt_r;
+      wire cnt_ena = wr_cnt | hpm_evt[i];
+      wire [`E203_XLEN-1:0] cnt_nxt = wr_cnt ? wbck_csr_dat : (cnt_r + 1'b1);
+      sirv_gnrl_dfflr #(`E203_XLEN) cnt_dfflr (cnt_ena, cnt_nxt, cnt_r, clk, rst_n);
+
+      assign hpm_rdat[i+1] = hpm_rdat[i] | ({`E203_XLEN{sel_cnt}} & cnt_r);
+    end//}
+  endgenerate//}
+
+  assign hpm_csr_dat = hpm_rdat[EVT_NUM];
+
+endmodule
@@ -0,0 +1,112 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The Instruction Fetch Queue, between the IFU IR stage and the EXU
+//  dispatch, to decouple the fetch from the dispatch stalls (e.g., the
+//  raw_dep, OITF full, or CSR drain), so the IFU keeps fetching ahead
+//  while the EXU is stalled, and the queued instructions are dispatched
+//  back-to-back across the later fetch bubbles.
+//
+//  * The queue is bypassed when it is empty, so an instruction coming to
+//    an empty queue goes to the dispatch in the same cycle as without it.
+//  * The pipeline flush clears the whole queue (at the pipe_flush_ack, the
+//    flushing instruction, i.e., the queue head, is handshaked out at the
+//    same time), and no instruction is pushed while the flush is pending,
+//    so the IFU still flushes its IR as before.
+//  * The IR from the IFU is already aligned (the compressed and the
+//    cross-boundary instructions are handled by the IFU), so each entry
+//    just keeps the IR with its PC and the fetch flags.
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_exu_ifq #(
+  parameter IFQ_DEPTH = 4,
+  parameter IFQ_PTR_W = 2
+)(
+  //////////////////////////////////////////////////////////////
+  // The IR stage from IFU
+  input  i_valid,
+  output i_ready,
+  input  [`E203_INSTR_SIZE-1:0] i_ir,
+  input  [`E203_PC_SIZE-1:0] i_pc,
+  input  i_pc_vld,
+  input  i_misalgn,
+  input  i_buserr,
+  input  i_prdt_taken,
+  input  i_muldiv_b2b,
+  input  [`E203_RFIDX_WIDTH-1:0] i_rs1idx,
+  input  [`E203_RFIDX_WIDTH-1:0] i_rs2idx,
+
+  //////////////////////////////////////////////////////////////
+  // The queue head to the EXU
+  output o_valid,
+  input  o_ready,
+  output [`E203_INSTR_SIZE-1:0] o_ir,
+  output [`E203_PC_SIZE-1:0] o_pc,
+  output o_pc_vld,
+  output o_misalgn,
+  output o_buserr,
+  output o_prdt_taken,
+  output o_muldiv_b2b,
+  output [`E203_RFIDX_WIDTH-1:0] o_rs1idx,
+  output [`E203_RFIDX_WIDTH-1:0] o_rs2idx,
+
+  input  pipe_flush_req,
+  input  pipe_flush_ack,
+
+  output ifq_empty,
+
+  input  clk,
+  input  rst_n
+  );
+
+  localparam ENT_W = `E203_INSTR_SIZE + `E203_PC_SIZE + 5 + 2*`E203_RFIDX_WIDTH;
+
+  wire [IFQ_PTR_W-1:0] wptr_r;
+  wire [IFQ_PTR_W-1:0] rptr_r;
+  wire [IFQ_PTR_W:0] cnt_r;
+
+  assign ifq_empty = (cnt_r == {IFQ_PTR_W+1{1'b0}});
+  wire ifq_full = (cnt_r == IFQ_DEPTH);
+
+  wire ifq_flush = pipe_flush_req & pipe_flush_ack;
+
+  // The instruction from IFU goes straight to the EXU when the queue is
+  //   empty, and only the one not taken by the EXU is pushed
+  assign o_valid = ifq_empty ? i_valid : 1'b1;
+  assign i_ready = ifq_empty ? (o_ready | (~pipe_flush_req)) : ((~ifq_full) & (~pipe_flush_req));
+
+  wire ifq_push = i_valid & i_ready & (~(ifq_empty & o_ready)) & (~ifq_flush);
+  wire ifq_pop  = o_valid & o_ready & (~ifq_empty);
+
+  wire [IFQ_PTR_W-1:0] wptr_nxt = ifq_flush ? {IFQ_PTR_W{1'b0}} : (wptr_r + 1'b1);
+  wire [IFQ_PTR_W-1:0] rptr_nxt = ifq_flush ? {IFQ_PTR_W{1'b0}} : (rptr_r + 1'b1);
+  wire [IFQ_PTR_W:0]   cnt_nxt  = ifq_flush ? {IFQ_PTR_W+1{1'b0}}
+                                : ifq_push  ? (cnt_r + 1'b1)
+                                :             (cnt_r - 1'b1);
+
+  sirv_gnrl_dfflr #(IFQ_PTR_W)   wptr_dfflr (ifq_push | ifq_flush, wptr_nxt, wptr_r, clk, rst_n);
+  sirv_gnrl_dfflr #(IFQ_PTR_W)   rptr_dfflr (ifq_pop  | ifq_flush, rptr_nxt, rptr_r, clk, rst_n);
+  sirv_gnrl_dfflr #(IFQ_PTR_W+1) cnt_dfflr  ((ifq_push ^ ifq_pop) | ifq_flush, cnt_nxt, cnt_r, clk, rst_n);
+
+  //////////////////////////////////////////////////////////////
+  // The queue entries
+  wire [ENT_W-1:0] i_ent = {i_ir, i_pc, i_pc_vld, i_misalgn, i_buserr, i_prdt_taken, i_muldiv_b2b, i_rs1idx, i_rs2idx};
+  wire [ENT_W-1:0] ent_r [IFQ_DEPTH-1:0];
+
+  genvar i;
+  generate //{
+    for (i=0; i<IFQ_DEPTH; i=i+1) begin:ifq_ent//{
+      wire ent_ena = ifq_push & (wptr_r == i);
+      sirv_gnrl_dffl #(ENT_W) ent_dffl (ent_ena, i_ent, ent_r[i], clk);
+    end//}
+  endgenerate//}
+
+  wire [ENT_W-1:0] o_ent = ifq_empty ? i_ent : ent_r[rptr_r];
+
+  assign {o_ir, o_pc, o_pc_vld, o_misalgn, o_buserr, o_prdt_taken, o_muldiv_b2b, o_rs1idx, o_rs2idx} = o_ent;
+
+endmodule
@@ -0,0 +1,360 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The L0 Data Cache, a small write-through cache on the AGU ICB channel
+//  between the AGU and the LSU-ctrl, for the loads to the slow memories
+//  outside the TCMs (e.g., the external SRAM over the system bus).
+//
+//  * Only the addresses inside the cacheable region (the addresses with
+//    (addr & L0D_REGION_MASK) == L0D_REGION_BASE) are cached, all the
+//    other commands (and the AMO, LR/SC) are passed through untouched.
+//  * A load hitting the cache is served locally, and its response is
+//    injected into the LSU write-back in order (i.e., only after all the
+//    older loads/stores have been written back), one cycle after the
+//    command.
+//  * A load missing the cache refills the whole line with word reads with
+//    the back2agu set (so the responses come back via the AGU ICB response
+//    channel), starting from the missed word and wrapping around the line.
+//    The missed word is written back as soon as it arrives (critical word
+//    first), the rest of the line is filled in the background while the
+//    following non-memory instructions keep going, and the next load/store
+//    waits until the refill is done.
+//  * A store is always passed down (write-through, no write-allocate), and
+//    also updates the hitting line with its byte mask.
+//  * The fence invalidates the whole cache, so the software can use fence
+//    to make the cache see the data written by other bus masters.
+//
+//  The cache is direct-mapped (L0D_WAY_NUM=1) or 2-way set associative
+//  (L0D_WAY_NUM=2, with the LRU replacement), the sets and the words per
+//  line must be powers of two, with at least 2 of each.
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_exu_l0d #(
+  parameter L0D_WAY_NUM = 2,
+  parameter L0D_SET_NUM = 4,
+  parameter L0D_SET_W = 2,
+  parameter L0D_LINE_WORDS = 4,
+  parameter L0D_LINE_W = 2,
+  parameter L0D_REGION_BASE = 32'hA000_0000,
+  parameter L0D_REGION_MASK = 32'hF000_0000
+)(
+  // Invalidate the whole cache (e.g., the fence)
+  input  l0d_flush,
+
+  //////////////////////////////////////////////////////////////
+  // The AGU ICB Interface from AGU
+  input                          i_icb_cmd_valid,
+  output                         i_icb_cmd_ready,
+  input  [`E203_ADDR_SIZE-1:0]   i_icb_cmd_addr,
+  input                          i_icb_cmd_read,
+  input  [`E203_XLEN-1:0]        i_icb_cmd_wdata,
+  input  [`E203_XLEN/8-1:0]      i_icb_cmd_wmask,
+  input                          i_icb_cmd_lock,
+  input                          i_icb_cmd_excl,
+  input  [1:0]                   i_icb_cmd_size,
+  input                          i_icb_cmd_back2agu,
+  input                          i_icb_cmd_usign,
+  input  [`E203_ITAG_WIDTH -1:0] i_icb_cmd_itag,
+
+  output                         i_icb_rsp_valid,
+  input                          i_icb_rsp_ready,
+  output                         i_icb_rsp_err  ,
+  output                         i_icb_rsp_excl_ok,
+  output [`E203_XLEN-1:0]        i_icb_rsp_rdata,
+
+  //////////////////////////////////////////////////////////////
+  // The AGU ICB Interface to LSU-ctrl
+  output                         o_icb_cmd_valid,
+  input                          o_icb_cmd_ready,
+  output [`E203_ADDR_SIZE-1:0]   o_icb_cmd_addr,
+  output                         o_icb_cmd_read,
+  output [`E203_XLEN-1:0]        o_icb_cmd_wdata,
+  output [`E203_XLEN/8-1:0]      o_icb_cmd_wmask,
+  output                         o_icb_cmd_lock,
+  output                         o_icb_cmd_excl,
+  output [1:0]                   o_icb_cmd_size,
+  output                         o_icb_cmd_back2agu,
+  output                         o_icb_cmd_usign,
+  output [`E203_ITAG_WIDTH -1:0] o_icb_cmd_itag,
+
+  input                          o_icb_rsp_valid,
+  output                         o_icb_rsp_ready,
+  input                          o_icb_rsp_err  ,
+  input                          o_icb_rsp_excl_ok,
+  input  [`E203_XLEN-1:0]        o_icb_rsp_rdata,
+
+  //////////////////////////////////////////////////////////////
+  // The LSU Write-Back Interface from LSU-ctrl
+  input  lsu_i_valid,
+  output lsu_i_ready,
+  input  [`E203_XLEN-1:0] lsu_i_wdat,
+  input  [`E203_ITAG_WIDTH -1:0] lsu_i_itag,
+  input  lsu_i_err ,
+  input  lsu_i_ld,
+  input  lsu_i_st,
+  input  [`E203_ADDR_SIZE -1:0] lsu_i_badaddr,
+  input  lsu_i_buserr ,
+
+  //////////////////////////////////////////////////////////////
+  // The LSU Write-Back Interface to the upstream
+  output lsu_o_valid,
+  input  lsu_o_ready,
+  output [`E203_XLEN-1:0] lsu_o_wdat,
+  output [`E203_ITAG_WIDTH -1:0] lsu_o_itag,
+  output lsu_o_err ,
+  output lsu_o_ld,
+  output lsu_o_st,
+  output [`E203_ADDR_SIZE -1:0] lsu_o_badaddr,
+  output lsu_o_buserr ,
+
+  output l0d_hit_evt,  // A load is served by the cache
+  output l0d_miss_evt, // A load misses the cache and refills a line
+
+  input  clk,
+  input  rst_n
+  );
+
+  localparam ENT_NUM = L0D_WAY_NUM * L0D_SET_NUM;
+  localparam TAG_W = `E203_ADDR_SIZE - L0D_SET_W - L0D_LINE_W - 2;
+
+  wire [L0D_LINE_W-1:0] i_wofst = i_icb_cmd_addr[L0D_LINE_W+1:2];
+  wire [L0D_SET_W-1:0]  i_set   = i_icb_cmd_addr[L0D_SET_W+L0D_LINE_W+1:L0D_LINE_W+2];
+  wire [TAG_W-1:0]      i_tag   = i_icb_cmd_addr[`E203_ADDR_SIZE-1:L0D_SET_W+L0D_LINE_W+2];
+
+  wire i_cacheable = ((i_icb_cmd_addr & L0D_REGION_MASK) == L0D_REGION_BASE);
+  wire i_dmd_ld = i_icb_cmd_read & (~i_icb_cmd_back2agu) & (~i_icb_cmd_lock) & (~i_icb_cmd_excl) & i_cacheable;
+  wire i_st     = (~i_icb_cmd_read);
+
+  //////////////////////////////////////////////////////////////
+  // The cache lines, the entry of way w and set s is (w*L0D_SET_NUM + s)
+  wire [ENT_NUM-1:0] ent_vld_r;
+  wire [TAG_W-1:0]      ent_tag_r  [ENT_NUM-1:0];
+  wire [`E203_XLEN-1:0] ent_data_r [ENT_NUM*L0D_LINE_WORDS-1:0];
+  wire [L0D_SET_NUM-1:0] set_lru_r;
+
+  wire [L0D_SET_W:0] i_ent0 = {1'b0, i_set};
+  wire [L0D_SET_W:0] i_ent1 = {1'b1, i_set};
+
+  wire i_hit_w0 = ent_vld_r[i_ent0] & (ent_tag_r[i_ent0] == i_tag);
+  wire i_hit_w1 = (L0D_WAY_NUM == 2) & ent_vld_r[i_ent1] & (ent_tag_r[i_ent1] == i_tag);
+  wire i_hit    = i_cacheable & (i_hit_w0 | i_hit_w1);
+  wire i_hit_way = i_hit_w1;
+  wire [L0D_SET_W:0] i_hit_ent = {i_hit_way, i_set};
+
+  wire [`E203_XLEN-1:0] i_hit_rdat = ent_data_r[{i_hit_ent, i_wofst}];
+
+  // The victim way, the invalid way goes first, otherwise the LRU one
+  wire i_vict_way = (L0D_WAY_NUM == 1) ? 1'b0
+                  : (~ent_vld_r[i_ent0]) ? 1'b0
+                  : (~ent_vld_r[i_ent1]) ? 1'b1
+                  : set_lru_r[i_set];
+
+  //////////////////////////////////////////////////////////////
+  // The command channel
+  wire rfl_busy_r;
+  wire lrsp_vld_r;
+  wire [2:0] dmd_outs_r;
+  wire [2:0] b2a_outs_r;
+
+  // The load hitting (or refilling) is served locally only when all the
+  //   older commands have been written back, to keep the write-back in
+  //   order, and the refill also needs the AGU response channel to be free
+  wire i_lcl_ok  = (dmd_outs_r == 3'b0) & (~lrsp_vld_r) & (~rfl_busy_r);
+  wire i_hit_acc = i_icb_cmd_valid & i_dmd_ld & i_hit & i_lcl_ok;
+  wire i_rfl_acc = i_icb_cmd_valid & i_dmd_ld & (~i_hit) & i_lcl_ok & (b2a_outs_r == 3'b0);
+
+  wire i_pass = i_icb_cmd_valid & (~i_dmd_ld) & (~rfl_busy_r)
+              // The younger command cannot go before the local response
+              & (~(lrsp_vld_r & (~i_icb_cmd_back2agu)));
+
+  wire [L0D_LINE_W:0] rfl_cmd_cnt_r;
+  wire [L0D_LINE_W-1:0] rfl_crit_r;
+  wire [L0D_SET_W-1:0] rfl_set_r;
+  wire [TAG_W-1:0] rfl_tag_r;
+  wire rfl_issue = rfl_busy_r & (rfl_cmd_cnt_r != L0D_LINE_WORDS);
+  wire [L0D_LINE_W-1:0] rfl_cmd_wofst = rfl_crit_r + rfl_cmd_cnt_r[L0D_LINE_W-1:0];
+
+  assign o_icb_cmd_valid    = i_pass | rfl_issue;
+  assign i_icb_cmd_ready    = i_hit_acc | i_rfl_acc | (i_pass & o_icb_cmd_ready);
+
+  assign o_icb_cmd_addr     = rfl_busy_r ? {rfl_tag_r, rfl_set_r, rfl_cmd_wofst, 2'b0} : i_icb_cmd_addr;
+  assign o_icb_cmd_read     = rfl_busy_r | i_icb_cmd_read;
+  assign o_icb_cmd_wdata    = i_icb_cmd_wdata;
+  assign o_icb_cmd_wmask    = i_icb_cmd_wmask;
+  assign o_icb_cmd_lock     = (~rfl_busy_r) & i_icb_cmd_lock;
+  assign o_icb_cmd_excl     = (~rfl_busy_r) & i_icb_cmd_excl;
+  assign o_icb_cmd_size     = rfl_busy_r ? 2'b10 : i_icb_cmd_size;
+  assign o_icb_cmd_back2agu = rfl_busy_r | i_icb_cmd_back2agu;
+  assign o_icb_cmd_usign    = rfl_busy_r | i_icb_cmd_usign;
+  assign o_icb_cmd_itag     = i_icb_cmd_itag;
+
+  wire i_pass_hsked    = i_pass & o_icb_cmd_ready;
+  wire rfl_issue_hsked = rfl_issue & o_icb_cmd_ready;
+  wire st_pass_hsked   = i_pass_hsked & i_st;
+
+  assign l0d_hit_evt  = i_hit_acc;
+  assign l0d_miss_evt = i_rfl_acc;
+
+  // The outstanding commands to be written back via the LSU write-back
+  wire dmd_outs_inc = i_pass_hsked & (~i_icb_cmd_back2agu);
+  wire dmd_outs_dec = lsu_i_valid & lsu_i_ready;
+  wire dmd_outs_ena = dmd_outs_inc ^ dmd_outs_dec;
+  wire [2:0] dmd_outs_nxt = dmd_outs_inc ? (dmd_outs_r + 3'b1) : (dmd_outs_r - 3'b1);
+  sirv_gnrl_dfflr #(3) dmd_outs_dfflr (dmd_outs_ena, dmd_outs_nxt, dmd_outs_r, clk, rst_n);
+
+  // The outstanding back2agu commands of the upstream (e.g., the AMO)
+  wire b2a_outs_inc = i_pass_hsked & i_icb_cmd_back2agu;
+  wire b2a_outs_dec = i_icb_rsp_valid & i_icb_rsp_ready;
+  wire b2a_outs_ena = b2a_outs_inc ^ b2a_outs_dec;
+  wire [2:0] b2a_outs_nxt = b2a_outs_inc ? (b2a_outs_r + 3'b1) : (b2a_outs_r - 3'b1);
+  sirv_gnrl_dfflr #(3) b2a_outs_dfflr (b2a_outs_ena, b2a_outs_nxt, b2a_outs_r, clk, rst_n);
+
+  //////////////////////////////////////////////////////////////
+  // The line refill
+  wire [L0D_LINE_W:0] rfl_rsp_cnt_r;
+  wire rfl_way_r;
+  wire rfl_kill_r;
+
+  // The refill responses come back via the AGU ICB response channel
+  wire rfl_rsp = o_icb_rsp_valid & rfl_busy_r;
+  assign i_icb_rsp_valid   = o_icb_rsp_valid & (~rfl_busy_r);
+  assign o_icb_rsp_ready   = rfl_busy_r | i_icb_rsp_ready;
+  assign i_icb_rsp_err     = o_icb_rsp_err;
+  assign i_icb_rsp_excl_ok = o_icb_rsp_excl_ok;
+  assign i_icb_rsp_rdata   = o_icb_rsp_rdata;
+
+  wire rfl_rsp_1st  = rfl_rsp & (rfl_rsp_cnt_r == {L0D_LINE_W+1{1'b0}});
+  wire rfl_rsp_last = rfl_rsp & (rfl_rsp_cnt_r == (L0D_LINE_WORDS-1));
+  wire [L0D_LINE_W-1:0] rfl_rsp_wofst = rfl_crit_r + rfl_rsp_cnt_r[L0D_LINE_W-1:0];
+  wire [L0D_SET_W:0] rfl_ent = {rfl_way_r, rfl_set_r};
+
+  wire rfl_busy_set = i_rfl_acc;
+  wire rfl_busy_clr = rfl_rsp_last;
+  wire rfl_busy_ena = rfl_busy_set | rfl_busy_clr;
+  wire rfl_busy_nxt = rfl_busy_set | (~rfl_busy_clr);
+  sirv_gnrl_dfflr #(1) rfl_busy_dfflr (rfl_busy_ena, rfl_busy_nxt, rfl_busy_r, clk, rst_n);
+
+  wire rfl_cmd_cnt_ena = i_rfl_acc | rfl_issue_hsked;
+  wire [L0D_LINE_W:0] rfl_cmd_cnt_nxt = i_rfl_acc ? {L0D_LINE_W+1{1'b0}} : (rfl_cmd_cnt_r + 1'b1);
+  sirv_gnrl_dfflr #(L0D_LINE_W+1) rfl_cmd_cnt_dfflr (rfl_cmd_cnt_ena, rfl_cmd_cnt_nxt, rfl_cmd_cnt_r, clk, rst_n);
+
+  wire rfl_rsp_cnt_ena = i_rfl_acc | rfl_rsp;
+  wire [L0D_LINE_W:0] rfl_rsp_cnt_nxt = i_rfl_acc ? {L0D_LINE_W+1{1'b0}} : (rfl_rsp_cnt_r + 1'b1);
+  sirv_gnrl_dfflr #(L0D_LINE_W+1) rfl_rsp_cnt_dfflr (rfl_rsp_cnt_ena, rfl_rsp_cnt_nxt, rfl_rsp_cnt_r, clk, rst_n);
+
+  sirv_gnrl_dffl #(L0D_LINE_W) rfl_crit_dffl (i_rfl_acc, i_wofst   , rfl_crit_r, clk);
+  sirv_gnrl_dffl #(L0D_SET_W)  rfl_set_dffl  (i_rfl_acc, i_set     , rfl_set_r , clk);
+  sirv_gnrl_dffl #(TAG_W)      rfl_tag_dffl  (i_rfl_acc, i_tag     , rfl_tag_r , clk);
+  sirv_gnrl_dffl #(1)          rfl_way_dffl  (i_rfl_acc, i_vict_way, rfl_way_r , clk);
+
+  // A bus error or a flush during the refill leaves the line invalid
+  wire rfl_kill_set = rfl_busy_r & (l0d_flush | (rfl_rsp & o_icb_rsp_err));
+  wire rfl_kill_clr = i_rfl_acc;
+  wire rfl_kill_ena = rfl_kill_set | rfl_kill_clr;
+  wire rfl_kill_nxt = rfl_kill_set | (~rfl_kill_clr);
+  sirv_gnrl_dfflr #(1) rfl_kill_dfflr (rfl_kill_ena, rfl_kill_nxt, rfl_kill_r, clk, rst_n);
+
+  wire rfl_done_ok = rfl_rsp_last & (~rfl_kill_r) & (~o_icb_rsp_err) & (~l0d_flush);
+
+  //////////////////////////////////////////////////////////////
+  // Update the cache lines
+  genvar i;
+  genvar k;
+  generate //{
+    for (i=0; i<ENT_NUM; i=i+1) begin:l0d_ent//{
+      // The line is invalid during its refill
+      wire ent_rfl_start = i_rfl_acc & ({i_vict_way, i_set} == i);
+      wire ent_rfl_done  = rfl_done_ok & (rfl_ent == i);
+
+      wire vld_ena = ent_rfl_start | ent_rfl_done | l0d_flush;
+      wire vld_nxt = ent_rfl_done & (~l0d_flush);
+      sirv_gnrl_dfflr #(1) ent_vld_dfflr (vld_ena, vld_nxt, ent_vld_r[i], clk, rst_n);
+
+      sirv_gnrl_dffl #(TAG_W) ent_tag_dffl (ent_rfl_start, i_tag, ent_tag_r[i], clk);
+
+      for (k=0; k<L0D_LINE_WORDS; k=k+1) begin:l0d_word//{
+        wire wd_rfl = rfl_rsp & (rfl_ent == i) & (rfl_rsp_wofst == k);
+        // The write-through store updates the hitting word
+        wire wd_st  = st_pass_hsked & i_hit & (i_hit_ent == i) & (i_wofst == k);
+
+        wire [`E203_XLEN-1:0] wd_r = ent_data_r[i*L0D_LINE_WORDS+k];
+        wire [`E203_XLEN-1:0] wd_st_dat = {
+             (i_icb_cmd_wmask[3] ? i_icb_cmd_wdata[31:24] : wd_r[31:24]),
+             (i_icb_cmd_wmask[2] ? i_icb_cmd_wdata[23:16] : wd_r[23:16]),
+             (i_icb_cmd_wmask[1] ? i_icb_cmd_wdata[15: 8] : wd_r[15: 8]),
+             (i_icb_cmd_wmask[0] ? i_icb_cmd_wdata[ 7: 0] : wd_r[ 7: 0])};
+
+        wire wd_ena = wd_rfl | wd_st;
+        wire [`E203_XLEN-1:0] wd_nxt = wd_rfl ? o_icb_rsp_rdata : wd_st_dat;
+        sirv_gnrl_dffl #(`E203_XLEN) ent_data_dffl (wd_ena, wd_nxt, ent_data_r[i*L0D_LINE_WORDS+k], clk);
+      end//}
+    end//}
+
+    for (i=0; i<L0D_SET_NUM; i=i+1) begin:l0d_lru//{
+      // The way just used becomes the MRU one
+      wire lru_hit = i_hit_acc & (i_set == i);
+      wire lru_rfl = i_rfl_acc & (i_set == i);
+      wire lru_ena = lru_hit | lru_rfl;
+      wire lru_nxt = lru_hit ? (~i_hit_way) : (~i_vict_way);
+      sirv_gnrl_dfflr #(1) set_lru_dfflr (lru_ena, lru_nxt, set_lru_r[i], clk, rst_n);
+    end//}
+  endgenerate//}
+
+  //////////////////////////////////////////////////////////////
+  // The local response of the load served by the cache, from the
+  //   hitting line, or from the critical word of the refill
+  wire [1:0] lcmd_ofst_r;
+  wire [1:0] lcmd_size_r;
+  wire lcmd_usign_r;
+  wire [`E203_ITAG_WIDTH-1:0] lcmd_itag_r;
+  wire [`E203_ADDR_SIZE-1:0] lcmd_addr_r;
+
+  wire lcmd_ena = i_hit_acc | i_rfl_acc;
+  sirv_gnrl_dffl #(2)                lcmd_ofst_dffl  (lcmd_ena, i_icb_cmd_addr[1:0], lcmd_ofst_r , clk);
+  sirv_gnrl_dffl #(2)                lcmd_size_dffl  (lcmd_ena, i_icb_cmd_size     , lcmd_size_r , clk);
+  sirv_gnrl_dffl #(1)                lcmd_usign_dffl (lcmd_ena, i_icb_cmd_usign    , lcmd_usign_r, clk);
+  sirv_gnrl_dffl #(`E203_ITAG_WIDTH) lcmd_itag_dffl  (lcmd_ena, i_icb_cmd_itag     , lcmd_itag_r , clk);
+  sirv_gnrl_dffl #(`E203_ADDR_SIZE)  lcmd_addr_dffl  (lcmd_ena, i_icb_cmd_addr     , lcmd_addr_r , clk);
+
+  wire lrsp_set_hit = i_hit_acc;
+  wire lrsp_set_rfl = rfl_rsp_1st;
+
+  // The hitting word is captured raw, the extension is done at the output
+  wire [`E203_XLEN-1:0] lrsp_raw_r;
+  wire lrsp_err_r;
+  wire lrsp_raw_ena = lrsp_set_hit | lrsp_set_rfl;
+  wire [`E203_XLEN-1:0] lrsp_raw_nxt = lrsp_set_hit ? i_hit_rdat : o_icb_rsp_rdata;
+  wire lrsp_err_nxt = lrsp_set_rfl & o_icb_rsp_err;
+  sirv_gnrl_dffl #(`E203_XLEN) lrsp_raw_dffl (lrsp_raw_ena, lrsp_raw_nxt, lrsp_raw_r, clk);
+  sirv_gnrl_dffl #(1)          lrsp_err_dffl (lrsp_raw_ena, lrsp_err_nxt, lrsp_err_r, clk);
+
+  wire lrsp_hsked = lrsp_vld_r & lsu_o_ready;
+  wire lrsp_vld_set = lrsp_set_hit | lrsp_set_rfl;
+  wire lrsp_vld_clr = lrsp_hsked;
+  wire lrsp_vld_ena = lrsp_vld_set | lrsp_vld_clr;
+  wire lrsp_vld_nxt = lrsp_vld_set | (~lrsp_vld_clr);
+  sirv_gnrl_dfflr #(1) lrsp_vld_dfflr (lrsp_vld_ena, lrsp_vld_nxt, lrsp_vld_r, clk, rst_n);
+
+  wire [`E203_XLEN-1:0] lrsp_sft = lrsp_raw_r >> {lcmd_ofst_r, 3'b0};
+  wire [`E203_XLEN-1:0] lrsp_wdat =
+        (lcmd_size_r == 2'b00) ? {{24{(~lcmd_usign_r) & lrsp_sft[7]}} , lrsp_sft[7:0]}
+      : (lcmd_size_r == 2'b01) ? {{16{(~lcmd_usign_r) & lrsp_sft[15]}}, lrsp_sft[15:0]}
+      : lrsp_sft;
+
+  // No command is passed down while the local response is pending, so
+  //   the LSU-ctrl cannot have its write-back valid at the same time
+  assign lsu_o_valid   = lrsp_vld_r | lsu_i_valid;
+  assign lsu_i_ready   = (~lrsp_vld_r) & lsu_o_ready;
+  assign lsu_o_wdat    = lrsp_vld_r ? lrsp_wdat : lsu_i_wdat;
+  assign lsu_o_itag    = lrsp_vld_r ? lcmd_itag_r : lsu_i_itag;
+  assign lsu_o_err     = lrsp_vld_r ? lrsp_err_r : lsu_i_err;
+  assign lsu_o_ld      = lrsp_vld_r | lsu_i_ld;
+  assign lsu_o_st      = (~lrsp_vld_r) & lsu_i_st;
+  assign lsu_o_badaddr = lrsp_vld_r ? lcmd_addr_r : lsu_i_badaddr;
+  assign lsu_o_buserr  = lrsp_vld_r ? lrsp_err_r : lsu_i_buserr;
+
+endmodule
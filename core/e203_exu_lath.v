@@ -0,0 +1,214 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The load latency histogram, which measures the round-trip of each load
+//  on the AGU ICB channel to LSU-ctrl (from the command handshake to the
+//  response handshake) and counts it into a latency bucket of the address
+//  region it goes to, so the CPI lost to the memory latency can be told
+//  for the DTCM, the external SRAM, the peripherals, etc.
+//
+//  * The LSU-ctrl responds in order, on agu_icb_rsp for the back2agu
+//    commands and on lsu_o for the others, so each command handshake
+//    pushes an entry (its region and age) into a small in-order queue,
+//    and each response handshake of either channel pops the oldest one.
+//    The stores are tracked for the ordering, but not counted.
+//  * The 4 regions are matched as (addr & mask) == (base & mask), and
+//    the first matching region is taken, a load in no region is not
+//    counted. A latency of L cycles goes into the bucket L >> shift, the
+//    last bucket takes all the longer ones.
+//
+//  The counters and the configuration are custom machine CSRs, OR-ed into
+//  the CSR read-data as the HPM counters are:
+//    0xBC0      LATH_SEL  : the counter index, {region, bucket}
+//    0xBC1      LATH_DAT  : the counter selected by LATH_SEL (writable)
+//    0xBC2      LATH_CFG  : the bucket shift
+//    0xBC4+r    LATH_BASE : the base address of region r
+//    0xBC8+r    LATH_MASK : the address mask of region r
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_exu_lath #(
+  parameter OUTS_NUM = 4,
+  parameter BUCKET_NUM = 8,
+  parameter BUCKET_W = 3,
+  parameter AGE_W = 8,
+  // The default regions of the HBirdv2 SoC memory map
+  parameter REGION0_BASE = 32'h9000_0000, // DTCM
+  parameter REGION0_MASK = 32'hFFFF_0000,
+  parameter REGION1_BASE = 32'h8000_0000, // ITCM
+  parameter REGION1_MASK = 32'hFFFF_0000,
+  parameter REGION2_BASE = 32'hA000_0000, // External memory
+  parameter REGION2_MASK = 32'hF000_0000,
+  parameter REGION3_BASE = 32'h1000_0000, // Peripherals
+  parameter REGION3_MASK = 32'hF000_0000
+)(
+  //////////////////////////////////////////////////////////////
+  // The AGU ICB channel to LSU-ctrl
+  input  agu_icb_cmd_valid,
+  input  agu_icb_cmd_ready,
+  input  [`E203_ADDR_SIZE-1:0] agu_icb_cmd_addr,
+  input  agu_icb_cmd_read,
+
+  input  agu_icb_rsp_valid,
+  input  agu_icb_rsp_ready,
+  input  lsu_o_valid,
+  input  lsu_o_ready,
+
+  //////////////////////////////////////////////////////////////
+  // The CSR access from the ALU
+  input  csr_ena,
+  input  csr_wr_en,
+  input  [12-1:0] csr_idx,
+  input  [`E203_XLEN-1:0] wbck_csr_dat,
+  output [`E203_XLEN-1:0] lath_csr_dat,
+
+  input  clk,
+  input  rst_n
+  );
+
+  localparam PTR_W = 3;
+  localparam REGION_NUM = 4;
+  localparam RGN_W = 2;
+  localparam CNT_NUM = REGION_NUM * BUCKET_NUM;
+
+  wire csr_wr = csr_ena & csr_wr_en;
+
+  //////////////////////////////////////////////////////////////
+  // The configuration CSRs
+  wire sel_sel = (csr_idx == 12'hBC0);
+  wire sel_dat = (csr_idx == 12'hBC1);
+  wire sel_cfg = (csr_idx == 12'hBC2);
+
+  wire [RGN_W+BUCKET_W-1:0] cnt_sel_r;
+  sirv_gnrl_dfflr #(RGN_W+BUCKET_W) cnt_sel_dfflr (csr_wr & sel_sel, wbck_csr_dat[RGN_W+BUCKET_W-1:0], cnt_sel_r, clk, rst_n);
+
+  wire [2:0] bkt_shift_r;
+  sirv_gnrl_dfflr #(3) bkt_shift_dfflr (csr_wr & sel_cfg, wbck_csr_dat[2:0], bkt_shift_r, clk, rst_n);
+
+  wire [`E203_ADDR_SIZE-1:0] rgn_base_rst [REGION_NUM-1:0];
+  wire [`E203_ADDR_SIZE-1:0] rgn_mask_rst [REGION_NUM-1:0];
+  assign rgn_base_rst[0] = REGION0_BASE;
+  assign rgn_mask_rst[0] = REGION0_MASK;
+  assign rgn_base_rst[1] = REGION1_BASE;
+  assign rgn_mask_rst[1] = REGION1_MASK;
+  assign rgn_base_rst[2] = REGION2_BASE;
+  assign rgn_mask_rst[2] = REGION2_MASK;
+  assign rgn_base_rst[3] = REGION3_BASE;
+  assign rgn_mask_rst[3] = REGION3_MASK;
+
+  wire [REGION_NUM-1:0] rgn_hit;
+  wire [`E203_XLEN-1:0] rgn_rdat [REGION_NUM:0];
+  assign rgn_rdat[0] = `E203_XLEN'b0;
+
+  genvar i;
+  generate //{
+    for (i=0; i<REGION_NUM; i=i+1) begin:lath_rgn//{
+      wire sel_base = (csr_idx == (12'hBC4 + i));
+      wire sel_mask = (csr_idx == (12'hBC8 + i));
+
+      // Kept XOR-ed with the default, so the flops reset to zeros but the
+      //   region reads as the default after the reset
+      wire [`E203_ADDR_SIZE-1:0] base_q;
+      wire [`E203_ADDR_SIZE-1:0] mask_q;
+      sirv_gnrl_dfflr #(`E203_ADDR_SIZE) base_dfflr (csr_wr & sel_base, wbck_csr_dat[`E203_ADDR_SIZE-1:0] ^ rgn_base_rst[i], base_q, clk, rst_n);
+      sirv_gnrl_dfflr #(`E203_ADDR_SIZE) mask_dfflr (csr_wr & sel_mask, wbck_csr_dat[`E203_ADDR_SIZE-1:0] ^ rgn_mask_rst[i], mask_q, clk, rst_n);
+
+      wire [`E203_ADDR_SIZE-1:0] base_r = base_q ^ rgn_base_rst[i];
+      wire [`E203_ADDR_SIZE-1:0] mask_r = mask_q ^ rgn_mask_rst[i];
+
+      assign rgn_hit[i] = ((agu_icb_cmd_addr & mask_r) == (base_r & mask_r));
+
+      assign rgn_rdat[i+1] = rgn_rdat[i]
+                           | ({`E203_XLEN{sel_base}} & base_r)
+                           | ({`E203_XLEN{sel_mask}} & mask_r);
+    end//}
+  endgenerate//}
+
+  // The first matching region
+  reg [RGN_W-1:0] cmd_rgn;
+  reg cmd_rgn_hit;
+  integer j;
+  always @* begin
+    cmd_rgn = {RGN_W{1'b0}};
+    cmd_rgn_hit = 1'b0;
+    for (j=REGION_NUM-1; j>=0; j=j-1) begin
+      if (rgn_hit[j]) begin
+        cmd_rgn = j;
+        cmd_rgn_hit = 1'b1;
+      end
+    end
+  end
+
+  //////////////////////////////////////////////////////////////
+  // The in-order queue of the outstanding commands
+  wire cmd_hsked = agu_icb_cmd_valid & agu_icb_cmd_ready;
+  wire rsp_hsked = (agu_icb_rsp_valid & agu_icb_rsp_ready)
+                 | (lsu_o_valid & lsu_o_ready);
+
+  wire [PTR_W-1:0] wptr_r;
+  wire [PTR_W-1:0] rptr_r;
+  wire [PTR_W-1:0] wptr_nxt = (wptr_r == (OUTS_NUM-1)) ? {PTR_W{1'b0}} : (wptr_r + 1'b1);
+  wire [PTR_W-1:0] rptr_nxt = (rptr_r == (OUTS_NUM-1)) ? {PTR_W{1'b0}} : (rptr_r + 1'b1);
+  sirv_gnrl_dfflr #(PTR_W) wptr_dfflr (cmd_hsked, wptr_nxt, wptr_r, clk, rst_n);
+  sirv_gnrl_dfflr #(PTR_W) rptr_dfflr (rsp_hsked, rptr_nxt, rptr_r, clk, rst_n);
+
+  wire [OUTS_NUM-1:0] ent_cnt;
+  wire [RGN_W-1:0] ent_rgn [OUTS_NUM-1:0];
+  wire [AGE_W-1:0] ent_age [OUTS_NUM-1:0];
+
+  generate //{
+    for (i=0; i<OUTS_NUM; i=i+1) begin:lath_ent//{
+      wire ent_set = cmd_hsked & (wptr_r == i);
+      wire ent_clr = rsp_hsked & (rptr_r == i);
+
+      wire vld_r;
+      wire vld_ena = ent_set | ent_clr;
+      sirv_gnrl_dfflr #(1) vld_dfflr (vld_ena, ent_set, vld_r, clk, rst_n);
+
+      // Only the loads in a region are counted
+      sirv_gnrl_dfflr #(1) cnt_dfflr (ent_set, agu_icb_cmd_read & cmd_rgn_hit, ent_cnt[i], clk, rst_n);
+      sirv_gnrl_dffl #(RGN_W) rgn_dffl (ent_set, cmd_rgn, ent_rgn[i], clk);
+
+      // The age is the latency if responded in this cycle, saturated
+      wire age_sat = (&ent_age[i]);
+      wire age_ena = ent_set | (vld_r & (~age_sat));
+      wire [AGE_W-1:0] age_nxt = ent_set ? {{AGE_W-1{1'b0}}, 1'b1} : (ent_age[i] + 1'b1);
+      sirv_gnrl_dfflr #(AGE_W) age_dfflr (age_ena, age_nxt, ent_age[i], clk, rst_n);
+    end//}
+  endgenerate//}
+
+  //////////////////////////////////////////////////////////////
+  // The histogram counters
+  wire rsp_cnt = rsp_hsked & ent_cnt[rptr_r];
+  wire [RGN_W-1:0] rsp_rgn = ent_rgn[rptr_r];
+  wire [AGE_W-1:0] rsp_lat = ent_age[rptr_r] >> bkt_shift_r;
+  wire [BUCKET_W-1:0] rsp_bkt = (rsp_lat >= (BUCKET_NUM-1)) ? (BUCKET_NUM-1) : rsp_lat[BUCKET_W-1:0];
+  wire [RGN_W+BUCKET_W-1:0] rsp_idx = {rsp_rgn, rsp_bkt};
+
+  wire [`E203_XLEN-1:0] cnt_rdat [CNT_NUM:0];
+  assign cnt_rdat[0] = `E203_XLEN'b0;
+
+  generate //{
+    for (i=0; i<CNT_NUM; i=i+1) begin:lath_cnt//{
+      wire sel_cnt = (cnt_sel_r == i);
+      wire wr_cnt  = sel_cnt & sel_dat & csr_wr;
+      wire inc_cnt = rsp_cnt & (rsp_idx == i);
+
+      wire [`E203_XLEN-1:0] cnt_r;
+      wire cnt_ena = wr_cnt | inc_cnt;
+      wire [`E203_XLEN-1:0] cnt_nxt = wr_cnt ? wbck_csr_dat : (cnt_r + 1'b1);
+      sirv_gnrl_dfflr #(`E203_XLEN) cnt_dfflr (cnt_ena, cnt_nxt, cnt_r, clk, rst_n);
+
+      assign cnt_rdat[i+1] = cnt_rdat[i] | ({`E203_XLEN{sel_cnt}} & cnt_r);
+    end//}
+  endgenerate//}
+
+  assign lath_csr_dat = ({`E203_XLEN{sel_dat}} & cnt_rdat[CNT_NUM])
+                      | ({`E203_XLEN{sel_sel}} & {{`E203_XLEN-RGN_W-BUCKET_W{1'b0}}, cnt_sel_r})
+                      | ({`E203_XLEN{sel_cfg}} & {{`E203_XLEN-3{1'b0}}, bkt_shift_r})
+                      | rgn_rdat[REGION_NUM];
+
+endmodule
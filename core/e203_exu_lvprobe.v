@@ -0,0 +1,94 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The load value locality probe: a PC-indexed last-value/stride table
+//  with 2-bit confidence counters, which measures how often a load value
+//  predictor would be right. It is not a predictor, no value ever leaves
+//  it.
+//
+//  The table is trained with every load written back by the LSU, and every
+//  load written back is also checked against the value predicted from the
+//  table before the update, so the accuracy a predictor would have is known
+//  from the events:
+//    * lvp_lkup_evt: a load is looked up (i.e., written back)
+//    * lvp_prdt_evt: the entry was confident, a prediction would be made
+//    * lvp_hit_evt : the confident prediction was correct
+//
+//  The lvp_* names stand for this probe. A load value predictor (the
+//  value supplied to the dependents, with the flush and replay of a wrong
+//  one) is not built: the ALU instructions commit at the EXU stage, so a
+//  dependent issued on a predicted value must hold its commit until the
+//  load write-back confirms it, which is the cycle the Load-Use forwarding
+//  already hands it the real value. A predictor needs a later commit point
+//  than this pipeline has.
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_exu_lvprobe #(
+  parameter LVP_ENTRY_NUM = 8,
+  parameter LVP_IDX_W = 3,
+  parameter LVP_TAG_W = 8
+)(
+  //////////////////////////////////////////////////////////////
+  // The load written back by LSU
+  input  lvp_i_valid,
+  input  [`E203_PC_SIZE-1:0] lvp_i_pc,
+  input  [`E203_XLEN-1:0] lvp_i_wdat,
+
+  output lvp_lkup_evt,
+  output lvp_prdt_evt,
+  output lvp_hit_evt,
+
+  input  clk,
+  input  rst_n
+  );
+
+  wire [LVP_IDX_W-1:0] lvp_idx = lvp_i_pc[LVP_IDX_W:1];
+  wire [LVP_TAG_W-1:0] lvp_tag = lvp_i_pc[LVP_IDX_W+LVP_TAG_W:LVP_IDX_W+1];
+
+  wire [LVP_ENTRY_NUM-1:0] ent_vld_r;
+  wire [LVP_TAG_W-1:0]  ent_tag_r  [LVP_ENTRY_NUM-1:0];
+  wire [`E203_XLEN-1:0] ent_last_r [LVP_ENTRY_NUM-1:0];
+  wire [`E203_XLEN-1:0] ent_strd_r [LVP_ENTRY_NUM-1:0];
+  wire [1:0]            ent_conf_r [LVP_ENTRY_NUM-1:0];
+
+  //////////////////////////////////////////////////////////////
+  // Lookup and check the prediction
+  wire [`E203_XLEN-1:0] sel_last = ent_last_r[lvp_idx];
+  wire [`E203_XLEN-1:0] sel_strd = ent_strd_r[lvp_idx];
+  wire [1:0]            sel_conf = ent_conf_r[lvp_idx];
+  wire sel_hit = ent_vld_r[lvp_idx] & (ent_tag_r[lvp_idx] == lvp_tag);
+
+  wire [`E203_XLEN-1:0] lvp_prdt = sel_last + sel_strd;
+  wire lvp_prdt_ok = (lvp_prdt == lvp_i_wdat);
+  wire lvp_confident = sel_hit & sel_conf[1];
+
+  assign lvp_lkup_evt = lvp_i_valid;
+  assign lvp_prdt_evt = lvp_i_valid & lvp_confident;
+  assign lvp_hit_evt  = lvp_i_valid & lvp_confident & lvp_prdt_ok;
+
+  //////////////////////////////////////////////////////////////
+  // Train the entry, a missed entry is just replaced
+  wire [`E203_XLEN-1:0] ent_strd_nxt = sel_hit ? (lvp_i_wdat - sel_last) : `E203_XLEN'b0;
+  wire [1:0] ent_conf_nxt = (~sel_hit)              ? 2'b00
+                          : (~lvp_prdt_ok)          ? 2'b00
+                          : (sel_conf == 2'b11)     ? 2'b11
+                          : (sel_conf + 2'b01);
+
+  genvar i;
+  generate //{
+    for (i=0; i<LVP_ENTRY_NUM; i=i+1) begin:lvp_ent//{
+      wire ent_ena = lvp_i_valid & (lvp_idx == i);
+
+      sirv_gnrl_dfflr #(1)          ent_vld_dfflr (ent_ena, 1'b1        , ent_vld_r[i] , clk, rst_n);
+      sirv_gnrl_dffl  #(LVP_TAG_W)  ent_tag_dffl  (ent_ena, lvp_tag     , ent_tag_r[i] , clk);
+      sirv_gnrl_dffl  #(`E203_XLEN) ent_last_dffl (ent_ena, lvp_i_wdat  , ent_last_r[i], clk);
+      sirv_gnrl_dffl  #(`E203_XLEN) ent_strd_dffl (ent_ena, ent_strd_nxt, ent_strd_r[i], clk);
+      sirv_gnrl_dffl  #(2)          ent_conf_dffl (ent_ena, ent_conf_nxt, ent_conf_r[i], clk);
+    end//}
+  endgenerate//}
+
+endmodule
@@ -0,0 +1,73 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The Regfile with two write ports, one for the ALU write-back and one
+//  for the Long-pipe write-back, so both of them can retire in the same
+//  cycle instead of being arbitrated by e203_exu_wbck.
+//
+//  The two ports never write the same register in the same cycle: an ALU
+//  instruction cannot be dispatched while an older long-pipe instruction
+//  in the OITF is to write the same register (the WAW dependency check of
+//  e203_exu_disp), and once it is dispatched it writes back in that very
+//  cycle, before any younger long-pipe instruction can retire. Still the
+//  ALU port (port 0) is given the priority, since whenever they do match
+//  the ALU instruction is always the younger one.
+//
+//  This regfile is DFF based only (no E203_REGFILE_LATCH_BASED), and it
+//  has the same read ports as e203_exu_regfile.
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_exu_regfile_2w(
+  input  [`E203_RFIDX_WIDTH-1:0] read_src1_idx,
+  input  [`E203_RFIDX_WIDTH-1:0] read_src2_idx,
+  output [`E203_XLEN-1:0] read_src1_dat,
+  output [`E203_XLEN-1:0] read_src2_dat,
+
+  // The write port 0, from the ALU
+  input  wbck0_dest_wen,
+  input  [`E203_RFIDX_WIDTH-1:0] wbck0_dest_idx,
+  input  [`E203_XLEN-1:0] wbck0_dest_dat,
+
+  // The write port 1, from the Long-pipe
+  input  wbck1_dest_wen,
+  input  [`E203_RFIDX_WIDTH-1:0] wbck1_dest_idx,
+  input  [`E203_XLEN-1:0] wbck1_dest_dat,
+
+  output [`E203_XLEN-1:0] x1_r,
+
+  input  test_mode,
+  input  clk,
+  input  rst_n
+  );
+
+  wire [`E203_XLEN-1:0] rf_r [`E203_RFREG_NUM-1:0];
+  wire [`E203_RFREG_NUM-1:0] rf_wen;
+
+  genvar i;
+  generate //{
+    for (i=0; i<`E203_RFREG_NUM; i=i+1) begin:regfile//{
+      if(i==0) begin: rf0
+          // x0 cannot be wrote since it is constant-zeros
+          assign rf_wen[i] = 1'b0;
+          assign rf_r[i] = `E203_XLEN'b0;
+      end
+      else begin: rfno0
+          wire rf_wen0 = wbck0_dest_wen & (wbck0_dest_idx == i);
+          wire rf_wen1 = wbck1_dest_wen & (wbck1_dest_idx == i);
+          assign rf_wen[i] = rf_wen0 | rf_wen1;
+          wire [`E203_XLEN-1:0] rf_wdat = rf_wen0 ? wbck0_dest_dat : wbck1_dest_dat;
+          sirv_gnrl_dffl #(`E203_XLEN) rf_dffl (rf_wen[i], rf_wdat, rf_r[i], clk);
+      end
+    end//}
+  endgenerate//}
+
+  assign read_src1_dat = rf_r[read_src1_idx];
+  assign read_src2_dat = rf_r[read_src2_idx];
+
+  assign x1_r = rf_r[1];
+
+endmodule
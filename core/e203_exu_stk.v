@@ -0,0 +1,379 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The Hardware Stacking Engine, which saves the caller-saved registers
+//  (ra, t0-t6, a0-a7) to the stack on the interrupt entry, and restores
+//  them on the mret returning from that interrupt, so the interrupt
+//  handler does not need to save and restore them by software.
+//
+//  * On the interrupt trap entry, the dispatch is held, and once the OITF
+//    and the outstanding AGU ICB transactions are drained, the 16
+//    registers are stored back-to-back below sp through the AGU ICB
+//    channel (as the back2agu transactions, so their responses come back
+//    here instead of to the LSU write-back), then sp is decreased by 64.
+//  * On the mret of an interrupt handler, the 16 registers are loaded back
+//    in the same way and written through the ALU write-back port, then sp
+//    is increased by 64.
+//  * Tail-chaining: if an enabled interrupt is pending at the mret, the
+//    frame is not restored, and once the next interrupt is taken (at the
+//    same return PC) its handler just runs on the same frame, skipping
+//    both the restore and the next save. The same applies if an interrupt
+//    is taken while the frame is being restored, since the frame is still
+//    intact on the stack until sp is increased. If no interrupt comes in
+//    TCHN_WIN cycles, the frame is restored as usual.
+//  * The exceptions (e.g., the ecall) are not stacked, the kind of each
+//    nested trap is kept in a small stack, so only the mret returning from
+//    an interrupt restores the frame.
+//  * The kind stack holds KND_DEPTH nested traps. Once it is full, no more
+//    interrupt is taken (stk_irq_blk masks mstatus.MIE to the Commit, the
+//    interrupt stays pending) until a mret pops it. The exceptions nested
+//    further are only counted (they are never stacked), up to
+//    2^KND_OVF_W-1 of them, deeper exception nesting is not supported.
+//
+//  The frame (from the lowest address) is: ra, t0-t2, a0-a7, t3-t6. The
+//  handler must not save these registers by itself (i.e., it is a plain
+//  C function called from a naked entry), and it must keep sp as it was
+//  at its entry when it executes the mret.
+//
+//  The frame transactions are not instructions, so a bus error on them
+//  cannot be taken as a load/store access fault (there is no PC to report
+//  it against). Instead:
+//  * A faulting push response is only recorded, the slot on the stack is
+//    lost and is restored as whatever the memory returns at the mret.
+//  * A faulting pop response is not written back, the register keeps the
+//    value the handler left in it.
+//  * Either one sets a sticky bit in STK_STA and pulses stk_err_evt (an
+//    HPM event), and the address of the first faulting transaction since
+//    STK_STA was cleared is kept in STK_BADADDR, so the software can check
+//    them (e.g., in the handler or a watchdog) and treat the interrupted
+//    context as corrupted:
+//      0xBD0   STK_STA     : bit 0 push error, bit 1 pop error (write 0 to clear)
+//      0xBD1   STK_BADADDR : the frame address of the first error (read-only)
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_exu_stk #(
+  parameter KND_DEPTH = 8,
+  parameter KND_OVF_W = 4,
+  parameter TCHN_WIN = 8
+)(
+  //////////////////////////////////////////////////////////////
+  // The trap entry and return from Commit
+  input  trap_ena,   // A trap is taken (the mcause is updated)
+  input  trap_irq,   // The trap is an interrupt
+  input  mret_ena,   // A mret is committed
+  input  irq_pend,   // An enabled interrupt is pending
+
+  input  oitf_empty,
+
+  output stk_hold,   // Hold the dispatch
+  output stk_irq_blk,// Take no interrupt, the kind stack is full
+
+  //////////////////////////////////////////////////////////////
+  // The regfile read
+  input  [`E203_RFIDX_WIDTH-1:0] i_rs1idx,
+  input  [`E203_RFIDX_WIDTH-1:0] i_rs2idx,
+  output [`E203_RFIDX_WIDTH-1:0] rf_rs1idx,
+  output [`E203_RFIDX_WIDTH-1:0] rf_rs2idx,
+  input  [`E203_XLEN-1:0] rf_rs1,
+  input  [`E203_XLEN-1:0] rf_rs2,
+
+  //////////////////////////////////////////////////////////////
+  // The ALU write-back, to which the restored registers are merged
+  input  i_wbck_valid,
+  output i_wbck_ready,
+  input  [`E203_XLEN-1:0] i_wbck_wdat,
+  input  [`E203_RFIDX_WIDTH-1:0] i_wbck_rdidx,
+
+  output o_wbck_valid,
+  input  o_wbck_ready,
+  output [`E203_XLEN-1:0] o_wbck_wdat,
+  output [`E203_RFIDX_WIDTH-1:0] o_wbck_rdidx,
+
+  //////////////////////////////////////////////////////////////
+  // The AGU ICB Interface from the upstream
+  input                          i_icb_cmd_valid,
+  output                         i_icb_cmd_ready,
+  input  [`E203_ADDR_SIZE-1:0]   i_icb_cmd_addr,
+  input                          i_icb_cmd_read,
+  input  [`E203_XLEN-1:0]        i_icb_cmd_wdata,
+  input  [`E203_XLEN/8-1:0]      i_icb_cmd_wmask,
+  input                          i_icb_cmd_lock,
+  input                          i_icb_cmd_excl,
+  input  [1:0]                   i_icb_cmd_size,
+  input                          i_icb_cmd_back2agu,
+  input                          i_icb_cmd_usign,
+  input  [`E203_ITAG_WIDTH -1:0] i_icb_cmd_itag,
+
+  output                         i_icb_rsp_valid,
+  input                          i_icb_rsp_ready,
+  output                         i_icb_rsp_err  ,
+  output                         i_icb_rsp_excl_ok,
+  output [`E203_XLEN-1:0]        i_icb_rsp_rdata,
+
+  //////////////////////////////////////////////////////////////
+  // The AGU ICB Interface to LSU-ctrl
+  output                         o_icb_cmd_valid,
+  input                          o_icb_cmd_ready,
+  output [`E203_ADDR_SIZE-1:0]   o_icb_cmd_addr,
+  output                         o_icb_cmd_read,
+  output [`E203_XLEN-1:0]        o_icb_cmd_wdata,
+  output [`E203_XLEN/8-1:0]      o_icb_cmd_wmask,
+  output                         o_icb_cmd_lock,
+  output                         o_icb_cmd_excl,
+  output [1:0]                   o_icb_cmd_size,
+  output                         o_icb_cmd_back2agu,
+  output                         o_icb_cmd_usign,
+  output [`E203_ITAG_WIDTH -1:0] o_icb_cmd_itag,
+
+  input                          o_icb_rsp_valid,
+  output                         o_icb_rsp_ready,
+  input                          o_icb_rsp_err  ,
+  input                          o_icb_rsp_excl_ok,
+  input  [`E203_XLEN-1:0]        o_icb_rsp_rdata,
+
+  //////////////////////////////////////////////////////////////
+  // The CSR access from the ALU
+  input  csr_ena,
+  input  csr_wr_en,
+  input  [12-1:0] csr_idx,
+  input  [`E203_XLEN-1:0] wbck_csr_dat,
+  output [`E203_XLEN-1:0] stk_csr_dat,
+
+  output stk_push_evt, // A frame is saved on the interrupt entry
+  output stk_tchn_evt, // An interrupt is tail-chained to the last one
+  output stk_err_evt,  // A frame transaction gets a bus error
+
+  input  clk,
+  input  rst_n
+  );
+
+  localparam STK_REG_NUM = 16;
+  localparam STK_CNT_W = 5;
+
+  //////////////////////////////////////////////////////////////
+  // The state machine
+  localparam STK_STATE_WIDTH = 3;
+  localparam STK_STATE_IDLE  = 3'd0;
+  localparam STK_STATE_PUSHW = 3'd1; // Wait to push
+  localparam STK_STATE_PUSH  = 3'd2; // Store the registers
+  localparam STK_STATE_TCHN  = 3'd3; // Wait for the tail-chained interrupt
+  localparam STK_STATE_POPW  = 3'd4; // Wait to pop
+  localparam STK_STATE_POP   = 3'd5; // Load the registers
+  localparam STK_STATE_SP    = 3'd6; // Update the sp
+
+  wire [STK_STATE_WIDTH-1:0] stk_state_r;
+  wire [STK_STATE_WIDTH-1:0] stk_state_nxt;
+
+  wire sta_idle  = (stk_state_r == STK_STATE_IDLE );
+  wire sta_pushw = (stk_state_r == STK_STATE_PUSHW);
+  wire sta_push  = (stk_state_r == STK_STATE_PUSH );
+  wire sta_tchn  = (stk_state_r == STK_STATE_TCHN );
+  wire sta_popw  = (stk_state_r == STK_STATE_POPW );
+  wire sta_pop   = (stk_state_r == STK_STATE_POP  );
+  wire sta_sp    = (stk_state_r == STK_STATE_SP   );
+
+  //////////////////////////////////////////////////////////////
+  // The kind of the nested traps, bit 0 is the current one, 1 for the
+  //   stacked interrupt, and knd_vld_r marks the used entries
+  wire [KND_DEPTH-1:0] knd_r;
+  wire [KND_DEPTH-1:0] knd_vld_r;
+  wire [KND_OVF_W-1:0] knd_ovf_r;
+  wire irq_trap = trap_ena & trap_irq;
+
+  // The traps beyond a full kind stack are the exceptions (no interrupt
+  //   is taken then), they are counted in knd_ovf_r instead
+  wire knd_full = knd_vld_r[KND_DEPTH-1];
+  wire knd_ovf  = (|knd_ovf_r);
+  wire knd_push = trap_ena & (~knd_full);
+  wire knd_pop  = mret_ena & (~knd_ovf);
+
+  wire knd_ena = knd_push | knd_pop;
+  wire [KND_DEPTH-1:0] knd_nxt = knd_push ? {knd_r[KND_DEPTH-2:0], trap_irq}
+                                          : {1'b0, knd_r[KND_DEPTH-1:1]};
+  wire [KND_DEPTH-1:0] knd_vld_nxt = knd_push ? {knd_vld_r[KND_DEPTH-2:0], 1'b1}
+                                              : {1'b0, knd_vld_r[KND_DEPTH-1:1]};
+  sirv_gnrl_dfflr #(KND_DEPTH) knd_dfflr (knd_ena, knd_nxt, knd_r, clk, rst_n);
+  sirv_gnrl_dfflr #(KND_DEPTH) knd_vld_dfflr (knd_ena, knd_vld_nxt, knd_vld_r, clk, rst_n);
+
+  wire knd_ovf_inc = trap_ena & knd_full;
+  wire knd_ovf_dec = mret_ena & knd_ovf;
+  wire knd_ovf_ena = knd_ovf_inc | knd_ovf_dec;
+  wire [KND_OVF_W-1:0] knd_ovf_nxt = knd_ovf_inc ? (knd_ovf_r + 1'b1) : (knd_ovf_r - 1'b1);
+  sirv_gnrl_dfflr #(KND_OVF_W) knd_ovf_dfflr (knd_ovf_ena, knd_ovf_nxt, knd_ovf_r, clk, rst_n);
+
+  assign stk_irq_blk = knd_full;
+
+  wire irq_mret = knd_pop & knd_r[0];
+
+  //////////////////////////////////////////////////////////////
+  // The outstanding back2agu transactions of the upstream, which must be
+  //   drained before the engine owns the AGU ICB channel
+  wire stk_own = sta_push | sta_pop;
+
+  wire [2:0] b2a_outs_r;
+  wire b2a_outs_inc = (~stk_own) & o_icb_cmd_valid & o_icb_cmd_ready & i_icb_cmd_back2agu;
+  wire b2a_outs_dec = (~stk_own) & o_icb_rsp_valid & o_icb_rsp_ready;
+  wire b2a_outs_ena = b2a_outs_inc ^ b2a_outs_dec;
+  wire [2:0] b2a_outs_nxt = b2a_outs_inc ? (b2a_outs_r + 3'b1) : (b2a_outs_r - 3'b1);
+  sirv_gnrl_dfflr #(3) b2a_outs_dfflr (b2a_outs_ena, b2a_outs_nxt, b2a_outs_r, clk, rst_n);
+
+  wire drained = oitf_empty & (b2a_outs_r == 3'b0) & (~i_icb_cmd_valid);
+
+  //////////////////////////////////////////////////////////////
+  // The frame transactions
+  wire [STK_CNT_W-1:0] cmd_cnt_r;
+  wire [STK_CNT_W-1:0] rsp_cnt_r;
+  wire abort_r;
+
+  wire cmd_done = (cmd_cnt_r == STK_REG_NUM) | abort_r;
+  wire rsp_done = (rsp_cnt_r == cmd_cnt_r) & cmd_done;
+
+  wire stk_cmd_hsked = stk_own & o_icb_cmd_valid & o_icb_cmd_ready;
+  wire stk_rsp_hsked = stk_own & o_icb_rsp_valid & o_icb_rsp_ready;
+
+  // The frame base, captured from sp when the push/pop starts
+  wire [`E203_XLEN-1:0] base_r;
+  wire push_start = sta_pushw & drained;
+  wire pop_start  = sta_popw  & drained;
+  wire [`E203_XLEN-1:0] base_nxt = push_start ? (rf_rs2 - (STK_REG_NUM*4)) : rf_rs2;
+  sirv_gnrl_dfflr #(`E203_XLEN) base_dfflr (push_start | pop_start, base_nxt, base_r, clk, rst_n);
+
+  wire cnt_clr = push_start | pop_start;
+  wire [STK_CNT_W-1:0] cmd_cnt_nxt = cnt_clr ? {STK_CNT_W{1'b0}} : (cmd_cnt_r + 1'b1);
+  wire [STK_CNT_W-1:0] rsp_cnt_nxt = cnt_clr ? {STK_CNT_W{1'b0}} : (rsp_cnt_r + 1'b1);
+  sirv_gnrl_dfflr #(STK_CNT_W) cmd_cnt_dfflr (cnt_clr | stk_cmd_hsked, cmd_cnt_nxt, cmd_cnt_r, clk, rst_n);
+  sirv_gnrl_dfflr #(STK_CNT_W) rsp_cnt_dfflr (cnt_clr | stk_rsp_hsked, rsp_cnt_nxt, rsp_cnt_r, clk, rst_n);
+
+  // The frame slot k holds the register stk_reg(k)
+  function [`E203_RFIDX_WIDTH-1:0] stk_reg;
+    input [3:0] k;
+    begin
+      stk_reg = (k == 4'd0) ? `E203_RFIDX_WIDTH'd1                          // ra
+              : (k <= 4'd3) ? (`E203_RFIDX_WIDTH'd4  + k)                    // t0-t2
+              : (k <= 4'd11)? (`E203_RFIDX_WIDTH'd6  + k)                    // a0-a7
+              :               (`E203_RFIDX_WIDTH'd16 + k);                   // t3-t6
+    end
+  endfunction
+
+  wire [`E203_RFIDX_WIDTH-1:0] cmd_reg = stk_reg(cmd_cnt_r[3:0]);
+  wire [`E203_RFIDX_WIDTH-1:0] rsp_reg = stk_reg(rsp_cnt_r[3:0]);
+
+  //////////////////////////////////////////////////////////////
+  // The tail-chaining window
+  wire [3:0] tchn_cnt_r;
+  wire tchn_cnt_ena = sta_tchn | irq_mret;
+  wire [3:0] tchn_cnt_nxt = sta_tchn ? (tchn_cnt_r + 1'b1) : 4'b0;
+  sirv_gnrl_dfflr #(4) tchn_cnt_dfflr (tchn_cnt_ena, tchn_cnt_nxt, tchn_cnt_r, clk, rst_n);
+
+  wire tchn_tout = (tchn_cnt_r == (TCHN_WIN-1));
+
+  // An interrupt taken while the frame is not restored yet (or it is, but
+  //   sp is not written back yet)
+  wire sp_hsked = sta_sp & o_wbck_valid & o_wbck_ready;
+  wire pushing_r;
+  wire tchn = irq_trap & (sta_tchn | sta_popw | sta_pop | (sta_sp & (~pushing_r) & (~sp_hsked)));
+
+  // The pop stops issuing at the tail-chaining, and finishes once the
+  //   issued loads are back (they restore the same values)
+  wire abort_set = tchn & sta_pop;
+  wire abort_ena = abort_set | cnt_clr;
+  sirv_gnrl_dfflr #(1) abort_dfflr (abort_ena, abort_set, abort_r, clk, rst_n);
+
+  //////////////////////////////////////////////////////////////
+  // The state transitions
+  sirv_gnrl_dfflr #(1) pushing_dfflr (push_start | pop_start, push_start, pushing_r, clk, rst_n);
+
+  assign stk_state_nxt =
+        (sta_idle  & irq_trap)            ? STK_STATE_PUSHW
+      : (sta_sp & (~pushing_r) & irq_trap & sp_hsked) ? STK_STATE_PUSHW
+      : (sta_idle  & irq_mret & irq_pend) ? STK_STATE_TCHN
+      : (sta_idle  & irq_mret)            ? STK_STATE_POPW
+      : (tchn & (~sta_pop))               ? STK_STATE_IDLE
+      : push_start                        ? STK_STATE_PUSH
+      : pop_start                         ? STK_STATE_POP
+      : (sta_tchn & tchn_tout)            ? STK_STATE_POPW
+      : ((sta_push | sta_pop) & rsp_done) ? (abort_r ? STK_STATE_IDLE : STK_STATE_SP)
+      : sp_hsked                          ? STK_STATE_IDLE
+      :                                     stk_state_r;
+
+  wire stk_state_ena = (stk_state_nxt != stk_state_r);
+  sirv_gnrl_dfflr #(STK_STATE_WIDTH) stk_state_dfflr (stk_state_ena, stk_state_nxt, stk_state_r, clk, rst_n);
+
+  assign stk_hold = ~sta_idle;
+
+  //////////////////////////////////////////////////////////////
+  // The regfile read, the pushed register and sp
+  assign rf_rs1idx = sta_push ? cmd_reg : i_rs1idx;
+  assign rf_rs2idx = (sta_pushw | sta_popw) ? `E203_RFIDX_WIDTH'd2 : i_rs2idx;
+
+  //////////////////////////////////////////////////////////////
+  // The write-back of the restored registers and sp
+  // A faulting pop response is dropped, see the bus errors above
+  wire stk_wbck_valid = (sta_pop & o_icb_rsp_valid & (~o_icb_rsp_err)) | sta_sp;
+  wire [`E203_XLEN-1:0] stk_wbck_wdat = sta_sp ? (pushing_r ? base_r : (base_r + (STK_REG_NUM*4)))
+                                               : o_icb_rsp_rdata;
+  wire [`E203_RFIDX_WIDTH-1:0] stk_wbck_rdidx = sta_sp ? `E203_RFIDX_WIDTH'd2 : rsp_reg;
+
+  assign o_wbck_valid = stk_hold ? stk_wbck_valid : i_wbck_valid;
+  assign o_wbck_wdat  = stk_hold ? stk_wbck_wdat  : i_wbck_wdat;
+  assign o_wbck_rdidx = stk_hold ? stk_wbck_rdidx : i_wbck_rdidx;
+  assign i_wbck_ready = (~stk_hold) & o_wbck_ready;
+
+  //////////////////////////////////////////////////////////////
+  // The AGU ICB channel
+  wire [`E203_ADDR_SIZE-1:0] stk_addr = base_r[`E203_ADDR_SIZE-1:0] + {cmd_cnt_r, 2'b00};
+
+  assign o_icb_cmd_valid    = stk_own ? (~cmd_done) : i_icb_cmd_valid;
+  assign o_icb_cmd_addr     = stk_own ? stk_addr : i_icb_cmd_addr;
+  assign o_icb_cmd_read     = stk_own ? sta_pop : i_icb_cmd_read;
+  assign o_icb_cmd_wdata    = stk_own ? rf_rs1 : i_icb_cmd_wdata;
+  assign o_icb_cmd_wmask    = stk_own ? {`E203_XLEN/8{1'b1}} : i_icb_cmd_wmask;
+  assign o_icb_cmd_lock     = (~stk_own) & i_icb_cmd_lock;
+  assign o_icb_cmd_excl     = (~stk_own) & i_icb_cmd_excl;
+  assign o_icb_cmd_size     = stk_own ? 2'b10 : i_icb_cmd_size;
+  assign o_icb_cmd_back2agu = stk_own | i_icb_cmd_back2agu;
+  assign o_icb_cmd_usign    = (~stk_own) & i_icb_cmd_usign;
+  assign o_icb_cmd_itag     = i_icb_cmd_itag;
+
+  // The upstream is not taken while the frame is being pushed or popped,
+  //   before that its in-flight commands (e.g., the prefetches) are let go
+  assign i_icb_cmd_ready    = (~stk_own) & o_icb_cmd_ready;
+
+  assign i_icb_rsp_valid    = (~stk_own) & o_icb_rsp_valid;
+  assign i_icb_rsp_err      = o_icb_rsp_err;
+  assign i_icb_rsp_excl_ok  = o_icb_rsp_excl_ok;
+  assign i_icb_rsp_rdata    = o_icb_rsp_rdata;
+
+  assign o_icb_rsp_ready    = stk_own ? (sta_push | o_icb_rsp_err | o_wbck_ready) : i_icb_rsp_ready;
+
+  //////////////////////////////////////////////////////////////
+  // The bus errors of the frame transactions
+  wire stk_err = stk_rsp_hsked & o_icb_rsp_err;
+  wire [`E203_ADDR_SIZE-1:0] rsp_addr = base_r[`E203_ADDR_SIZE-1:0] + {rsp_cnt_r, 2'b00};
+
+  wire csr_wr = csr_ena & csr_wr_en;
+  wire sel_sta     = (csr_idx == 12'hBD0);
+  wire sel_badaddr = (csr_idx == 12'hBD1);
+
+  wire [1:0] err_sta_r;
+  wire [1:0] err_sta_set = {(stk_err & sta_pop), (stk_err & sta_push)};
+  // The error of this cycle is not lost to a CSR write in the same cycle
+  wire [1:0] err_sta_nxt = (csr_wr & sel_sta) ? (wbck_csr_dat[1:0] | err_sta_set)
+                                              : (err_sta_r | err_sta_set);
+  sirv_gnrl_dfflr #(2) err_sta_dfflr ((csr_wr & sel_sta) | stk_err, err_sta_nxt, err_sta_r, clk, rst_n);
+
+  wire [`E203_ADDR_SIZE-1:0] badaddr_r;
+  sirv_gnrl_dfflr #(`E203_ADDR_SIZE) badaddr_dfflr (stk_err & (err_sta_r == 2'b0), rsp_addr, badaddr_r, clk, rst_n);
+
+  assign stk_csr_dat = ({`E203_XLEN{sel_sta    }} & {{`E203_XLEN-2{1'b0}}, err_sta_r})
+                     | ({`E203_XLEN{sel_badaddr}} & badaddr_r);
+
+  assign stk_push_evt = push_start;
+  assign stk_tchn_evt = tchn;
+  assign stk_err_evt  = stk_err;
+
+endmodule
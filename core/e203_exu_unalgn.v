@@ -0,0 +1,199 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The module to handle the unaligned load/store in hardware instead of
+//  raising the address-misaligned exception.
+//
+//  The dispatcher hands the AGU a word-aligned address for an unaligned
+//  load/store (so the AGU never flags it as misaligned), together with the
+//  byte offset that was stripped off. This module then:
+//    * On the ICB command channel, re-issues the access as one (inside a
+//      word) or two (crossing a word boundary) word-aligned transactions,
+//      with the store data rotated and the write mask computed from the
+//      original offset.
+//    * On the LSU write-back channel, absorbs the 1st half response of a
+//      split access and merges it with the 2nd half, so the longpipe
+//      write-back and the Load-Use forwarding path in e203_exu_disp only
+//      ever see one merged (aligned, sign/zero extended) result.
+//
+//  Only one unaligned access is tracked at a time, a following unaligned
+//  access is stalled until the previous one has written back; aligned
+//  accesses are passed through untouched.
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_exu_unalgn(
+  //////////////////////////////////////////////////////////////
+  // The unaligned indication from dispatch, valid along with the command
+  input  i_unalgn,
+  input  [1:0] i_unalgn_ofst,
+
+  //////////////////////////////////////////////////////////////
+  // The AGU ICB Interface from AGU
+  input                          i_icb_cmd_valid,
+  output                         i_icb_cmd_ready,
+  input  [`E203_ADDR_SIZE-1:0]   i_icb_cmd_addr,
+  input                          i_icb_cmd_read,
+  input  [`E203_XLEN-1:0]        i_icb_cmd_wdata,
+  input  [`E203_XLEN/8-1:0]      i_icb_cmd_wmask,
+  input  [1:0]                   i_icb_cmd_size,
+  input                          i_icb_cmd_usign,
+  input  [`E203_ITAG_WIDTH -1:0] i_icb_cmd_itag,
+
+  //////////////////////////////////////////////////////////////
+  // The AGU ICB Interface to LSU-ctrl
+  output                         o_icb_cmd_valid,
+  input                          o_icb_cmd_ready,
+  output [`E203_ADDR_SIZE-1:0]   o_icb_cmd_addr,
+  output [`E203_XLEN-1:0]        o_icb_cmd_wdata,
+  output [`E203_XLEN/8-1:0]      o_icb_cmd_wmask,
+  output [1:0]                   o_icb_cmd_size,
+  output                         o_icb_cmd_usign,
+
+  //////////////////////////////////////////////////////////////
+  // The LSU Write-Back Interface from LSU-ctrl
+  input  lsu_i_valid,
+  output lsu_i_ready,
+  input  [`E203_XLEN-1:0] lsu_i_wdat,
+  input  [`E203_ITAG_WIDTH -1:0] lsu_i_itag,
+  input  lsu_i_err ,
+  input  [`E203_ADDR_SIZE -1:0] lsu_i_badaddr,
+  input  lsu_i_buserr ,
+
+  //////////////////////////////////////////////////////////////
+  // The LSU Write-Back Interface to Longpipe Write-Back and Dispatch
+  output lsu_o_valid,
+  input  lsu_o_ready,
+  output [`E203_XLEN-1:0] lsu_o_wdat,
+  output lsu_o_err ,
+  output [`E203_ADDR_SIZE -1:0] lsu_o_badaddr,
+  output lsu_o_buserr ,
+
+  // The command on o_icb_cmd is the 2nd half of a split access
+  output splt_2nd,
+  // The event that one access is split into two ICB transactions
+  output splt_evt,
+
+  input  clk,
+  input  rst_n
+  );
+
+  //////////////////////////////////////////////////////////////
+  // The command side
+  //
+  // The byte mask of the whole access spread over two words, the low
+  //   nibble goes to the 1st word and the high nibble to the 2nd word
+  wire [3:0] unalgn_szmask = (i_icb_cmd_size == 2'b01) ? 4'b0011 : 4'b1111;
+  wire [7:0] unalgn_mask   = {4'b0, unalgn_szmask} << i_unalgn_ofst;
+  wire       unalgn_cross  = (|unalgn_mask[7:4]);
+
+  wire [63:0] unalgn_wdat  = {32'b0, i_icb_cmd_wdata} << {i_unalgn_ofst, 3'b0};
+
+  wire ctx_busy_r;
+  wire splt_2nd_r;
+
+  // The unaligned command must wait until the previous one written back,
+  //   except its own 2nd half, issued while its context is already busy
+  wire unalgn_go  = (~ctx_busy_r) | splt_2nd_r;
+  wire unalgn_cmd = i_unalgn & unalgn_go;
+
+  assign o_icb_cmd_valid = i_icb_cmd_valid & ((~i_unalgn) | unalgn_go);
+  assign i_icb_cmd_ready = i_unalgn ? (unalgn_cmd & o_icb_cmd_ready & ((~unalgn_cross) | splt_2nd_r))
+                                    : o_icb_cmd_ready;
+
+  assign o_icb_cmd_addr  = (i_unalgn & splt_2nd_r) ? (i_icb_cmd_addr + `E203_ADDR_SIZE'd4) : i_icb_cmd_addr;
+  assign o_icb_cmd_wdata = (~i_unalgn) ? i_icb_cmd_wdata
+                         : splt_2nd_r  ? unalgn_wdat[63:32] : unalgn_wdat[31:0];
+  assign o_icb_cmd_wmask = (~i_unalgn) ? i_icb_cmd_wmask
+                         : splt_2nd_r  ? unalgn_mask[7:4] : unalgn_mask[3:0];
+  // Always fetch the raw words, the extension is done when merging
+  assign o_icb_cmd_size  = i_unalgn ? 2'b10 : i_icb_cmd_size;
+  assign o_icb_cmd_usign = i_unalgn ? 1'b1  : i_icb_cmd_usign;
+
+  wire o_icb_cmd_hsked = o_icb_cmd_valid & o_icb_cmd_ready;
+  // The 1st (or the only) transaction of an unaligned access
+  wire unalgn_1st_hsked = o_icb_cmd_hsked & unalgn_cmd & (~splt_2nd_r);
+
+  wire splt_2nd_set = unalgn_1st_hsked & unalgn_cross;
+  wire splt_2nd_clr = o_icb_cmd_hsked & splt_2nd_r;
+  wire splt_2nd_ena = splt_2nd_set | splt_2nd_clr;
+  wire splt_2nd_nxt = splt_2nd_set | (~splt_2nd_clr);
+  sirv_gnrl_dfflr #(1) splt_2nd_dfflr (splt_2nd_ena, splt_2nd_nxt, splt_2nd_r, clk, rst_n);
+
+  assign splt_2nd = i_unalgn & splt_2nd_r;
+  assign splt_evt = splt_2nd_set;
+
+  //////////////////////////////////////////////////////////////
+  // The context of the tracked unaligned access
+  wire [`E203_ITAG_WIDTH-1:0] ctx_itag_r;
+  wire [1:0] ctx_ofst_r;
+  wire [1:0] ctx_size_r;
+  wire ctx_usign_r;
+  wire ctx_cross_r;
+  wire [`E203_ADDR_SIZE-1:0] ctx_addr_r;
+
+  wire ctx_ena = unalgn_1st_hsked;
+  wire [`E203_ADDR_SIZE-1:0] ctx_addr_nxt = {i_icb_cmd_addr[`E203_ADDR_SIZE-1:2], i_unalgn_ofst};
+
+  sirv_gnrl_dffl #(`E203_ITAG_WIDTH) ctx_itag_dffl (ctx_ena, i_icb_cmd_itag , ctx_itag_r , clk);
+  sirv_gnrl_dffl #(2)                ctx_ofst_dffl (ctx_ena, i_unalgn_ofst  , ctx_ofst_r , clk);
+  sirv_gnrl_dffl #(2)                ctx_size_dffl (ctx_ena, i_icb_cmd_size , ctx_size_r , clk);
+  sirv_gnrl_dffl #(1)                ctx_usign_dffl(ctx_ena, i_icb_cmd_usign, ctx_usign_r, clk);
+  sirv_gnrl_dffl #(1)                ctx_cross_dffl(ctx_ena, unalgn_cross   , ctx_cross_r, clk);
+  sirv_gnrl_dffl #(`E203_ADDR_SIZE)  ctx_addr_dffl (ctx_ena, ctx_addr_nxt   , ctx_addr_r , clk);
+
+  //////////////////////////////////////////////////////////////
+  // The write-back side
+  wire ctx_1st_got_r;
+  wire [`E203_XLEN-1:0] ctx_1st_wdat_r;
+  wire ctx_1st_err_r;
+  wire ctx_1st_buserr_r;
+
+  wire lsu_i_match = lsu_i_valid & ctx_busy_r & (lsu_i_itag == ctx_itag_r);
+  // The 1st half of a split access is absorbed here
+  wire lsu_i_1st   = lsu_i_match & ctx_cross_r & (~ctx_1st_got_r);
+
+  assign lsu_o_valid = lsu_i_valid & (~lsu_i_1st);
+  assign lsu_i_ready = lsu_i_1st | lsu_o_ready;
+
+  wire [63:0] merge_raw = {(ctx_cross_r ? lsu_i_wdat : `E203_XLEN'b0),
+                           (ctx_cross_r ? ctx_1st_wdat_r : lsu_i_wdat)};
+  wire [63:0] merge_sft = merge_raw >> {ctx_ofst_r, 3'b0};
+  // The byte access can never be unaligned, so only halfword and word here
+  wire [`E203_XLEN-1:0] merge_wdat = (ctx_size_r == 2'b01) ?
+                           {{16{(~ctx_usign_r) & merge_sft[15]}}, merge_sft[15:0]}
+                         : merge_sft[31:0];
+
+  assign lsu_o_wdat    = lsu_i_match ? merge_wdat : lsu_i_wdat;
+  // The 1st half flags are only loaded by a split access, so they are
+  //   stale (or not yet reset) for an unaligned access inside one word
+  wire ctx_1st_err    = lsu_i_match & ctx_cross_r & ctx_1st_err_r;
+  wire ctx_1st_buserr = lsu_i_match & ctx_cross_r & ctx_1st_buserr_r;
+
+  assign lsu_o_err     = lsu_i_err    | ctx_1st_err;
+  assign lsu_o_buserr  = lsu_i_buserr | ctx_1st_buserr;
+  assign lsu_o_badaddr = lsu_i_match ? ctx_addr_r : lsu_i_badaddr;
+
+  wire lsu_i_1st_hsked = lsu_i_1st;
+  wire lsu_o_merged_hsked = lsu_o_valid & lsu_o_ready & lsu_i_match;
+
+  wire ctx_1st_got_set = lsu_i_1st_hsked;
+  wire ctx_1st_got_clr = lsu_o_merged_hsked;
+  wire ctx_1st_got_ena = ctx_1st_got_set | ctx_1st_got_clr;
+  wire ctx_1st_got_nxt = ctx_1st_got_set | (~ctx_1st_got_clr);
+  sirv_gnrl_dfflr #(1) ctx_1st_got_dfflr (ctx_1st_got_ena, ctx_1st_got_nxt, ctx_1st_got_r, clk, rst_n);
+
+  sirv_gnrl_dffl #(`E203_XLEN) ctx_1st_wdat_dffl  (lsu_i_1st_hsked, lsu_i_wdat  , ctx_1st_wdat_r  , clk);
+  sirv_gnrl_dffl #(1)          ctx_1st_err_dffl   (lsu_i_1st_hsked, lsu_i_err   , ctx_1st_err_r   , clk);
+  sirv_gnrl_dffl #(1)          ctx_1st_buserr_dffl(lsu_i_1st_hsked, lsu_i_buserr, ctx_1st_buserr_r, clk);
+
+  wire ctx_busy_set = ctx_ena;
+  wire ctx_busy_clr = lsu_o_merged_hsked;
+  wire ctx_busy_ena = ctx_busy_set | ctx_busy_clr;
+  wire ctx_busy_nxt = ctx_busy_set | (~ctx_busy_clr);
+  sirv_gnrl_dfflr #(1) ctx_busy_dfflr (ctx_busy_ena, ctx_busy_nxt, ctx_busy_r, clk, rst_n);
+
+endmodule
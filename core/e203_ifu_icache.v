@@ -0,0 +1,282 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The Instruction Cache, a small read-only cache on the IFU fetch ICB
+//  channel to the system bus (i.e., the ifu2biu ICB of the
+//  e203_ifu_ift2icb), for the code executed in place from the slow
+//  memories outside the ITCM (e.g., the external SPI flash).
+//
+//  * Only the addresses inside the cacheable region (the addresses with
+//    (addr & IC_REGION_MASK) == IC_REGION_BASE) are cached, all the other
+//    fetches are passed through untouched, one at a time.
+//  * A fetch hitting the cache is responded in the next cycle, and the
+//    hits can be back-to-back.
+//  * A fetch missing the cache refills the whole line with word reads,
+//    starting from the missed word and wrapping around the line, and the
+//    missed word is responded as soon as it arrives (critical word first).
+//  * Once a line is refilled by a missed fetch, the next sequential line
+//    is also refilled in the background (if it is not in the cache yet),
+//    while the fetches hitting the other lines are still served.
+//
+//  The cache is direct-mapped (IC_WAY_NUM=1) or 2-way set associative
+//  (IC_WAY_NUM=2, with the LRU replacement), the sets and the words per
+//  line must be powers of two, with at least 2 of each. There is no
+//  invalidation: the cached region is regarded as read-only (e.g., the
+//  flash), the fence.i does not flush this cache.
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_ifu_icache #(
+  parameter IC_WAY_NUM = 2,
+  parameter IC_SET_NUM = 16,
+  parameter IC_SET_W = 4,
+  parameter IC_LINE_WORDS = 4,
+  parameter IC_LINE_W = 2,
+  parameter IC_PF_ENA = 1,
+  parameter IC_REGION_BASE = 32'h2000_0000,
+  parameter IC_REGION_MASK = 32'hE000_0000
+)(
+  //////////////////////////////////////////////////////////////
+  // The fetch ICB Interface from IFU
+  input                          i_icb_cmd_valid,
+  output                         i_icb_cmd_ready,
+  input  [`E203_ADDR_SIZE-1:0]   i_icb_cmd_addr,
+
+  output                         i_icb_rsp_valid,
+  input                          i_icb_rsp_ready,
+  output                         i_icb_rsp_err  ,
+  output [`E203_XLEN-1:0]        i_icb_rsp_rdata,
+
+  //////////////////////////////////////////////////////////////
+  // The fetch ICB Interface to the memory (e.g., the BIU)
+  output                         o_icb_cmd_valid,
+  input                          o_icb_cmd_ready,
+  output [`E203_ADDR_SIZE-1:0]   o_icb_cmd_addr,
+
+  input                          o_icb_rsp_valid,
+  output                         o_icb_rsp_ready,
+  input                          o_icb_rsp_err  ,
+  input  [`E203_XLEN-1:0]        o_icb_rsp_rdata,
+
+  output icache_hit_evt,  // A fetch is served by the cache
+  output icache_miss_evt, // A fetch misses the cache and refills a line
+  output icache_pf_evt,   // A next line refill is started
+
+  input  clk,
+  input  rst_n
+  );
+
+  localparam TAG_W = `E203_ADDR_SIZE - IC_SET_W - IC_LINE_W - 2;
+  localparam LADDR_W = `E203_ADDR_SIZE - IC_LINE_W - 2;
+
+  wire [IC_LINE_W-1:0] i_wofst = i_icb_cmd_addr[IC_LINE_W+1:2];
+  wire [IC_SET_W-1:0]  i_set   = i_icb_cmd_addr[IC_SET_W+IC_LINE_W+1:IC_LINE_W+2];
+  wire [TAG_W-1:0]     i_tag   = i_icb_cmd_addr[`E203_ADDR_SIZE-1:IC_SET_W+IC_LINE_W+2];
+  wire [LADDR_W-1:0]   i_laddr = i_icb_cmd_addr[`E203_ADDR_SIZE-1:IC_LINE_W+2];
+
+  wire i_cacheable = ((i_icb_cmd_addr & IC_REGION_MASK) == IC_REGION_BASE);
+
+  //////////////////////////////////////////////////////////////
+  // The cache lines, the entry of way w and set s is (w*IC_SET_NUM + s)
+  localparam ENT_NUM = IC_WAY_NUM * IC_SET_NUM;
+
+  wire [ENT_NUM-1:0] ent_vld_r;
+  wire [TAG_W-1:0]      ent_tag_r  [ENT_NUM-1:0];
+  wire [`E203_XLEN-1:0] ent_data_r [ENT_NUM*IC_LINE_WORDS-1:0];
+  wire [IC_SET_NUM-1:0] set_lru_r;
+
+  wire [IC_SET_W:0] i_ent0 = {1'b0, i_set};
+  wire [IC_SET_W:0] i_ent1 = {1'b1, i_set};
+
+  wire i_hit_w0 = ent_vld_r[i_ent0] & (ent_tag_r[i_ent0] == i_tag);
+  wire i_hit_w1 = (IC_WAY_NUM == 2) & ent_vld_r[i_ent1] & (ent_tag_r[i_ent1] == i_tag);
+  wire i_hit    = i_cacheable & (i_hit_w0 | i_hit_w1);
+  wire i_hit_way = i_hit_w1;
+
+  wire [`E203_XLEN-1:0] i_hit_rdat = ent_data_r[{i_hit_way, i_set, i_wofst}];
+
+  //////////////////////////////////////////////////////////////
+  // The command channel
+  wire rsp_vld_r;
+  wire byp_out_r;
+  wire rfl_busy_r;
+  wire rfl_pf_r;
+  wire [LADDR_W-1:0] rfl_laddr_r;
+  wire pf_req_r;
+  wire [LADDR_W-1:0] pf_laddr_r;
+
+  // The response register is free, or is being freed in this cycle
+  wire rsp_free = (~rsp_vld_r) | i_icb_rsp_ready;
+
+  // The hit can be served during the next line refill, but not for the
+  //   line being refilled
+  wire i_ok_hit  = rsp_free & (~byp_out_r) & ((~rfl_busy_r) | (rfl_pf_r & (rfl_laddr_r != i_laddr)));
+  wire i_ok_miss = rsp_free & (~byp_out_r) & (~rfl_busy_r) & (~pf_req_r);
+
+  wire i_hit_acc = i_icb_cmd_valid & i_hit & i_ok_hit;
+  wire i_rfl_acc = i_icb_cmd_valid & i_cacheable & (~i_hit) & i_ok_miss;
+  wire i_byp     = i_icb_cmd_valid & (~i_cacheable) & i_ok_miss;
+
+  // The next line refill starts once the demand refill is done
+  wire pf_start = pf_req_r & (~rfl_busy_r);
+
+  wire [IC_LINE_W:0] rfl_cmd_cnt_r;
+  wire [IC_LINE_W-1:0] rfl_crit_r;
+  wire rfl_issue = rfl_busy_r & (rfl_cmd_cnt_r != IC_LINE_WORDS);
+  wire [IC_LINE_W-1:0] rfl_cmd_wofst = rfl_crit_r + rfl_cmd_cnt_r[IC_LINE_W-1:0];
+
+  assign o_icb_cmd_valid = i_byp | rfl_issue;
+  assign o_icb_cmd_addr  = rfl_busy_r ? {rfl_laddr_r, rfl_cmd_wofst, 2'b0} : i_icb_cmd_addr;
+  assign i_icb_cmd_ready = i_hit_acc | i_rfl_acc | (i_byp & o_icb_cmd_ready);
+
+  wire rfl_issue_hsked = rfl_issue & o_icb_cmd_ready;
+  wire byp_hsked = i_byp & o_icb_cmd_ready;
+
+  assign icache_hit_evt  = i_hit_acc;
+  assign icache_miss_evt = i_rfl_acc;
+  assign icache_pf_evt   = pf_start;
+
+  //////////////////////////////////////////////////////////////
+  // The uncached fetch passed through
+  wire byp_rsp_hsked = byp_out_r & o_icb_rsp_valid & i_icb_rsp_ready;
+
+  wire byp_out_set = byp_hsked;
+  wire byp_out_clr = byp_rsp_hsked;
+  wire byp_out_ena = byp_out_set | byp_out_clr;
+  wire byp_out_nxt = byp_out_set | (~byp_out_clr);
+  sirv_gnrl_dfflr #(1) byp_out_dfflr (byp_out_ena, byp_out_nxt, byp_out_r, clk, rst_n);
+
+  //////////////////////////////////////////////////////////////
+  // The line refill, of the missed line or of the next line
+  wire [IC_LINE_W:0] rfl_rsp_cnt_r;
+  wire rfl_way_r;
+  wire rfl_kill_r;
+
+  wire [IC_SET_W-1:0] pf_set = pf_laddr_r[IC_SET_W-1:0];
+  wire [TAG_W-1:0]    pf_tag = pf_laddr_r[LADDR_W-1:IC_SET_W];
+  wire [IC_SET_W:0] pf_ent0 = {1'b0, pf_set};
+  wire [IC_SET_W:0] pf_ent1 = {1'b1, pf_set};
+  wire pf_hit = (ent_vld_r[pf_ent0] & (ent_tag_r[pf_ent0] == pf_tag))
+              | ((IC_WAY_NUM == 2) & ent_vld_r[pf_ent1] & (ent_tag_r[pf_ent1] == pf_tag));
+
+  // The victim way, the invalid way goes first, otherwise the LRU one
+  wire [IC_SET_W-1:0] vict_set = pf_start ? pf_set : i_set;
+  wire vict_way = (IC_WAY_NUM == 1) ? 1'b0
+                : (~ent_vld_r[{1'b0, vict_set}]) ? 1'b0
+                : (~ent_vld_r[{1'b1, vict_set}]) ? 1'b1
+                : set_lru_r[vict_set];
+
+  // The next line already in the cache is not refilled again
+  wire rfl_start = i_rfl_acc | (pf_start & (~pf_hit));
+
+  wire rfl_rsp = o_icb_rsp_valid & rfl_busy_r;
+  wire rfl_rsp_1st  = rfl_rsp & (rfl_rsp_cnt_r == {IC_LINE_W+1{1'b0}});
+  wire rfl_rsp_last = rfl_rsp & (rfl_rsp_cnt_r == (IC_LINE_WORDS-1));
+  wire [IC_LINE_W-1:0] rfl_rsp_wofst = rfl_crit_r + rfl_rsp_cnt_r[IC_LINE_W-1:0];
+  wire [IC_SET_W-1:0] rfl_set = rfl_laddr_r[IC_SET_W-1:0];
+  wire [IC_SET_W:0] rfl_ent = {rfl_way_r, rfl_set};
+
+  wire rfl_busy_set = rfl_start;
+  wire rfl_busy_clr = rfl_rsp_last;
+  wire rfl_busy_ena = rfl_busy_set | rfl_busy_clr;
+  wire rfl_busy_nxt = rfl_busy_set | (~rfl_busy_clr);
+  sirv_gnrl_dfflr #(1) rfl_busy_dfflr (rfl_busy_ena, rfl_busy_nxt, rfl_busy_r, clk, rst_n);
+
+  wire rfl_cmd_cnt_ena = rfl_start | rfl_issue_hsked;
+  wire [IC_LINE_W:0] rfl_cmd_cnt_nxt = rfl_start ? {IC_LINE_W+1{1'b0}} : (rfl_cmd_cnt_r + 1'b1);
+  sirv_gnrl_dfflr #(IC_LINE_W+1) rfl_cmd_cnt_dfflr (rfl_cmd_cnt_ena, rfl_cmd_cnt_nxt, rfl_cmd_cnt_r, clk, rst_n);
+
+  wire rfl_rsp_cnt_ena = rfl_start | rfl_rsp;
+  wire [IC_LINE_W:0] rfl_rsp_cnt_nxt = rfl_start ? {IC_LINE_W+1{1'b0}} : (rfl_rsp_cnt_r + 1'b1);
+  sirv_gnrl_dfflr #(IC_LINE_W+1) rfl_rsp_cnt_dfflr (rfl_rsp_cnt_ena, rfl_rsp_cnt_nxt, rfl_rsp_cnt_r, clk, rst_n);
+
+  // The next line is refilled from its 1st word
+  wire [IC_LINE_W-1:0] rfl_crit_nxt  = i_rfl_acc ? i_wofst : {IC_LINE_W{1'b0}};
+  wire [LADDR_W-1:0]   rfl_laddr_nxt = i_rfl_acc ? i_laddr : pf_laddr_r;
+  sirv_gnrl_dffl #(IC_LINE_W) rfl_crit_dffl  (rfl_start, rfl_crit_nxt , rfl_crit_r , clk);
+  sirv_gnrl_dffl #(LADDR_W)   rfl_laddr_dffl (rfl_start, rfl_laddr_nxt, rfl_laddr_r, clk);
+  sirv_gnrl_dffl #(1)         rfl_way_dffl   (rfl_start, vict_way     , rfl_way_r  , clk);
+  sirv_gnrl_dfflr #(1)        rfl_pf_dfflr   (rfl_start, (~i_rfl_acc) , rfl_pf_r   , clk, rst_n);
+
+  // A bus error during the refill leaves the line invalid
+  wire rfl_kill_set = rfl_rsp & o_icb_rsp_err;
+  wire rfl_kill_clr = rfl_start;
+  wire rfl_kill_ena = rfl_kill_set | rfl_kill_clr;
+  wire rfl_kill_nxt = rfl_kill_set | (~rfl_kill_clr);
+  sirv_gnrl_dfflr #(1) rfl_kill_dfflr (rfl_kill_ena, rfl_kill_nxt, rfl_kill_r, clk, rst_n);
+
+  wire rfl_done_ok = rfl_rsp_last & (~rfl_kill_r) & (~o_icb_rsp_err);
+
+  //////////////////////////////////////////////////////////////
+  // The next line request, raised by a successful demand refill
+  wire [LADDR_W-1:0] pf_laddr_nxt = rfl_laddr_r + 1'b1;
+  wire pf_laddr_in_region = (({pf_laddr_nxt, {IC_LINE_W+2{1'b0}}} & IC_REGION_MASK) == IC_REGION_BASE);
+
+  wire pf_req_set = (IC_PF_ENA == 1) & rfl_done_ok & (~rfl_pf_r) & pf_laddr_in_region;
+  wire pf_req_clr = pf_start;
+  wire pf_req_ena = pf_req_set | pf_req_clr;
+  wire pf_req_nxt = pf_req_set | (~pf_req_clr);
+  sirv_gnrl_dfflr #(1) pf_req_dfflr (pf_req_ena, pf_req_nxt, pf_req_r, clk, rst_n);
+  sirv_gnrl_dffl #(LADDR_W) pf_laddr_dffl (pf_req_set, pf_laddr_nxt, pf_laddr_r, clk);
+
+  //////////////////////////////////////////////////////////////
+  // Update the cache lines
+  genvar i;
+  genvar k;
+  generate //{
+    for (i=0; i<ENT_NUM; i=i+1) begin:ic_ent//{
+      // The line is invalid during its refill
+      wire ent_rfl_start = rfl_start & ({vict_way, vict_set} == i);
+      wire ent_rfl_done  = rfl_done_ok & (rfl_ent == i);
+
+      wire vld_ena = ent_rfl_start | ent_rfl_done;
+      wire vld_nxt = ent_rfl_done;
+      sirv_gnrl_dfflr #(1) ent_vld_dfflr (vld_ena, vld_nxt, ent_vld_r[i], clk, rst_n);
+
+      wire [TAG_W-1:0] tag_nxt = i_rfl_acc ? i_tag : pf_tag;
+      sirv_gnrl_dffl #(TAG_W) ent_tag_dffl (ent_rfl_start, tag_nxt, ent_tag_r[i], clk);
+
+      for (k=0; k<IC_LINE_WORDS; k=k+1) begin:ic_word//{
+        wire wd_ena = rfl_rsp & (rfl_ent == i) & (rfl_rsp_wofst == k);
+        sirv_gnrl_dffl #(`E203_XLEN) ent_data_dffl (wd_ena, o_icb_rsp_rdata, ent_data_r[i*IC_LINE_WORDS+k], clk);
+      end//}
+    end//}
+
+    for (i=0; i<IC_SET_NUM; i=i+1) begin:ic_lru//{
+      // The way just used becomes the MRU one
+      wire lru_hit = i_hit_acc & (i_set == i);
+      wire lru_rfl = rfl_start & (vict_set == i);
+      wire lru_ena = lru_hit | lru_rfl;
+      wire lru_nxt = lru_rfl ? (~vict_way) : (~i_hit_way);
+      sirv_gnrl_dfflr #(1) set_lru_dfflr (lru_ena, lru_nxt, set_lru_r[i], clk, rst_n);
+    end//}
+  endgenerate//}
+
+  //////////////////////////////////////////////////////////////
+  // The response, from the hitting line, or from the critical word of
+  //   the demand refill, or straight from the memory for the uncached
+  wire rsp_rfl = rfl_rsp_1st & (~rfl_pf_r);
+
+  wire rsp_vld_set = i_hit_acc | rsp_rfl;
+  wire rsp_vld_clr = rsp_vld_r & i_icb_rsp_ready;
+  wire rsp_vld_ena = rsp_vld_set | rsp_vld_clr;
+  wire rsp_vld_nxt = rsp_vld_set | (~rsp_vld_clr);
+  sirv_gnrl_dfflr #(1) rsp_vld_dfflr (rsp_vld_ena, rsp_vld_nxt, rsp_vld_r, clk, rst_n);
+
+  wire [`E203_XLEN-1:0] rsp_dat_r;
+  wire rsp_err_r;
+  wire [`E203_XLEN-1:0] rsp_dat_nxt = i_hit_acc ? i_hit_rdat : o_icb_rsp_rdata;
+  wire rsp_err_nxt = (~i_hit_acc) & o_icb_rsp_err;
+  sirv_gnrl_dffl #(`E203_XLEN) rsp_dat_dffl (rsp_vld_set, rsp_dat_nxt, rsp_dat_r, clk);
+  sirv_gnrl_dffl #(1)          rsp_err_dffl (rsp_vld_set, rsp_err_nxt, rsp_err_r, clk);
+
+  assign i_icb_rsp_valid = rsp_vld_r | (byp_out_r & o_icb_rsp_valid);
+  assign i_icb_rsp_err   = rsp_vld_r ? rsp_err_r : o_icb_rsp_err;
+  assign i_icb_rsp_rdata = rsp_vld_r ? rsp_dat_r : o_icb_rsp_rdata;
+  // The refill responses are always taken
+  assign o_icb_rsp_ready = rfl_busy_r | (byp_out_r & (~rsp_vld_r) & i_icb_rsp_ready);
+
+endmodule
@@ -0,0 +1,196 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The banked ITCM arbiter, which replaces the single SRAM port arbitration
+//  of e203_itcm_ctrl with two address-interleaved banks, so a load/store
+//  (e.g., reading the constant tables kept in ITCM with the code) and an
+//  instruction fetch can access the ITCM in the same cycle if they go to
+//  different banks.
+//
+//  * The ITCM is split into two SRAMs of half depth, the bank is selected
+//    by the address bit 3 (the 64-bit lane), so the sequential fetches and
+//    the sequential loads alternate between the banks.
+//  * Each bank is arbitrated on its own, the LSU has the priority over the
+//    IFU, as in e203_itcm_ctrl, and a cycle both of them request the same
+//    bank is a bank conflict.
+//  * Each requestor has at most one outstanding command, the response comes
+//    in the next cycle from the bank SRAM output, and it is held in a
+//    register if it is not accepted in that cycle.
+//  * The IFU hold-up is kept: ifu_holdup is asserted while the bank last
+//    read by the IFU has not been accessed by the LSU since, so its SRAM
+//    output (the IFU response data) still holds the fetched lane.
+//
+//  The LSU port here is the 64-bit ICB after the width conversion and the
+//  arbitration with the external ITCM port (e.g., the debug/DMA access) in
+//  e203_itcm_ctrl, which stay the same.
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_itcm_bnk #(
+  parameter BNK_AW = `E203_ITCM_RAM_AW-1
+)(
+  //////////////////////////////////////////////////////////////
+  // The ICB Interface from IFU
+  input                          ifu_icb_cmd_valid,
+  output                         ifu_icb_cmd_ready,
+  input  [`E203_ITCM_ADDR_WIDTH-1:0] ifu_icb_cmd_addr,
+
+  output                         ifu_icb_rsp_valid,
+  input                          ifu_icb_rsp_ready,
+  output                         ifu_icb_rsp_err,
+  output [`E203_ITCM_DATA_WIDTH-1:0] ifu_icb_rsp_rdata,
+
+  output                         ifu_holdup,
+
+  //////////////////////////////////////////////////////////////
+  // The ICB Interface from LSU (and the external port)
+  input                          lsu_icb_cmd_valid,
+  output                         lsu_icb_cmd_ready,
+  input  [`E203_ITCM_ADDR_WIDTH-1:0] lsu_icb_cmd_addr,
+  input                          lsu_icb_cmd_read,
+  input  [`E203_ITCM_DATA_WIDTH-1:0] lsu_icb_cmd_wdata,
+  input  [`E203_ITCM_WMSK_WIDTH-1:0] lsu_icb_cmd_wmask,
+
+  output                         lsu_icb_rsp_valid,
+  input                          lsu_icb_rsp_ready,
+  output                         lsu_icb_rsp_err,
+  output [`E203_ITCM_DATA_WIDTH-1:0] lsu_icb_rsp_rdata,
+
+  //////////////////////////////////////////////////////////////
+  // The bank SRAMs
+  output                         ram0_cs,
+  output                         ram0_we,
+  output [BNK_AW-1:0]            ram0_addr,
+  output [`E203_ITCM_WMSK_WIDTH-1:0] ram0_wem,
+  output [`E203_ITCM_DATA_WIDTH-1:0] ram0_din,
+  input  [`E203_ITCM_DATA_WIDTH-1:0] ram0_dout,
+
+  output                         ram1_cs,
+  output                         ram1_we,
+  output [BNK_AW-1:0]            ram1_addr,
+  output [`E203_ITCM_WMSK_WIDTH-1:0] ram1_wem,
+  output [`E203_ITCM_DATA_WIDTH-1:0] ram1_din,
+  input  [`E203_ITCM_DATA_WIDTH-1:0] ram1_dout,
+
+  output itcm_bnk_active,
+  output itcm_bnk_cfl_evt, // The LSU and IFU request the same bank
+
+  input  clk,
+  input  rst_n
+  );
+
+  //////////////////////////////////////////////////////////////
+  // The bank arbitration
+  wire ifu_bnk = ifu_icb_cmd_addr[3];
+  wire lsu_bnk = lsu_icb_cmd_addr[3];
+
+  wire ifu_rsp_vld_r;
+  wire lsu_rsp_vld_r;
+
+  // A new command is taken only when the response of the last one is
+  //   gone or going
+  wire ifu_rsp_free = (~ifu_rsp_vld_r) | ifu_icb_rsp_ready;
+  wire lsu_rsp_free = (~lsu_rsp_vld_r) | lsu_icb_rsp_ready;
+
+  wire bnk_cfl = ifu_icb_cmd_valid & lsu_icb_cmd_valid & (ifu_bnk == lsu_bnk);
+
+  assign lsu_icb_cmd_ready = lsu_rsp_free;
+  assign ifu_icb_cmd_ready = ifu_rsp_free & (~(bnk_cfl & lsu_rsp_free));
+
+  wire ifu_cmd_hsked = ifu_icb_cmd_valid & ifu_icb_cmd_ready;
+  wire lsu_cmd_hsked = lsu_icb_cmd_valid & lsu_icb_cmd_ready;
+
+  // Counted only when the IFU is stalled by the conflict itself
+  assign itcm_bnk_cfl_evt = bnk_cfl & lsu_rsp_free & ifu_rsp_free;
+
+  //////////////////////////////////////////////////////////////
+  // The bank SRAM access
+  wire ram0_lsu = lsu_cmd_hsked & (~lsu_bnk);
+  wire ram1_lsu = lsu_cmd_hsked &   lsu_bnk;
+  wire ram0_ifu = ifu_cmd_hsked & (~ifu_bnk);
+  wire ram1_ifu = ifu_cmd_hsked &   ifu_bnk;
+
+  wire [BNK_AW-1:0] ifu_bnk_addr = ifu_icb_cmd_addr[BNK_AW+3:4];
+  wire [BNK_AW-1:0] lsu_bnk_addr = lsu_icb_cmd_addr[BNK_AW+3:4];
+
+  assign ram0_cs   = ram0_lsu | ram0_ifu;
+  assign ram0_we   = ram0_lsu & (~lsu_icb_cmd_read);
+  assign ram0_addr = ram0_lsu ? lsu_bnk_addr : ifu_bnk_addr;
+  assign ram0_wem  = lsu_icb_cmd_wmask;
+  assign ram0_din  = lsu_icb_cmd_wdata;
+
+  assign ram1_cs   = ram1_lsu | ram1_ifu;
+  assign ram1_we   = ram1_lsu & (~lsu_icb_cmd_read);
+  assign ram1_addr = ram1_lsu ? lsu_bnk_addr : ifu_bnk_addr;
+  assign ram1_wem  = lsu_icb_cmd_wmask;
+  assign ram1_din  = lsu_icb_cmd_wdata;
+
+  //////////////////////////////////////////////////////////////
+  // The IFU response
+  wire ifu_rsp_hsked = ifu_icb_rsp_valid & ifu_icb_rsp_ready;
+  wire ifu_rsp_vld_ena = ifu_cmd_hsked | ifu_rsp_hsked;
+  sirv_gnrl_dfflr #(1) ifu_rsp_vld_dfflr (ifu_rsp_vld_ena, ifu_cmd_hsked, ifu_rsp_vld_r, clk, rst_n);
+
+  wire ifu_rbnk_r;
+  sirv_gnrl_dfflr #(1) ifu_rbnk_dfflr (ifu_cmd_hsked, ifu_bnk, ifu_rbnk_r, clk, rst_n);
+
+  // The response data is the SRAM output in the first cycle, and it is held
+  //   from there if not accepted
+  wire ifu_rsp_1st_r;
+  sirv_gnrl_dfflr #(1) ifu_rsp_1st_dfflr (1'b1, ifu_cmd_hsked, ifu_rsp_1st_r, clk, rst_n);
+
+  wire [`E203_ITCM_DATA_WIDTH-1:0] ifu_ram_dout = ifu_rbnk_r ? ram1_dout : ram0_dout;
+
+  wire ifu_hold_r;
+  wire ifu_hold_set = ifu_rsp_1st_r & (~ifu_icb_rsp_ready);
+  wire ifu_hold_ena = ifu_hold_set | ifu_rsp_hsked;
+  sirv_gnrl_dfflr #(1) ifu_hold_dfflr (ifu_hold_ena, ifu_hold_set, ifu_hold_r, clk, rst_n);
+
+  wire [`E203_ITCM_DATA_WIDTH-1:0] ifu_hold_dat_r;
+  sirv_gnrl_dffl #(`E203_ITCM_DATA_WIDTH) ifu_hold_dat_dffl (ifu_hold_set, ifu_ram_dout, ifu_hold_dat_r, clk);
+
+  assign ifu_icb_rsp_valid = ifu_rsp_vld_r;
+  assign ifu_icb_rsp_err   = 1'b0;
+  assign ifu_icb_rsp_rdata = ifu_hold_r ? ifu_hold_dat_r : ifu_ram_dout;
+
+  // The bank SRAM output still holds the lane last read by IFU until the
+  //   LSU accesses that bank
+  wire ifu_own_r;
+  wire ifu_lost = ifu_rbnk_r ? ram1_lsu : ram0_lsu;
+  wire ifu_own_ena = ifu_cmd_hsked | ifu_lost;
+  sirv_gnrl_dfflr #(1) ifu_own_dfflr (ifu_own_ena, ifu_cmd_hsked, ifu_own_r, clk, rst_n);
+
+  assign ifu_holdup = ifu_own_r;
+
+  //////////////////////////////////////////////////////////////
+  // The LSU response
+  wire lsu_rsp_hsked = lsu_icb_rsp_valid & lsu_icb_rsp_ready;
+  wire lsu_rsp_vld_ena = lsu_cmd_hsked | lsu_rsp_hsked;
+  sirv_gnrl_dfflr #(1) lsu_rsp_vld_dfflr (lsu_rsp_vld_ena, lsu_cmd_hsked, lsu_rsp_vld_r, clk, rst_n);
+
+  wire lsu_rbnk_r;
+  sirv_gnrl_dfflr #(1) lsu_rbnk_dfflr (lsu_cmd_hsked, lsu_bnk, lsu_rbnk_r, clk, rst_n);
+
+  wire lsu_rsp_1st_r;
+  sirv_gnrl_dfflr #(1) lsu_rsp_1st_dfflr (1'b1, lsu_cmd_hsked, lsu_rsp_1st_r, clk, rst_n);
+
+  wire [`E203_ITCM_DATA_WIDTH-1:0] lsu_ram_dout = lsu_rbnk_r ? ram1_dout : ram0_dout;
+
+  wire lsu_hold_r;
+  wire lsu_hold_set = lsu_rsp_1st_r & (~lsu_icb_rsp_ready);
+  wire lsu_hold_ena = lsu_hold_set | lsu_rsp_hsked;
+  sirv_gnrl_dfflr #(1) lsu_hold_dfflr (lsu_hold_ena, lsu_hold_set, lsu_hold_r, clk, rst_n);
+
+  wire [`E203_ITCM_DATA_WIDTH-1:0] lsu_hold_dat_r;
+  sirv_gnrl_dffl #(`E203_ITCM_DATA_WIDTH) lsu_hold_dat_dffl (lsu_hold_set, lsu_ram_dout, lsu_hold_dat_r, clk);
+
+  assign lsu_icb_rsp_valid = lsu_rsp_vld_r;
+  assign lsu_icb_rsp_err   = 1'b0;
+  assign lsu_icb_rsp_rdata = lsu_hold_r ? lsu_hold_dat_r : lsu_ram_dout;
+
+  assign itcm_bnk_active = ifu_icb_cmd_valid | lsu_icb_cmd_valid | ifu_rsp_vld_r | lsu_rsp_vld_r;
+
+endmodule
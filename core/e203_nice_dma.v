@@ -0,0 +1,260 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The DMA engine as a NICE coprocessor, which copies or fills a block of
+//  memory over the NICE memory ICB port (arbitrated with the AGU inside
+//  LSU-ctrl), instead of the word-by-word lw/sw through the AGU.
+//
+//  It takes the place of the NICE core of the SoC (e.g., the
+//  e203_subsys_nice_core of HBirdv2), with the same interface. The
+//  instructions are the R-type of the custom-3 opcode (7'b1111011), with
+//  funct3 = {xd, xs1, xs2}:
+//
+//    funct7   funct3   Instruction            Operation
+//    7'h01    3'b111   dma.len  rd, rs1, rs2  len = rs1, src/fill = rs2,
+//                                             rd = the ticket of the block
+//    7'h02    3'b111   dma.cpy  rd, rs1, rs2  copy len bytes src -> rs1
+//    7'h03    3'b111   dma.set  rd, rs1, rs2  fill len bytes at rs1 with the
+//                                             fill word
+//
+//  The rs2 of dma.cpy/dma.set is the ticket returned by the dma.len.
+//  * The src/dst must be word aligned and the len a multiple of 4 (the low
+//    bits are ignored), the software handles the unaligned head and tail.
+//  * The block is moved in bursts of DMA_BUF_WORDS words: the reads of a
+//    burst are issued back-to-back into the burst buffer, then the writes,
+//    so the copy is the memcpy (the overlapped blocks are not supported).
+//  * The dma.cpy/dma.set responds at the completion, through the NICE
+//    multi-cycle response (i.e., the Long-pipe write-back with the OITF),
+//    with the number of bytes moved in rd, so the instructions depending
+//    on rd wait for the completion by the normal OITF dependency check. A
+//    bus error responds with nice_rsp_err.
+//  * The nice_mem_holdup is asserted while the block is being moved, so
+//    the AGU does not take the LSU-ctrl in the middle of a burst.
+//  * The len/src set by dma.len is kept here, it is not part of the hart
+//    context, so an interrupt handler (or another task) may issue its own
+//    dma.len between the dma.len and the dma.cpy/dma.set of the code it
+//    interrupted. To make the pair atomic, every dma.len returns a new
+//    ticket, and arms the engine for one dma.cpy/dma.set only. A
+//    dma.cpy/dma.set whose rs2 is not the ticket of the last dma.len, or
+//    that comes after the armed one was already taken, moves nothing and
+//    responds with rd = 0 (no error), and the software issues the pair
+//    again (the e203_dma.h wrappers do so). A request taken while a block
+//    is moving just waits for nice_req_ready.
+//
+//  The NICE ICB port goes to the memory behind LSU-ctrl directly, around
+//  the L0 data cache (e203_exu_l0d), so a fence is needed before reading
+//  a block written by the DMA from the L0D cacheable region.
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_nice_dma #(
+  parameter DMA_BUF_WORDS = 4,
+  parameter DMA_BUF_W = 2
+)(
+  input                         nice_clk,
+  input                         nice_rst_n,
+  output                        nice_active,
+  output                        nice_mem_holdup,
+
+  //////////////////////////////////////////////////////////////
+  // The NICE request and response
+  input                         nice_req_valid,
+  output                        nice_req_ready,
+  input  [`E203_XLEN-1:0]       nice_req_inst,
+  input  [`E203_XLEN-1:0]       nice_req_rs1,
+  input  [`E203_XLEN-1:0]       nice_req_rs2,
+
+  output                        nice_rsp_valid,
+  input                         nice_rsp_ready,
+  output [`E203_XLEN-1:0]       nice_rsp_rdat,
+  output                        nice_rsp_err,
+
+  //////////////////////////////////////////////////////////////
+  // The NICE memory ICB port
+  output                        nice_icb_cmd_valid,
+  input                         nice_icb_cmd_ready,
+  output [`E203_ADDR_SIZE-1:0]  nice_icb_cmd_addr,
+  output                        nice_icb_cmd_read,
+  output [`E203_XLEN-1:0]       nice_icb_cmd_wdata,
+  output [1:0]                  nice_icb_cmd_size,
+
+  input                         nice_icb_rsp_valid,
+  output                        nice_icb_rsp_ready,
+  input  [`E203_XLEN-1:0]       nice_icb_rsp_rdata,
+  input                         nice_icb_rsp_err
+  );
+
+  wire clk = nice_clk;
+  wire rst_n = nice_rst_n;
+
+  //////////////////////////////////////////////////////////////
+  // Decode the instruction
+  wire [6:0] req_opcode = nice_req_inst[6:0];
+  wire [6:0] req_funct7 = nice_req_inst[31:25];
+
+  wire req_custom3 = (req_opcode == 7'b1111011);
+  wire req_len = req_custom3 & (req_funct7 == 7'h01);
+  wire req_cpy = req_custom3 & (req_funct7 == 7'h02);
+  wire req_set = req_custom3 & (req_funct7 == 7'h03);
+
+  //////////////////////////////////////////////////////////////
+  // The state machine
+  localparam DMA_STATE_WIDTH = 2;
+  localparam DMA_STATE_IDLE  = 2'd0;
+  localparam DMA_STATE_RD    = 2'd1; // Read a burst into the buffer
+  localparam DMA_STATE_WR    = 2'd2; // Write a burst from the buffer
+  localparam DMA_STATE_RSP   = 2'd3; // Respond to the instruction
+
+  wire [DMA_STATE_WIDTH-1:0] dma_state_r;
+  wire [DMA_STATE_WIDTH-1:0] dma_state_nxt;
+
+  wire sta_idle = (dma_state_r == DMA_STATE_IDLE);
+  wire sta_rd   = (dma_state_r == DMA_STATE_RD  );
+  wire sta_wr   = (dma_state_r == DMA_STATE_WR  );
+  wire sta_rsp  = (dma_state_r == DMA_STATE_RSP );
+
+  assign nice_req_ready = sta_idle;
+  wire req_hsked = nice_req_valid & nice_req_ready;
+
+  //////////////////////////////////////////////////////////////
+  // The block registers
+  wire [`E203_XLEN-1:0] len_r;
+  wire [`E203_ADDR_SIZE-1:0] src_r;
+  wire [`E203_ADDR_SIZE-1:0] dst_r;
+  wire [`E203_XLEN-1:0] fill_r;
+  wire set_r;
+  wire [`E203_XLEN-3:0] left_r; // The words left to move
+
+  wire len_ena = req_hsked & req_len;
+  sirv_gnrl_dfflr #(`E203_XLEN) len_dfflr (len_ena, {nice_req_rs1[`E203_XLEN-1:2], 2'b00}, len_r, clk, rst_n);
+  sirv_gnrl_dfflr #(`E203_XLEN) fill_dfflr (len_ena, nice_req_rs2, fill_r, clk, rst_n);
+
+  // The ticket of the last dma.len, wide enough to never wrap around
+  //   while a context is interrupted between its dma.len and dma.cpy
+  wire [`E203_XLEN-1:0] tkt_r;
+  sirv_gnrl_dfflr #(`E203_XLEN) tkt_dfflr (len_ena, tkt_r + 1'b1, tkt_r, clk, rst_n);
+
+  // Armed by a dma.len, for the first dma.cpy/dma.set only
+  wire arm_r;
+  wire blk_req = req_hsked & (req_cpy | req_set);
+  wire arm_ena = len_ena | blk_req;
+  sirv_gnrl_dfflr #(1) arm_dfflr (arm_ena, len_ena, arm_r, clk, rst_n);
+
+  wire tkt_ok = arm_r & (nice_req_rs2 == tkt_r);
+  wire blk_start = blk_req & tkt_ok;
+  sirv_gnrl_dfflr #(1) set_dfflr (blk_start, req_set, set_r, clk, rst_n);
+
+  // The burst size, the words left up to the buffer size
+  wire left_ge_buf = (left_r >= DMA_BUF_WORDS);
+  wire [DMA_BUF_W:0] bst_num = left_ge_buf ? DMA_BUF_WORDS : left_r[DMA_BUF_W:0];
+
+  wire [DMA_BUF_W:0] cmd_cnt_r;
+  wire [DMA_BUF_W:0] rsp_cnt_r;
+
+  wire bst_cmd_done = (cmd_cnt_r == bst_num);
+  wire bst_rsp_done = (rsp_cnt_r == bst_num);
+  wire bst_end = (sta_rd | sta_wr) & bst_rsp_done;
+  wire wr_end  = sta_wr & bst_rsp_done;
+
+  wire [`E203_ADDR_SIZE-1:0] bst_bytes = {{`E203_ADDR_SIZE-DMA_BUF_W-3{1'b0}}, bst_num, 2'b00};
+
+  wire src_ena = len_ena | wr_end;
+  wire [`E203_ADDR_SIZE-1:0] src_nxt = len_ena ? {nice_req_rs2[`E203_ADDR_SIZE-1:2], 2'b00} : (src_r + bst_bytes);
+  sirv_gnrl_dfflr #(`E203_ADDR_SIZE) src_dfflr (src_ena, src_nxt, src_r, clk, rst_n);
+
+  wire dst_ena = blk_start | wr_end;
+  wire [`E203_ADDR_SIZE-1:0] dst_nxt = blk_start ? {nice_req_rs1[`E203_ADDR_SIZE-1:2], 2'b00} : (dst_r + bst_bytes);
+  sirv_gnrl_dfflr #(`E203_ADDR_SIZE) dst_dfflr (dst_ena, dst_nxt, dst_r, clk, rst_n);
+
+  wire left_ena = blk_start | wr_end;
+  wire [`E203_XLEN-3:0] left_nxt = blk_start ? len_r[`E203_XLEN-1:2] : (left_r - bst_num);
+  sirv_gnrl_dfflr #(`E203_XLEN-2) left_dfflr (left_ena, left_nxt, left_r, clk, rst_n);
+
+  wire last_bst = (left_r == {{`E203_XLEN-DMA_BUF_W-3{1'b0}}, bst_num});
+
+  //////////////////////////////////////////////////////////////
+  // The state transitions, the block registers are loaded at the same
+  //   edge the state leaves IDLE, so the first burst starts right away
+  wire len_zero = (len_r == `E203_XLEN'b0);
+
+  wire rsp_hsked = nice_rsp_valid & nice_rsp_ready;
+
+  assign dma_state_nxt =
+        (req_hsked & (~blk_start))      ? DMA_STATE_RSP
+      : (blk_start & len_zero)          ? DMA_STATE_RSP
+      : (blk_start & req_set)           ? DMA_STATE_WR
+      : blk_start                       ? DMA_STATE_RD
+      : (sta_rd & bst_end)              ? DMA_STATE_WR
+      : (wr_end & last_bst)             ? DMA_STATE_RSP
+      : (wr_end & set_r)                ? DMA_STATE_WR
+      : wr_end                          ? DMA_STATE_RD
+      : rsp_hsked                       ? DMA_STATE_IDLE
+      :                                   dma_state_r;
+
+  wire dma_state_ena = (dma_state_nxt != dma_state_r);
+  sirv_gnrl_dfflr #(DMA_STATE_WIDTH) dma_state_dfflr (dma_state_ena, dma_state_nxt, dma_state_r, clk, rst_n);
+
+  //////////////////////////////////////////////////////////////
+  // The burst commands and responses
+  wire icb_cmd_hsked = nice_icb_cmd_valid & nice_icb_cmd_ready;
+  wire icb_rsp_hsked = nice_icb_rsp_valid & nice_icb_rsp_ready;
+
+  wire cnt_clr = blk_start | bst_end;
+  wire [DMA_BUF_W:0] cmd_cnt_nxt = cnt_clr ? {DMA_BUF_W+1{1'b0}} : (cmd_cnt_r + 1'b1);
+  wire [DMA_BUF_W:0] rsp_cnt_nxt = cnt_clr ? {DMA_BUF_W+1{1'b0}} : (rsp_cnt_r + 1'b1);
+  sirv_gnrl_dfflr #(DMA_BUF_W+1) cmd_cnt_dfflr (cnt_clr | icb_cmd_hsked, cmd_cnt_nxt, cmd_cnt_r, clk, rst_n);
+  sirv_gnrl_dfflr #(DMA_BUF_W+1) rsp_cnt_dfflr (cnt_clr | icb_rsp_hsked, rsp_cnt_nxt, rsp_cnt_r, clk, rst_n);
+
+  wire [`E203_XLEN-1:0] buf_r [DMA_BUF_WORDS-1:0];
+
+  genvar i;
+  generate //{
+    for (i=0; i<DMA_BUF_WORDS; i=i+1) begin:dma_buf//{
+      wire buf_ena = sta_rd & icb_rsp_hsked & (rsp_cnt_r == i);
+      sirv_gnrl_dffl #(`E203_XLEN) buf_dffl (buf_ena, nice_icb_rsp_rdata, buf_r[i], clk);
+    end//}
+  endgenerate//}
+
+  wire [`E203_ADDR_SIZE-1:0] cmd_ofst = {{`E203_ADDR_SIZE-DMA_BUF_W-3{1'b0}}, cmd_cnt_r, 2'b00};
+
+  assign nice_icb_cmd_valid = (sta_rd | sta_wr) & (~bst_cmd_done);
+  assign nice_icb_cmd_addr  = (sta_rd ? src_r : dst_r) + cmd_ofst;
+  assign nice_icb_cmd_read  = sta_rd;
+  assign nice_icb_cmd_wdata = set_r ? fill_r : buf_r[cmd_cnt_r[DMA_BUF_W-1:0]];
+  assign nice_icb_cmd_size  = 2'b10;
+
+  assign nice_icb_rsp_ready = 1'b1;
+
+  // Any bus error of the block is reported at the response
+  wire err_r;
+  wire err_set = icb_rsp_hsked & nice_icb_rsp_err;
+  wire err_ena = err_set | blk_start;
+  sirv_gnrl_dfflr #(1) err_dfflr (err_ena, err_set, err_r, clk, rst_n);
+
+  // The response of a non-DMA instruction of custom-3 is an error
+  wire ilgl_r;
+  wire ilgl_ena = req_hsked;
+  sirv_gnrl_dfflr #(1) ilgl_dfflr (ilgl_ena, ~(req_len | req_cpy | req_set), ilgl_r, clk, rst_n);
+
+  wire len_rsp_r;
+  sirv_gnrl_dfflr #(1) len_rsp_dfflr (req_hsked, req_len, len_rsp_r, clk, rst_n);
+
+  // A dma.cpy/dma.set with a stale ticket
+  wire tkt_fail_r;
+  sirv_gnrl_dfflr #(1) tkt_fail_dfflr (req_hsked, blk_req & (~tkt_ok), tkt_fail_r, clk, rst_n);
+
+  //////////////////////////////////////////////////////////////
+  // The response
+  assign nice_rsp_valid = sta_rsp;
+  assign nice_rsp_rdat  = len_rsp_r                ? tkt_r
+                        : (ilgl_r | tkt_fail_r)    ? `E203_XLEN'b0
+                        :                            len_r;
+  assign nice_rsp_err   = ilgl_r | ((~len_rsp_r) & (~tkt_fail_r) & err_r);
+
+  assign nice_mem_holdup = sta_rd | sta_wr;
+  assign nice_active = nice_req_valid | (~sta_idle);
+
+endmodule
@@ -0,0 +1,253 @@
+// e203_ckpt: save the whole RTL simulation (the Verilator model with its
+// memories) where the program writes a marker, and run variants of the
+// experiment from the saved state, so the boot, the CoreMark
+// initialization and the UART banner are simulated once:
+//
+//   e203_ckpt save cm.vlt [--mark 1] +ITCM=coremark.verilog   (or +ELF=coremark.elf)
+//   e203_ckpt run --from cm.vlt [--stop-mark 2]
+//
+// A saved state only restores into the same build of the model. A variant
+// of the RTL itself (a define of core/) starts from the architectural
+// checkpoint of e203sim --ckpt-at-mark instead, whose images any build
+// boots:
+//
+//   e203_ckpt run --start-pc <stub end> [--stop-mark 2] +CKPT=ckpt/mark1
+//
+// run prints every marker it sees with the cycle and instruction counts
+// from the reset, and stops at the first of the --stop-mark ids (2 when
+// none is given).
+//
+// run --trace FILE.fst writes the scopes of --trace-scope (by default
+// u_e203_exu_disp and u_e203_exu_oitf) only in the windows of the
+// triggers, see e203_rtl_trace.h; e.g., the first 20 RAW stalls after the
+// start of the timed loop:
+//
+//   e203_ckpt run --from cm.vlt --trace raw.fst --trace-raw 20 --trace-window 64
+//
+// --trace-before N also traces the N cycles before each trigger, by
+// running twice: once to find the triggers, once to trace.
+//
+// +PIPEVIEW=FILE writes the Konata pipeline view of the run (see
+// e203_rtl_pipeview.h):
+//
+//   e203_ckpt run --from cm.vlt --max-cycles 20000 +PIPEVIEW=cm.kanata.gz
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "e203_rtl_harness.h"
+
+namespace {
+
+void Usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s save FILE [--mark ID] [--max-cycles N] IMAGES\n"
+               "       %s run [--from FILE] [--start-mark ID | --start-pc PC] [--stop-mark ID]...\n"
+               "              [--max-cycles N] [TRACE] [IMAGES]\n"
+               "IMAGES: +ELF=F | +ITCM=F [+DTCM=F] | +CKPT=P, and +PIPEVIEW=F.kanata.gz\n"
+               "TRACE:  --trace FILE.fst [--trace-scope NAME]... [--trace-cycles A:B]...\n"
+               "        [--trace-pc LO:HI]... [--trace-raw N] [--trace-mark ID]...\n"
+               "        [--trace-window N] [--trace-before N]\n",
+               argv0, argv0);
+}
+
+// Where run starts counting and stops
+struct RunLimits {
+  uint32_t start_mark = 0;
+  uint32_t start_pc = 0;
+  std::vector<uint32_t> stop_marks;
+  uint64_t max_cycles = ~uint64_t{0};
+};
+
+struct RunStop {
+  uint32_t stop_mark = 0;  // 0: the cycle limit or $finish
+  uint64_t cycles = 0;     // Counted from the start
+  uint64_t insts = 0;
+};
+
+RunStop RunTo(e203sim::RtlHarness* rtl, const RunLimits& l, bool print_marks) {
+  // Counting from the restore (or the reset) unless a start is given
+  bool counting = l.start_mark == 0 && l.start_pc == 0;
+  uint64_t c0 = rtl->cycle();
+  uint64_t i0 = rtl->instret();
+  RunStop r;
+  uint64_t limit = l.max_cycles == ~uint64_t{0} ? l.max_cycles : rtl->cycle() + l.max_cycles;
+  while (rtl->cycle() < limit && !rtl->finished()) {
+    e203sim::RtlEdge e = rtl->Cycle();
+    if (e.mark_valid && print_marks) {
+      std::fprintf(stderr, "mark %u: cycle %llu, instret %llu\n", e.mark_id,
+                   static_cast<unsigned long long>(rtl->cycle()),
+                   static_cast<unsigned long long>(rtl->instret()));
+    }
+    if (!counting && ((l.start_mark != 0 && e.mark_valid && e.mark_id == l.start_mark) ||
+                      (l.start_pc != 0 && e.cmt_valid && e.cmt_pc == l.start_pc))) {
+      counting = true;
+      c0 = rtl->cycle();
+      i0 = rtl->instret();
+      continue;
+    }
+    if (counting && e.mark_valid &&
+        std::find(l.stop_marks.begin(), l.stop_marks.end(), e.mark_id) != l.stop_marks.end()) {
+      r.stop_mark = e.mark_id;
+      break;
+    }
+  }
+  r.cycles = rtl->cycle() - c0;
+  r.insts = rtl->instret() - i0;
+  return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    Usage(argv[0]);
+    return 2;
+  }
+  std::string mode = argv[1];
+  std::string file;
+  std::string from;
+  uint32_t mark = 1;
+  RunLimits lim;
+  std::vector<std::string> plusargs;
+  std::string trace;
+  std::vector<std::string> trace_scopes;
+  e203sim::RtlTraceSpec trace_spec;
+  for (int i = 2; i < argc; i++) {
+    std::string a = argv[i];
+    bool has_next = i + 1 < argc;
+    if (a[0] == '+') {
+      plusargs.push_back(a);
+    } else if (a == "--from" && has_next) {
+      from = argv[++i];
+    } else if (a == "--trace" && has_next) {
+      trace = argv[++i];
+    } else if (a == "--trace-scope" && has_next) {
+      trace_scopes.push_back(argv[++i]);
+    } else if ((a == "--trace-cycles" || a == "--trace-pc") && has_next) {
+      std::pair<uint64_t, uint64_t> r;
+      if (!e203sim::ParseTraceRange(argv[++i], &r)) {
+        Usage(argv[0]);
+        return 2;
+      }
+      if (a == "--trace-cycles") trace_spec.cycles.push_back(r);
+      if (a == "--trace-pc") {
+        trace_spec.pcs.push_back({static_cast<uint32_t>(r.first), static_cast<uint32_t>(r.second)});
+      }
+    } else if ((a == "--trace-raw" || a == "--trace-mark" || a == "--trace-window" ||
+                a == "--trace-before") && has_next) {
+      uint64_t v = std::strtoull(argv[++i], nullptr, 0);
+      if (a == "--trace-raw") trace_spec.raw_stalls = v;
+      if (a == "--trace-mark") trace_spec.marks.push_back(static_cast<uint32_t>(v));
+      if (a == "--trace-window") trace_spec.window = v;
+      if (a == "--trace-before") trace_spec.before = v;
+    } else if ((a == "--mark" || a == "--start-mark" || a == "--start-pc" || a == "--stop-mark" ||
+                a == "--max-cycles") && has_next) {
+      uint64_t v = std::strtoull(argv[++i], nullptr, 0);
+      if (a == "--mark") mark = static_cast<uint32_t>(v);
+      if (a == "--start-mark") lim.start_mark = static_cast<uint32_t>(v);
+      if (a == "--start-pc") lim.start_pc = static_cast<uint32_t>(v);
+      if (a == "--stop-mark") lim.stop_marks.push_back(static_cast<uint32_t>(v));
+      if (a == "--max-cycles") lim.max_cycles = v;
+    } else if (a[0] != '-' && file.empty() && mode == "save") {
+      file = a;
+    } else {
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if (mode == "save") {
+    if (file.empty() || plusargs.empty()) {
+      Usage(argv[0]);
+      return 2;
+    }
+    e203sim::RtlHarness rtl(plusargs);
+    if (!rtl.error().empty()) {
+      std::fprintf(stderr, "%s\n", rtl.error().c_str());
+      return 2;
+    }
+    while (rtl.cycle() < lim.max_cycles && !rtl.finished()) {
+      e203sim::RtlEdge e = rtl.Cycle();
+      if (e.mark_valid && e.mark_id == mark) {
+        rtl.Save(file);
+        std::fprintf(stderr, "%s: mark %u at cycle %llu, %llu instructions\n", file.c_str(), mark,
+                     static_cast<unsigned long long>(rtl.cycle()),
+                     static_cast<unsigned long long>(rtl.instret()));
+        return 0;
+      }
+    }
+    std::fprintf(stderr, "no mark %u in %llu cycles\n", mark,
+                 static_cast<unsigned long long>(rtl.cycle()));
+    return 1;
+  }
+
+  if (mode != "run") {
+    Usage(argv[0]);
+    return 2;
+  }
+  if (lim.stop_marks.empty()) lim.stop_marks.push_back(2);
+
+  // The first run of a pre-trigger trace, untraced and quiet, without the
+  // pipeline view the second run writes
+  bool events = !trace_spec.pcs.empty() || trace_spec.raw_stalls != 0 || !trace_spec.marks.empty();
+  bool pre_trigger = !trace.empty() && trace_spec.before > 0 && events;
+  uint64_t pre_windows = 0;
+  if (pre_trigger) {
+    std::vector<std::string> args;
+    for (const std::string& a : plusargs) {
+      if (a.compare(0, 10, "+PIPEVIEW=") != 0) args.push_back(a);
+    }
+    e203sim::RtlHarness first(args);
+    if (!first.error().empty()) {
+      std::fprintf(stderr, "%s\n", first.error().c_str());
+      return 2;
+    }
+    if (!from.empty()) first.Restore(from);
+    first.WatchTriggers(trace_spec);
+    RunTo(&first, lim, false);
+    trace_spec = first.triggers()->PreTriggerSpec();
+    pre_windows = first.triggers()->windows();
+    std::fprintf(stderr, "pre-trigger: %llu windows, running again to trace them\n",
+                 static_cast<unsigned long long>(pre_windows));
+  }
+
+  e203sim::RtlHarness rtl(plusargs);
+  if (!rtl.error().empty()) {
+    std::fprintf(stderr, "%s\n", rtl.error().c_str());
+    return 2;
+  }
+  if (!from.empty()) rtl.Restore(from);
+  // Nothing fired in the first run: nothing to trace (an empty spec would
+  // trace the whole run)
+  if (!trace.empty() && !(pre_trigger && trace_spec.empty())) {
+    if (trace_scopes.empty()) trace_scopes = {"u_e203_exu_disp", "u_e203_exu_oitf"};
+    std::string err;
+    if (!rtl.OpenTrace(trace, trace_scopes, trace_spec, &err)) {
+      std::fprintf(stderr, "%s\n", err.c_str());
+      return 2;
+    }
+  }
+
+  RunStop r = RunTo(&rtl, lim, true);
+  std::fprintf(stderr, "stop:      %s\n",
+               r.stop_mark != 0 ? ("mark " + std::to_string(r.stop_mark)).c_str()
+                                : (rtl.finished() ? "$finish" : "cycle limit"));
+  std::fprintf(stderr, "instret:   %llu\n", static_cast<unsigned long long>(r.insts));
+  std::fprintf(stderr, "cycles:    %llu\n", static_cast<unsigned long long>(r.cycles));
+  std::fprintf(stderr, "CPI:       %.3f\n",
+               r.insts ? static_cast<double>(r.cycles) / r.insts : 0.0);
+  if (rtl.triggers() != nullptr) {
+    std::fprintf(stderr, "trace:     %s, %llu cycles in %llu windows\n", trace.c_str(),
+                 static_cast<unsigned long long>(rtl.triggers()->traced()),
+                 static_cast<unsigned long long>(pre_trigger ? pre_windows
+                                                             : rtl.triggers()->windows()));
+  } else if (pre_trigger) {
+    std::fprintf(stderr, "trace:     %s not written, no trigger fired\n", trace.c_str());
+  }
+  return r.stop_mark != 0 ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The pipeline monitor of the Verilator runs of sim/rtl, bound into every
+//  e203_exu. Each cycle it hands the pipeline events of the EXU to the
+//  harness through the DPI import e203_pipeview_cycle
+//  (e203_rtl_pipeview.cc). The harness follows each instruction through
+//  them and, with +PIPEVIEW=<file>, writes its lifetime as a Konata log:
+//    * the instruction in the IR (exu_i_*) and whether it dispatches;
+//    * the cause of a dispatch stall, from e203_exu_disp:
+//        1 a RAW dependency on the OITF, 2 a WAW dependency,
+//        3 the OITF full, 4 a CSR/fence waiting for the OITF to drain,
+//        5 the ALU busy (a multi-cycle MULDIV, the write-back port),
+//        6 the stack-cache hold, 7 a WFI halt, 0 none of them;
+//    * a load-use forwarding hit at the dispatch;
+//    * the OITF allocation of a long-pipe instruction, its LSU return
+//      and its OITF retirement (the long-pipe write-back), by OITF entry;
+//    * the pipeline flush.
+//  The IFU is outside the EXU, so the lifetime starts in the IR. The
+//  monitor drives nothing.
+//
+// ====================================================================
+`include "e203_defines.v"
+
+module e203_exu_pipemon(
+  input  exu_i_valid,
+  input  exu_i_ready,
+  input  [`E203_PC_SIZE-1:0] exu_i_pc,
+  input  [`E203_INSTR_SIZE-1:0] exu_i_ir,
+
+  input  raw_dep,
+  input  waw_dep,
+  input  fwd_match,
+  input  disp_csr,
+  input  disp_fence_fencei,
+  input  disp_alu_longp_prdt,
+  input  wfi_halt_exu_req,
+  input  oitf_empty,
+  input  disp_oitf_ready,
+  input  disp_alu_valid,
+  input  disp_alu_ready,
+  input  stk_hold,
+
+  input  disp_oitf_ena,
+  input  [`E203_ITAG_WIDTH-1:0] disp_oitf_ptr,
+  input  lsu_wbck_valid,
+  input  lsu_wbck_ready,
+  input  [`E203_ITAG_WIDTH-1:0] lsu_wbck_itag,
+  input  oitf_ret_ena,
+  input  [`E203_ITAG_WIDTH-1:0] oitf_ret_ptr,
+  input  pipe_flush_req,
+  input  pipe_flush_ack,
+
+  input  clk,
+  input  rst_n
+  );
+
+  import "DPI-C" function void e203_pipeview_cycle(
+    input bit ir_valid, input bit ir_hsked, input int ir_pc, input int ir,
+    input byte stall, input bit fwd,
+    input bit oitf_dis, input byte oitf_dis_ptr,
+    input bit lsu_ret, input byte lsu_ret_itag,
+    input bit oitf_ret, input byte oitf_ret_ptr,
+    input bit flush);
+
+  wire [2:0] stall =
+      stk_hold                                                     ? 3'd6
+    : wfi_halt_exu_req                                             ? 3'd7
+    : raw_dep                                                      ? 3'd1
+    : waw_dep                                                      ? 3'd2
+    : ((disp_csr | disp_fence_fencei) & (~oitf_empty))             ? 3'd4
+    : (disp_alu_longp_prdt & (~disp_oitf_ready))                   ? 3'd3
+    : (disp_alu_valid & (~disp_alu_ready))                         ? 3'd5
+    :                                                                3'd0;
+
+  wire ir_hsked = exu_i_valid & exu_i_ready;
+
+  always @(posedge clk) begin
+    if (rst_n) begin
+      e203_pipeview_cycle(exu_i_valid, ir_hsked, exu_i_pc, exu_i_ir,
+                          {5'b0, stall}, ir_hsked & fwd_match,
+                          disp_oitf_ena, {{(8-`E203_ITAG_WIDTH){1'b0}}, disp_oitf_ptr},
+                          lsu_wbck_valid & lsu_wbck_ready,
+                          {{(8-`E203_ITAG_WIDTH){1'b0}}, lsu_wbck_itag},
+                          oitf_ret_ena, {{(8-`E203_ITAG_WIDTH){1'b0}}, oitf_ret_ptr},
+                          pipe_flush_req & pipe_flush_ack);
+    end
+  end
+
+endmodule
+
+bind e203_exu e203_exu_pipemon u_e203_exu_pipemon(
+  .exu_i_valid         (exu_i_valid),
+  .exu_i_ready         (exu_i_ready),
+  .exu_i_pc            (exu_i_pc   ),
+  .exu_i_ir            (exu_i_ir   ),
+
+  .raw_dep             (u_e203_exu_disp.raw_dep),
+  .waw_dep             (u_e203_exu_disp.waw_dep),
+  .fwd_match           (u_e203_exu_disp.rs1_fwd_match | u_e203_exu_disp.rs2_fwd_match),
+  .disp_csr            (u_e203_exu_disp.disp_csr),
+  .disp_fence_fencei   (u_e203_exu_disp.disp_fence_fencei),
+  .disp_alu_longp_prdt (u_e203_exu_disp.disp_alu_longp_prdt),
+  .wfi_halt_exu_req    (wfi_halt_exu_req),
+  .oitf_empty          (exu_oitf_empty  ),
+  .disp_oitf_ready     (disp_oitf_ready ),
+  .disp_alu_valid      (disp_alu_valid  ),
+  .disp_alu_ready      (disp_alu_ready  ),
+  .stk_hold            (stk_hold        ),
+
+  .disp_oitf_ena       (disp_oitf_ena   ),
+  .disp_oitf_ptr       (disp_oitf_ptr   ),
+  .lsu_wbck_valid      (lsu_wbck_valid  ),
+  .lsu_wbck_ready      (lsu_wbck_ready  ),
+  .lsu_wbck_itag       (lsu_wbck_itag   ),
+  .oitf_ret_ena        (oitf_ret_ena    ),
+  .oitf_ret_ptr        (oitf_ret_ptr    ),
+  .pipe_flush_req      (pipe_flush_req  ),
+  .pipe_flush_ack      (pipe_flush_ack  ),
+
+  .clk                 (clk  ),
+  .rst_n               (rst_n)
+);
@@ -0,0 +1,8 @@
+// The DPI import of e203_window_top for the simulation console: the bytes
+// the program writes to the console CSR (0x7FE) go to stdout, in order with
+// the output of the tools.
+#include <cstdio>
+
+#include "Ve203_window_top__Dpi.h"
+
+void e203_console_putc(char c) { std::fputc(static_cast<unsigned char>(c), stdout); }
@@ -0,0 +1,243 @@
+// The Verilator harness of e203_window_top shared by the sim/rtl tools:
+// the clocks and the reset of the SoC, the retired instructions and the
+// simulation markers of each cycle, and the save/restore of the whole
+// model (the model is verilated with --savable, the memories are in it).
+//
+// +ELF=<file> loads a program without the .verilog images: the ELF is
+// mapped, and its segments are copied into the ITCM/DTCM arrays through the
+// DPI backdoor of e203_window_top before the reset, so the load costs the
+// size of the program, not the parsing of 64K-line hex files.
+//
+// +PIPEVIEW=<file> streams the lifetime of every instruction through the
+// EXU to a Konata log (e203_rtl_pipeview.h).
+//
+// OpenTrace writes an FST of a few scopes in the windows of its triggers
+// (e203_rtl_trace.h). It needs the model verilated with --trace-fst
+// (-DE203SIM_RTL_TRACE=ON, the default).
+#ifndef E203SIM_RTL_HARNESS_H
+#define E203SIM_RTL_HARNESS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <svdpi.h>
+#include <verilated.h>
+#include <verilated_save.h>
+#ifdef E203SIM_RTL_TRACE
+#include <verilated_fst_c.h>
+#endif
+
+#include "Ve203_window_top.h"
+#include "Ve203_window_top__Dpi.h"
+#include "checkpoint.h"
+#include "e203_rtl_pipeview.h"
+#include "e203_rtl_trace.h"
+#include "elf_image.h"
+
+namespace e203sim {
+
+// What commits on one rising edge of the core clock
+struct RtlEdge {
+  bool cmt_valid;
+  uint32_t cmt_pc;
+  bool mark_valid;
+  uint32_t mark_id;
+  bool raw_stall;  // The dispatch waits on a RAW dependency
+};
+
+class RtlHarness {
+ public:
+  static constexpr uint64_t kLfDiv = 16;         // hfclk cycles per lfclk half period
+  static constexpr uint64_t kResetCycles = 640;  // The AON reset sync runs on the lfclk
+
+  // plusargs are the +KEY=VALUE arguments of the model (+CKPT=, +ITCM=, ...)
+  explicit RtlHarness(const std::vector<std::string>& plusargs)
+      : ctx_(new VerilatedContext), args_(plusargs) {
+    args_.insert(args_.begin(), "e203_rtl");
+    std::vector<const char*> argv;
+    for (const std::string& a : args_) argv.push_back(a.c_str());
+    ctx_->commandArgs(static_cast<int>(argv.size()), argv.data());
+#ifdef E203SIM_RTL_TRACE
+    ctx_->traceEverOn(true);
+#endif
+    top_.reset(new Ve203_window_top(ctx_.get()));
+    top_->clk = 0;
+    top_->lfclk = 0;
+    top_->rst_n = 0;
+    for (const std::string& a : plusargs) {
+      if (a.compare(0, 5, "+ELF=") == 0 && !LoadElf(a.substr(5), &error_)) break;
+      if (a.compare(0, 10, "+PIPEVIEW=") == 0 && !PipeViewOpen(a.substr(10), &error_)) break;
+    }
+  }
+
+  ~RtlHarness() {
+    top_->final();
+    PipeViewClose();
+#ifdef E203SIM_RTL_TRACE
+    if (trace_) trace_->close();
+#endif
+  }
+
+  RtlHarness(const RtlHarness&) = delete;
+  RtlHarness& operator=(const RtlHarness&) = delete;
+
+  // One core clock cycle
+  RtlEdge Cycle() {
+    if (cycle_ % kLfDiv == 0) top_->lfclk = !top_->lfclk;
+    top_->rst_n = cycle_ >= kResetCycles;
+    top_->clk = 0;
+    top_->eval();
+    RtlEdge e{top_->cmt_valid != 0, static_cast<uint32_t>(top_->cmt_pc), top_->sim_mark_valid != 0,
+              static_cast<uint32_t>(top_->sim_mark_id), top_->raw_stall != 0};
+    bool dump = triggers_ &&
+                triggers_->Update(cycle_, e.cmt_valid, e.cmt_pc, e.mark_valid, e.mark_id, e.raw_stall);
+    if (dump) Dump(2 * cycle_);
+    top_->clk = 1;
+    top_->eval();
+    if (dump) Dump(2 * cycle_ + 1);
+    cycle_++;
+    if (e.cmt_valid) instret_++;
+    return e;
+  }
+
+  // Trace the scopes to an FST in the windows of spec from now on. A scope
+  // is an instance of the EXU (u_e203_exu_disp, u_e203_exu_oitf, ...) or a
+  // path from TOP.
+  bool OpenTrace(const std::string& path, const std::vector<std::string>& scopes,
+                 const RtlTraceSpec& spec, std::string* err) {
+#ifdef E203SIM_RTL_TRACE
+    trace_.reset(new VerilatedFstC);
+    for (const std::string& s : scopes) {
+      trace_->dumpvars(0, s.find('.') == std::string::npos ? std::string(kExuScope) + "." + s : s);
+    }
+    top_->trace(trace_.get(), 99);
+    trace_->open(path.c_str());
+    if (!trace_->isOpen()) {
+      *err = "cannot write " + path;
+      trace_.reset();
+      return false;
+    }
+    triggers_.reset(new RtlTraceTriggers(spec));
+    return true;
+#else
+    (void)scopes;
+    (void)spec;
+    *err = path + ": the model is built without tracing (-DE203SIM_RTL_TRACE=ON)";
+    return false;
+#endif
+  }
+
+  // Take the triggers of spec from now on without a trace, the first run
+  // of a pre-trigger trace
+  void WatchTriggers(const RtlTraceSpec& spec) { triggers_.reset(new RtlTraceTriggers(spec)); }
+
+  // The triggers of the trace, null without one
+  const RtlTraceTriggers* triggers() const { return triggers_.get(); }
+
+  // Why the harness cannot run (e.g., a bad +ELF=), empty if it can
+  const std::string& error() const { return error_; }
+
+  // Copy the loadable segments of an ELF into the ITCM/DTCM, before the
+  // reset is released (cycle() 0)
+  bool LoadElf(const std::string& path, std::string* err) {
+    ElfImage elf;
+    if (!elf.Open(path, err)) return false;
+    top_->eval();  // The initial blocks first, they load the memories too
+    svSetScope(svGetScopeFromName("TOP.e203_window_top"));
+    RtlLayout layout;
+    for (const ElfSegment& seg : elf.segments()) {
+      uint32_t i = 0;
+      while (i < seg.filesz) {
+        uint32_t addr = seg.paddr + i;
+        uint32_t n = 0;
+        if (addr - layout.itcm_base < layout.itcm_size) {
+          n = CopyWord(addr - layout.itcm_base, 8, seg.data + i, seg.filesz - i);
+        } else if (addr - layout.dtcm_base < layout.dtcm_size) {
+          n = CopyWord(addr - layout.dtcm_base, 4, seg.data + i, seg.filesz - i);
+        } else {
+          char buf[96];
+          std::snprintf(buf, sizeof(buf), "%s: 0x%08x is outside the ITCM and the DTCM",
+                        path.c_str(), addr);
+          *err = buf;
+          return false;
+        }
+        i += n;
+      }
+    }
+    return true;
+  }
+
+  uint64_t cycle() const { return cycle_; }
+  uint64_t instret() const { return instret_; }
+  bool finished() const { return ctx_->gotFinish(); }
+
+  // The model and the harness counters, restorable only into the same
+  // build of the model
+  void Save(const std::string& path) {
+    VerilatedSave os;
+    os.open(path.c_str());
+    os << cycle_ << instret_;
+    os << *top_;
+    os.close();
+  }
+
+  void Restore(const std::string& path) {
+    VerilatedRestore os;
+    os.open(path.c_str());
+    os >> cycle_ >> instret_;
+    os >> *top_;
+    os.close();
+  }
+
+ private:
+  static constexpr const char* kExuScope =
+      "TOP.e203_window_top.u_e203_soc_top.u_e203_subsys_top.u_e203_subsys_main.u_e203_cpu_top."
+      "u_e203_cpu.u_e203_core.u_e203_exu";
+
+  void Dump(uint64_t time) {
+#ifdef E203SIM_RTL_TRACE
+    if (trace_) trace_->dump(time);
+#else
+    (void)time;
+#endif
+  }
+
+  // Merge the bytes at ofs of a TCM with words of width bytes into its
+  // word, returns the bytes taken from data (up to the end of the word)
+  static uint32_t CopyWord(uint32_t ofs, uint32_t width, const uint8_t* data, uint32_t left) {
+    int idx = static_cast<int>(ofs / width);
+    uint32_t pos = ofs % width;
+    uint32_t n = std::min(width - pos, left);
+    uint64_t word = width == 8 ? static_cast<uint64_t>(e203_itcm_read(idx))
+                               : static_cast<uint32_t>(e203_dtcm_read(idx));
+    for (uint32_t b = 0; b < n; b++) {
+      word &= ~(uint64_t{0xff} << (8 * (pos + b)));
+      word |= uint64_t{data[b]} << (8 * (pos + b));
+    }
+    if (width == 8) {
+      e203_itcm_write(idx, static_cast<long long>(word));
+    } else {
+      e203_dtcm_write(idx, static_cast<int>(word));
+    }
+    return n;
+  }
+
+  std::unique_ptr<VerilatedContext> ctx_;
+  std::vector<std::string> args_;
+  std::unique_ptr<Ve203_window_top> top_;
+  uint64_t cycle_ = 0;
+  uint64_t instret_ = 0;
+  std::string error_;
+  std::unique_ptr<RtlTraceTriggers> triggers_;
+#ifdef E203SIM_RTL_TRACE
+  std::unique_ptr<VerilatedFstC> trace_;
+#endif
+};
+
+}  // namespace e203sim
+
+#endif  // E203SIM_RTL_HARNESS_H
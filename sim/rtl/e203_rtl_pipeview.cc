@@ -0,0 +1,236 @@
+#include "e203_rtl_pipeview.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "Ve203_window_top__Dpi.h"
+#include "decode.h"
+
+namespace e203sim {
+
+namespace {
+
+constexpr int kOitfEntries = 256;  // Any E203_ITAG_WIDTH up to 8
+
+// The stage of each stall cause of e203_exu_pipemon
+const char* const kStallStages[8] = {"Ds",       "Ds:raw", "Ds:waw", "Ds:oitf",
+                                     "Ds:drain", "Ds:alu", "Ds:stk", "Ds:wfi"};
+const char* const kEx = "Ex";
+const char* const kLp = "Lp";
+const char* const kWb = "Wb";
+
+struct Live {
+  uint64_t id = 0;
+  uint32_t pc = 0;
+  const char* stage = nullptr;  // Null before the first stage
+  bool valid = false;
+};
+
+// The stage change of an instruction at the start of the next cycle
+struct Pending {
+  uint64_t id;
+  const char* stage;
+  const char* next;  // Null to retire
+};
+
+class PipeView {
+ public:
+  explicit PipeView(gzFile out) : out_(out) {
+    buf_ = "Kanata\t0004\nC=\t0\n";
+    pending_.reserve(4);
+  }
+
+  ~PipeView() {
+    Flush();
+    gzclose(out_);
+  }
+
+  void Cycle(bool ir_valid, bool ir_hsked, uint32_t ir_pc, uint32_t ir, unsigned stall, bool fwd,
+             bool oitf_dis, unsigned oitf_dis_ptr, bool lsu_ret, unsigned lsu_ret_itag,
+             bool oitf_ret, unsigned oitf_ret_ptr, bool flush) {
+    // The stages that ended with the last cycle
+    for (const Pending& p : pending_) {
+      End(p.id, p.stage);
+      if (p.next != nullptr) {
+        Start(p.id, p.next);
+      } else {
+        Retire(p.id, false);
+      }
+    }
+    pending_.clear();
+
+    // The IR: a new instruction, or the one that stalled is gone (a flush)
+    if (ir_.valid && (!ir_valid || ir_pc != ir_.pc || (flush && !ir_hsked))) {
+      if (ir_.stage != nullptr) End(ir_.id, ir_.stage);
+      Retire(ir_.id, true);
+      ir_.valid = false;
+    }
+    if (ir_valid && !ir_.valid) {
+      ir_ = Live();
+      ir_.id = next_id_++;
+      ir_.pc = ir_pc;
+      ir_.valid = true;
+      Fetch(ir_.id, ir_pc, ir);
+    }
+    if (ir_.valid) {
+      const char* stage = ir_hsked ? kEx : kStallStages[stall & 7];
+      if (stage != ir_.stage) {
+        if (ir_.stage != nullptr) End(ir_.id, ir_.stage);
+        Start(ir_.id, stage);
+        ir_.stage = stage;
+      }
+      if (ir_hsked) {
+        if (fwd) Label(ir_.id, 1, "load-use forwarded");
+        if (oitf_dis) {
+          Live& e = oitf_[oitf_dis_ptr % kOitfEntries];
+          e = ir_;
+          e.stage = kLp;
+          pending_.push_back({ir_.id, kEx, kLp});
+        } else {
+          pending_.push_back({ir_.id, kEx, nullptr});
+        }
+        ir_.valid = false;
+      }
+    }
+
+    // The long pipe, by OITF entry (after a restore, the entries
+    // dispatched before it are unknown)
+    if (lsu_ret) {
+      Live& e = oitf_[lsu_ret_itag % kOitfEntries];
+      if (e.valid && e.stage == kLp) {
+        End(e.id, kLp);
+        Start(e.id, kWb);
+        e.stage = kWb;
+      }
+    }
+    if (oitf_ret) {
+      Live& e = oitf_[oitf_ret_ptr % kOitfEntries];
+      if (e.valid) pending_.push_back({e.id, e.stage, nullptr});
+      e.valid = false;
+    }
+
+    cycle_++;
+    if (buf_.size() >= (1 << 16)) Flush();
+  }
+
+ private:
+  // The cycle line before the first event of a cycle
+  void At() {
+    if (cycle_ == logged_) return;
+    char line[32];
+    std::snprintf(line, sizeof(line), "C\t%llu\n",
+                  static_cast<unsigned long long>(cycle_ - logged_));
+    buf_ += line;
+    logged_ = cycle_;
+  }
+
+  void Fetch(uint64_t id, uint32_t pc, uint32_t raw) {
+    At();
+    Inst d = Decode(raw);
+    char line[128];
+    int n = std::snprintf(line, sizeof(line), "I\t%llu\t%llu\t0\nL\t%llu\t0\t%08x %s",
+                          static_cast<unsigned long long>(id), static_cast<unsigned long long>(id),
+                          static_cast<unsigned long long>(id), pc, OpName(d.op));
+    buf_.append(line, static_cast<size_t>(n));
+    const char* sep = " ";
+    if (d.rd_wen) {
+      std::snprintf(line, sizeof(line), "%sx%u", sep, d.rd);
+      buf_ += line;
+      sep = ", ";
+    }
+    if (d.rs1_en) {
+      std::snprintf(line, sizeof(line), "%sx%u", sep, d.rs1);
+      buf_ += line;
+      sep = ", ";
+    }
+    if (d.rs2_en) {
+      std::snprintf(line, sizeof(line), "%sx%u", sep, d.rs2);
+      buf_ += line;
+    }
+    buf_ += '\n';
+  }
+
+  void Label(uint64_t id, int type, const char* text) {
+    At();
+    char line[96];
+    std::snprintf(line, sizeof(line), "L\t%llu\t%d\t%s\n", static_cast<unsigned long long>(id),
+                  type, text);
+    buf_ += line;
+  }
+
+  void Stage(char kind, uint64_t id, const char* stage) {
+    At();
+    char line[64];
+    std::snprintf(line, sizeof(line), "%c\t%llu\t0\t%s\n", kind,
+                  static_cast<unsigned long long>(id), stage);
+    buf_ += line;
+  }
+
+  void Start(uint64_t id, const char* stage) { Stage('S', id, stage); }
+  void End(uint64_t id, const char* stage) { Stage('E', id, stage); }
+
+  void Retire(uint64_t id, bool flushed) {
+    At();
+    char line[64];
+    std::snprintf(line, sizeof(line), "R\t%llu\t%llu\t%d\n", static_cast<unsigned long long>(id),
+                  static_cast<unsigned long long>(flushed ? 0 : retired_++), flushed ? 1 : 0);
+    buf_ += line;
+  }
+
+  void Flush() {
+    if (!buf_.empty()) gzwrite(out_, buf_.data(), static_cast<unsigned>(buf_.size()));
+    buf_.clear();
+  }
+
+  gzFile out_;
+  std::string buf_;
+  uint64_t cycle_ = 0;
+  uint64_t logged_ = 0;
+  uint64_t next_id_ = 0;
+  uint64_t retired_ = 0;
+  Live ir_;
+  Live oitf_[kOitfEntries];
+  std::vector<Pending> pending_;
+};
+
+std::unique_ptr<PipeView> g_view;
+
+bool EndsWith(const std::string& s, const char* suffix) {
+  size_t n = std::strlen(suffix);
+  return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+}  // namespace
+
+bool PipeViewOpen(const std::string& path, std::string* err) {
+  // "T" writes the log as it is
+  gzFile out = gzopen(path.c_str(), EndsWith(path, ".gz") ? "wb1" : "wbT");
+  if (out == nullptr) {
+    *err = "cannot write " + path;
+    return false;
+  }
+  gzbuffer(out, 1 << 17);
+  g_view.reset(new PipeView(out));
+  return true;
+}
+
+void PipeViewClose() { g_view.reset(); }
+
+}  // namespace e203sim
+
+void e203_pipeview_cycle(svBit ir_valid, svBit ir_hsked, int ir_pc, int ir, char stall, svBit fwd,
+                         svBit oitf_dis, char oitf_dis_ptr, svBit lsu_ret, char lsu_ret_itag,
+                         svBit oitf_ret, char oitf_ret_ptr, svBit flush) {
+  if (!e203sim::g_view) return;
+  e203sim::g_view->Cycle(ir_valid, ir_hsked, static_cast<uint32_t>(ir_pc),
+                         static_cast<uint32_t>(ir), static_cast<unsigned char>(stall), fwd,
+                         oitf_dis, static_cast<unsigned char>(oitf_dis_ptr), lsu_ret,
+                         static_cast<unsigned char>(lsu_ret_itag), oitf_ret,
+                         static_cast<unsigned char>(oitf_ret_ptr), flush);
+}
@@ -0,0 +1,32 @@
+// The pipeline view of the sim/rtl tools: the events e203_exu_pipemon
+// reports each cycle are followed per instruction and streamed out as a
+// Konata log (the "Kanata 0004" format), gzip-compressed when the file
+// name ends in .gz, so a whole CoreMark run fits on the disk.
+//
+// An instruction starts in the IR (the IFU is outside the EXU) and goes
+// through the stages:
+//   Ds:<cause>  a dispatch stall, the cause as e203_exu_pipemon.v names it
+//               (raw, waw, oitf, drain, alu, stk, wfi)
+//   Ex          the dispatch and the ALU (decoded in the same cycle)
+//   Lp          a long-pipe instruction in the OITF, waiting on the LSU
+//   Wb          the LSU returned, up to the OITF retirement
+// It retires after Ex, or after its OITF retirement; an instruction that
+// leaves the IR without dispatching is flushed. A load-use forwarding hit
+// is in the detail label of the consumer.
+#ifndef E203SIM_RTL_PIPEVIEW_H
+#define E203SIM_RTL_PIPEVIEW_H
+
+#include <string>
+
+namespace e203sim {
+
+// Start the log of the following cycles, false with err set if path
+// cannot be written
+bool PipeViewOpen(const std::string& path, std::string* err);
+
+// Flush and close the log, if open
+void PipeViewClose();
+
+}  // namespace e203sim
+
+#endif  // E203SIM_RTL_PIPEVIEW_H
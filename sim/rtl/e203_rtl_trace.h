@@ -0,0 +1,122 @@
+// The trigger windows of the FST tracing of the sim/rtl tools. A full trace
+// of a CoreMark run is gigabytes and slows the model ten times, so the
+// harness dumps only the cycles a trigger opens, and only the scopes asked
+// for (see RtlHarness::OpenTrace):
+//
+//   - a range of cycles, counted from the reset as the tools print them;
+//   - the commit of a pc in a range;
+//   - the first N RAW-dependency stalls of the dispatch;
+//   - a marker write, e.g., 4, which CoreMark writes on a CRC mismatch.
+//
+// All but the cycle ranges open a window of `window` cycles from the cycle
+// of the trigger; a trigger inside a window extends it.
+//
+// A window cannot open before its trigger in one pass, and the cause of a
+// failure (the CRC mismatch marker, say) is often well before it. With a
+// pre-trigger depth `before`, the tool runs twice from the same state:
+// the first run only records where the triggers fire, the second traces
+// each window from `before` cycles ahead of its trigger (PreTriggerSpec).
+// The model is deterministic, so the second run is the first one again.
+#ifndef E203SIM_RTL_TRACE_H
+#define E203SIM_RTL_TRACE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace e203sim {
+
+struct RtlTraceSpec {
+  std::vector<std::pair<uint64_t, uint64_t>> cycles;  // [first, last]
+  std::vector<std::pair<uint32_t, uint32_t>> pcs;     // [lo, hi]
+  uint64_t raw_stalls = 0;
+  std::vector<uint32_t> marks;
+  uint64_t window = 1000;
+  uint64_t before = 0;  // The pre-trigger depth, 0 for a single pass
+
+  // With no trigger, the whole run is traced
+  bool empty() const { return cycles.empty() && pcs.empty() && raw_stalls == 0 && marks.empty(); }
+};
+
+// Parse A:B (either may be hex) into first/last, false if it is not one
+template <typename T>
+bool ParseTraceRange(const std::string& s, std::pair<T, T>* r) {
+  size_t colon = s.find(':');
+  if (colon == std::string::npos || colon == 0 || colon + 1 == s.size()) return false;
+  char* end = nullptr;
+  unsigned long long a = std::strtoull(s.c_str(), &end, 0);
+  if (end != s.c_str() + colon) return false;
+  unsigned long long b = std::strtoull(s.c_str() + colon + 1, &end, 0);
+  if (*end != '\0' || b < a) return false;
+  r->first = static_cast<T>(a);
+  r->second = static_cast<T>(b);
+  return true;
+}
+
+class RtlTraceTriggers {
+ public:
+  explicit RtlTraceTriggers(const RtlTraceSpec& spec) : spec_(spec) {}
+
+  // Take the triggers of the edge of cycle, returns whether cycle is traced
+  bool Update(uint64_t cycle, bool cmt_valid, uint32_t cmt_pc, bool mark_valid, uint32_t mark_id,
+              bool raw_stall) {
+    if (spec_.empty()) return true;
+    bool fire = false;
+    if (cmt_valid) {
+      for (const auto& r : spec_.pcs) fire |= cmt_pc >= r.first && cmt_pc <= r.second;
+    }
+    if (mark_valid) {
+      fire |= std::find(spec_.marks.begin(), spec_.marks.end(), mark_id) != spec_.marks.end();
+    }
+    // A stall of several cycles counts once
+    if (raw_stall && !raw_stall_prev_ && raw_stalls_ < spec_.raw_stalls) {
+      raw_stalls_++;
+      fire = true;
+    }
+    raw_stall_prev_ = raw_stall;
+    if (fire) {
+      if (cycle >= open_until_) windows_++;
+      open_until_ = std::max(open_until_, cycle + spec_.window);
+      // The window with its pre-trigger cycles, merged with the last one
+      uint64_t first = cycle - std::min(cycle, spec_.before);
+      if (!fired_.empty() && first <= fired_.back().second + 1) {
+        fired_.back().second = open_until_ - 1;
+      } else {
+        fired_.push_back({first, open_until_ - 1});
+      }
+    }
+    bool on = cycle < open_until_;
+    for (const auto& r : spec_.cycles) on |= cycle >= r.first && cycle <= r.second;
+    traced_ += on;
+    return on;
+  }
+
+  uint64_t windows() const { return windows_; }
+  uint64_t traced() const { return traced_; }
+
+  // The spec of the second run of a pre-trigger trace: the cycle ranges of
+  // the spec and the windows fired so far, `before` cycles earlier each.
+  // Empty if nothing fired and no cycle range was asked for.
+  RtlTraceSpec PreTriggerSpec() const {
+    RtlTraceSpec s;
+    s.cycles = spec_.cycles;
+    s.cycles.insert(s.cycles.end(), fired_.begin(), fired_.end());
+    return s;
+  }
+
+ private:
+  RtlTraceSpec spec_;
+  uint64_t open_until_ = 0;
+  uint64_t raw_stalls_ = 0;
+  bool raw_stall_prev_ = false;
+  uint64_t windows_ = 0;
+  uint64_t traced_ = 0;
+  std::vector<std::pair<uint64_t, uint64_t>> fired_;  // [first, last]
+};
+
+}  // namespace e203sim
+
+#endif  // E203SIM_RTL_TRACE_H
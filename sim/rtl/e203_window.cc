@@ -0,0 +1,114 @@
+// e203_window: run the detailed windows of a checkpoint directory written
+// by e203sim --simpoints ... --rtl-images on the Verilator model of the
+// HBirdv2 SoC, and report the weighted CPI, as e203sim --sampled does with a
+// timing model.
+//
+// Each window is a fresh model (and Verilator context, for its +CKPT=):
+// reset, boot through the restore stub, which ends with the jal at
+// stub_jal_pc, run the warm-up instructions, then count the cycles of the
+// window instructions.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "checkpoint.h"
+#include "e203_rtl_harness.h"
+
+namespace {
+
+struct Window {
+  uint64_t insts = 0;
+  uint64_t cycles = 0;
+};
+
+Window RunWindow(const std::string& prefix, const e203sim::ManifestEntry& e, uint64_t max_cycles) {
+  e203sim::RtlHarness rtl({"+CKPT=" + prefix});
+
+  enum { kBoot, kWarmup, kWindow } phase = kBoot;
+  uint64_t left = 0;
+  uint64_t start = 0;
+  Window w;
+  while (rtl.cycle() < max_cycles && !rtl.finished()) {
+    e203sim::RtlEdge edge = rtl.Cycle();
+    if (!edge.cmt_valid) continue;
+    if (phase == kBoot) {
+      if (edge.cmt_pc == e.stub_jal_pc) {
+        phase = e.warmup ? kWarmup : kWindow;
+        left = e.warmup ? e.warmup : e.window;
+        start = rtl.cycle();
+      }
+    } else if (--left == 0) {
+      if (phase == kWarmup) {
+        phase = kWindow;
+        left = e.window;
+        start = rtl.cycle();
+      } else {
+        break;
+      }
+    }
+  }
+  if (phase == kWindow) {
+    // Short if the program ended (or the limit) in the window
+    w.insts = e.window - left;
+    w.cycles = rtl.cycle() - start;
+  }
+  return w;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  uint64_t max_cycles = 100000000;
+  std::string dir;
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    if (a == "--max-cycles" && i + 1 < argc) {
+      max_cycles = std::strtoull(argv[++i], nullptr, 0);
+    } else if (a[0] != '-' && dir.empty()) {
+      dir = a;
+    } else {
+      std::fprintf(stderr, "usage: %s [--max-cycles N] CKPT_DIR\n", argv[0]);
+      return 2;
+    }
+  }
+  if (dir.empty()) {
+    std::fprintf(stderr, "usage: %s [--max-cycles N] CKPT_DIR\n", argv[0]);
+    return 2;
+  }
+
+  std::string err;
+  std::vector<e203sim::ManifestEntry> entries;
+  if (!e203sim::ReadManifest(dir + "/manifest.txt", &entries, &err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 2;
+  }
+
+  double cpi = 0;
+  double weights = 0;
+  std::fprintf(stderr, "%-8s %10s %8s %12s %12s %8s\n", "point", "interval", "weight", "insts",
+               "cycles", "CPI");
+  for (const e203sim::ManifestEntry& e : entries) {
+    if (e.stub_jal_pc == 0) {
+      std::fprintf(stderr, "%s: no RTL image, rerun e203sim with --rtl-images\n", e.name.c_str());
+      return 2;
+    }
+    Window w = RunWindow(dir + "/" + e.name, e, max_cycles);
+    if (w.insts == 0) {
+      std::fprintf(stderr, "%-8s: the window did not start in %llu cycles\n", e.name.c_str(),
+                   static_cast<unsigned long long>(max_cycles));
+      continue;
+    }
+    double w_cpi = static_cast<double>(w.cycles) / static_cast<double>(w.insts);
+    std::fprintf(stderr, "%-8s %10llu %8.4f %12llu %12llu %8.3f\n", e.name.c_str(),
+                 static_cast<unsigned long long>(e.interval), e.weight,
+                 static_cast<unsigned long long>(w.insts), static_cast<unsigned long long>(w.cycles),
+                 w_cpi);
+    cpi += e.weight * w_cpi;
+    weights += e.weight;
+  }
+  if (weights <= 0) return 1;
+  std::fprintf(stderr, "weighted CPI: %.3f (RTL)\n", cpi / weights);
+  return 0;
+}
@@ -0,0 +1,148 @@
+//=====================================================================
+//
+// Designer   : Jiacheng Guo
+//
+// Description:
+//  The top of the Verilator runs of sim/rtl: the HBirdv2 SoC with its ITCM
+//  and DTCM loaded, as tb_top does, from $readmemh images:
+//    +CKPT=<prefix>  the images e203sim writes for a checkpoint,
+//                    <prefix>.itcm.verilog and <prefix>.dtcm.verilog. The
+//                    restore stub in the ITCM puts the registers and CSRs
+//                    back, so nothing but the memories is written here.
+//    +ITCM=<file> [+DTCM=<file>]  the images of a program, as built for
+//                    tb_top.
+//  With neither (e.g., the model is restored from a saved state), the
+//  memories are left as they are. The harness also loads an ELF itself
+//  (+ELF=<file>), through the DPI backdoor below.
+//
+//  The retired instructions and the simulation markers are brought out
+//  for the harness (e203_rtl_harness.h): cmt_valid is the EXU instret
+//  enable, with the pc of the instruction committed by the ALU, and
+//  sim_mark_valid is a CSR write of sim_mark_id to the marker CSR (0x7FF,
+//  see benchmark/coremark/e203_sim.h), which the core itself ignores.
+//  raw_stall is a dispatch held by a RAW dependency on the OITF, a trigger
+//  of the tracing (e203_rtl_trace.h).
+//  A write to the console CSR (0x7FE) is handed to the host through the
+//  DPI import e203_console_putc (e203_rtl_console.cc) on its cycle.
+//  e203_exu_pipemon.v, bound into e203_exu, reports the pipeline events
+//  for +PIPEVIEW=<file>.
+//
+// ====================================================================
+`include "e203_defines.v"
+
+`define WIN_CPU_TOP u_e203_soc_top.u_e203_subsys_top.u_e203_subsys_main.u_e203_cpu_top
+`define WIN_EXU     `WIN_CPU_TOP.u_e203_cpu.u_e203_core.u_e203_exu
+`define WIN_ITCM    `WIN_CPU_TOP.u_e203_srams.u_e203_itcm_ram.u_e203_itcm_gnrl_ram.u_sirv_sim_ram
+`define WIN_DTCM    `WIN_CPU_TOP.u_e203_srams.u_e203_dtcm_ram.u_e203_dtcm_gnrl_ram.u_sirv_sim_ram
+
+module e203_window_top(
+  input  clk,
+  input  lfclk,
+  input  rst_n,
+
+  output cmt_valid,
+  output [`E203_PC_SIZE-1:0] cmt_pc,
+  output sim_mark_valid,
+  output [`E203_XLEN-1:0] sim_mark_id,
+  output raw_stall
+  );
+
+  assign cmt_valid = `WIN_EXU.cmt_instret_ena;
+  assign cmt_pc    = `WIN_EXU.alu_cmt_pc;
+
+  assign sim_mark_valid = `WIN_EXU.csr_ena & `WIN_EXU.csr_wr_en & (`WIN_EXU.csr_idx == 12'h7FF);
+  assign sim_mark_id    = `WIN_EXU.wbck_csr_dat;
+
+  assign raw_stall = `WIN_EXU.u_e203_exu_disp.disp_i_valid & `WIN_EXU.u_e203_exu_disp.raw_dep;
+
+  import "DPI-C" function void e203_console_putc(input byte c);
+
+  wire sim_console_valid = `WIN_EXU.csr_ena & `WIN_EXU.csr_wr_en & (`WIN_EXU.csr_idx == 12'h7FE);
+
+  always @(posedge clk) begin
+    if (sim_console_valid) e203_console_putc(`WIN_EXU.wbck_csr_dat[7:0]);
+  end
+
+  reg [7:0] itcm_mem [0:(`E203_ITCM_RAM_DP*8)-1];
+  reg [7:0] dtcm_mem [0:(`E203_DTCM_RAM_DP*4)-1];
+  string ckpt;
+  string itcm_file;
+  string dtcm_file;
+  integer i;
+
+  initial begin
+    itcm_file = "";
+    dtcm_file = "";
+    if ($value$plusargs("CKPT=%s", ckpt)) begin
+      itcm_file = {ckpt, ".itcm.verilog"};
+      dtcm_file = {ckpt, ".dtcm.verilog"};
+    end
+    else begin
+      if (!$value$plusargs("ITCM=%s", itcm_file)) itcm_file = "";
+      if (!$value$plusargs("DTCM=%s", dtcm_file)) dtcm_file = "";
+    end
+
+    if (itcm_file != "") begin
+      $readmemh(itcm_file, itcm_mem);
+      for (i=0; i<`E203_ITCM_RAM_DP; i=i+1) begin
+        `WIN_ITCM.mem_r[i] = {itcm_mem[i*8+7], itcm_mem[i*8+6], itcm_mem[i*8+5], itcm_mem[i*8+4],
+                              itcm_mem[i*8+3], itcm_mem[i*8+2], itcm_mem[i*8+1], itcm_mem[i*8+0]};
+      end
+    end
+    if (dtcm_file != "") begin
+      $readmemh(dtcm_file, dtcm_mem);
+      for (i=0; i<`E203_DTCM_RAM_DP; i=i+1) begin
+        `WIN_DTCM.mem_r[i] = {dtcm_mem[i*4+3], dtcm_mem[i*4+2], dtcm_mem[i*4+1], dtcm_mem[i*4+0]};
+      end
+    end
+  end
+
+  // The backdoor of the memories for the harness: a word of the ITCM (64
+  // bits) or of the DTCM (32 bits) by its index
+  export "DPI-C" function e203_itcm_read;
+  export "DPI-C" function e203_itcm_write;
+  export "DPI-C" function e203_dtcm_read;
+  export "DPI-C" function e203_dtcm_write;
+
+  function longint e203_itcm_read(input int idx);
+    e203_itcm_read = `WIN_ITCM.mem_r[idx];
+  endfunction
+
+  function void e203_itcm_write(input int idx, input longint data);
+    `WIN_ITCM.mem_r[idx] = data;
+  endfunction
+
+  function int e203_dtcm_read(input int idx);
+    e203_dtcm_read = `WIN_DTCM.mem_r[idx];
+  endfunction
+
+  function void e203_dtcm_write(input int idx, input int data);
+    `WIN_DTCM.mem_r[idx] = data;
+  endfunction
+
+  // The pads as tb_top drives them, the ones left out are unused inputs
+  // (tied to 0) or outputs
+  e203_soc_top u_e203_soc_top(
+    .hfextclk                         (clk),
+    .hfxoscen                         (),
+    .lfextclk                         (lfclk),
+    .lfxoscen                         (),
+
+    .io_pads_jtag_TCK_i_ival          (1'b0),
+    .io_pads_jtag_TMS_i_ival          (1'b0),
+    .io_pads_jtag_TDI_i_ival          (1'b0),
+    .io_pads_jtag_TDO_o_oval          (),
+    .io_pads_jtag_TDO_o_oe            (),
+
+    .io_pads_aon_erst_n_i_ival        (rst_n),
+    .io_pads_aon_pmu_dwakeup_n_i_ival (1'b1),
+    .io_pads_aon_pmu_vddpaden_o_oval  (),
+    .io_pads_aon_pmu_padrst_o_oval    (),
+
+    .io_pads_bootrom_n_i_ival         (1'b0), // The mask ROM jumps to the ITCM
+    .io_pads_dbgmode0_n_i_ival        (1'b1),
+    .io_pads_dbgmode1_n_i_ival        (1'b1),
+    .io_pads_dbgmode2_n_i_ival        (1'b1)
+  );
+
+endmodule
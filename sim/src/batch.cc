@@ -0,0 +1,197 @@
+#include "batch.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+#include "elf_image.h"
+#include "machine.h"
+#include "proc.h"
+
+namespace e203sim {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::string Join(const std::vector<std::string>& v, const char* sep) {
+  std::string s;
+  for (const std::string& e : v) s += (s.empty() ? "" : sep) + e;
+  return s;
+}
+
+}  // namespace
+
+const char* RunCheckName(const RunResult& r) {
+  if (!r.ok) return "-";
+  return r.check == RunCheck::kPass ? "PASS" : r.check == RunCheck::kFail ? "FAIL" : "-";
+}
+
+void ResultFromMarks(const std::vector<MarkEvent>& marks, uint64_t cycles, uint64_t insts,
+                     RunResult* r) {
+  const MarkEvent* start = nullptr;
+  const MarkEvent* end = nullptr;
+  for (const MarkEvent& m : marks) {
+    if (m.id == kMarkStart && start == nullptr) start = &m;
+    if (m.id == kMarkEnd && start != nullptr && end == nullptr) end = &m;
+    if (m.id == kMarkPass) r->check = RunCheck::kPass;
+    if (m.id == kMarkFail) r->check = RunCheck::kFail;
+  }
+  if (end != nullptr) {
+    r->cycles = end->cycles - start->cycles;
+    r->insts = end->instret - start->instret;
+  } else {
+    r->cycles = cycles;
+    r->insts = insts;
+  }
+  r->run_cycles = cycles;
+  r->ok = true;
+}
+
+bool ParseSymbolPatch(const std::string& s, SymbolPatch* p) {
+  size_t eq = s.find('=');
+  if (eq == std::string::npos || eq == 0 || eq + 1 == s.size()) return false;
+  char* end = nullptr;
+  unsigned long long v = std::strtoull(s.c_str() + eq + 1, &end, 0);
+  if (*end != '\0' || v > 0xffffffffull) return false;
+  p->symbol = s.substr(0, eq);
+  p->value = static_cast<uint32_t>(v);
+  return true;
+}
+
+bool LoadProgram(const ElfImage& elf, const std::vector<SymbolPatch>& patches, Machine* m,
+                 std::string* err) {
+  elf.Load(&m->mem);
+  for (const SymbolPatch& p : patches) {
+    uint32_t vaddr = 0;
+    uint32_t paddr = 0;
+    if (!elf.Symbol(p.symbol, &vaddr) || !elf.LoadAddress(vaddr, &paddr)) {
+      *err = "no initialized symbol " + p.symbol;
+      return false;
+    }
+    uint8_t bytes[4] = {static_cast<uint8_t>(p.value), static_cast<uint8_t>(p.value >> 8),
+                        static_cast<uint8_t>(p.value >> 16), static_cast<uint8_t>(p.value >> 24)};
+    m->mem.WriteBlock(paddr, bytes, sizeof(bytes));
+  }
+  m->hart.Reset(elf.entry());
+  return true;
+}
+
+RunResult RunIss(const ElfImage& elf, const std::vector<SymbolPatch>& patches,
+                 const std::string& model, const ModelOptions& opts, uint64_t max_insts,
+                 FILE* uart_out) {
+  RunResult r;
+  std::unique_ptr<TimingModel> timing = MakeTimingModel(model, opts, &r.note);
+  if (!timing) return r;
+  Machine m(1, uart_out);
+  if (!LoadProgram(elf, patches, &m, &r.note)) return r;
+  m.hart.set_timing(timing.get());
+  m.hart.Run(max_insts);
+  ResultFromMarks(m.hart.marks(), m.hart.Cycles(), m.hart.instret(), &r);
+  if (!m.hart.halted()) r.note = "instruction limit";
+  return r;
+}
+
+bool HashRtlSources(const std::string& rtl_dir, Fnv64* h, std::string* err) {
+  fs::path sim(E203SIM_SOURCE_DIR);
+  std::ifstream cmake(sim / "CMakeLists.txt");
+  std::string text((std::istreambuf_iterator<char>(cmake)), std::istreambuf_iterator<char>());
+  h->Update(text);
+  h->Update(fs::absolute(rtl_dir).lexically_normal().string());
+  for (const fs::path& dir : {sim / "src", sim / "rtl", sim / ".." / "core", fs::path(rtl_dir)}) {
+    if (!HashTree(dir.string(), h, err)) return false;
+  }
+  return true;
+}
+
+RtlBuild CachedRtlBuild(const std::string& cache, const Fnv64& sources,
+                        const std::vector<std::string>& defines) {
+  Fnv64 h = sources;
+  for (const std::string& d : defines) h.Update(d);
+  RtlBuild b;
+  b.defines = defines;
+  b.dir = (fs::path(cache) / h.Hex()).string();
+  b.ok = b.cached = fs::exists(fs::path(b.dir) / "build.ok");
+  return b;
+}
+
+void BuildRtlModel(const std::string& rtl_dir, unsigned make_jobs, RtlBuild* b) {
+  if (b->cached) return;
+  auto t0 = std::chrono::steady_clock::now();
+  fs::path dir(b->dir);
+  std::error_code ec;
+  fs::create_directories(dir, ec);
+  std::vector<std::string> configure = {E203SIM_CMAKE, "-S", E203SIM_SOURCE_DIR, "-B", b->dir,
+                                        "-DE203SIM_RTL=ON", "-DE203SIM_RTL_TRACE=OFF",
+                                        "-DE203_RTL_DIR=" + fs::absolute(rtl_dir).string(),
+                                        "-DE203_RTL_DEFINES=" + Join(b->defines, ";")};
+  std::vector<std::string> build = {E203SIM_CMAKE, "--build", b->dir, "--target", "e203_ckpt",
+                                    "-j", std::to_string(make_jobs)};
+  b->log = (dir / "configure.log").string();
+  if (RunCommand(configure, b->log) == 0) {
+    b->log = (dir / "build.log").string();
+    b->ok = RunCommand(build, b->log) == 0;
+  }
+  if (b->ok) std::ofstream(dir / "build.ok") << Join(b->defines, "\n") << "\n";
+  b->secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+RunResult RunRtl(const RtlBuild& b, const std::vector<std::string>& plusargs,
+                 uint64_t max_cycles, const std::string& log) {
+  RunResult r;
+  if (!b.ok) {
+    r.note = "build failed, see " + b.log;
+    return r;
+  }
+  std::vector<std::string> argv = {(fs::path(b.dir) / "e203_ckpt").string(),
+                                   "run",
+                                   "--stop-mark",
+                                   std::to_string(kMarkPass),
+                                   "--stop-mark",
+                                   std::to_string(kMarkFail),
+                                   "--max-cycles",
+                                   std::to_string(max_cycles)};
+  argv.insert(argv.end(), plusargs.begin(), plusargs.end());
+  // e203_ckpt run exits with 0 at a stop marker, 1 when the run ended
+  // without one (its stop: line says how) and 2 on an error of its own
+  int rc = RunCommand(argv, log);
+  if (rc < 0) {
+    r.note = "e203_ckpt failed, see " + log;
+    return r;
+  }
+  if (rc == 2) {
+    r.note = "e203_ckpt error, see " + log;
+    return r;
+  }
+  if (rc != 0 && rc != 1) {
+    r.note = "e203_ckpt exit " + std::to_string(rc) + ", see " + log;
+    return r;
+  }
+
+  // The markers and the totals e203_ckpt run prints
+  std::vector<MarkEvent> marks;
+  unsigned long long cycles = 0;
+  unsigned long long insts = 0;
+  std::string stop;
+  std::ifstream in(log);
+  for (std::string line; std::getline(in, line);) {
+    unsigned id = 0;
+    unsigned long long c = 0;
+    unsigned long long i = 0;
+    if (std::sscanf(line.c_str(), "mark %u: cycle %llu, instret %llu", &id, &c, &i) == 3) {
+      marks.push_back({id, i, c});
+    }
+    size_t at = line.find_first_not_of(' ', 5);
+    if (line.rfind("stop:", 0) == 0 && at != std::string::npos) stop = line.substr(at);
+    std::sscanf(line.c_str(), "instret: %llu", &insts);
+    std::sscanf(line.c_str(), "cycles: %llu", &cycles);
+  }
+  ResultFromMarks(marks, cycles, insts, &r);
+  if (rc == 1) r.note = stop.empty() ? "no stop marker" : stop;
+  return r;
+}
+
+}  // namespace e203sim
@@ -0,0 +1,100 @@
+// The batch runs of e203sweep and e203farm: a program run on a timing model
+// or on a Verilator build of the RTL, with its counts and its self-check
+// taken from the simulation markers, and the cache of the RTL builds.
+#ifndef E203SIM_BATCH_H
+#define E203SIM_BATCH_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "hart.h"
+#include "sweep.h"
+#include "timing.h"
+
+namespace e203sim {
+
+class ElfImage;
+struct Machine;
+
+// The markers of benchmark/coremark/e203_sim.h
+constexpr uint32_t kMarkStart = 1;
+constexpr uint32_t kMarkEnd = 2;
+constexpr uint32_t kMarkPass = 3;
+constexpr uint32_t kMarkFail = 4;
+
+enum class RunCheck { kNone, kPass, kFail };
+
+struct RunResult {
+  bool ok = false;
+  std::string note;        // Why the run failed or stopped early
+  uint64_t cycles = 0;     // Between the markers 1 and 2, else of the whole run
+  uint64_t insts = 0;
+  uint64_t run_cycles = 0;  // Of the whole run
+  RunCheck check = RunCheck::kNone;
+};
+
+// "PASS", "FAIL" or "-"
+const char* RunCheckName(const RunResult& r);
+
+// Fill the counts and the check of r from the markers of a run and its
+// totals
+void ResultFromMarks(const std::vector<MarkEvent>& marks, uint64_t cycles, uint64_t insts,
+                     RunResult* r);
+
+// A 32-bit word of the program to set before it runs, e.g., a CoreMark seed
+// (seed1_volatile=0x3415)
+struct SymbolPatch {
+  std::string symbol;
+  uint32_t value;
+};
+
+// Parse SYMBOL=VALUE, false if it is not one
+bool ParseSymbolPatch(const std::string& s, SymbolPatch* p);
+
+// Load the program into a machine just built and apply the patches at the
+// load addresses of their symbols, so the startup code copies them with
+// the rest of .data. Resets the hart to the entry.
+bool LoadProgram(const ElfImage& elf, const std::vector<SymbolPatch>& patches, Machine* m,
+                 std::string* err);
+
+// Run the program on a timing model to its end (or max_insts), the UART
+// output to uart_out (may be null)
+RunResult RunIss(const ElfImage& elf, const std::vector<SymbolPatch>& patches,
+                 const std::string& model, const ModelOptions& opts, uint64_t max_insts,
+                 FILE* uart_out);
+
+// One Verilator model of e203_ckpt in the build cache
+struct RtlBuild {
+  std::vector<std::string> defines;
+  std::string dir;  // cache/<hash>
+  std::string log;  // The log of the step that failed
+  bool ok = false;
+  bool cached = false;
+  double secs = 0;
+};
+
+// The hash of everything a build depends on but its defines: sim/, core/
+// and the HBirdv2 RTL
+bool HashRtlSources(const std::string& rtl_dir, Fnv64* h, std::string* err);
+
+// The build of the defines (sorted) in the cache, built if its directory
+// holds a finished build
+RtlBuild CachedRtlBuild(const std::string& cache, const Fnv64& sources,
+                        const std::vector<std::string>& defines);
+
+// Configure and build e203_ckpt into b->dir with make_jobs jobs, unless
+// it is cached. The batch runs do not trace, so neither does the model.
+void BuildRtlModel(const std::string& rtl_dir, unsigned make_jobs, RtlBuild* b);
+
+// An e203_ckpt run from the reset, with the memories of plusargs (+ELF=,
+// or +ITCM= and +DTCM=), to the pass/fail marker or max_cycles; its output goes to log.
+// A run that stopped elsewhere has the stop of e203_ckpt as its note (the
+// cycle limit, $finish), one that failed is not ok
+RunResult RunRtl(const RtlBuild& b, const std::vector<std::string>& plusargs,
+                 uint64_t max_cycles, const std::string& log);
+
+}  // namespace e203sim
+
+#endif  // E203SIM_BATCH_H
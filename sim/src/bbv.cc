@@ -0,0 +1,66 @@
+#include "bbv.h"
+
+#include <cinttypes>
+
+namespace e203sim {
+
+BbvProfiler::BbvProfiler(std::unique_ptr<TimingModel> inner, uint64_t interval, FILE* out)
+    : inner_(std::move(inner)), interval_(interval), out_(out) {}
+
+void BbvProfiler::Retire(const RetireInfo& r) {
+  inner_->Retire(r);
+
+  if (block_len_ == 0) block_pc_ = r.pc;
+  block_len_++;
+  in_interval_++;
+
+  Cls c = r.inst->cls;
+  bool ends = c == Cls::kBranch || c == Cls::kJal || c == Cls::kJalr || c == Cls::kSystem ||
+              c == Cls::kFenceI || r.next_pc != r.pc + r.inst->len;
+  if (ends || in_interval_ == interval_) EndBlock();
+  if (in_interval_ == interval_) EndInterval();
+}
+
+void BbvProfiler::Trap(uint32_t pc, uint32_t handler) {
+  inner_->Trap(pc, handler);
+  EndBlock();
+}
+
+void BbvProfiler::EndBlock() {
+  if (block_len_ == 0) return;
+  auto it = ids_.find(block_pc_);
+  if (it == ids_.end()) {
+    it = ids_.emplace(block_pc_, static_cast<uint32_t>(ids_.size() + 1)).first;
+    counts_.push_back(0);
+  }
+  uint32_t id = it->second;
+  if (counts_[id - 1] == 0) touched_.push_back(id);
+  counts_[id - 1] += block_len_;
+  block_len_ = 0;
+}
+
+void BbvProfiler::EndInterval() {
+  std::fputc('T', out_);
+  for (uint32_t id : touched_) {
+    std::fprintf(out_, ":%u:%" PRIu64 " ", id, counts_[id - 1]);
+    counts_[id - 1] = 0;
+  }
+  std::fputc('\n', out_);
+  touched_.clear();
+  in_interval_ = 0;
+  intervals_++;
+}
+
+void BbvProfiler::Flush() {
+  EndBlock();
+  if (in_interval_ != 0) EndInterval();
+  std::fflush(out_);
+}
+
+void BbvProfiler::PrintStats(FILE* out) const {
+  std::fprintf(out, "bbv: %" PRIu64 " intervals of %" PRIu64 " instructions, %zu blocks\n",
+               intervals_, interval_, ids_.size());
+  inner_->PrintStats(out);
+}
+
+}  // namespace e203sim
@@ -0,0 +1,59 @@
+// The basic-block vector (BBV) profiler of the sampled simulation.
+//
+// It wraps a timing model and, for every interval of a fixed number of
+// retired instructions, counts the instructions executed in each basic
+// block. The intervals are written in the SimPoint .bb format, one line per
+// interval:
+//   T:id:count :id:count ...
+// where id numbers the blocks from 1 in the order they are first seen.
+#ifndef E203SIM_BBV_H
+#define E203SIM_BBV_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "timing.h"
+
+namespace e203sim {
+
+class BbvProfiler : public TimingModel {
+ public:
+  // out is written as the intervals end, inner keeps the time
+  BbvProfiler(std::unique_ptr<TimingModel> inner, uint64_t interval, FILE* out);
+
+  void Retire(const RetireInfo& r) override;
+  void Trap(uint32_t pc, uint32_t handler) override;
+  uint64_t Cycles() const override { return inner_->Cycles(); }
+  DispatchStall LastStall() const override { return inner_->LastStall(); }
+  void PrintStats(FILE* out) const override;
+
+  // Write the last, partial interval
+  void Flush();
+
+  uint64_t intervals() const { return intervals_; }
+  size_t blocks() const { return ids_.size(); }
+
+ private:
+  void EndBlock();
+  void EndInterval();
+
+  std::unique_ptr<TimingModel> inner_;
+  uint64_t interval_;
+  FILE* out_;
+
+  std::unordered_map<uint32_t, uint32_t> ids_;  // Block start pc -> id
+  std::vector<uint64_t> counts_;                // By id, for this interval
+  std::vector<uint32_t> touched_;               // The ids counted in this interval
+
+  uint32_t block_pc_ = 0;
+  uint64_t block_len_ = 0;
+  uint64_t in_interval_ = 0;
+  uint64_t intervals_ = 0;
+};
+
+}  // namespace e203sim
+
+#endif  // E203SIM_BBV_H
@@ -0,0 +1,439 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+#include "decode.h"
+#include "machine.h"
+#include "timing_e203.h"
+
+namespace e203sim {
+
+namespace {
+
+constexpr char kMagic[8] = {'E', '2', '0', '3', 'C', 'K', 'P', '2'};
+
+void Put32(std::string* s, uint32_t v) {
+  for (int i = 0; i < 4; i++) s->push_back(static_cast<char>(v >> (8 * i)));
+}
+
+void Put64(std::string* s, uint64_t v) {
+  Put32(s, static_cast<uint32_t>(v));
+  Put32(s, static_cast<uint32_t>(v >> 32));
+}
+
+class Reader {
+ public:
+  Reader(const std::string& s) : s_(s) {}
+
+  bool Get32(uint32_t* v) {
+    if (pos_ + 4 > s_.size()) return false;
+    *v = 0;
+    for (int i = 0; i < 4; i++) *v |= uint32_t{static_cast<uint8_t>(s_[pos_ + i])} << (8 * i);
+    pos_ += 4;
+    return true;
+  }
+
+  bool Get64(uint64_t* v) {
+    uint32_t lo, hi;
+    if (!Get32(&lo) || !Get32(&hi)) return false;
+    *v = (uint64_t{hi} << 32) | lo;
+    return true;
+  }
+
+  const char* Take(size_t n) {
+    if (pos_ + n > s_.size()) return nullptr;
+    const char* p = s_.data() + pos_;
+    pos_ += n;
+    return p;
+  }
+
+ private:
+  const std::string& s_;
+  size_t pos_ = 0;
+};
+
+// The few RV32I encodings of the restore stub
+uint32_t Lui(int rd, uint32_t imm20) { return (imm20 << 12) | (rd << 7) | 0x37; }
+uint32_t Addi(int rd, int rs1, int32_t imm) {
+  return ((static_cast<uint32_t>(imm) & 0xfff) << 20) | (rs1 << 15) | (rd << 7) | 0x13;
+}
+uint32_t Lw(int rd, int rs1, int32_t imm) {
+  return ((static_cast<uint32_t>(imm) & 0xfff) << 20) | (rs1 << 15) | (2 << 12) | (rd << 7) | 0x03;
+}
+uint32_t Sw(int rs2, int rs1, int32_t imm) {
+  uint32_t i = static_cast<uint32_t>(imm) & 0xfff;
+  return ((i >> 5) << 25) | (rs2 << 20) | (rs1 << 15) | (2 << 12) | ((i & 0x1f) << 7) | 0x23;
+}
+uint32_t Csrw(uint32_t csr, int rs1) { return (csr << 20) | (rs1 << 15) | (1 << 12) | 0x73; }
+uint32_t Csrsi(uint32_t csr, uint32_t uimm) { return (csr << 20) | (uimm << 15) | (6 << 12) | 0x73; }
+uint32_t Jal(int rd, int32_t off) {
+  uint32_t i = static_cast<uint32_t>(off);
+  return (((i >> 20) & 1) << 31) | (((i >> 1) & 0x3ff) << 21) | (((i >> 11) & 1) << 20) |
+         (((i >> 12) & 0xff) << 12) | (rd << 7) | 0x6f;
+}
+constexpr uint32_t kFenceI = 0x0000100f;
+constexpr uint32_t kMstatusMie = 0x8;
+
+// li rd, v as lui + addi, always two instructions so the stub size is fixed
+void Li(std::vector<uint32_t>* code, int rd, uint32_t v) {
+  code->push_back(Lui(rd, ((v + 0x800) >> 12) & 0xfffff));
+  code->push_back(Addi(rd, rd, static_cast<int32_t>(v << 20) >> 20));
+}
+
+// The cycles the e203 model with its defaults takes from the dispatch of
+// code[from] to the one of the program after the final jal of the stub.
+// The instructions before it are run first, for the stalls they cause
+uint64_t StubCycles(const std::vector<uint32_t>& code, size_t from) {
+  std::unique_ptr<TimingModel> t = MakeE203Timing(E203TimingConfig());
+  uint64_t base = 0;
+  for (size_t k = 0; k < code.size(); k++) {
+    if (k == from) base = t->Cycles();
+    Inst in = Decode(code[k]);
+    bool jump = in.cls == Cls::kJal;
+    uint32_t pc = 4 * static_cast<uint32_t>(k);
+    t->Retire(RetireInfo{&in, pc, jump ? pc + static_cast<uint32_t>(in.imm) : pc + 4, 0, jump});
+  }
+  return t->Cycles() - base;
+}
+
+std::vector<uint8_t> Image(const Machine& m, uint32_t base, uint32_t size) {
+  std::vector<uint8_t> img(size, 0);
+  m.mem.ForEachPage([&](uint32_t addr, const uint8_t* page) {
+    for (uint32_t i = 0; i < Memory::kPageSize; i++) {
+      uint32_t a = addr + i;
+      if (a - base < size) img[a - base] = page[i];
+    }
+  });
+  return img;
+}
+
+bool WriteHex(const std::string& path, const std::vector<uint8_t>& img, std::string* err) {
+  FILE* f = std::fopen(path.c_str(), "w");
+  if (f == nullptr) {
+    *err = "cannot write " + path;
+    return false;
+  }
+  std::fprintf(f, "@00000000\n");
+  for (size_t i = 0; i < img.size(); i++) {
+    std::fprintf(f, "%02X%c", img[i], (i % 16 == 15) ? '\n' : ' ');
+  }
+  std::fclose(f);
+  return true;
+}
+
+bool ReadHex(const std::string& path, Memory* mem, uint32_t base, uint32_t size, std::string* err) {
+  std::ifstream in(path);
+  if (!in) {
+    *err = "cannot open " + path;
+    return false;
+  }
+  std::string tok;
+  uint32_t addr = 0;
+  while (in >> tok) {
+    char* end = nullptr;
+    bool at = tok[0] == '@';
+    unsigned long v = std::strtoul(tok.c_str() + (at ? 1 : 0), &end, 16);
+    if (*end != '\0' || (!at && v > 0xff)) {
+      *err = path + ": bad token " + tok;
+      return false;
+    }
+    if (at) {
+      addr = static_cast<uint32_t>(v);
+      continue;
+    }
+    if (addr >= size) {
+      *err = path + ": past the end of the memory";
+      return false;
+    }
+    mem->Write<uint8_t>(base + addr++, static_cast<uint8_t>(v));
+  }
+  return true;
+}
+
+}  // namespace
+
+bool SaveCheckpoint(const std::string& path, const Machine& m, uint64_t position, std::string* err) {
+  const Hart& h = m.hart;
+  const HartCsrs& c = h.csrs();
+  std::string s(kMagic, sizeof(kMagic));
+  Put64(&s, position);
+  Put32(&s, h.pc());
+  for (int i = 0; i < 32; i++) Put32(&s, h.x(i));
+  for (uint32_t v : {c.mstatus, c.mie, c.mtvec, c.mscratch, c.mepc, c.mcause, c.mtval}) Put32(&s, v);
+  Put64(&s, h.Cycles() + c.mcycle_ofs);
+  Put64(&s, h.instret() + c.minstret_ofs);
+  Put32(&s, m.clint.msip() ? 1 : 0);
+  Put64(&s, m.clint.mtimecmp());
+  Put64(&s, m.clint.mtime());
+
+  std::string pages;
+  uint32_t npages = 0;
+  m.mem.ForEachPage([&](uint32_t addr, const uint8_t* page) {
+    Put32(&pages, addr);
+    pages.append(reinterpret_cast<const char*>(page), Memory::kPageSize);
+    npages++;
+  });
+  Put32(&s, npages);
+  s += pages;
+
+  std::ofstream out(path, std::ios::binary);
+  out.write(s.data(), static_cast<std::streamsize>(s.size()));
+  if (!out) {
+    *err = "cannot write " + path;
+    return false;
+  }
+  return true;
+}
+
+bool LoadCheckpoint(const std::string& path, Machine* m, uint64_t* position, std::string* err) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    *err = "cannot open " + path;
+    return false;
+  }
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::string s = ss.str();
+  Reader r(s);
+
+  const char* magic = r.Take(sizeof(kMagic));
+  if (magic == nullptr || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    *err = path + ": not a checkpoint";
+    return false;
+  }
+  uint32_t pc = 0;
+  uint32_t x[32];
+  HartCsrs c;
+  uint64_t mcycle = 0, minstret = 0;
+  uint32_t msip = 0;
+  uint64_t mtimecmp = 0, mtime = 0;
+  uint32_t npages = 0;
+  bool ok = r.Get64(position) && r.Get32(&pc);
+  for (int i = 0; i < 32 && ok; i++) ok = r.Get32(&x[i]);
+  for (uint32_t* v : {&c.mstatus, &c.mie, &c.mtvec, &c.mscratch, &c.mepc, &c.mcause, &c.mtval}) {
+    ok = ok && r.Get32(v);
+  }
+  ok = ok && r.Get64(&mcycle) && r.Get64(&minstret);
+  ok = ok && r.Get32(&msip) && r.Get64(&mtimecmp) && r.Get64(&mtime) && r.Get32(&npages);
+  for (uint32_t i = 0; i < npages && ok; i++) {
+    uint32_t addr = 0;
+    const char* data = nullptr;
+    ok = r.Get32(&addr) && (data = r.Take(Memory::kPageSize)) != nullptr;
+    if (ok) m->mem.WriteBlock(addr, data, Memory::kPageSize);
+  }
+  if (!ok) {
+    *err = path + ": truncated";
+    return false;
+  }
+
+  Hart& h = m->hart;
+  h.Reset(pc);
+  for (int i = 1; i < 32; i++) h.set_x(i, x[i]);
+  // The counters go on from the checkpoint values
+  c.mcycle_ofs = mcycle - h.Cycles();
+  c.minstret_ofs = minstret - h.instret();
+  h.set_csrs(c);
+  // mtime after the counters, it is derived from the cycles
+  m->clint.Write(0x0000, 4, msip);
+  m->clint.Write(0x4000, 4, static_cast<uint32_t>(mtimecmp));
+  m->clint.Write(0x4004, 4, static_cast<uint32_t>(mtimecmp >> 32));
+  m->clint.Write(0xbff8, 4, static_cast<uint32_t>(mtime));
+  m->clint.Write(0xbffc, 4, static_cast<uint32_t>(mtime >> 32));
+  return true;
+}
+
+bool WriteRtlImages(const std::string& prefix, const Machine& m, const RtlLayout& layout,
+                    uint32_t* stub_jal_pc, std::string* err) {
+  const Hart& h = m.hart;
+  const HartCsrs& c = h.csrs();
+  std::vector<uint8_t> itcm = Image(m, layout.itcm_base, layout.itcm_size);
+  std::vector<uint8_t> dtcm = Image(m, layout.dtcm_base, layout.dtcm_size);
+
+  uint32_t stub = layout.stub_addr ? layout.stub_addr : layout.itcm_base + layout.itcm_size - kStubBytes;
+  uint32_t stub_ofs = stub - layout.itcm_base;
+  uint32_t reset_ofs = layout.reset_pc - layout.itcm_base;
+  char buf[160];
+  if (stub_ofs > layout.itcm_size - kStubBytes || (stub & 3) != 0 || reset_ofs > layout.itcm_size - 4) {
+    std::snprintf(buf, sizeof(buf), "the stub (0x%08x) and the reset vector must be in the ITCM", stub);
+    *err = buf;
+    return false;
+  }
+  for (uint32_t i = 0; i < kStubBytes; i++) {
+    if (itcm[stub_ofs + i] != 0) {
+      std::snprintf(buf, sizeof(buf), "the stub would overwrite the data at 0x%08x, move it", stub + i);
+      *err = buf;
+      return false;
+    }
+  }
+
+  uint32_t reset_word;
+  std::memcpy(&reset_word, &itcm[reset_ofs], 4);
+  uint64_t mcycle = h.Cycles() + c.mcycle_ofs;
+  uint64_t minstret = h.instret() + c.minstret_ofs;
+  uint64_t mtimecmp = m.clint.mtimecmp();
+  uint64_t mtime = m.clint.mtime();
+
+  // All the values are loaded from a save area right after the code: the
+  // registers at 4 * i, then the other values. x31 holds its base, x5/x6
+  // are the scratch registers until the registers themselves are loaded.
+  std::vector<uint32_t> vals;
+  for (int i = 0; i < 32; i++) vals.push_back(h.x(i));
+  auto val = [&vals](uint32_t v) {
+    vals.push_back(v);
+    return static_cast<int32_t>(4 * (vals.size() - 1));
+  };
+
+  std::vector<uint32_t> code;
+  Li(&code, 5, reset_word);
+  Li(&code, 6, layout.reset_pc);
+  code.push_back(Sw(5, 6, 0));
+  code.push_back(kFenceI);
+  size_t area_li = code.size();
+  Li(&code, 31, 0);  // Patched below
+
+  const std::pair<uint32_t, uint32_t> csrs[] = {
+      {0x305, c.mtvec}, {0x340, c.mscratch}, {0x341, c.mepc}, {0x342, c.mcause},
+      {0x343, c.mtval},
+  };
+  for (const auto& cv : csrs) {
+    code.push_back(Lw(5, 31, val(cv.second)));
+    code.push_back(Csrw(cv.first, 5));
+  }
+
+  // The CLINT, mtimecmp before msip and mtime, with the interrupts still
+  // disabled by the reset mstatus. x6 is the base of each register group
+  const std::pair<uint32_t, std::vector<std::pair<int32_t, uint32_t>>> clint[] = {
+      {0x4000, {{0, static_cast<uint32_t>(mtimecmp)}, {4, static_cast<uint32_t>(mtimecmp >> 32)}}},
+      {0x0000, {{0, m.clint.msip() ? 1u : 0u}}},
+      {0xbff8, {{4, static_cast<uint32_t>(mtime >> 32)}, {0, static_cast<uint32_t>(mtime)}}},
+  };
+  for (const auto& group : clint) {
+    Li(&code, 6, Clint::kBase + group.first);
+    for (const auto& rv : group.second) {
+      code.push_back(Lw(5, 31, val(rv.second)));
+      code.push_back(Sw(5, 6, rv.first));
+    }
+  }
+
+  for (int i = 1; i < 30; i++) code.push_back(Lw(i, 31, 4 * i));
+
+  // The counters, mie and mstatus last, with x30 as the scratch. mstatus
+  // is written with MIE clear, the csrsi right before the jal sets it, so
+  // no interrupt is taken in the stub before the registers are back. The
+  // counters are written minus what the stub takes from their write on
+  // (the write included, as e203sim counts it), so the program reads on
+  // from the checkpoint values
+  const uint32_t tail[] = {0xb80, 0xb82, 0xb00, 0xb02, 0x304, 0x300};
+  size_t tail_at = code.size();
+  for (uint32_t csr : tail) {
+    code.push_back(Lw(30, 31, 0));  // Patched below
+    code.push_back(Csrw(csr, 30));
+  }
+  code.push_back(Lw(30, 31, 4 * 30));
+  code.push_back(Lw(31, 31, 4 * 31));
+  if (c.mstatus & kMstatusMie) code.push_back(Csrsi(0x300, kMstatusMie));
+  uint32_t jal_pc = stub + 4 * static_cast<uint32_t>(code.size());
+  int64_t off = int64_t{h.pc()} - int64_t{jal_pc};
+  if (off < -(1 << 20) || off >= (1 << 20)) {
+    std::snprintf(buf, sizeof(buf), "the pc 0x%08x is out of the jal range of the stub", h.pc());
+    *err = buf;
+    return false;
+  }
+  code.push_back(Jal(0, static_cast<int32_t>(off)));
+
+  size_t mcycle_csrw = tail_at + 2 * 2 + 1;
+  size_t minstret_csrw = tail_at + 3 * 2 + 1;
+  uint64_t mcycle_wr = mcycle - StubCycles(code, mcycle_csrw);
+  uint64_t minstret_wr = minstret - (code.size() - minstret_csrw);
+  const uint32_t tail_vals[] = {
+      static_cast<uint32_t>(mcycle_wr >> 32), static_cast<uint32_t>(minstret_wr >> 32),
+      static_cast<uint32_t>(mcycle_wr), static_cast<uint32_t>(minstret_wr), c.mie,
+      c.mstatus & ~kMstatusMie,
+  };
+  for (size_t k = 0; k < 6; k++) code[tail_at + 2 * k] = Lw(30, 31, val(tail_vals[k]));
+
+  uint32_t area = stub + 4 * static_cast<uint32_t>(code.size());
+  code[area_li] = Lui(31, ((area + 0x800) >> 12) & 0xfffff);
+  code[area_li + 1] = Addi(31, 31, static_cast<int32_t>(area << 20) >> 20);
+  code.insert(code.end(), vals.begin(), vals.end());
+  if (code.size() * 4 > kStubBytes) {
+    *err = "the stub is too big";
+    return false;
+  }
+
+  std::memcpy(&itcm[stub_ofs], code.data(), code.size() * 4);
+  uint32_t jump = Jal(0, static_cast<int32_t>(stub - layout.reset_pc));
+  std::memcpy(&itcm[reset_ofs], &jump, 4);
+
+  *stub_jal_pc = jal_pc;
+  return WriteHex(prefix + ".itcm.verilog", itcm, err) &&
+         WriteHex(prefix + ".dtcm.verilog", dtcm, err);
+}
+
+bool WriteMemoryImages(const std::string& prefix, const Machine& m, const RtlLayout& layout,
+                       std::string* err) {
+  return WriteHex(prefix + ".itcm.verilog", Image(m, layout.itcm_base, layout.itcm_size), err) &&
+         WriteHex(prefix + ".dtcm.verilog", Image(m, layout.dtcm_base, layout.dtcm_size), err);
+}
+
+bool LoadRtlImages(const std::string& prefix, Machine* m, const RtlLayout& layout, std::string* err) {
+  if (!ReadHex(prefix + ".itcm.verilog", &m->mem, layout.itcm_base, layout.itcm_size, err) ||
+      !ReadHex(prefix + ".dtcm.verilog", &m->mem, layout.dtcm_base, layout.dtcm_size, err)) {
+    return false;
+  }
+  m->hart.Reset(layout.reset_pc);
+  return true;
+}
+
+bool WriteManifest(const std::string& path, const std::vector<ManifestEntry>& entries,
+                   std::string* err) {
+  FILE* f = std::fopen(path.c_str(), "w");
+  if (f == nullptr) {
+    *err = "cannot write " + path;
+    return false;
+  }
+  std::fprintf(f, "# name interval weight position warmup window stub_jal_pc\n");
+  for (const ManifestEntry& e : entries) {
+    std::fprintf(f, "%s %llu %.6f %llu %llu %llu 0x%08x\n", e.name.c_str(),
+                 static_cast<unsigned long long>(e.interval), e.weight,
+                 static_cast<unsigned long long>(e.position), static_cast<unsigned long long>(e.warmup),
+                 static_cast<unsigned long long>(e.window), e.stub_jal_pc);
+  }
+  std::fclose(f);
+  return true;
+}
+
+bool ReadManifest(const std::string& path, std::vector<ManifestEntry>* entries, std::string* err) {
+  std::ifstream in(path);
+  if (!in) {
+    *err = "cannot open " + path;
+    return false;
+  }
+  entries->clear();
+  std::string line;
+  int lineno = 0;
+  while (std::getline(in, line)) {
+    lineno++;
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream ls(line);
+    ManifestEntry e;
+    std::string jal;
+    if (!(ls >> e.name >> e.interval >> e.weight >> e.position >> e.warmup >> e.window >> jal)) {
+      *err = path + ": bad line " + std::to_string(lineno);
+      return false;
+    }
+    e.stub_jal_pc = static_cast<uint32_t>(std::strtoul(jal.c_str(), nullptr, 0));
+    entries->push_back(e);
+  }
+  if (entries->empty()) {
+    *err = path + ": no checkpoint";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace e203sim
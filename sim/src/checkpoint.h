@@ -0,0 +1,76 @@
+// The architectural checkpoints of the sampled simulation.
+//
+// A checkpoint is the state a program needs to go on from an instruction:
+// the registers, the pc, the machine CSRs, the CLINT and the RAM pages. It
+// is written twice:
+//   * As a .ckpt file, which e203sim restores to run a detailed window with
+//     a timing model.
+//   * As the ITCM/DTCM images of the RTL testbench ($readmemh, the same
+//     .verilog format as the HBirdv2 tb_top loads). A restore stub is put in
+//     an unused part of the ITCM, the reset vector jumps to it, and it puts
+//     back the reset vector word, the CSRs, the CLINT and the registers,
+//     then the counters (less what the rest of the stub takes), mie and
+//     mstatus, its MIE set by the instruction before the jump to the
+//     checkpoint pc. The RTL only needs its memories loaded.
+#ifndef E203SIM_CHECKPOINT_H
+#define E203SIM_CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace e203sim {
+
+struct Machine;
+
+bool SaveCheckpoint(const std::string& path, const Machine& m, uint64_t position, std::string* err);
+
+// Restore into a machine just built, position gets the instruction count the
+// checkpoint was taken at
+bool LoadCheckpoint(const std::string& path, Machine* m, uint64_t* position, std::string* err);
+
+// The HBirdv2 memory map the RTL images are made for
+struct RtlLayout {
+  uint32_t itcm_base = 0x80000000;
+  uint32_t itcm_size = 0x10000;
+  uint32_t dtcm_base = 0x90000000;
+  uint32_t dtcm_size = 0x10000;
+  uint32_t reset_pc = 0x80000000;
+  uint32_t stub_addr = 0;  // 0: the top kStubBytes of the ITCM
+};
+
+constexpr uint32_t kStubBytes = 512;
+
+// Write prefix.itcm.verilog and prefix.dtcm.verilog, stub_jal_pc gets the pc
+// of the last stub instruction, after which the program itself runs. Fails
+// if the stub would overwrite non-zero bytes, or the pc is out of the ITCM.
+bool WriteRtlImages(const std::string& prefix, const Machine& m, const RtlLayout& layout,
+                    uint32_t* stub_jal_pc, std::string* err);
+
+// Write prefix.itcm.verilog and prefix.dtcm.verilog of the memory as it is,
+// e.g., a program loaded from its ELF, to boot from the reset
+bool WriteMemoryImages(const std::string& prefix, const Machine& m, const RtlLayout& layout,
+                       std::string* err);
+
+// Load the images written by WriteRtlImages, e.g., to check them on
+// e203sim before running the RTL
+bool LoadRtlImages(const std::string& prefix, Machine* m, const RtlLayout& layout, std::string* err);
+
+// The manifest of a checkpoint directory, one line per checkpoint
+struct ManifestEntry {
+  std::string name;     // The files are dir/name.ckpt, dir/name.itcm.verilog, ...
+  uint64_t interval;
+  double weight;
+  uint64_t position;    // The instruction count of the checkpoint
+  uint64_t warmup;      // The instructions to run before the window
+  uint64_t window;      // The instructions to measure
+  uint32_t stub_jal_pc;
+};
+
+bool WriteManifest(const std::string& path, const std::vector<ManifestEntry>& entries,
+                   std::string* err);
+bool ReadManifest(const std::string& path, std::vector<ManifestEntry>* entries, std::string* err);
+
+}  // namespace e203sim
+
+#endif  // E203SIM_CHECKPOINT_H
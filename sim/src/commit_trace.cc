@@ -0,0 +1,99 @@
+#include "commit_trace.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace e203sim {
+
+namespace {
+
+constexpr size_t kBufRecords = 1 << 14;
+
+}  // namespace
+
+CommitTraceWriter::CommitTraceWriter(std::unique_ptr<TimingModel> inner, FILE* out)
+    : inner_(std::move(inner)), out_(out) {
+  uint8_t header[kCommitTraceHeader] = {};
+  std::memcpy(header, kCommitTraceMagic, sizeof(kCommitTraceMagic));
+  uint32_t size = sizeof(CommitRecord);
+  std::memcpy(header + 8, &size, sizeof(size));
+  ok_ = std::fwrite(header, sizeof(header), 1, out_) == 1;
+  buf_.reserve(kBufRecords);
+}
+
+void CommitTraceWriter::Retire(const RetireInfo& r) {
+  inner_->Retire(r);
+
+  const Inst& in = *r.inst;
+  CommitRecord c{};
+  c.pc = r.pc;
+  c.inst = in.raw;
+  c.cycle = inner_->Cycles();
+  c.rd = in.rd;
+  c.rs1 = in.rs1;
+  c.rs2 = in.rs2;
+  if (in.cls == Cls::kLoad || in.cls == Cls::kAmo) c.flags |= kCommitLoad;
+  if (in.cls == Cls::kStore || (in.cls == Cls::kAmo && in.op != Op::kLrW)) {
+    c.flags |= kCommitStore;
+  }
+  if (in.rd_wen) c.flags |= kCommitRdWen;
+  if (in.rs1_en) c.flags |= kCommitRs1En;
+  if (in.rs2_en) c.flags |= kCommitRs2En;
+  if (in.len == 2) c.flags |= kCommitRvc;
+  c.stall = PackCommitStall(inner_->LastStall());
+  buf_.push_back(c);
+  if (buf_.size() == kBufRecords) Flush();
+}
+
+bool CommitTraceWriter::Flush() {
+  if (!buf_.empty()) {
+    ok_ &= std::fwrite(buf_.data(), sizeof(CommitRecord), buf_.size(), out_) == buf_.size();
+    records_ += buf_.size();
+    buf_.clear();
+  }
+  return ok_;
+}
+
+CommitTrace::~CommitTrace() {
+  if (map_ != nullptr) munmap(const_cast<uint8_t*>(map_), map_size_);
+}
+
+bool CommitTrace::Open(const std::string& path, std::string* err) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    *err = "cannot open " + path;
+    return false;
+  }
+  struct stat st;
+  void* map = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (map == MAP_FAILED) {
+    *err = "cannot map " + path;
+    return false;
+  }
+  map_ = static_cast<const uint8_t*>(map);
+  map_size_ = static_cast<size_t>(st.st_size);
+  // Read once front to back, by the threads of each chunk
+  madvise(map, map_size_, MADV_SEQUENTIAL);
+
+  uint32_t size = 0;
+  if (map_size_ >= kCommitTraceHeader) std::memcpy(&size, map_ + 8, sizeof(size));
+  if (map_size_ < kCommitTraceHeader ||
+      std::memcmp(map_, kCommitTraceMagic, sizeof(kCommitTraceMagic)) != 0 ||
+      size != sizeof(CommitRecord)) {
+    *err = path + ": not a commit trace of this version";
+    return false;
+  }
+  records_ = reinterpret_cast<const CommitRecord*>(map_ + kCommitTraceHeader);
+  size_ = (map_size_ - kCommitTraceHeader) / sizeof(CommitRecord);
+  return true;
+}
+
+}  // namespace e203sim
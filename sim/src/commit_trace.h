@@ -0,0 +1,107 @@
+// The commit trace of the E203 simulator: one fixed-size record per
+// retired instruction, with the cycle the timing model retired it in and
+// its dispatch stall, for the offline analyses of e203hazard.
+//
+// The file is a 16-byte header ("E203CMT2", the record size, 0) and the
+// records, little-endian as the host writes them, so a reader maps the file
+// and indexes it without parsing.
+#ifndef E203SIM_COMMIT_TRACE_H
+#define E203SIM_COMMIT_TRACE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "timing.h"
+
+namespace e203sim {
+
+enum CommitFlags : uint8_t {
+  kCommitLoad = 1 << 0,   // A load, lr or AMO
+  kCommitStore = 1 << 1,  // A store, sc or AMO
+  kCommitRdWen = 1 << 2,
+  kCommitRs1En = 1 << 3,
+  kCommitRs2En = 1 << 4,
+  kCommitRvc = 1 << 5,    // Compressed, inst is its 32-bit expansion
+};
+
+struct CommitRecord {
+  uint32_t pc;
+  uint32_t inst;   // The 32-bit encoding (expanded, see kCommitRvc)
+  uint64_t cycle;  // Of the timing model, after the instruction retired
+  uint8_t rd;
+  uint8_t rs1;
+  uint8_t rs2;
+  uint8_t flags;
+  uint32_t stall;  // The dispatch stall (timing.h), see PackCommitStall
+};
+
+static_assert(sizeof(CommitRecord) == 24, "the record layout is the file format");
+
+// The stall cycles (saturated) in the low 24 bits, the cause in the high 8
+constexpr uint32_t kCommitStallCycles = (1u << 24) - 1;
+
+inline uint32_t PackCommitStall(const DispatchStall& s) {
+  return std::min(s.cycles, kCommitStallCycles) | (static_cast<uint32_t>(s.cause) << 24);
+}
+inline uint32_t CommitStallCycles(const CommitRecord& c) { return c.stall & kCommitStallCycles; }
+inline StallCause CommitStallCause(const CommitRecord& c) {
+  return static_cast<StallCause>(c.stall >> 24);
+}
+
+constexpr char kCommitTraceMagic[8] = {'E', '2', '0', '3', 'C', 'M', 'T', '2'};
+constexpr size_t kCommitTraceHeader = 16;
+
+// Wraps a timing model and writes a record for every instruction it retires
+class CommitTraceWriter : public TimingModel {
+ public:
+  // Writes the header, check ok() before running
+  CommitTraceWriter(std::unique_ptr<TimingModel> inner, FILE* out);
+
+  void Retire(const RetireInfo& r) override;
+  void Trap(uint32_t pc, uint32_t handler) override { inner_->Trap(pc, handler); }
+  uint64_t Cycles() const override { return inner_->Cycles(); }
+  DispatchStall LastStall() const override { return inner_->LastStall(); }
+  void PrintStats(FILE* out) const override { inner_->PrintStats(out); }
+
+  // Write the buffered records, false if a write failed
+  bool Flush();
+  bool ok() const { return ok_; }
+  uint64_t records() const { return records_; }
+
+ private:
+  std::unique_ptr<TimingModel> inner_;
+  FILE* out_;
+  std::vector<CommitRecord> buf_;
+  uint64_t records_ = 0;
+  bool ok_ = true;
+};
+
+// A commit trace mapped read-only
+class CommitTrace {
+ public:
+  CommitTrace() = default;
+  ~CommitTrace();
+  CommitTrace(const CommitTrace&) = delete;
+  CommitTrace& operator=(const CommitTrace&) = delete;
+
+  // Map and check the file, false with err set on failure
+  bool Open(const std::string& path, std::string* err);
+
+  size_t size() const { return size_; }
+  const CommitRecord& operator[](size_t i) const { return records_[i]; }
+
+ private:
+  const uint8_t* map_ = nullptr;
+  size_t map_size_ = 0;
+  const CommitRecord* records_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace e203sim
+
+#endif  // E203SIM_COMMIT_TRACE_H
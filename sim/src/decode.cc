@@ -0,0 +1,326 @@
+#include "decode.h"
+
+#include <cstddef>
+
+namespace e203sim {
+
+namespace {
+
+inline uint32_t Bits(uint32_t v, int hi, int lo) {
+  return (v >> lo) & ((1u << (hi - lo + 1)) - 1);
+}
+
+inline int32_t Sext(uint32_t v, int bits) {
+  return static_cast<int32_t>(v << (32 - bits)) >> (32 - bits);
+}
+
+uint32_t EncR(uint32_t op, uint32_t rd, uint32_t f3, uint32_t rs1, uint32_t rs2, uint32_t f7) {
+  return (f7 << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | op;
+}
+
+uint32_t EncI(uint32_t op, uint32_t rd, uint32_t f3, uint32_t rs1, int32_t imm) {
+  return ((static_cast<uint32_t>(imm) & 0xfff) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | op;
+}
+
+uint32_t EncS(uint32_t op, uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm) {
+  uint32_t u = static_cast<uint32_t>(imm);
+  return (Bits(u, 11, 5) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (Bits(u, 4, 0) << 7) | op;
+}
+
+uint32_t EncB(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm) {
+  uint32_t u = static_cast<uint32_t>(imm);
+  return (Bits(u, 12, 12) << 31) | (Bits(u, 10, 5) << 25) | (rs2 << 20) | (rs1 << 15) |
+         (f3 << 12) | (Bits(u, 4, 1) << 8) | (Bits(u, 11, 11) << 7) | 0x63;
+}
+
+uint32_t EncU(uint32_t op, uint32_t rd, int32_t imm) {
+  return (static_cast<uint32_t>(imm) & 0xfffff000u) | (rd << 7) | op;
+}
+
+uint32_t EncJ(uint32_t rd, int32_t imm) {
+  uint32_t u = static_cast<uint32_t>(imm);
+  return (Bits(u, 20, 20) << 31) | (Bits(u, 10, 1) << 21) | (Bits(u, 11, 11) << 20) |
+         (Bits(u, 19, 12) << 12) | (rd << 7) | 0x6f;
+}
+
+constexpr uint32_t kOpLoad = 0x03;
+constexpr uint32_t kOpStore = 0x23;
+constexpr uint32_t kOpImm = 0x13;
+constexpr uint32_t kOpReg = 0x33;
+constexpr uint32_t kOpLui = 0x37;
+constexpr uint32_t kOpJalr = 0x67;
+constexpr uint32_t kOpSystem = 0x73;
+
+}  // namespace
+
+uint32_t ExpandRvc(uint16_t c16) {
+  uint32_t c = c16;
+  uint32_t f3 = Bits(c, 15, 13);
+  uint32_t rd = Bits(c, 11, 7);       // Also rs1 of the full-register forms
+  uint32_t rs2 = Bits(c, 6, 2);
+  uint32_t rdp = Bits(c, 4, 2) + 8;   // rd'/rs2'
+  uint32_t rs1p = Bits(c, 9, 7) + 8;  // rs1'/rd'
+
+  switch (Bits(c, 1, 0)) {
+    case 0:
+      switch (f3) {
+        case 0: {  // c.addi4spn
+          uint32_t imm = (Bits(c, 12, 11) << 4) | (Bits(c, 10, 7) << 6) |
+                         (Bits(c, 6, 6) << 2) | (Bits(c, 5, 5) << 3);
+          if (imm == 0) return 0;
+          return EncI(kOpImm, rdp, 0, 2, static_cast<int32_t>(imm));
+        }
+        case 2: {  // c.lw
+          uint32_t imm = (Bits(c, 12, 10) << 3) | (Bits(c, 6, 6) << 2) | (Bits(c, 5, 5) << 6);
+          return EncI(kOpLoad, rdp, 2, rs1p, static_cast<int32_t>(imm));
+        }
+        case 6: {  // c.sw
+          uint32_t imm = (Bits(c, 12, 10) << 3) | (Bits(c, 6, 6) << 2) | (Bits(c, 5, 5) << 6);
+          return EncS(kOpStore, 2, rs1p, rdp, static_cast<int32_t>(imm));
+        }
+        default:
+          return 0;
+      }
+
+    case 1: {
+      int32_t imm6 = Sext((Bits(c, 12, 12) << 5) | Bits(c, 6, 2), 6);
+      int32_t jimm = Sext((Bits(c, 12, 12) << 11) | (Bits(c, 11, 11) << 4) | (Bits(c, 10, 9) << 8) |
+                          (Bits(c, 8, 8) << 10) | (Bits(c, 7, 7) << 6) | (Bits(c, 6, 6) << 7) |
+                          (Bits(c, 5, 3) << 1) | (Bits(c, 2, 2) << 5), 12);
+      int32_t bimm = Sext((Bits(c, 12, 12) << 8) | (Bits(c, 11, 10) << 3) | (Bits(c, 6, 5) << 6) |
+                          (Bits(c, 4, 3) << 1) | (Bits(c, 2, 2) << 5), 9);
+      switch (f3) {
+        case 0:  // c.addi / c.nop
+          return EncI(kOpImm, rd, 0, rd, imm6);
+        case 1:  // c.jal
+          return EncJ(1, jimm);
+        case 2:  // c.li
+          return EncI(kOpImm, rd, 0, 0, imm6);
+        case 3:
+          if (rd == 2) {  // c.addi16sp
+            int32_t imm = Sext((Bits(c, 12, 12) << 9) | (Bits(c, 6, 6) << 4) | (Bits(c, 5, 5) << 6) |
+                               (Bits(c, 4, 3) << 7) | (Bits(c, 2, 2) << 5), 10);
+            if (imm == 0) return 0;
+            return EncI(kOpImm, 2, 0, 2, imm);
+          } else {  // c.lui
+            int32_t imm = Sext((Bits(c, 12, 12) << 17) | (Bits(c, 6, 2) << 12), 18);
+            if (imm == 0) return 0;
+            return EncU(kOpLui, rd, imm);
+          }
+        case 4:
+          switch (Bits(c, 11, 10)) {
+            case 0:  // c.srli
+              if (Bits(c, 12, 12)) return 0;
+              return EncR(kOpImm, rs1p, 5, rs1p, rs2, 0x00);
+            case 1:  // c.srai
+              if (Bits(c, 12, 12)) return 0;
+              return EncR(kOpImm, rs1p, 5, rs1p, rs2, 0x20);
+            case 2:  // c.andi
+              return EncI(kOpImm, rs1p, 7, rs1p, imm6);
+            default:
+              if (Bits(c, 12, 12)) return 0;
+              switch (Bits(c, 6, 5)) {
+                case 0: return EncR(kOpReg, rs1p, 0, rs1p, rdp, 0x20);  // c.sub
+                case 1: return EncR(kOpReg, rs1p, 4, rs1p, rdp, 0x00);  // c.xor
+                case 2: return EncR(kOpReg, rs1p, 6, rs1p, rdp, 0x00);  // c.or
+                default: return EncR(kOpReg, rs1p, 7, rs1p, rdp, 0x00); // c.and
+              }
+          }
+        case 5:  // c.j
+          return EncJ(0, jimm);
+        case 6:  // c.beqz
+          return EncB(0, rs1p, 0, bimm);
+        default:  // c.bnez
+          return EncB(1, rs1p, 0, bimm);
+      }
+    }
+
+    case 2:
+      switch (f3) {
+        case 0:  // c.slli
+          if (Bits(c, 12, 12)) return 0;
+          return EncR(kOpImm, rd, 1, rd, rs2, 0x00);
+        case 2: {  // c.lwsp
+          if (rd == 0) return 0;
+          uint32_t imm = (Bits(c, 12, 12) << 5) | (Bits(c, 6, 4) << 2) | (Bits(c, 3, 2) << 6);
+          return EncI(kOpLoad, rd, 2, 2, static_cast<int32_t>(imm));
+        }
+        case 4:
+          if (Bits(c, 12, 12) == 0) {
+            if (rs2 == 0) {  // c.jr
+              if (rd == 0) return 0;
+              return EncI(kOpJalr, 0, 0, rd, 0);
+            }
+            return EncR(kOpReg, rd, 0, 0, rs2, 0x00);  // c.mv
+          }
+          if (rd == 0 && rs2 == 0) return 0x00100073;  // c.ebreak
+          if (rs2 == 0) return EncI(kOpJalr, 1, 0, rd, 0);  // c.jalr
+          return EncR(kOpReg, rd, 0, rd, rs2, 0x00);  // c.add
+        case 6: {  // c.swsp
+          uint32_t imm = (Bits(c, 12, 9) << 2) | (Bits(c, 8, 7) << 6);
+          return EncS(kOpStore, 2, 2, rs2, static_cast<int32_t>(imm));
+        }
+        default:
+          return 0;
+      }
+
+    default:
+      return 0;
+  }
+}
+
+Inst Decode(uint32_t raw) {
+  Inst d;
+  uint32_t w = raw;
+  if (IsRvc(raw)) {
+    d.len = 2;
+    w = ExpandRvc(static_cast<uint16_t>(raw));
+    if (w == 0) return d;
+  }
+  d.raw = w;
+
+  uint32_t opcode = Bits(w, 6, 0);
+  uint32_t f3 = Bits(w, 14, 12);
+  uint32_t f7 = Bits(w, 31, 25);
+  d.rd = static_cast<uint8_t>(Bits(w, 11, 7));
+  d.rs1 = static_cast<uint8_t>(Bits(w, 19, 15));
+  d.rs2 = static_cast<uint8_t>(Bits(w, 24, 20));
+
+  int32_t imm_i = static_cast<int32_t>(w) >> 20;
+  int32_t imm_s = Sext((Bits(w, 31, 25) << 5) | Bits(w, 11, 7), 12);
+  int32_t imm_b = Sext((Bits(w, 31, 31) << 12) | (Bits(w, 7, 7) << 11) | (Bits(w, 30, 25) << 5) |
+                       (Bits(w, 11, 8) << 1), 13);
+  int32_t imm_u = static_cast<int32_t>(w & 0xfffff000u);
+  int32_t imm_j = Sext((Bits(w, 31, 31) << 20) | (Bits(w, 19, 12) << 12) | (Bits(w, 20, 20) << 11) |
+                       (Bits(w, 30, 21) << 1), 21);
+
+  auto set = [&d](Op op, Cls cls, int32_t imm, bool rd_wen, bool rs1_en, bool rs2_en) {
+    d.op = op;
+    d.cls = cls;
+    d.imm = imm;
+    d.rd_wen = rd_wen;
+    d.rs1_en = rs1_en;
+    d.rs2_en = rs2_en;
+  };
+
+  switch (opcode) {
+    case 0x37: set(Op::kLui, Cls::kAlu, imm_u, true, false, false); break;
+    case 0x17: set(Op::kAuipc, Cls::kAlu, imm_u, true, false, false); break;
+    case 0x6f: set(Op::kJal, Cls::kJal, imm_j, true, false, false); break;
+    case 0x67:
+      if (f3 == 0) set(Op::kJalr, Cls::kJalr, imm_i, true, true, false);
+      break;
+    case 0x63: {
+      static const Op kBr[8] = {Op::kBeq, Op::kBne, Op::kIllegal, Op::kIllegal,
+                                Op::kBlt, Op::kBge, Op::kBltu, Op::kBgeu};
+      if (kBr[f3] != Op::kIllegal) set(kBr[f3], Cls::kBranch, imm_b, false, true, true);
+      break;
+    }
+    case 0x03: {
+      static const Op kLd[8] = {Op::kLb, Op::kLh, Op::kLw, Op::kIllegal,
+                                Op::kLbu, Op::kLhu, Op::kIllegal, Op::kIllegal};
+      if (kLd[f3] != Op::kIllegal) set(kLd[f3], Cls::kLoad, imm_i, true, true, false);
+      break;
+    }
+    case 0x23: {
+      static const Op kSt[8] = {Op::kSb, Op::kSh, Op::kSw, Op::kIllegal,
+                                Op::kIllegal, Op::kIllegal, Op::kIllegal, Op::kIllegal};
+      if (kSt[f3] != Op::kIllegal) set(kSt[f3], Cls::kStore, imm_s, false, true, true);
+      break;
+    }
+    case 0x13:
+      switch (f3) {
+        case 0: set(Op::kAddi, Cls::kAlu, imm_i, true, true, false); break;
+        case 2: set(Op::kSlti, Cls::kAlu, imm_i, true, true, false); break;
+        case 3: set(Op::kSltiu, Cls::kAlu, imm_i, true, true, false); break;
+        case 4: set(Op::kXori, Cls::kAlu, imm_i, true, true, false); break;
+        case 6: set(Op::kOri, Cls::kAlu, imm_i, true, true, false); break;
+        case 7: set(Op::kAndi, Cls::kAlu, imm_i, true, true, false); break;
+        case 1:
+          if (f7 == 0x00) set(Op::kSlli, Cls::kAlu, d.rs2, true, true, false);
+          break;
+        case 5:
+          if (f7 == 0x00) set(Op::kSrli, Cls::kAlu, d.rs2, true, true, false);
+          else if (f7 == 0x20) set(Op::kSrai, Cls::kAlu, d.rs2, true, true, false);
+          break;
+      }
+      break;
+    case 0x33:
+      if (f7 == 0x01) {
+        static const Op kMd[8] = {Op::kMul, Op::kMulh, Op::kMulhsu, Op::kMulhu,
+                                  Op::kDiv, Op::kDivu, Op::kRem, Op::kRemu};
+        set(kMd[f3], f3 < 4 ? Cls::kMul : Cls::kDiv, 0, true, true, true);
+      } else if (f7 == 0x00) {
+        static const Op kRr[8] = {Op::kAdd, Op::kSll, Op::kSlt, Op::kSltu,
+                                  Op::kXor, Op::kSrl, Op::kOr, Op::kAnd};
+        set(kRr[f3], Cls::kAlu, 0, true, true, true);
+      } else if (f7 == 0x20) {
+        if (f3 == 0) set(Op::kSub, Cls::kAlu, 0, true, true, true);
+        else if (f3 == 5) set(Op::kSra, Cls::kAlu, 0, true, true, true);
+      }
+      break;
+    case 0x0f:
+      if (f3 == 0) set(Op::kFence, Cls::kFence, 0, false, false, false);
+      else if (f3 == 1) set(Op::kFenceI, Cls::kFenceI, 0, false, false, false);
+      break;
+    case 0x73:
+      if (f3 == 0) {
+        if (w == 0x00000073) set(Op::kEcall, Cls::kSystem, 0, false, false, false);
+        else if (w == 0x00100073) set(Op::kEbreak, Cls::kSystem, 0, false, false, false);
+        else if (w == 0x30200073) set(Op::kMret, Cls::kSystem, 0, false, false, false);
+        else if (w == 0x10500073) set(Op::kWfi, Cls::kSystem, 0, false, false, false);
+      } else if (f3 != 4) {
+        static const Op kCsr[8] = {Op::kIllegal, Op::kCsrrw, Op::kCsrrs, Op::kCsrrc,
+                                   Op::kIllegal, Op::kCsrrwi, Op::kCsrrsi, Op::kCsrrci};
+        bool reg = f3 < 4;
+        set(kCsr[f3], Cls::kCsr, static_cast<int32_t>(d.rs1), true, reg, false);
+        d.csr = static_cast<uint16_t>(Bits(w, 31, 20));
+      }
+      break;
+    case 0x2f:
+      if (f3 == 2) {
+        switch (Bits(w, 31, 27)) {
+          case 0x02: if (d.rs2 == 0) set(Op::kLrW, Cls::kAmo, 0, true, true, false); break;
+          case 0x03: set(Op::kScW, Cls::kAmo, 0, true, true, true); break;
+          case 0x01: set(Op::kAmoswapW, Cls::kAmo, 0, true, true, true); break;
+          case 0x00: set(Op::kAmoaddW, Cls::kAmo, 0, true, true, true); break;
+          case 0x04: set(Op::kAmoxorW, Cls::kAmo, 0, true, true, true); break;
+          case 0x0c: set(Op::kAmoandW, Cls::kAmo, 0, true, true, true); break;
+          case 0x08: set(Op::kAmoorW, Cls::kAmo, 0, true, true, true); break;
+          case 0x10: set(Op::kAmominW, Cls::kAmo, 0, true, true, true); break;
+          case 0x14: set(Op::kAmomaxW, Cls::kAmo, 0, true, true, true); break;
+          case 0x18: set(Op::kAmominuW, Cls::kAmo, 0, true, true, true); break;
+          case 0x1c: set(Op::kAmomaxuW, Cls::kAmo, 0, true, true, true); break;
+        }
+      }
+      break;
+  }
+
+  // The x0 destination is never a write, which is what the hazard rules of
+  // the timing models expect
+  if (d.rd == 0) d.rd_wen = false;
+  return d;
+}
+
+const char* OpName(Op op) {
+  // In the order of Op
+  static const char* const kNames[] = {
+      "lui", "auipc", "jal", "jalr",
+      "beq", "bne", "blt", "bge", "bltu", "bgeu",
+      "lb", "lh", "lw", "lbu", "lhu",
+      "sb", "sh", "sw",
+      "addi", "slti", "sltiu", "xori", "ori", "andi", "slli", "srli", "srai",
+      "add", "sub", "sll", "slt", "sltu", "xor", "srl", "sra", "or", "and",
+      "fence", "fence.i", "ecall", "ebreak", "mret", "wfi",
+      "csrrw", "csrrs", "csrrc", "csrrwi", "csrrsi", "csrrci",
+      "mul", "mulh", "mulhsu", "mulhu", "div", "divu", "rem", "remu",
+      "lr.w", "sc.w", "amoswap.w", "amoadd.w", "amoxor.w", "amoand.w", "amoor.w",
+      "amomin.w", "amomax.w", "amominu.w", "amomaxu.w",
+      "illegal",
+  };
+  static_assert(sizeof(kNames) / sizeof(kNames[0]) == static_cast<size_t>(Op::kIllegal) + 1,
+                "one name per Op");
+  return kNames[static_cast<size_t>(op)];
+}
+
+}  // namespace e203sim
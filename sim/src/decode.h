@@ -0,0 +1,75 @@
+// RV32IMAC instruction decoder of the E203 simulator.
+//
+// The compressed instructions are expanded into their 32-bit equivalents
+// first, so the rest of the simulator only sees one encoding, with len
+// telling the size of the original instruction.
+#ifndef E203SIM_DECODE_H
+#define E203SIM_DECODE_H
+
+#include <cstdint>
+
+namespace e203sim {
+
+enum class Op : uint8_t {
+  kLui, kAuipc, kJal, kJalr,
+  kBeq, kBne, kBlt, kBge, kBltu, kBgeu,
+  kLb, kLh, kLw, kLbu, kLhu,
+  kSb, kSh, kSw,
+  kAddi, kSlti, kSltiu, kXori, kOri, kAndi, kSlli, kSrli, kSrai,
+  kAdd, kSub, kSll, kSlt, kSltu, kXor, kSrl, kSra, kOr, kAnd,
+  kFence, kFenceI, kEcall, kEbreak, kMret, kWfi,
+  kCsrrw, kCsrrs, kCsrrc, kCsrrwi, kCsrrsi, kCsrrci,
+  kMul, kMulh, kMulhsu, kMulhu, kDiv, kDivu, kRem, kRemu,
+  kLrW, kScW, kAmoswapW, kAmoaddW, kAmoxorW, kAmoandW, kAmoorW,
+  kAmominW, kAmomaxW, kAmominuW, kAmomaxuW,
+  kIllegal,
+};
+
+// The instruction class, which is all the timing models look at
+enum class Cls : uint8_t {
+  kAlu,     // Single-cycle ALU, incl. lui/auipc
+  kLoad,
+  kStore,
+  kBranch,
+  kJal,
+  kJalr,
+  kMul,
+  kDiv,     // div/divu/rem/remu
+  kCsr,
+  kFence,
+  kFenceI,
+  kSystem,  // ecall/ebreak/mret/wfi
+  kAmo,     // lr/sc/amo
+  kIllegal,
+};
+
+struct Inst {
+  uint32_t raw = 0;   // The 32-bit (expanded) encoding
+  int32_t imm = 0;
+  Op op = Op::kIllegal;
+  Cls cls = Cls::kIllegal;
+  uint8_t rd = 0;
+  uint8_t rs1 = 0;
+  uint8_t rs2 = 0;
+  uint8_t len = 4;    // 2 for a compressed instruction
+  uint16_t csr = 0;
+  bool rd_wen = false;
+  bool rs1_en = false;
+  bool rs2_en = false;
+};
+
+// Expand a 16-bit compressed instruction, returns 0 if it is illegal
+uint32_t ExpandRvc(uint16_t c);
+
+// Decode one instruction, raw is the 16-bit or 32-bit encoding as fetched
+// (the low 2 bits tell which one)
+Inst Decode(uint32_t raw);
+
+inline bool IsRvc(uint32_t raw) { return (raw & 3) != 3; }
+
+// The mnemonic of op ("lw", "amoswap.w", ...)
+const char* OpName(Op op);
+
+}  // namespace e203sim
+
+#endif  // E203SIM_DECODE_H
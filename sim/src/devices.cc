@@ -0,0 +1,60 @@
+#include "devices.h"
+
+namespace e203sim {
+
+uint64_t Clint::Mtime() const {
+  return now_() / rtc_div_ + mtime_ofs_;
+}
+
+uint32_t Clint::Read(uint32_t offset, int size) {
+  (void)size;
+  switch (offset) {
+    case 0x0000: return msip_ ? 1 : 0;
+    case 0x4000: return static_cast<uint32_t>(mtimecmp_);
+    case 0x4004: return static_cast<uint32_t>(mtimecmp_ >> 32);
+    case 0xbff8: return static_cast<uint32_t>(Mtime());
+    case 0xbffc: return static_cast<uint32_t>(Mtime() >> 32);
+    default: return 0;
+  }
+}
+
+void Clint::Write(uint32_t offset, int size, uint32_t value) {
+  (void)size;
+  switch (offset) {
+    case 0x0000:
+      msip_ = (value & 1) != 0;
+      break;
+    case 0x4000:
+      mtimecmp_ = (mtimecmp_ & 0xffffffff00000000ull) | value;
+      break;
+    case 0x4004:
+      mtimecmp_ = (mtimecmp_ & 0xffffffffull) | (uint64_t{value} << 32);
+      break;
+    case 0xbff8: {
+      uint64_t now = Mtime();
+      mtime_ofs_ += ((now & 0xffffffff00000000ull) | value) - now;
+      break;
+    }
+    case 0xbffc: {
+      uint64_t now = Mtime();
+      mtime_ofs_ += ((now & 0xffffffffull) | (uint64_t{value} << 32)) - now;
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+uint32_t Uart::Read(uint32_t offset, int size) {
+  (void)size;
+  // rxdata: bit 31 is empty
+  if (offset == 0x04) return 0x80000000u;
+  return 0;
+}
+
+void Uart::Write(uint32_t offset, int size, uint32_t value) {
+  (void)size;
+  if (offset == 0x00) Put(static_cast<uint8_t>(value));
+}
+
+}  // namespace e203sim
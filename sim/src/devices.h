@@ -0,0 +1,70 @@
+// The SoC devices of the E203 simulator: the CLINT and the UART of the
+// HBirdv2 SoC, as far as the benchmarks use them.
+#ifndef E203SIM_DEVICES_H
+#define E203SIM_DEVICES_H
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <utility>
+
+#include "memory.h"
+
+namespace e203sim {
+
+// The CLINT: msip (0x0), mtimecmp (0x4000), mtime (0xbff8). The mtime
+// counts the simulated cycles divided by rtc_div.
+class Clint : public Device {
+ public:
+  static constexpr uint32_t kBase = 0x02000000;
+  static constexpr uint32_t kSize = 0x10000;
+
+  // now returns the current simulated cycle
+  Clint(std::function<uint64_t()> now, uint32_t rtc_div) : now_(std::move(now)), rtc_div_(rtc_div) {}
+
+  uint32_t Read(uint32_t offset, int size) override;
+  void Write(uint32_t offset, int size, uint32_t value) override;
+
+  bool msip() const { return msip_; }
+  bool mtip() const { return Mtime() >= mtimecmp_; }
+  uint64_t mtimecmp() const { return mtimecmp_; }
+  uint64_t mtime() const { return Mtime(); }
+
+ private:
+  uint64_t Mtime() const;
+
+  std::function<uint64_t()> now_;
+  uint32_t rtc_div_;
+  bool msip_ = false;
+  uint64_t mtimecmp_ = ~uint64_t{0};
+  uint64_t mtime_ofs_ = 0;
+};
+
+// The UART0 TX: a write of txdata prints the byte, txdata never reads
+// full and rxdata always reads empty. The hart prints the bytes of the
+// simulation console here too (Put).
+class Uart : public Device {
+ public:
+  static constexpr uint32_t kBase = 0x10013000;
+  static constexpr uint32_t kSize = 0x1000;
+
+  explicit Uart(FILE* out) : out_(out) {}
+
+  uint32_t Read(uint32_t offset, int size) override;
+  void Write(uint32_t offset, int size, uint32_t value) override;
+
+  void Put(uint8_t c) {
+    bytes_++;
+    if (out_ != nullptr) std::fputc(c, out_);
+  }
+
+  uint64_t bytes() const { return bytes_; }
+
+ private:
+  FILE* out_;
+  uint64_t bytes_ = 0;
+};
+
+}  // namespace e203sim
+
+#endif  // E203SIM_DEVICES_H
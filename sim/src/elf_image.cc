@@ -0,0 +1,199 @@
+#include "elf_image.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "memory.h"
+
+namespace e203sim {
+
+namespace {
+
+// The ELF32 structures, as in <elf.h>, which is not on every host
+struct Elf32Ehdr {
+  uint8_t e_ident[16];
+  uint16_t e_type;
+  uint16_t e_machine;
+  uint32_t e_version;
+  uint32_t e_entry;
+  uint32_t e_phoff;
+  uint32_t e_shoff;
+  uint32_t e_flags;
+  uint16_t e_ehsize;
+  uint16_t e_phentsize;
+  uint16_t e_phnum;
+  uint16_t e_shentsize;
+  uint16_t e_shnum;
+  uint16_t e_shstrndx;
+};
+
+struct Elf32Phdr {
+  uint32_t p_type;
+  uint32_t p_offset;
+  uint32_t p_vaddr;
+  uint32_t p_paddr;
+  uint32_t p_filesz;
+  uint32_t p_memsz;
+  uint32_t p_flags;
+  uint32_t p_align;
+};
+
+struct Elf32Shdr {
+  uint32_t sh_name;
+  uint32_t sh_type;
+  uint32_t sh_flags;
+  uint32_t sh_addr;
+  uint32_t sh_offset;
+  uint32_t sh_size;
+  uint32_t sh_link;
+  uint32_t sh_info;
+  uint32_t sh_addralign;
+  uint32_t sh_entsize;
+};
+
+struct Elf32Sym {
+  uint32_t st_name;
+  uint32_t st_value;
+  uint32_t st_size;
+  uint8_t st_info;
+  uint8_t st_other;
+  uint16_t st_shndx;
+};
+
+constexpr uint16_t kEmRiscv = 243;
+constexpr uint32_t kPtLoad = 1;
+constexpr uint32_t kShtSymtab = 2;
+
+}  // namespace
+
+ElfImage::~ElfImage() { Close(); }
+
+void ElfImage::Close() {
+  if (file_ != nullptr) munmap(const_cast<uint8_t*>(file_), size_);
+  file_ = nullptr;
+  size_ = 0;
+  segments_.clear();
+  symbols_.clear();
+}
+
+bool ElfImage::Open(const std::string& path, std::string* err) {
+  Close();
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    *err = "cannot open " + path;
+    return false;
+  }
+  struct stat st;
+  void* map = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (map == MAP_FAILED) {
+    *err = "cannot map " + path;
+    return false;
+  }
+  file_ = static_cast<const uint8_t*>(map);
+  size_ = static_cast<size_t>(st.st_size);
+
+  Elf32Ehdr eh;
+  if (size_ < sizeof(eh)) {
+    *err = path + ": too short for an ELF header";
+    return false;
+  }
+  std::memcpy(&eh, file_, sizeof(eh));
+  if (std::memcmp(eh.e_ident, "\177ELF", 4) != 0 || eh.e_ident[4] != 1 || eh.e_ident[5] != 1) {
+    *err = path + ": not a little-endian ELF32 file";
+    return false;
+  }
+  if (eh.e_machine != kEmRiscv) {
+    *err = path + ": not a RISC-V executable";
+    return false;
+  }
+  entry_ = eh.e_entry;
+
+  for (uint32_t i = 0; i < eh.e_phnum; i++) {
+    Elf32Phdr ph;
+    size_t off = eh.e_phoff + size_t{i} * eh.e_phentsize;
+    if (off + sizeof(ph) > size_) break;
+    std::memcpy(&ph, file_ + off, sizeof(ph));
+    if (ph.p_type != kPtLoad || ph.p_memsz == 0) continue;
+    if (size_t{ph.p_offset} + ph.p_filesz > size_) {
+      *err = path + ": truncated segment";
+      return false;
+    }
+    segments_.push_back(
+        {ph.p_vaddr, ph.p_paddr, ph.p_filesz, ph.p_memsz, file_ + ph.p_offset});
+  }
+  if (segments_.empty()) {
+    *err = path + ": no loadable segment";
+    return false;
+  }
+
+  // The symbol table is optional (a stripped file still runs)
+  for (uint32_t i = 0; i < eh.e_shnum; i++) {
+    Elf32Shdr sh;
+    size_t off = eh.e_shoff + size_t{i} * eh.e_shentsize;
+    if (off + sizeof(sh) > size_) break;
+    std::memcpy(&sh, file_ + off, sizeof(sh));
+    if (sh.sh_type != kShtSymtab || sh.sh_link >= eh.e_shnum) continue;
+
+    // The string table must be in the file, and each name end inside it
+    Elf32Shdr str;
+    size_t str_off = eh.e_shoff + size_t{sh.sh_link} * eh.e_shentsize;
+    if (str_off + sizeof(str) > size_) continue;
+    std::memcpy(&str, file_ + str_off, sizeof(str));
+    if (size_t{str.sh_offset} + str.sh_size > size_) continue;
+    const char* strtab = reinterpret_cast<const char*>(file_ + str.sh_offset);
+
+    for (uint32_t s = 0; s + sizeof(Elf32Sym) <= sh.sh_size; s += sizeof(Elf32Sym)) {
+      Elf32Sym sym;
+      if (size_t{sh.sh_offset} + s + sizeof(sym) > size_) break;
+      std::memcpy(&sym, file_ + sh.sh_offset + s, sizeof(sym));
+      if (sym.st_name == 0 || sym.st_name >= str.sh_size) continue;
+      const char* name = strtab + sym.st_name;
+      size_t len = strnlen(name, str.sh_size - sym.st_name);
+      if (len == str.sh_size - sym.st_name) continue;
+      symbols_.emplace(std::string(name, len), sym.st_value);
+    }
+  }
+  return true;
+}
+
+bool ElfImage::Symbol(const std::string& name, uint32_t* addr) const {
+  auto it = symbols_.find(name);
+  if (it == symbols_.end()) return false;
+  *addr = it->second;
+  return true;
+}
+
+bool ElfImage::LoadAddress(uint32_t vaddr, uint32_t* paddr) const {
+  for (const ElfSegment& seg : segments_) {
+    if (vaddr - seg.vaddr < seg.filesz) {
+      *paddr = seg.paddr + (vaddr - seg.vaddr);
+      return true;
+    }
+  }
+  return false;
+}
+
+// The data is copied to the load address, where the startup code copies it
+// from. The zeros of .bss only exist where the segment runs: past the load
+// image they would overwrite what the linker placed after it (the next
+// segment's load image). So a segment that runs elsewhere is also copied
+// to its run address, and the zeros follow the data there
+void ElfImage::Load(Memory* mem) const {
+  for (const ElfSegment& seg : segments_) {
+    mem->WriteBlock(seg.paddr, seg.data, seg.filesz);
+    if (seg.memsz == seg.filesz) continue;
+    if (seg.vaddr != seg.paddr) mem->WriteBlock(seg.vaddr, seg.data, seg.filesz);
+    std::vector<uint8_t> zeros(seg.memsz - seg.filesz);
+    mem->WriteBlock(seg.vaddr + seg.filesz, zeros.data(), zeros.size());
+  }
+}
+
+}  // namespace e203sim
@@ -0,0 +1,59 @@
+// The RV32 ELF executable loader of the E203 simulator.
+#ifndef E203SIM_ELF_IMAGE_H
+#define E203SIM_ELF_IMAGE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace e203sim {
+
+class Memory;
+
+struct ElfSegment {
+  uint32_t vaddr;       // The run address (VMA), e.g., .data in the DTCM
+  uint32_t paddr;       // The load address (LMA)
+  uint32_t filesz;
+  uint32_t memsz;       // The bytes past filesz are zeros (.bss)
+  const uint8_t* data;  // filesz bytes, inside the mapping
+};
+
+// The file is mapped (mmap), not read, so opening a large image costs
+// only the pages the segments and the symbols touch
+class ElfImage {
+ public:
+  ElfImage() = default;
+  ~ElfImage();
+  ElfImage(const ElfImage&) = delete;
+  ElfImage& operator=(const ElfImage&) = delete;
+
+  // Map and check the file, false with err set on failure
+  bool Open(const std::string& path, std::string* err);
+
+  uint32_t entry() const { return entry_; }
+  const std::vector<ElfSegment>& segments() const { return segments_; }
+
+  // The address of a symbol, false if it is not in the symbol table
+  bool Symbol(const std::string& name, uint32_t* addr) const;
+
+  // The load address of the initialized byte at vaddr, which the startup
+  // code copies to vaddr, false if no segment holds it
+  bool LoadAddress(uint32_t vaddr, uint32_t* paddr) const;
+
+  // Copy the loadable segments into the simulated memory
+  void Load(Memory* mem) const;
+
+ private:
+  void Close();
+
+  const uint8_t* file_ = nullptr;  // The mapping
+  size_t size_ = 0;
+  uint32_t entry_ = 0;
+  std::vector<ElfSegment> segments_;
+  std::unordered_map<std::string, uint32_t> symbols_;
+};
+
+}  // namespace e203sim
+
+#endif  // E203SIM_ELF_IMAGE_H
@@ -0,0 +1,364 @@
+// e203farm: run many programs, or one program with many seed sets, on one
+// model at a time, spread over the host cores, and summarize the results
+// and the throughput.
+//
+//   e203farm [--engine iss|rtl] [--jobs N] [--coremark-seeds] prog.elf ...
+//   e203farm --list regress.jobs
+//
+// A job list has one run per line, "name prog.elf [SYMBOL=VALUE ...]", the
+// patches setting 32-bit words of the program (e.g., the CoreMark seeds
+// seed1_volatile..seed3_volatile) at their load address before it starts.
+// --coremark-seeds runs every program with the validation, performance and
+// profile seeds of core_portme.c instead.
+//
+// iss: every run is a hart with a timing model in this process, its UART
+// output in OUT/name.uart.
+// rtl: the e203_ckpt model is built once (into the build cache, so only
+// when sim/, core/ or the RTL changed), and every run is an e203_ckpt run
+// of the ELF loaded straight into the TCMs (+ELF), or, with patches, of
+// its own OUT/name.{itcm,dtcm}.verilog images written from the ELF with
+// them; its output in OUT/name.log.
+//
+// A run ends at the pass/fail marker (CFG_SIM_MARK) or when the program
+// halts; the counts are those of the measured region, see batch.h.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "batch.h"
+#include "checkpoint.h"
+#include "elf_image.h"
+#include "machine.h"
+#include "proc.h"
+#include "sweep.h"
+#include "timing.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+using e203sim::RunResult;
+using e203sim::SymbolPatch;
+
+struct Job {
+  std::string name;
+  std::string elf;
+  std::vector<SymbolPatch> patches;
+};
+
+// The seed sets of benchmark/coremark/core_portme.c
+struct SeedSet {
+  const char* name;
+  uint32_t seed[3];
+};
+
+constexpr SeedSet kCoremarkSeeds[] = {
+    {"validation", {0x3415, 0x3415, 0x66}},
+    {"performance", {0x0, 0x0, 0x66}},
+    {"profile", {0x8, 0x8, 0x8}},
+};
+
+struct Options {
+  bool rtl = false;
+  unsigned jobs = e203sim::HostCores();
+  std::string out = "farm-out";
+  std::string list;
+  std::vector<std::string> elfs;
+  bool coremark_seeds = false;
+
+  std::string model = "e203";
+  e203sim::ModelOptions model_opts;
+  uint64_t max_insts = ~uint64_t{0};
+
+  std::string rtl_dir;
+  std::string cache = "sweep-cache";
+  std::vector<std::string> defines;
+  uint64_t max_cycles = 1000000000;
+};
+
+void Usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [options] [--list FILE] [prog.elf ...]\n"
+               "  --engine iss|rtl      run on a timing model (default) or on the RTL\n"
+               "  --jobs N              parallel runs (default: the host cores)\n"
+               "  --out DIR             the per-run images and output (default farm-out)\n"
+               "  --list FILE           the runs, \"name prog.elf [SYMBOL=VALUE ...]\" per line\n"
+               "  --coremark-seeds      run each ELF with the three seed sets of core_portme.c\n"
+               "iss:\n"
+               "  --model NAME          timing model (default e203)\n"
+               "  -o KEY=VALUE          timing model option, repeatable\n"
+               "  --max-insts N         stop a run after N instructions\n"
+               "rtl:\n"
+               "  --rtl-dir DIR         the rtl/e203 directory of e203_hbirdv2\n"
+               "  --cache DIR           the build cache (default sweep-cache)\n"
+               "  --define MACRO[=V]    a define of the model, repeatable\n"
+               "  --max-cycles N        stop a run after N cycles (default 1000000000)\n",
+               argv0);
+}
+
+bool ParseCount(const char* s, uint64_t* v) {
+  char* end = nullptr;
+  *v = std::strtoull(s, &end, 0);
+  return *s != '\0' && *end == '\0';
+}
+
+// 0 on success, else the exit code
+int ParseArgs(int argc, char** argv, Options* o) {
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool has_next = i + 1 < argc;
+    uint64_t n = 0;
+    if (a == "--engine" && has_next) {
+      std::string e = argv[++i];
+      if (e != "iss" && e != "rtl") {
+        std::fprintf(stderr, "bad --engine %s\n", e.c_str());
+        return 2;
+      }
+      o->rtl = e == "rtl";
+    } else if ((a == "--jobs" || a == "--max-insts" || a == "--max-cycles") && has_next) {
+      if (!ParseCount(argv[++i], &n) || n == 0) {
+        std::fprintf(stderr, "bad %s %s\n", a.c_str(), argv[i]);
+        return 2;
+      }
+      if (a == "--jobs") o->jobs = static_cast<unsigned>(n);
+      if (a == "--max-insts") o->max_insts = n;
+      if (a == "--max-cycles") o->max_cycles = n;
+    } else if (a == "-o" && has_next) {
+      std::string kv = argv[++i];
+      size_t eq = kv.find('=');
+      if (eq == std::string::npos) {
+        std::fprintf(stderr, "bad model option %s, expected KEY=VALUE\n", kv.c_str());
+        return 2;
+      }
+      o->model_opts.push_back({kv.substr(0, eq), kv.substr(eq + 1)});
+    } else if (a == "--model" && has_next) {
+      o->model = argv[++i];
+    } else if (a == "--out" && has_next) {
+      o->out = argv[++i];
+    } else if (a == "--list" && has_next) {
+      o->list = argv[++i];
+    } else if (a == "--rtl-dir" && has_next) {
+      o->rtl_dir = argv[++i];
+    } else if (a == "--cache" && has_next) {
+      o->cache = argv[++i];
+    } else if (a == "--define" && has_next) {
+      o->defines.push_back(argv[++i]);
+    } else if (a == "--coremark-seeds") {
+      o->coremark_seeds = true;
+    } else if (a == "-h" || a == "--help") {
+      Usage(argv[0]);
+      return 1;
+    } else if (a[0] != '-') {
+      o->elfs.push_back(a);
+    } else {
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+  if (o->list.empty() == o->elfs.empty()) {
+    Usage(argv[0]);
+    return 2;
+  }
+  if (o->rtl && o->rtl_dir.empty()) {
+    std::fprintf(stderr, "--engine rtl needs --rtl-dir\n");
+    return 2;
+  }
+  std::sort(o->defines.begin(), o->defines.end());
+  return 0;
+}
+
+bool ReadJobs(const std::string& path, std::vector<Job>* jobs, std::string* err) {
+  std::ifstream in(path);
+  if (!in) {
+    *err = "cannot open " + path;
+    return false;
+  }
+  std::string line;
+  int lineno = 0;
+  while (std::getline(in, line)) {
+    lineno++;
+    size_t hash = line.find('#');
+    if (hash != std::string::npos) line.resize(hash);
+    std::istringstream ls(line);
+    Job j;
+    if (!(ls >> j.name)) continue;
+    if (!(ls >> j.elf)) {
+      *err = path + ":" + std::to_string(lineno) + ": expected name prog.elf [SYMBOL=VALUE ...]";
+      return false;
+    }
+    for (std::string t; ls >> t;) {
+      SymbolPatch p;
+      if (!e203sim::ParseSymbolPatch(t, &p)) {
+        *err = path + ":" + std::to_string(lineno) + ": bad patch " + t;
+        return false;
+      }
+      j.patches.push_back(p);
+    }
+    jobs->push_back(j);
+  }
+  return true;
+}
+
+// The runs of the command line, each ELF once or with each seed set
+std::vector<Job> ElfJobs(const Options& o) {
+  std::vector<Job> jobs;
+  for (const std::string& elf : o.elfs) {
+    std::string base = fs::path(elf).stem().string();
+    if (!o.coremark_seeds) {
+      jobs.push_back({base, elf, {}});
+      continue;
+    }
+    for (const SeedSet& s : kCoremarkSeeds) {
+      Job j{base + "." + s.name, elf, {}};
+      for (int i = 0; i < 3; i++) {
+        j.patches.push_back({"seed" + std::to_string(i + 1) + "_volatile", s.seed[i]});
+      }
+      jobs.push_back(j);
+    }
+  }
+  return jobs;
+}
+
+double Seconds(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options o;
+  if (int rc = ParseArgs(argc, argv, &o)) return rc == 1 ? 0 : rc;
+
+  std::string err;
+  std::vector<Job> jobs = ElfJobs(o);
+  if (!o.list.empty() && !ReadJobs(o.list, &jobs, &err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 2;
+  }
+  std::set<std::string> names;
+  for (const Job& j : jobs) {
+    if (!names.insert(j.name).second) {
+      std::fprintf(stderr, "two runs are named %s\n", j.name.c_str());
+      return 2;
+    }
+  }
+  if (!o.rtl && !e203sim::MakeTimingModel(o.model, o.model_opts, &err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 2;
+  }
+  std::error_code ec;
+  fs::create_directories(o.out, ec);
+
+  // Every ELF is read once, the runs share it
+  std::vector<std::unique_ptr<e203sim::ElfImage>> elfs;
+  std::vector<size_t> elf_of(jobs.size());
+  for (size_t i = 0; i < jobs.size(); i++) {
+    size_t k = 0;
+    while (k < i && jobs[k].elf != jobs[i].elf) k++;
+    if (k < i) {
+      elf_of[i] = elf_of[k];
+      continue;
+    }
+    elfs.emplace_back(new e203sim::ElfImage);
+    if (!elfs.back()->Open(jobs[i].elf, &err)) {
+      std::fprintf(stderr, "%s: %s\n", jobs[i].elf.c_str(), err.c_str());
+      return 2;
+    }
+    elf_of[i] = elfs.size() - 1;
+  }
+
+  e203sim::RtlBuild build;
+  if (o.rtl) {
+    e203sim::Fnv64 sources;
+    if (!e203sim::HashRtlSources(o.rtl_dir, &sources, &err)) {
+      std::fprintf(stderr, "%s\n", err.c_str());
+      return 2;
+    }
+    build = e203sim::CachedRtlBuild(o.cache, sources, o.defines);
+    e203sim::BuildRtlModel(o.rtl_dir, o.jobs, &build);
+    std::fprintf(stderr, "model %s: %s\n", build.dir.c_str(),
+                 build.cached ? "cached" : build.ok ? "built" : "FAILED");
+    if (!build.ok) {
+      std::fprintf(stderr, "see %s\n", build.log.c_str());
+      return 2;
+    }
+  }
+
+  auto t0 = std::chrono::steady_clock::now();
+  std::vector<RunResult> results(jobs.size());
+  std::vector<double> secs(jobs.size());
+  e203sim::ParallelFor(jobs.size(), o.jobs, [&](size_t i) {
+    auto t = std::chrono::steady_clock::now();
+    const Job& j = jobs[i];
+    const e203sim::ElfImage& elf = *elfs[elf_of[i]];
+    std::string prefix = (fs::path(o.out) / j.name).string();
+    RunResult& r = results[i];
+    if (!o.rtl) {
+      FILE* uart = std::fopen((prefix + ".uart").c_str(), "w");
+      r = e203sim::RunIss(elf, j.patches, o.model, o.model_opts, o.max_insts, uart);
+      if (uart) std::fclose(uart);
+    } else if (j.patches.empty()) {
+      r = e203sim::RunRtl(build, {"+ELF=" + fs::absolute(j.elf).string()}, o.max_cycles,
+                          prefix + ".log");
+    } else {
+      // The images of this run, with its patches
+      e203sim::Machine m(1, nullptr);
+      e203sim::RtlLayout layout;
+      if (!e203sim::LoadProgram(elf, j.patches, &m, &r.note) ||
+          !e203sim::WriteMemoryImages(prefix, m, layout, &r.note)) {
+        return;
+      }
+      r = e203sim::RunRtl(build,
+                          {"+ITCM=" + fs::absolute(prefix + ".itcm.verilog").string(),
+                           "+DTCM=" + fs::absolute(prefix + ".dtcm.verilog").string()},
+                          o.max_cycles, prefix + ".log");
+    }
+    secs[i] = Seconds(t);
+  });
+  double wall = Seconds(t0);
+
+  size_t name_w = 4;
+  for (const Job& j : jobs) name_w = std::max(name_w, j.name.size());
+  std::printf("%-*s %14s %14s %7s %5s %8s %9s  %s\n", static_cast<int>(name_w), "run", "cycles",
+              "instret", "CPI", "check", "host s", "Mcyc/s", "note");
+  size_t pass = 0, fail = 0, unchecked = 0, errors = 0;
+  uint64_t sim_cycles = 0;
+  double run_secs = 0;
+  for (size_t i = 0; i < jobs.size(); i++) {
+    const RunResult& r = results[i];
+    double cpi = r.insts ? static_cast<double>(r.cycles) / r.insts : 0.0;
+    std::printf("%-*s %14llu %14llu %7.3f %5s %8.2f %9.2f  %s\n", static_cast<int>(name_w),
+                jobs[i].name.c_str(), static_cast<unsigned long long>(r.cycles),
+                static_cast<unsigned long long>(r.insts), cpi, e203sim::RunCheckName(r), secs[i],
+                secs[i] > 0 ? r.run_cycles / secs[i] / 1e6 : 0.0, r.note.c_str());
+    if (!r.ok || !r.note.empty()) {
+      errors++;
+    } else if (r.check == e203sim::RunCheck::kPass) {
+      pass++;
+    } else if (r.check == e203sim::RunCheck::kFail) {
+      fail++;
+    } else {
+      unchecked++;
+    }
+    sim_cycles += r.run_cycles;
+    run_secs += secs[i];
+  }
+  std::fflush(stdout);
+  std::fprintf(stderr,
+               "%zu runs on %u jobs: %zu pass, %zu fail, %zu unchecked, %zu not finished\n"
+               "%.1f s wall, %.1fM cycles simulated, %.2fM cycles per host second "
+               "(%.2fM per run)\n",
+               jobs.size(), o.jobs, pass, fail, unchecked, errors, wall, sim_cycles / 1e6,
+               wall > 0 ? sim_cycles / wall / 1e6 : 0.0,
+               run_secs > 0 ? sim_cycles / run_secs / 1e6 : 0.0);
+  return fail == 0 && errors == 0 ? 0 : 1;
+}
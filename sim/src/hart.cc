@@ -0,0 +1,416 @@
+#include "hart.h"
+
+#include <cstdio>
+
+#include "devices.h"
+#include "memory.h"
+
+namespace e203sim {
+
+namespace {
+
+constexpr uint32_t kMstatusMie = 1u << 3;
+constexpr uint32_t kMstatusMpie = 1u << 7;
+constexpr uint32_t kMstatusMpp = 3u << 11;  // Always machine mode
+
+constexpr uint32_t kMipMsip = 1u << 3;
+constexpr uint32_t kMipMtip = 1u << 7;
+
+constexpr uint32_t kCauseIllegal = 2;
+constexpr uint32_t kCauseBreakpoint = 3;
+constexpr uint32_t kCauseLoadMisalign = 4;
+constexpr uint32_t kCauseStoreMisalign = 6;
+constexpr uint32_t kCauseEcall = 11;
+constexpr uint32_t kCauseIrq = 0x80000000u;
+
+// RV32IMAC
+constexpr uint32_t kMisa = (1u << 30) | (1u << 0) | (1u << 2) | (1u << 8) | (1u << 12);
+
+}  // namespace
+
+Hart::Hart(Memory* mem, Clint* clint)
+    : mem_(mem), clint_(clint), dcache_(size_t{1} << kDecodeBits) {}
+
+void Hart::Reset(uint32_t pc) {
+  for (uint32_t& r : x_) r = 0;
+  pc_ = pc;
+  csrs_ = HartCsrs();
+  instret_ = 0;
+  lr_valid_ = false;
+  halted_ = false;
+  halt_reason_.clear();
+  marks_.clear();
+}
+
+void Hart::Halt(const std::string& reason) {
+  halted_ = true;
+  halt_reason_ = reason;
+}
+
+uint64_t Hart::Run(uint64_t n) {
+  uint64_t start = instret_;
+  while (!halted_ && instret_ - start < n) {
+    Step();
+  }
+  return instret_ - start;
+}
+
+void Hart::TakeTrap(uint32_t cause, uint32_t tval) {
+  if (csrs_.mtvec == 0) {
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "trap (mcause 0x%08x, mtval 0x%08x) at pc 0x%08x with no mtvec",
+                  cause, tval, pc_);
+    Halt(buf);
+    return;
+  }
+  csrs_.mepc = pc_;
+  csrs_.mcause = cause;
+  csrs_.mtval = tval;
+  uint32_t mie = csrs_.mstatus & kMstatusMie;
+  csrs_.mstatus = (csrs_.mstatus & ~(kMstatusMie | kMstatusMpie)) | (mie ? kMstatusMpie : 0);
+  uint32_t handler = csrs_.mtvec & ~3u;
+  if (timing_ != nullptr) timing_->Trap(pc_, handler);
+  pc_ = handler;
+}
+
+bool Hart::CheckInterrupt() {
+  if (clint_ == nullptr) return false;
+  uint32_t mip = (clint_->msip() ? kMipMsip : 0) | (clint_->mtip() ? kMipMtip : 0);
+  uint32_t pend = mip & csrs_.mie;
+  if (pend == 0) return false;
+  // The software interrupt has the priority over the timer interrupt
+  TakeTrap(kCauseIrq | ((pend & kMipMsip) ? 3u : 7u), 0);
+  return true;
+}
+
+uint32_t Hart::ReadCsr(uint16_t csr) {
+  switch (csr) {
+    case 0x300: return csrs_.mstatus | kMstatusMpp;
+    case 0x301: return kMisa;
+    case 0x304: return csrs_.mie;
+    case 0x305: return csrs_.mtvec;
+    case 0x340: return csrs_.mscratch;
+    case 0x341: return csrs_.mepc;
+    case 0x342: return csrs_.mcause;
+    case 0x343: return csrs_.mtval;
+    case 0x344:
+      if (clint_ == nullptr) return 0;
+      return (clint_->msip() ? kMipMsip : 0) | (clint_->mtip() ? kMipMtip : 0);
+    case 0xb00:
+    case 0xc00:
+      return static_cast<uint32_t>(Cycles() + csrs_.mcycle_ofs);
+    case 0xb80:
+    case 0xc80:
+      return static_cast<uint32_t>((Cycles() + csrs_.mcycle_ofs) >> 32);
+    case 0xb02:
+    case 0xc02:
+      return static_cast<uint32_t>(instret_ + csrs_.minstret_ofs);
+    case 0xb82:
+    case 0xc82:
+      return static_cast<uint32_t>((instret_ + csrs_.minstret_ofs) >> 32);
+    default:
+      // The other CSRs (mhartid, the HPM counters, ...) read as zero, the
+      // E203 does not trap on them either
+      return 0;
+  }
+}
+
+void Hart::WriteCsr(uint16_t csr, uint32_t v) {
+  switch (csr) {
+    case 0x300: csrs_.mstatus = v & (kMstatusMie | kMstatusMpie); break;
+    case 0x304: csrs_.mie = v & (kMipMsip | kMipMtip | (1u << 11)); break;
+    case 0x305: csrs_.mtvec = v; break;
+    case 0x340: csrs_.mscratch = v; break;
+    case 0x341: csrs_.mepc = v & ~1u; break;
+    case 0x342: csrs_.mcause = v; break;
+    case 0x343: csrs_.mtval = v; break;
+    case 0xb00: {
+      uint64_t now = Cycles() + csrs_.mcycle_ofs;
+      csrs_.mcycle_ofs += ((now & 0xffffffff00000000ull) | v) - now;
+      break;
+    }
+    case 0xb80: {
+      uint64_t now = Cycles() + csrs_.mcycle_ofs;
+      csrs_.mcycle_ofs += ((now & 0xffffffffull) | (uint64_t{v} << 32)) - now;
+      break;
+    }
+    case 0xb02: {
+      uint64_t now = instret_ + csrs_.minstret_ofs;
+      csrs_.minstret_ofs += ((now & 0xffffffff00000000ull) | v) - now;
+      break;
+    }
+    case 0xb82: {
+      uint64_t now = instret_ + csrs_.minstret_ofs;
+      csrs_.minstret_ofs += ((now & 0xffffffffull) | (uint64_t{v} << 32)) - now;
+      break;
+    }
+    case kMarkCsr:
+      marks_.push_back({v, instret_, Cycles()});
+      if (stop_mark_ != 0 && v == stop_mark_) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "mark %u", v);
+        Halt(buf);
+      }
+      break;
+    case kConsoleCsr:
+      if (console_ != nullptr) console_->Put(static_cast<uint8_t>(v));
+      break;
+    default:
+      break;
+  }
+}
+
+bool Hart::Step() {
+  if ((csrs_.mstatus & kMstatusMie) && csrs_.mie != 0 && CheckInterrupt()) return !halted_;
+
+  uint32_t pc = pc_;
+  uint32_t raw = mem_->Read<uint16_t>(pc);
+  if ((raw & 3) == 3) raw |= uint32_t{mem_->Read<uint16_t>(pc + 2)} << 16;
+
+  DecodeEntry& e = dcache_[(pc >> 1) & ((1u << kDecodeBits) - 1)];
+  if (e.pc != pc || e.raw != raw) {
+    e.pc = pc;
+    e.raw = raw;
+    e.inst = Decode(raw);
+  }
+  const Inst& in = e.inst;
+
+  uint32_t a = x_[in.rs1];
+  uint32_t b = x_[in.rs2];
+  uint32_t next = pc + in.len;
+  uint32_t rd = 0;
+  uint32_t addr = 0;
+  bool taken = false;
+
+  auto misaligned = [this](uint32_t ad, uint32_t size) {
+    return misaligned_trap_ && (ad & (size - 1)) != 0;
+  };
+
+  switch (in.op) {
+    case Op::kLui: rd = static_cast<uint32_t>(in.imm); break;
+    case Op::kAuipc: rd = pc + static_cast<uint32_t>(in.imm); break;
+    case Op::kJal:
+      rd = next;
+      next = pc + static_cast<uint32_t>(in.imm);
+      taken = true;
+      break;
+    case Op::kJalr:
+      rd = next;
+      next = (a + static_cast<uint32_t>(in.imm)) & ~1u;
+      taken = true;
+      break;
+
+    case Op::kBeq: taken = a == b; break;
+    case Op::kBne: taken = a != b; break;
+    case Op::kBlt: taken = static_cast<int32_t>(a) < static_cast<int32_t>(b); break;
+    case Op::kBge: taken = static_cast<int32_t>(a) >= static_cast<int32_t>(b); break;
+    case Op::kBltu: taken = a < b; break;
+    case Op::kBgeu: taken = a >= b; break;
+
+    case Op::kLb:
+    case Op::kLbu:
+      addr = a + static_cast<uint32_t>(in.imm);
+      rd = mem_->Read<uint8_t>(addr);
+      if (in.op == Op::kLb) rd = static_cast<uint32_t>(static_cast<int8_t>(rd));
+      break;
+    case Op::kLh:
+    case Op::kLhu:
+      addr = a + static_cast<uint32_t>(in.imm);
+      if (misaligned(addr, 2)) {
+        TakeTrap(kCauseLoadMisalign, addr);
+        return !halted_;
+      }
+      rd = mem_->Read<uint16_t>(addr);
+      if (in.op == Op::kLh) rd = static_cast<uint32_t>(static_cast<int16_t>(rd));
+      break;
+    case Op::kLw:
+      addr = a + static_cast<uint32_t>(in.imm);
+      if (misaligned(addr, 4)) {
+        TakeTrap(kCauseLoadMisalign, addr);
+        return !halted_;
+      }
+      rd = mem_->Read<uint32_t>(addr);
+      break;
+
+    case Op::kSb:
+      addr = a + static_cast<uint32_t>(in.imm);
+      mem_->Write<uint8_t>(addr, static_cast<uint8_t>(b));
+      break;
+    case Op::kSh:
+      addr = a + static_cast<uint32_t>(in.imm);
+      if (misaligned(addr, 2)) {
+        TakeTrap(kCauseStoreMisalign, addr);
+        return !halted_;
+      }
+      mem_->Write<uint16_t>(addr, static_cast<uint16_t>(b));
+      break;
+    case Op::kSw:
+      addr = a + static_cast<uint32_t>(in.imm);
+      if (misaligned(addr, 4)) {
+        TakeTrap(kCauseStoreMisalign, addr);
+        return !halted_;
+      }
+      mem_->Write<uint32_t>(addr, b);
+      break;
+
+    case Op::kAddi: rd = a + static_cast<uint32_t>(in.imm); break;
+    case Op::kSlti: rd = static_cast<int32_t>(a) < in.imm; break;
+    case Op::kSltiu: rd = a < static_cast<uint32_t>(in.imm); break;
+    case Op::kXori: rd = a ^ static_cast<uint32_t>(in.imm); break;
+    case Op::kOri: rd = a | static_cast<uint32_t>(in.imm); break;
+    case Op::kAndi: rd = a & static_cast<uint32_t>(in.imm); break;
+    case Op::kSlli: rd = a << in.imm; break;
+    case Op::kSrli: rd = a >> in.imm; break;
+    case Op::kSrai: rd = static_cast<uint32_t>(static_cast<int32_t>(a) >> in.imm); break;
+
+    case Op::kAdd: rd = a + b; break;
+    case Op::kSub: rd = a - b; break;
+    case Op::kSll: rd = a << (b & 31); break;
+    case Op::kSlt: rd = static_cast<int32_t>(a) < static_cast<int32_t>(b); break;
+    case Op::kSltu: rd = a < b; break;
+    case Op::kXor: rd = a ^ b; break;
+    case Op::kSrl: rd = a >> (b & 31); break;
+    case Op::kSra: rd = static_cast<uint32_t>(static_cast<int32_t>(a) >> (b & 31)); break;
+    case Op::kOr: rd = a | b; break;
+    case Op::kAnd: rd = a & b; break;
+
+    case Op::kMul: rd = a * b; break;
+    case Op::kMulh:
+      rd = static_cast<uint32_t>((int64_t{static_cast<int32_t>(a)} * static_cast<int32_t>(b)) >> 32);
+      break;
+    case Op::kMulhsu:
+      rd = static_cast<uint32_t>((int64_t{static_cast<int32_t>(a)} * int64_t{b}) >> 32);
+      break;
+    case Op::kMulhu: rd = static_cast<uint32_t>((uint64_t{a} * b) >> 32); break;
+    case Op::kDiv:
+      if (b == 0) rd = ~0u;
+      else if (a == 0x80000000u && b == ~0u) rd = a;
+      else rd = static_cast<uint32_t>(static_cast<int32_t>(a) / static_cast<int32_t>(b));
+      break;
+    case Op::kDivu: rd = (b == 0) ? ~0u : a / b; break;
+    case Op::kRem:
+      if (b == 0) rd = a;
+      else if (a == 0x80000000u && b == ~0u) rd = 0;
+      else rd = static_cast<uint32_t>(static_cast<int32_t>(a) % static_cast<int32_t>(b));
+      break;
+    case Op::kRemu: rd = (b == 0) ? a : a % b; break;
+
+    case Op::kFence:
+      break;
+    case Op::kFenceI:
+      for (DecodeEntry& d : dcache_) d.pc = 1;
+      break;
+    case Op::kEcall:
+      TakeTrap(kCauseEcall, 0);
+      return !halted_;
+    case Op::kEbreak:
+      TakeTrap(kCauseBreakpoint, pc);
+      return !halted_;
+    case Op::kMret: {
+      uint32_t mpie = csrs_.mstatus & kMstatusMpie;
+      csrs_.mstatus = (csrs_.mstatus & ~kMstatusMie) | (mpie ? kMstatusMie : 0) | kMstatusMpie;
+      next = csrs_.mepc;
+      taken = true;
+      break;
+    }
+    case Op::kWfi:
+      // Nothing could ever wake it up
+      if (clint_ == nullptr || csrs_.mie == 0) Halt("wfi with no interrupt enabled");
+      break;
+
+    case Op::kCsrrw:
+    case Op::kCsrrs:
+    case Op::kCsrrc:
+    case Op::kCsrrwi:
+    case Op::kCsrrsi:
+    case Op::kCsrrci: {
+      uint32_t src = (in.op == Op::kCsrrw || in.op == Op::kCsrrs || in.op == Op::kCsrrc)
+                         ? a : static_cast<uint32_t>(in.imm);
+      rd = ReadCsr(in.csr);
+      if (in.op == Op::kCsrrw || in.op == Op::kCsrrwi) {
+        WriteCsr(in.csr, src);
+      } else if (in.rs1 != 0) {
+        bool set = (in.op == Op::kCsrrs || in.op == Op::kCsrrsi);
+        WriteCsr(in.csr, set ? (rd | src) : (rd & ~src));
+      }
+      break;
+    }
+
+    case Op::kLrW:
+      addr = a;
+      if (addr & 3) {
+        TakeTrap(kCauseLoadMisalign, addr);
+        return !halted_;
+      }
+      rd = mem_->Read<uint32_t>(addr);
+      lr_valid_ = true;
+      lr_addr_ = addr;
+      break;
+    case Op::kScW:
+      addr = a;
+      if (addr & 3) {
+        TakeTrap(kCauseStoreMisalign, addr);
+        return !halted_;
+      }
+      if (lr_valid_ && lr_addr_ == addr) {
+        mem_->Write<uint32_t>(addr, b);
+        rd = 0;
+      } else {
+        rd = 1;
+      }
+      lr_valid_ = false;
+      break;
+    case Op::kAmoswapW:
+    case Op::kAmoaddW:
+    case Op::kAmoxorW:
+    case Op::kAmoandW:
+    case Op::kAmoorW:
+    case Op::kAmominW:
+    case Op::kAmomaxW:
+    case Op::kAmominuW:
+    case Op::kAmomaxuW: {
+      addr = a;
+      if (addr & 3) {
+        TakeTrap(kCauseStoreMisalign, addr);
+        return !halted_;
+      }
+      uint32_t m = mem_->Read<uint32_t>(addr);
+      uint32_t w = b;
+      switch (in.op) {
+        case Op::kAmoaddW: w = m + b; break;
+        case Op::kAmoxorW: w = m ^ b; break;
+        case Op::kAmoandW: w = m & b; break;
+        case Op::kAmoorW: w = m | b; break;
+        case Op::kAmominW: w = static_cast<int32_t>(m) < static_cast<int32_t>(b) ? m : b; break;
+        case Op::kAmomaxW: w = static_cast<int32_t>(m) > static_cast<int32_t>(b) ? m : b; break;
+        case Op::kAmominuW: w = m < b ? m : b; break;
+        case Op::kAmomaxuW: w = m > b ? m : b; break;
+        default: break;
+      }
+      mem_->Write<uint32_t>(addr, w);
+      rd = m;
+      break;
+    }
+
+    case Op::kIllegal:
+      TakeTrap(kCauseIllegal, raw);
+      return !halted_;
+  }
+
+  if (in.cls == Cls::kBranch && taken) next = pc + static_cast<uint32_t>(in.imm);
+  if (in.rd_wen) x_[in.rd] = rd;
+
+  instret_++;
+  if (timing_ != nullptr) timing_->Retire(RetireInfo{&in, pc, next, addr, taken});
+
+  // A jump to itself is how the programs end (e.g., "j ." after main)
+  if (next == pc && (in.cls == Cls::kJal || in.cls == Cls::kBranch)) {
+    char buf[48];
+    std::snprintf(buf, sizeof(buf), "self loop at pc 0x%08x", pc);
+    Halt(buf);
+  }
+  pc_ = next;
+  return !halted_;
+}
+
+}  // namespace e203sim
@@ -0,0 +1,130 @@
+// The RV32IMAC hart of the E203 simulator: the functional execution of the
+// machine mode, with the CSRs and the traps/interrupts the E203 has.
+#ifndef E203SIM_HART_H
+#define E203SIM_HART_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "decode.h"
+#include "timing.h"
+
+namespace e203sim {
+
+class Clint;
+class Memory;
+class Uart;
+
+// The machine CSRs kept by the hart, all of the architectural state apart
+// from the registers, the pc and the memory
+struct HartCsrs {
+  uint32_t mstatus = 0;
+  uint32_t mie = 0;
+  uint32_t mtvec = 0;
+  uint32_t mscratch = 0;
+  uint32_t mepc = 0;
+  uint32_t mcause = 0;
+  uint32_t mtval = 0;
+  uint64_t mcycle_ofs = 0;    // mcycle = the timing model cycles + this
+  uint64_t minstret_ofs = 0;  // minstret = the retired count + this
+};
+
+// A write to the marker CSR, with the counts of when it took place
+struct MarkEvent {
+  uint32_t id;
+  uint64_t instret;
+  uint64_t cycles;
+};
+
+class Hart {
+ public:
+  // The simulation marker CSR: a write of an id marks a point of the
+  // program (e.g., the start of the measured loop), the reads return 0 as
+  // on the core
+  static constexpr uint16_t kMarkCsr = 0x7ff;
+  // The simulation console CSR: a write prints its low byte as the UART
+  // would, in one instruction
+  static constexpr uint16_t kConsoleCsr = 0x7fe;
+
+  Hart(Memory* mem, Clint* clint);
+
+  void Reset(uint32_t pc);
+
+  // The timing model called on each retired instruction, may be null
+  void set_timing(TimingModel* timing) { timing_ = timing; }
+
+  // Trap on the misaligned loads/stores as the E203 does (the default), or
+  // do them as E203_HAS_UNALGN_SPLIT does
+  void set_misaligned_trap(bool trap) { misaligned_trap_ = trap; }
+
+  // The output of kConsoleCsr, may be null to drop it
+  void set_console(Uart* console) { console_ = console; }
+
+  // Halt after the instruction writing id to kMarkCsr, 0 for never
+  void set_stop_mark(uint32_t id) { stop_mark_ = id; }
+
+  // Run until n more instructions are retired or the hart halts, returns
+  // the number retired
+  uint64_t Run(uint64_t n);
+
+  // The marker writes so far, in order
+  const std::vector<MarkEvent>& marks() const { return marks_; }
+
+  bool halted() const { return halted_; }
+  const std::string& halt_reason() const { return halt_reason_; }
+
+  uint32_t pc() const { return pc_; }
+  void set_pc(uint32_t pc) { pc_ = pc; }
+  uint32_t x(int i) const { return x_[i]; }
+  void set_x(int i, uint32_t v) {
+    if (i != 0) x_[i] = v;
+  }
+  const HartCsrs& csrs() const { return csrs_; }
+  void set_csrs(const HartCsrs& c) { csrs_ = c; }
+
+  uint64_t instret() const { return instret_; }
+  uint64_t Cycles() const { return timing_ ? timing_->Cycles() : instret_; }
+
+ private:
+  struct DecodeEntry {
+    uint32_t pc = 1;  // Never a valid pc, so the entry starts empty
+    uint32_t raw = 0;
+    Inst inst;
+  };
+
+  static constexpr int kDecodeBits = 16;
+
+  bool Step();
+  void TakeTrap(uint32_t cause, uint32_t tval);
+  bool CheckInterrupt();
+  uint32_t ReadCsr(uint16_t csr);
+  void WriteCsr(uint16_t csr, uint32_t v);
+  void Halt(const std::string& reason);
+
+  Memory* mem_;
+  Clint* clint_;
+  TimingModel* timing_ = nullptr;
+  Uart* console_ = nullptr;
+  bool misaligned_trap_ = true;
+  uint32_t stop_mark_ = 0;
+
+  uint32_t x_[32] = {};
+  uint32_t pc_ = 0;
+  HartCsrs csrs_;
+  uint64_t instret_ = 0;
+
+  bool lr_valid_ = false;
+  uint32_t lr_addr_ = 0;
+
+  bool halted_ = false;
+  std::string halt_reason_;
+  std::vector<MarkEvent> marks_;
+
+  std::vector<DecodeEntry> dcache_;
+};
+
+}  // namespace e203sim
+
+#endif  // E203SIM_HART_H
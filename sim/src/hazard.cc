@@ -0,0 +1,127 @@
+#include "hazard.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "proc.h"
+
+namespace e203sim {
+
+namespace {
+
+// Few enough chunks to merge cheaply, enough to keep the threads busy
+constexpr size_t kMinChunk = size_t{1} << 20;
+constexpr size_t kChunksPerJob = 4;
+
+constexpr int64_t kNone = -1;
+
+void AnalyzeChunk(const CommitTrace& t, size_t begin, size_t end, HazardReport* out) {
+  // The last writer of each register and whether it was a load
+  int64_t writer[32];
+  bool by_load[32] = {};
+  std::fill(writer, writer + 32, kNone);
+
+  size_t first = begin > static_cast<size_t>(kHazardDists) ? begin - kHazardDists : 0;
+  for (size_t i = first; i < end; i++) {
+    const CommitRecord& c = t[i];
+    int64_t at = static_cast<int64_t>(i);
+    if (i >= begin) {
+      // The stall the model recorded at the dispatch, by cause; the fetch
+      // bubbles after a jump or a mispredict are not in it
+      uint64_t stall = CommitStallCycles(c);
+      StallCause cause = CommitStallCause(c);
+      uint64_t raw = cause == StallCause::kRaw ? stall : 0;
+      uint64_t waw = cause == StallCause::kWaw ? stall : 0;
+      PcHazards& h = out->pcs[c.pc];
+      h.inst = c.inst;
+      h.count++;
+      h.stall += stall;
+
+      // The nearest producer of a source, and of a source a load wrote
+      int64_t near = kNone;
+      int64_t near_load = kNone;
+      bool has_src = false;
+      auto source = [&](bool en, uint8_t r) {
+        if (!en || r == 0) return;
+        has_src = true;
+        near = std::max(near, writer[r]);
+        if (by_load[r]) near_load = std::max(near_load, writer[r]);
+      };
+      source(c.flags & kCommitRs1En, c.rs1);
+      source(c.flags & kCommitRs2En, c.rs2);
+
+      if (has_src) {
+        int64_t d = near == kNone ? kHazardDists - 1 : at - near - 1;
+        h.dist[std::min<int64_t>(d, kHazardDists - 1)]++;
+      }
+      bool load_use = false;
+      if (near_load != kNone && at - near_load - 1 < kLoadUseDists) {
+        int64_t d = at - near_load - 1;
+        h.load_use[d]++;
+        h.load_use_stalled[d] += raw > 0;
+        h.load_use_stall[d] += raw;
+        load_use = true;
+      }
+      if (!load_use && (c.flags & kCommitRdWen) && c.rd != 0 && by_load[c.rd] &&
+          at - writer[c.rd] - 1 < kLoadUseDists) {
+        h.waw_load++;
+        h.waw_load_stall += waw;
+      }
+    }
+    if ((c.flags & kCommitRdWen) && c.rd != 0) {
+      writer[c.rd] = at;
+      by_load[c.rd] = (c.flags & kCommitLoad) != 0;
+    }
+  }
+}
+
+}  // namespace
+
+void PcHazards::Add(const PcHazards& o) {
+  inst = o.inst;
+  count += o.count;
+  stall += o.stall;
+  for (int d = 0; d < kHazardDists; d++) dist[d] += o.dist[d];
+  for (int d = 0; d < kLoadUseDists; d++) {
+    load_use[d] += o.load_use[d];
+    load_use_stalled[d] += o.load_use_stalled[d];
+    load_use_stall[d] += o.load_use_stall[d];
+  }
+  waw_load += o.waw_load;
+  waw_load_stall += o.waw_load_stall;
+}
+
+HazardReport AnalyzeHazards(const CommitTrace& trace, unsigned jobs) {
+  size_t n = trace.size();
+  size_t chunks = std::max<size_t>(1, std::min<size_t>(size_t{jobs} * kChunksPerJob,
+                                                      n / kMinChunk));
+  std::vector<HazardReport> parts(chunks);
+  ParallelFor(chunks, jobs, [&](size_t k) {
+    AnalyzeChunk(trace, n * k / chunks, n * (k + 1) / chunks, &parts[k]);
+  });
+
+  HazardReport r;
+  r.insts = n;
+  r.cycles = n > 0 ? trace[n - 1].cycle : 0;
+  for (const HazardReport& p : parts) {
+    for (const auto& [pc, h] : p.pcs) {
+      r.pcs[pc].Add(h);
+      r.total.Add(h);
+    }
+  }
+  return r;
+}
+
+BypassEstimate EstimateBypass(const PcHazards& h) {
+  BypassEstimate e;
+  e.early_load = 0;
+  e.ideal_load = 0;
+  for (int d = 0; d < kLoadUseDists; d++) {
+    e.early_load += h.load_use_stalled[d];
+    e.ideal_load += h.load_use_stall[d];
+  }
+  e.waw_load = h.waw_load_stall;
+  return e;
+}
+
+}  // namespace e203sim
@@ -0,0 +1,82 @@
+// The hazard analysis of e203hazard over a commit trace (commit_trace.h).
+//
+// For each instruction it finds the nearest earlier instruction that wrote
+// one of its sources, and counts, per PC:
+//   * the distance to it, the number of instructions in between (0 is the
+//     instruction right before), the last bin holding the further ones
+//     and those with no producer at all;
+//   * the load-use pairs, the nearest load producer at distance 0, 1 or 2,
+//     and the RAW stall cycles of those consumers;
+//   * the WAW after a load, a destination a load within distance 2 writes,
+//     and its WAW stall cycles;
+//   * the stall cycles, the dispatch stall the timing model recorded for
+//     the instruction (of any cause).
+// The stalls are the ones of the records (CommitStallCycles), not the
+// cycle deltas between them, which also hold the fetch bubbles after the
+// taken jumps and the mispredicts, and the MUL/DIV latency.
+//
+// The trace is cut into chunks analyzed in parallel. Each chunk first
+// replays the kHazardDists records before it, without counting them: no
+// count looks further back, so the result is the same as one pass.
+#ifndef E203SIM_HAZARD_H
+#define E203SIM_HAZARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include "commit_trace.h"
+
+namespace e203sim {
+
+constexpr int kHazardDists = 8;
+constexpr int kLoadUseDists = 3;
+
+struct PcHazards {
+  uint32_t inst = 0;  // The (expanded) encoding, for the report
+  uint64_t count = 0;
+  uint64_t stall = 0;
+
+  // Of the instructions with a source other than x0
+  uint64_t dist[kHazardDists] = {};
+
+  uint64_t load_use[kLoadUseDists] = {};
+  uint64_t load_use_stalled[kLoadUseDists] = {};  // Of those, the ones that stalled
+  uint64_t load_use_stall[kLoadUseDists] = {};
+
+  // Not counted when the instruction is also a load-use consumer, so the
+  // stall is the WAW's
+  uint64_t waw_load = 0;
+  uint64_t waw_load_stall = 0;
+
+  void Add(const PcHazards& o);
+};
+
+struct HazardReport {
+  uint64_t insts = 0;
+  uint64_t cycles = 0;  // Of the last record
+  PcHazards total;
+  std::unordered_map<uint32_t, PcHazards> pcs;
+};
+
+// Analyze the trace in up to jobs threads
+HazardReport AnalyzeHazards(const CommitTrace& trace, unsigned jobs);
+
+// What further bypass paths would save, estimated from the stall cycles
+// of the consumers they would serve
+struct BypassEstimate {
+  // The load data one cycle earlier (from the LSU response rather than its
+  // write-back): one cycle of each stalled load-use consumer
+  uint64_t early_load;
+  // No load-use stall at all, the bound of any load bypass
+  uint64_t ideal_load;
+  // No WAW stall on a load in flight (the write-back ordered by the OITF
+  // instead of held at the dispatch)
+  uint64_t waw_load;
+};
+
+BypassEstimate EstimateBypass(const PcHazards& h);
+
+}  // namespace e203sim
+
+#endif  // E203SIM_HAZARD_H
@@ -0,0 +1,206 @@
+// e203hazard: the hazard distances and the forwarding opportunity of a
+// commit trace (see hazard.h), to pick the next bypass of the RTL from the
+// data.
+//
+//   e203sim --commit-trace prog.ct prog.elf
+//   e203hazard [--jobs N] [--top N] [--csv FILE] prog.ct
+//
+// The trace is mapped, not read, so a trace of many GB takes no memory of
+// its own; its chunks are analyzed on --jobs threads. The report has the
+// distance distribution, the load-use pairs and the WAW after a load over
+// the whole trace, what further bypasses would save, and the PCs with the
+// most stall cycles. --csv writes the counts of every PC.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "commit_trace.h"
+#include "decode.h"
+#include "hazard.h"
+#include "proc.h"
+
+namespace {
+
+using e203sim::kHazardDists;
+using e203sim::kLoadUseDists;
+using e203sim::PcHazards;
+
+struct Options {
+  unsigned jobs = e203sim::HostCores();
+  uint64_t top = 20;
+  std::string csv;
+  const char* trace = nullptr;
+};
+
+void Usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [options] prog.ct\n"
+               "  --jobs N              analysis threads (default: the host cores)\n"
+               "  --top N               the PCs listed, by stall cycles (default 20)\n"
+               "  --csv FILE            also write the counts of every PC as CSV\n",
+               argv0);
+}
+
+bool ParseCount(const char* s, uint64_t* v) {
+  char* end = nullptr;
+  *v = std::strtoull(s, &end, 0);
+  return *s != '\0' && *end == '\0';
+}
+
+// 0 on success, else the exit code
+int ParseArgs(int argc, char** argv, Options* o) {
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool has_next = i + 1 < argc;
+    uint64_t n = 0;
+    if ((a == "--jobs" || a == "--top") && has_next) {
+      if (!ParseCount(argv[++i], &n) || (n == 0 && a == "--jobs")) {
+        std::fprintf(stderr, "bad %s %s\n", a.c_str(), argv[i]);
+        return 2;
+      }
+      if (a == "--jobs") o->jobs = static_cast<unsigned>(n);
+      if (a == "--top") o->top = n;
+    } else if (a == "--csv" && has_next) {
+      o->csv = argv[++i];
+    } else if (a == "-h" || a == "--help") {
+      Usage(argv[0]);
+      return 1;
+    } else if (a[0] != '-' && o->trace == nullptr) {
+      o->trace = argv[i];
+    } else {
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+  if (o->trace == nullptr) {
+    Usage(argv[0]);
+    return 2;
+  }
+  return 0;
+}
+
+double Percent(uint64_t part, uint64_t whole) {
+  return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+unsigned long long Ull(uint64_t v) { return static_cast<unsigned long long>(v); }
+
+const char* Mnemonic(const PcHazards& h) {
+  return e203sim::OpName(e203sim::Decode(h.inst).op);
+}
+
+void PrintSummary(const e203sim::HazardReport& r) {
+  const PcHazards& t = r.total;
+  std::printf("%llu instructions, %llu cycles, CPI %.3f, %llu dispatch stall cycles (%.1f%%)\n",
+              Ull(r.insts), Ull(r.cycles),
+              r.insts ? static_cast<double>(r.cycles) / r.insts : 0.0, Ull(t.stall),
+              Percent(t.stall, r.cycles));
+
+  uint64_t consumers = 0;
+  for (int d = 0; d < kHazardDists; d++) consumers += t.dist[d];
+  std::printf("\nproducer-consumer distance (%llu consumers)\n", Ull(consumers));
+  for (int d = 0; d < kHazardDists; d++) {
+    std::string label = d < kHazardDists - 1 ? std::to_string(d) : ">=" + std::to_string(d);
+    std::printf("  %-8s %14llu %6.1f%%\n", label.c_str(), Ull(t.dist[d]),
+                Percent(t.dist[d], consumers));
+  }
+
+  std::printf("\n%-18s %14s %14s %14s\n", "", "pairs", "stalled", "stall cycles");
+  for (int d = 0; d < kLoadUseDists; d++) {
+    std::string label = "load-use d=" + std::to_string(d);
+    std::printf("  %-16s %14llu %14llu %14llu\n", label.c_str(), Ull(t.load_use[d]),
+                Ull(t.load_use_stalled[d]), Ull(t.load_use_stall[d]));
+  }
+  std::printf("  %-16s %14llu %14s %14llu\n", "WAW after load", Ull(t.waw_load), "",
+              Ull(t.waw_load_stall));
+
+  e203sim::BypassEstimate e = e203sim::EstimateBypass(t);
+  std::printf("\nestimated savings (of the stall cycles seen)\n");
+  std::printf("  %-34s %14llu %6.2f%%\n", "load data one cycle earlier", Ull(e.early_load),
+              Percent(e.early_load, r.cycles));
+  std::printf("  %-34s %14llu %6.2f%%\n", "no load-use stall (bound)", Ull(e.ideal_load),
+              Percent(e.ideal_load, r.cycles));
+  std::printf("  %-34s %14llu %6.2f%%\n", "no WAW hold on a load in flight", Ull(e.waw_load),
+              Percent(e.waw_load, r.cycles));
+}
+
+void PrintTop(const std::vector<std::pair<uint32_t, const PcHazards*>>& pcs, uint64_t top,
+              uint64_t cycles) {
+  if (top == 0) return;
+  std::printf("\n%-10s %-8s %12s %12s %6s %10s %10s %10s %10s %10s\n", "pc", "inst", "count",
+              "stall", "%", "d0", "d1", "d2", "load-use", "waw-load");
+  for (size_t i = 0; i < pcs.size() && i < top; i++) {
+    const PcHazards& h = *pcs[i].second;
+    uint64_t load_use = 0;
+    for (int d = 0; d < kLoadUseDists; d++) load_use += h.load_use[d];
+    std::printf("0x%08x %-8s %12llu %12llu %6.2f %10llu %10llu %10llu %10llu %10llu\n",
+                pcs[i].first, Mnemonic(h), Ull(h.count), Ull(h.stall), Percent(h.stall, cycles),
+                Ull(h.dist[0]), Ull(h.dist[1]), Ull(h.dist[2]), Ull(load_use),
+                Ull(h.waw_load));
+  }
+}
+
+bool WriteCsv(const std::string& path,
+              std::vector<std::pair<uint32_t, const PcHazards*>> pcs) {
+  std::FILE* f = std::fopen(path.c_str(), "w");
+  if (f == nullptr) return false;
+  std::sort(pcs.begin(), pcs.end());
+  std::fprintf(f, "pc,inst,count,stall");
+  for (int d = 0; d < kHazardDists; d++) std::fprintf(f, ",dist%d", d);
+  for (int d = 0; d < kLoadUseDists; d++) {
+    std::fprintf(f, ",load_use%d,load_use%d_stalled,load_use%d_stall", d, d, d);
+  }
+  std::fprintf(f, ",waw_load,waw_load_stall\n");
+  for (const auto& [pc, h] : pcs) {
+    std::fprintf(f, "0x%08x,%s,%llu,%llu", pc, Mnemonic(*h), Ull(h->count), Ull(h->stall));
+    for (int d = 0; d < kHazardDists; d++) std::fprintf(f, ",%llu", Ull(h->dist[d]));
+    for (int d = 0; d < kLoadUseDists; d++) {
+      std::fprintf(f, ",%llu,%llu,%llu", Ull(h->load_use[d]), Ull(h->load_use_stalled[d]),
+                   Ull(h->load_use_stall[d]));
+    }
+    std::fprintf(f, ",%llu,%llu\n", Ull(h->waw_load), Ull(h->waw_load_stall));
+  }
+  return std::fclose(f) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options o;
+  if (int rc = ParseArgs(argc, argv, &o)) return rc == 1 ? 0 : rc;
+
+  e203sim::CommitTrace trace;
+  std::string err;
+  if (!trace.Open(o.trace, &err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 2;
+  }
+  auto t0 = std::chrono::steady_clock::now();
+  e203sim::HazardReport r = e203sim::AnalyzeHazards(trace, o.jobs);
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  // By stall cycles, then by PC, so the order does not depend on the chunks
+  std::vector<std::pair<uint32_t, const PcHazards*>> pcs;
+  pcs.reserve(r.pcs.size());
+  for (const auto& [pc, h] : r.pcs) pcs.emplace_back(pc, &h);
+  std::sort(pcs.begin(), pcs.end(), [](const auto& a, const auto& b) {
+    if (a.second->stall != b.second->stall) return a.second->stall > b.second->stall;
+    return a.first < b.first;
+  });
+
+  PrintSummary(r);
+  PrintTop(pcs, o.top, r.cycles);
+  std::fflush(stdout);
+  if (!o.csv.empty() && !WriteCsv(o.csv, pcs)) {
+    std::fprintf(stderr, "cannot write %s\n", o.csv.c_str());
+    return 2;
+  }
+  std::fprintf(stderr, "%zu PCs in %.2f s (%.1fM records/s)\n", r.pcs.size(), secs,
+               secs > 0 ? r.insts / secs / 1e6 : 0.0);
+  return 0;
+}
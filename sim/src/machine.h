@@ -0,0 +1,37 @@
+// The simulated HBirdv2 SoC: the memory, the CLINT and UART devices and the
+// hart, wired together as every run mode of e203sim needs them.
+#ifndef E203SIM_MACHINE_H
+#define E203SIM_MACHINE_H
+
+#include <cstdint>
+#include <cstdio>
+
+#include "devices.h"
+#include "hart.h"
+#include "memory.h"
+
+namespace e203sim {
+
+struct Machine {
+  // uart_out may be null to drop the UART output
+  Machine(uint32_t rtc_div, FILE* uart_out)
+      : clint([this] { return hart.Cycles(); }, rtc_div),
+        uart(uart_out),
+        hart(&mem, &clint) {
+    mem.AddDevice(Clint::kBase, Clint::kSize, &clint);
+    mem.AddDevice(Uart::kBase, Uart::kSize, &uart);
+    hart.set_console(&uart);
+  }
+
+  Machine(const Machine&) = delete;
+  Machine& operator=(const Machine&) = delete;
+
+  Memory mem;
+  Clint clint;
+  Uart uart;
+  Hart hart;
+};
+
+}  // namespace e203sim
+
+#endif  // E203SIM_MACHINE_H
@@ -0,0 +1,460 @@
+// e203sim: run an RV32 ELF (e.g., the CoreMark of benchmark/) on the
+// functional hart with a timing model, and report the cycles it takes.
+//
+// The sampled simulation runs in three steps (the second one is
+// e203simpoint):
+//   e203sim --bbv prog.bb --interval N prog.elf
+//   e203simpoint prog.bb prog.simpts
+//   e203sim --simpoints prog.simpts --interval N --ckpt-dir DIR prog.elf
+// then the windows of DIR run on e203sim (--sampled DIR) or on the RTL.
+//
+// A program can also be checkpointed where it writes a marker (see
+// Hart::kMarkCsr), e.g., past the CoreMark initialization, and every
+// variant of the model (--restore) or of the RTL goes on from there:
+//   e203sim --ckpt-at-mark 1 --ckpt-dir DIR [--rtl-images] prog.elf
+//   e203sim --restore DIR/mark1.ckpt --stop-mark 2 -o fwd=off
+//
+// --commit-trace writes a record per retired instruction for e203hazard.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "bbv.h"
+#include "checkpoint.h"
+#include "commit_trace.h"
+#include "elf_image.h"
+#include "machine.h"
+#include "simpoint.h"
+#include "timing.h"
+
+namespace {
+
+using e203sim::Machine;
+
+struct Options {
+  std::string model = "e203";
+  e203sim::ModelOptions model_opts;
+  uint64_t max_insts = ~uint64_t{0};
+  uint32_t rtc_div = 1;
+  bool misaligned_trap = true;
+  bool stats = false;
+  bool quiet = false;
+  std::string commit_trace;
+
+  uint64_t interval = 0;
+  uint64_t warmup = 0;
+  std::string bbv;
+  std::string simpoints;
+  std::string ckpt_dir;
+  std::string sampled;
+  std::string rtl_image;
+  std::string restore;
+  uint32_t ckpt_mark = 0;
+  uint32_t stop_mark = 0;
+  bool rtl_images = false;
+  e203sim::RtlLayout layout;
+
+  const char* elf = nullptr;
+};
+
+void Usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [options] prog.elf\n"
+               "       %s [options] --sampled DIR\n"
+               "  --model NAME          timing model (default e203):",
+               argv0, argv0);
+  for (const std::string& n : e203sim::TimingModelNames()) std::fprintf(stderr, " %s", n.c_str());
+  std::fprintf(stderr,
+               "\n"
+               "  -o KEY=VALUE          timing model option, repeatable\n"
+               "  --max-insts N         stop after N instructions\n"
+               "  --rtc-div N           mtime = cycles / N (default 1)\n"
+               "  --misaligned allow    do the misaligned loads/stores instead of trapping\n"
+               "  --stats               print the timing model counters\n"
+               "  --quiet               do not print the UART output\n"
+               "  --commit-trace FILE   write the commit trace of the run (see e203hazard)\n"
+               "sampled simulation:\n"
+               "  --bbv FILE            write the basic-block vectors of each interval\n"
+               "  --interval N          instructions per interval\n"
+               "  --simpoints FILE      checkpoint the points picked by e203simpoint ...\n"
+               "  --ckpt-dir DIR        ... into DIR\n"
+               "  --warmup N            detailed warm-up instructions before each window\n"
+               "  --rtl-images          also write the RTL ITCM/DTCM images of each checkpoint\n"
+               "  --stub-addr ADDR      the ITCM address of the RTL restore stub\n"
+               "  --sampled DIR         run the windows of DIR, report the weighted CPI\n"
+               "  --rtl-image PREFIX    boot the RTL images of a checkpoint (to check them)\n"
+               "checkpoints at a marker:\n"
+               "  --ckpt-at-mark ID     checkpoint into --ckpt-dir at the marker ID\n"
+               "  --restore FILE        run from a checkpoint instead of an ELF\n"
+               "  --stop-mark ID        stop at the marker ID\n");
+}
+
+bool ParseCount(const char* s, uint64_t* v) {
+  char* end = nullptr;
+  *v = std::strtoull(s, &end, 0);
+  return *s != '\0' && *end == '\0';
+}
+
+// 0 on success, else the exit code
+int ParseArgs(int argc, char** argv, Options* o) {
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool has_next = i + 1 < argc;
+    uint64_t n = 0;
+    if (a == "--model" && has_next) {
+      o->model = argv[++i];
+    } else if (a == "-o" && has_next) {
+      std::string kv = argv[++i];
+      size_t eq = kv.find('=');
+      if (eq == std::string::npos) {
+        std::fprintf(stderr, "bad model option %s, expected KEY=VALUE\n", kv.c_str());
+        return 2;
+      }
+      o->model_opts.push_back({kv.substr(0, eq), kv.substr(eq + 1)});
+    } else if ((a == "--max-insts" || a == "--interval" || a == "--warmup") && has_next) {
+      if (!ParseCount(argv[++i], &n)) {
+        std::fprintf(stderr, "bad %s %s\n", a.c_str(), argv[i]);
+        return 2;
+      }
+      if (a == "--max-insts") o->max_insts = n;
+      if (a == "--interval") o->interval = n;
+      if (a == "--warmup") o->warmup = n;
+    } else if ((a == "--rtc-div" || a == "--stub-addr" || a == "--ckpt-at-mark" ||
+                a == "--stop-mark") && has_next) {
+      if (!ParseCount(argv[++i], &n) || n == 0 || n > 0xffffffffu) {
+        std::fprintf(stderr, "bad %s %s\n", a.c_str(), argv[i]);
+        return 2;
+      }
+      if (a == "--rtc-div") o->rtc_div = static_cast<uint32_t>(n);
+      if (a == "--stub-addr") o->layout.stub_addr = static_cast<uint32_t>(n);
+      if (a == "--ckpt-at-mark") o->ckpt_mark = static_cast<uint32_t>(n);
+      if (a == "--stop-mark") o->stop_mark = static_cast<uint32_t>(n);
+    } else if (a == "--misaligned" && has_next) {
+      if (std::strcmp(argv[++i], "allow") != 0) {
+        std::fprintf(stderr, "bad --misaligned %s\n", argv[i]);
+        return 2;
+      }
+      o->misaligned_trap = false;
+    } else if (a == "--commit-trace" && has_next) {
+      o->commit_trace = argv[++i];
+    } else if (a == "--bbv" && has_next) {
+      o->bbv = argv[++i];
+    } else if (a == "--simpoints" && has_next) {
+      o->simpoints = argv[++i];
+    } else if (a == "--ckpt-dir" && has_next) {
+      o->ckpt_dir = argv[++i];
+    } else if (a == "--sampled" && has_next) {
+      o->sampled = argv[++i];
+    } else if (a == "--rtl-image" && has_next) {
+      o->rtl_image = argv[++i];
+    } else if (a == "--restore" && has_next) {
+      o->restore = argv[++i];
+    } else if (a == "--rtl-images") {
+      o->rtl_images = true;
+    } else if (a == "--stats") {
+      o->stats = true;
+    } else if (a == "--quiet") {
+      o->quiet = true;
+    } else if (a == "-h" || a == "--help") {
+      Usage(argv[0]);
+      return 1;
+    } else if (a[0] != '-' && o->elf == nullptr) {
+      o->elf = argv[i];
+    } else {
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+
+  bool need_elf = o->sampled.empty() && o->rtl_image.empty() && o->restore.empty();
+  if (need_elf != (o->elf != nullptr)) {
+    Usage(argv[0]);
+    return 2;
+  }
+  if ((!o->bbv.empty() || !o->simpoints.empty()) && o->interval == 0) {
+    std::fprintf(stderr, "--bbv and --simpoints need --interval\n");
+    return 2;
+  }
+  if ((!o->simpoints.empty() || o->ckpt_mark != 0) && o->ckpt_dir.empty()) {
+    std::fprintf(stderr, "--simpoints and --ckpt-at-mark need --ckpt-dir\n");
+    return 2;
+  }
+  return 0;
+}
+
+std::unique_ptr<e203sim::TimingModel> MakeModel(const Options& o, const std::string& name) {
+  std::string err;
+  std::unique_ptr<e203sim::TimingModel> timing =
+      e203sim::MakeTimingModel(name, name == o.model ? o.model_opts : e203sim::ModelOptions(), &err);
+  if (!timing) std::fprintf(stderr, "%s\n", err.c_str());
+  return timing;
+}
+
+bool LoadElf(const Options& o, Machine* m) {
+  e203sim::ElfImage elf;
+  std::string err;
+  if (!elf.Open(o.elf, &err)) {
+    std::fprintf(stderr, "%s: %s\n", o.elf, err.c_str());
+    return false;
+  }
+  elf.Load(&m->mem);
+  m->hart.Reset(elf.entry());
+  return true;
+}
+
+void Report(const Options& o, const Machine& m, const e203sim::TimingModel& timing,
+            const char* model, double secs) {
+  uint64_t insts = m.hart.instret();
+  uint64_t cycles = m.hart.Cycles();
+  std::fprintf(stderr, "\n==== e203sim (%s) ====\n", model);
+  std::fprintf(stderr, "stop:      %s\n",
+               m.hart.halted() ? m.hart.halt_reason().c_str() : "instruction limit");
+  std::fprintf(stderr, "instret:   %llu\n", static_cast<unsigned long long>(insts));
+  std::fprintf(stderr, "cycles:    %llu\n", static_cast<unsigned long long>(cycles));
+  std::fprintf(stderr, "CPI:       %.3f\n", insts ? static_cast<double>(cycles) / insts : 0.0);
+  std::fprintf(stderr, "host time: %.3f s (%.1f MIPS)\n", secs,
+               secs > 0 ? insts / secs / 1e6 : 0.0);
+  if (o.stats) timing.PrintStats(stderr);
+}
+
+double Seconds(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// The whole program with the timing model, with the commit trace and the
+// BBV profiler around it
+int RunFull(const Options& o) {
+  Machine m(o.rtc_div, o.quiet ? nullptr : stdout);
+  std::unique_ptr<e203sim::TimingModel> timing = MakeModel(o, o.model);
+  if (!timing) return 2;
+
+  FILE* trace_out = nullptr;
+  e203sim::CommitTraceWriter* trace = nullptr;
+  if (!o.commit_trace.empty()) {
+    trace_out = std::fopen(o.commit_trace.c_str(), "wb");
+    if (trace_out == nullptr) {
+      std::fprintf(stderr, "cannot write %s\n", o.commit_trace.c_str());
+      return 2;
+    }
+    trace = new e203sim::CommitTraceWriter(std::move(timing), trace_out);
+    timing.reset(trace);
+  }
+
+  FILE* bbv_out = nullptr;
+  e203sim::BbvProfiler* bbv = nullptr;
+  if (!o.bbv.empty()) {
+    bbv_out = std::fopen(o.bbv.c_str(), "w");
+    if (bbv_out == nullptr) {
+      std::fprintf(stderr, "cannot write %s\n", o.bbv.c_str());
+      return 2;
+    }
+    bbv = new e203sim::BbvProfiler(std::move(timing), o.interval, bbv_out);
+    timing.reset(bbv);
+  }
+
+  m.hart.set_timing(timing.get());
+  std::string err;
+  uint64_t position = 0;
+  if (!o.rtl_image.empty()) {
+    if (!e203sim::LoadRtlImages(o.rtl_image, &m, o.layout, &err)) {
+      std::fprintf(stderr, "%s\n", err.c_str());
+      return 2;
+    }
+  } else if (!o.restore.empty()) {
+    if (!e203sim::LoadCheckpoint(o.restore, &m, &position, &err)) {
+      std::fprintf(stderr, "%s\n", err.c_str());
+      return 2;
+    }
+    std::fprintf(stderr, "restored %s at instruction %llu\n", o.restore.c_str(),
+                 static_cast<unsigned long long>(position));
+  } else if (!LoadElf(o, &m)) {
+    return 2;
+  }
+  m.hart.set_misaligned_trap(o.misaligned_trap);
+  m.hart.set_stop_mark(o.stop_mark);
+
+  auto t0 = std::chrono::steady_clock::now();
+  m.hart.Run(o.max_insts);
+  double secs = Seconds(t0);
+  std::fflush(stdout);
+  if (bbv != nullptr) {
+    bbv->Flush();
+    std::fclose(bbv_out);
+  }
+  if (trace != nullptr) {
+    bool ok = trace->Flush();
+    ok &= std::fclose(trace_out) == 0;
+    std::fprintf(stderr, ok ? "%s: %llu records\n" : "%s: write error after %llu records\n",
+                 o.commit_trace.c_str(), static_cast<unsigned long long>(trace->records()));
+  }
+  Report(o, m, *timing, o.model.c_str(), secs);
+  return 0;
+}
+
+// Fast-forward functionally to the marker and checkpoint there
+int RunMarkCheckpoint(const Options& o) {
+  mkdir(o.ckpt_dir.c_str(), 0777);
+  Machine m(o.rtc_div, o.quiet ? nullptr : stdout);
+  std::unique_ptr<e203sim::TimingModel> timing = MakeModel(o, "ideal");
+  if (!timing || !LoadElf(o, &m)) return 2;
+  m.hart.set_timing(timing.get());
+  m.hart.set_misaligned_trap(o.misaligned_trap);
+  m.hart.set_stop_mark(o.ckpt_mark);
+
+  auto t0 = std::chrono::steady_clock::now();
+  m.hart.Run(o.max_insts);
+  std::fflush(stdout);
+  std::string want = "mark " + std::to_string(o.ckpt_mark);
+  if (m.hart.halt_reason() != want) {
+    std::fprintf(stderr, "\nno %s (stopped: %s)\n", want.c_str(),
+                 m.hart.halted() ? m.hart.halt_reason().c_str() : "instruction limit");
+    return 2;
+  }
+
+  std::string err;
+  std::string prefix = o.ckpt_dir + "/mark" + std::to_string(o.ckpt_mark);
+  uint32_t stub_jal_pc = 0;
+  if (!e203sim::SaveCheckpoint(prefix + ".ckpt", m, m.hart.instret(), &err) ||
+      (o.rtl_images && !e203sim::WriteRtlImages(prefix, m, o.layout, &stub_jal_pc, &err))) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 2;
+  }
+  std::fprintf(stderr, "\n%s.ckpt at instruction %llu, pc 0x%08x (%.3f s)\n", prefix.c_str(),
+               static_cast<unsigned long long>(m.hart.instret()), m.hart.pc(), Seconds(t0));
+  if (o.rtl_images) {
+    std::fprintf(stderr, "%s.{itcm,dtcm}.verilog, the stub ends at 0x%08x\n", prefix.c_str(),
+                 stub_jal_pc);
+  }
+  return 0;
+}
+
+// Fast-forward functionally to each point, less the warm-up, and checkpoint
+int RunCheckpoints(const Options& o) {
+  std::string err;
+  std::vector<e203sim::SimPoint> points;
+  if (!e203sim::ReadSimPoints(o.simpoints, &points, &err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 2;
+  }
+  mkdir(o.ckpt_dir.c_str(), 0777);
+
+  Machine m(o.rtc_div, nullptr);
+  std::unique_ptr<e203sim::TimingModel> timing = MakeModel(o, "ideal");
+  if (!timing || !LoadElf(o, &m)) return 2;
+  m.hart.set_timing(timing.get());
+  m.hart.set_misaligned_trap(o.misaligned_trap);
+
+  auto t0 = std::chrono::steady_clock::now();
+  std::vector<e203sim::ManifestEntry> entries;
+  for (size_t i = 0; i < points.size(); i++) {
+    e203sim::ManifestEntry e;
+    e.name = "sp" + std::to_string(i);
+    e.interval = points[i].interval;
+    e.weight = points[i].weight;
+    uint64_t start = points[i].interval * o.interval;
+    e.position = start > o.warmup ? start - o.warmup : 0;
+    e.warmup = start - e.position;
+    e.window = o.interval;
+    e.stub_jal_pc = 0;
+
+    if (e.position < m.hart.instret()) {
+      std::fprintf(stderr, "%s: the points must be in order\n", o.simpoints.c_str());
+      return 2;
+    }
+    m.hart.Run(e.position - m.hart.instret());
+    if (m.hart.instret() != e.position) {
+      std::fprintf(stderr, "%s: stopped at %llu before the point %llu (%s)\n", e.name.c_str(),
+                   static_cast<unsigned long long>(m.hart.instret()),
+                   static_cast<unsigned long long>(e.position), m.hart.halt_reason().c_str());
+      return 2;
+    }
+
+    std::string prefix = o.ckpt_dir + "/" + e.name;
+    if (!e203sim::SaveCheckpoint(prefix + ".ckpt", m, e.position, &err) ||
+        (o.rtl_images && !e203sim::WriteRtlImages(prefix, m, o.layout, &e.stub_jal_pc, &err))) {
+      std::fprintf(stderr, "%s: %s\n", e.name.c_str(), err.c_str());
+      return 2;
+    }
+    entries.push_back(e);
+  }
+  if (!e203sim::WriteManifest(o.ckpt_dir + "/manifest.txt", entries, &err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 2;
+  }
+  std::fprintf(stderr, "%zu checkpoints in %s (%.3f s)\n", entries.size(), o.ckpt_dir.c_str(),
+               Seconds(t0));
+  return 0;
+}
+
+// Each window from its checkpoint with a cold model, warmed up for the
+// warm-up instructions, then the weighted CPI
+int RunSampled(const Options& o) {
+  std::string err;
+  std::vector<e203sim::ManifestEntry> entries;
+  if (!e203sim::ReadManifest(o.sampled + "/manifest.txt", &entries, &err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 2;
+  }
+
+  auto t0 = std::chrono::steady_clock::now();
+  double cpi = 0;
+  double weights = 0;
+  uint64_t insts = 0;
+  std::fprintf(stderr, "%-8s %10s %8s %12s %12s %8s\n", "point", "interval", "weight", "insts",
+               "cycles", "CPI");
+  for (const e203sim::ManifestEntry& e : entries) {
+    Machine m(o.rtc_div, nullptr);
+    std::unique_ptr<e203sim::TimingModel> timing = MakeModel(o, o.model);
+    if (!timing) return 2;
+    m.hart.set_timing(timing.get());
+    m.hart.set_misaligned_trap(o.misaligned_trap);
+    uint64_t position = 0;
+    if (!e203sim::LoadCheckpoint(o.sampled + "/" + e.name + ".ckpt", &m, &position, &err)) {
+      std::fprintf(stderr, "%s\n", err.c_str());
+      return 2;
+    }
+
+    m.hart.Run(e.warmup);
+    uint64_t i0 = m.hart.instret();
+    uint64_t c0 = m.hart.Cycles();
+    m.hart.Run(e.window);
+    uint64_t di = m.hart.instret() - i0;
+    uint64_t dc = m.hart.Cycles() - c0;
+    insts += m.hart.instret();
+    if (di == 0) {
+      std::fprintf(stderr, "%-8s: no instruction in the window (%s)\n", e.name.c_str(),
+                   m.hart.halt_reason().c_str());
+      continue;
+    }
+    double w_cpi = static_cast<double>(dc) / static_cast<double>(di);
+    std::fprintf(stderr, "%-8s %10llu %8.4f %12llu %12llu %8.3f\n", e.name.c_str(),
+                 static_cast<unsigned long long>(e.interval), e.weight,
+                 static_cast<unsigned long long>(di), static_cast<unsigned long long>(dc), w_cpi);
+    cpi += e.weight * w_cpi;
+    weights += e.weight;
+  }
+  if (weights <= 0) return 1;
+  double secs = Seconds(t0);
+  std::fprintf(stderr, "weighted CPI: %.3f (%s, %llu instructions simulated in %.3f s)\n",
+               cpi / weights, o.model.c_str(), static_cast<unsigned long long>(insts), secs);
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options o;
+  if (int rc = ParseArgs(argc, argv, &o)) return rc == 1 ? 0 : rc;
+
+  if (!o.sampled.empty()) return RunSampled(o);
+  if (!o.simpoints.empty()) return RunCheckpoints(o);
+  if (o.ckpt_mark != 0) return RunMarkCheckpoint(o);
+  return RunFull(o);
+}
@@ -0,0 +1,82 @@
+#include "memory.h"
+
+namespace e203sim {
+
+Memory::Memory() : pages_(size_t{1} << (32 - kPageBits)) {}
+
+void Memory::AddDevice(uint32_t base, uint32_t size, Device* dev) {
+  devs_.push_back({base, size, dev});
+}
+
+Device* Memory::FindDevice(uint32_t addr, uint32_t* offset) {
+  for (const DevRange& r : devs_) {
+    if (addr - r.base < r.size) {
+      *offset = addr - r.base;
+      return r.dev;
+    }
+  }
+  return nullptr;
+}
+
+uint8_t* Memory::Page(uint32_t addr) {
+  std::unique_ptr<uint8_t[]>& page = pages_[addr >> kPageBits];
+  if (!page) {
+    uint32_t offset;
+    if (FindDevice(addr & ~(kPageSize - 1), &offset) != nullptr) return nullptr;
+    page.reset(new uint8_t[kPageSize]());
+  }
+  return page.get();
+}
+
+void Memory::WriteBlock(uint32_t addr, const void* src, size_t len) {
+  const uint8_t* s = static_cast<const uint8_t*>(src);
+  while (len > 0) {
+    uint32_t in_page = addr & (kPageSize - 1);
+    size_t n = kPageSize - in_page;
+    if (n > len) n = len;
+    uint8_t* page = Page(addr);
+    if (page != nullptr) {
+      std::memcpy(page + in_page, s, n);
+    } else {
+      for (size_t i = 0; i < n; i++) SlowWrite(addr + i, 1, s[i]);
+    }
+    addr += n;
+    s += n;
+    len -= n;
+  }
+}
+
+void Memory::ReadBlock(uint32_t addr, void* dst, size_t len) {
+  uint8_t* d = static_cast<uint8_t*>(dst);
+  for (size_t i = 0; i < len; i++) d[i] = Read<uint8_t>(addr + i);
+}
+
+uint32_t Memory::SlowRead(uint32_t addr, int size) {
+  uint32_t offset;
+  if (Device* dev = FindDevice(addr, &offset)) return dev->Read(offset, size);
+
+  // Crossing a page, or a page never written (reads as zero)
+  uint32_t v = 0;
+  for (int i = 0; i < size; i++) {
+    uint32_t a = addr + i;
+    uint8_t* page = pages_[a >> kPageBits].get();
+    uint32_t b = page ? page[a & (kPageSize - 1)] : 0;
+    v |= b << (8 * i);
+  }
+  return v;
+}
+
+void Memory::SlowWrite(uint32_t addr, int size, uint32_t v) {
+  uint32_t offset;
+  if (Device* dev = FindDevice(addr, &offset)) {
+    dev->Write(offset, size, v);
+    return;
+  }
+  for (int i = 0; i < size; i++) {
+    uint32_t a = addr + i;
+    uint8_t* page = Page(a);
+    if (page != nullptr) page[a & (kPageSize - 1)] = static_cast<uint8_t>(v >> (8 * i));
+  }
+}
+
+}  // namespace e203sim
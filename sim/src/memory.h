@@ -0,0 +1,89 @@
+// The physical memory of the E203 simulator.
+//
+// The RAM is a sparse array of 4 KB pages allocated on the first touch, so
+// any memory map (ITCM, DTCM, external SRAM/flash) works without being
+// declared. The devices are declared as address ranges, they never get a
+// page, so the RAM fast path is one table lookup.
+#ifndef E203SIM_MEMORY_H
+#define E203SIM_MEMORY_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace e203sim {
+
+// A memory-mapped device, accessed with the naturally aligned 1/2/4 bytes
+class Device {
+ public:
+  virtual ~Device() = default;
+  virtual uint32_t Read(uint32_t offset, int size) = 0;
+  virtual void Write(uint32_t offset, int size, uint32_t value) = 0;
+};
+
+class Memory {
+ public:
+  static constexpr int kPageBits = 12;
+  static constexpr uint32_t kPageSize = 1u << kPageBits;
+
+  Memory();
+
+  // The device takes [base, base + size), which must be page aligned
+  void AddDevice(uint32_t base, uint32_t size, Device* dev);
+
+  // The host pointer of a RAM page, allocated if not yet there, nullptr for
+  // a device page
+  uint8_t* Page(uint32_t addr);
+
+  // Copy a block into the RAM, e.g., an ELF segment
+  void WriteBlock(uint32_t addr, const void* src, size_t len);
+  void ReadBlock(uint32_t addr, void* dst, size_t len);
+
+  template <typename T>
+  T Read(uint32_t addr) {
+    uint8_t* page = pages_[addr >> kPageBits].get();
+    if (page != nullptr && ((addr & (kPageSize - 1)) <= kPageSize - sizeof(T))) {
+      T v;
+      std::memcpy(&v, page + (addr & (kPageSize - 1)), sizeof(T));
+      return v;
+    }
+    return static_cast<T>(SlowRead(addr, sizeof(T)));
+  }
+
+  template <typename T>
+  void Write(uint32_t addr, T v) {
+    uint8_t* page = pages_[addr >> kPageBits].get();
+    if (page != nullptr && ((addr & (kPageSize - 1)) <= kPageSize - sizeof(T))) {
+      std::memcpy(page + (addr & (kPageSize - 1)), &v, sizeof(T));
+      return;
+    }
+    SlowWrite(addr, sizeof(T), v);
+  }
+
+  // The RAM pages allocated, in address order, for the checkpoints
+  template <typename F>
+  void ForEachPage(F f) const {
+    for (uint32_t i = 0; i < pages_.size(); i++) {
+      if (pages_[i]) f(i << kPageBits, pages_[i].get());
+    }
+  }
+
+ private:
+  struct DevRange {
+    uint32_t base;
+    uint32_t size;
+    Device* dev;
+  };
+
+  Device* FindDevice(uint32_t addr, uint32_t* offset);
+  uint32_t SlowRead(uint32_t addr, int size);
+  void SlowWrite(uint32_t addr, int size, uint32_t v);
+
+  std::vector<std::unique_ptr<uint8_t[]>> pages_;
+  std::vector<DevRange> devs_;
+};
+
+}  // namespace e203sim
+
+#endif  // E203SIM_MEMORY_H
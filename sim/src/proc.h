@@ -0,0 +1,27 @@
+// The host side of the batch tools (e203sweep): run a command with its
+// output captured in a log file, and spread a number of tasks over a pool
+// of threads.
+#ifndef E203SIM_PROC_H
+#define E203SIM_PROC_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace e203sim {
+
+// Run argv (argv[0] looked up in PATH) with its stdout and stderr written to
+// log, and wait for it. Returns its exit status, or -1 if it could not be
+// started or was killed by a signal.
+int RunCommand(const std::vector<std::string>& argv, const std::string& log);
+
+// Call fn(0) .. fn(n - 1) on up to jobs threads, in no particular order
+void ParallelFor(size_t n, unsigned jobs, const std::function<void(size_t)>& fn);
+
+// The number of host cores, at least 1
+unsigned HostCores();
+
+}  // namespace e203sim
+
+#endif  // E203SIM_PROC_H
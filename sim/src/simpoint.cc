@@ -0,0 +1,261 @@
+#include "simpoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <random>
+
+namespace e203sim {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+using Point = std::vector<double>;
+
+// A random projection coordinate of a block, the same on every call
+double Projection(uint32_t id, int dim, uint64_t seed) {
+  uint64_t z = seed ^ (uint64_t{id} * 0x9e3779b97f4a7c15ull) ^ (uint64_t(dim) << 48);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  z ^= z >> 31;
+  return static_cast<double>(z >> 11) / static_cast<double>(1ull << 52) - 1.0;  // [-1, 1)
+}
+
+double Dist2(const Point& a, const Point& b) {
+  double d = 0;
+  for (size_t i = 0; i < a.size(); i++) d += (a[i] - b[i]) * (a[i] - b[i]);
+  return d;
+}
+
+struct Clustering {
+  std::vector<int> assign;
+  std::vector<Point> centers;
+  double sse = 0;
+};
+
+// Weighted k-means (Lloyd), seeded with k-means++
+Clustering KMeans(const std::vector<Point>& pts, const std::vector<double>& w, int k,
+                  std::mt19937_64* rng, int max_iters) {
+  size_t n = pts.size();
+  Clustering c;
+  c.assign.assign(n, 0);
+
+  std::uniform_int_distribution<size_t> pick(0, n - 1);
+  c.centers.push_back(pts[pick(*rng)]);
+  std::vector<double> d2(n);
+  while (static_cast<int>(c.centers.size()) < k) {
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) {
+      double best = std::numeric_limits<double>::max();
+      for (const Point& ctr : c.centers) best = std::min(best, Dist2(pts[i], ctr));
+      d2[i] = best * w[i];
+      sum += d2[i];
+    }
+    if (sum <= 0) {
+      c.centers.push_back(pts[pick(*rng)]);
+      continue;
+    }
+    double r = std::uniform_real_distribution<double>(0, sum)(*rng);
+    size_t i = 0;
+    for (; i + 1 < n && r >= d2[i]; i++) r -= d2[i];
+    c.centers.push_back(pts[i]);
+  }
+
+  size_t dims = pts[0].size();
+  for (int iter = 0; iter < max_iters; iter++) {
+    bool moved = iter == 0;
+    for (size_t i = 0; i < n; i++) {
+      int best = 0;
+      double best_d = Dist2(pts[i], c.centers[0]);
+      for (int j = 1; j < k; j++) {
+        double d = Dist2(pts[i], c.centers[j]);
+        if (d < best_d) {
+          best_d = d;
+          best = j;
+        }
+      }
+      if (best != c.assign[i]) moved = true;
+      c.assign[i] = best;
+    }
+    if (!moved) break;
+
+    std::vector<Point> sum(k, Point(dims, 0.0));
+    std::vector<double> wsum(k, 0.0);
+    for (size_t i = 0; i < n; i++) {
+      for (size_t d = 0; d < dims; d++) sum[c.assign[i]][d] += pts[i][d] * w[i];
+      wsum[c.assign[i]] += w[i];
+    }
+    for (int j = 0; j < k; j++) {
+      if (wsum[j] <= 0) continue;  // An empty cluster keeps its center
+      for (size_t d = 0; d < dims; d++) c.centers[j][d] = sum[j][d] / wsum[j];
+    }
+  }
+
+  c.sse = 0;
+  for (size_t i = 0; i < n; i++) c.sse += Dist2(pts[i], c.centers[c.assign[i]]);
+  return c;
+}
+
+// The BIC of a clustering under the identical spherical Gaussians model
+// (Pelleg and Moore, X-means), as SimPoint scores it
+double Bic(const Clustering& c, size_t n, int k, size_t dims) {
+  double r = static_cast<double>(n);
+  double var = std::max(c.sse / (r - k), 1e-12);
+  std::vector<double> rn(k, 0.0);
+  for (int a : c.assign) rn[a] += 1;
+  double ll = 0;
+  for (int j = 0; j < k; j++) {
+    if (rn[j] == 0) continue;
+    ll += rn[j] * std::log(rn[j]) - rn[j] * std::log(r) -
+          rn[j] * static_cast<double>(dims) / 2 * std::log(2 * kPi * var) - (rn[j] - k) / 2;
+  }
+  double params = (k - 1) + static_cast<double>(k) * dims + 1;
+  return ll - params / 2 * std::log(r);
+}
+
+}  // namespace
+
+bool ReadBbv(const std::string& path, std::vector<BbvInterval>* intervals, std::string* err) {
+  std::ifstream in(path);
+  if (!in) {
+    *err = "cannot open " + path;
+    return false;
+  }
+  intervals->clear();
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] != 'T') continue;
+    BbvInterval iv;
+    const char* p = line.c_str() + 1;
+    while (*p == ':') {
+      char* end = nullptr;
+      unsigned long id = std::strtoul(p + 1, &end, 10);
+      if (*end != ':') {
+        *err = path + ": bad interval line " + std::to_string(intervals->size() + 1);
+        return false;
+      }
+      unsigned long long n = std::strtoull(end + 1, &end, 10);
+      iv.counts.emplace_back(static_cast<uint32_t>(id), n);
+      iv.insts += n;
+      p = end;
+      while (*p == ' ') p++;
+    }
+    intervals->push_back(std::move(iv));
+  }
+  if (intervals->empty()) {
+    *err = path + ": no interval";
+    return false;
+  }
+  return true;
+}
+
+std::vector<SimPoint> PickSimPoints(const std::vector<BbvInterval>& intervals,
+                                    const SimPointOptions& opts, int* k_out) {
+  size_t n = intervals.size();
+  size_t dims = static_cast<size_t>(opts.dims);
+
+  // The frequency vectors (each interval normalized to 1) projected
+  std::vector<Point> pts(n, Point(dims, 0.0));
+  std::vector<double> w(n);
+  double total = 0;
+  for (size_t i = 0; i < n; i++) {
+    const BbvInterval& iv = intervals[i];
+    w[i] = static_cast<double>(iv.insts);
+    total += w[i];
+    if (iv.insts == 0) continue;
+    for (const auto& bc : iv.counts) {
+      double f = static_cast<double>(bc.second) / static_cast<double>(iv.insts);
+      for (size_t d = 0; d < dims; d++) {
+        pts[i][d] += f * Projection(bc.first, static_cast<int>(d), opts.seed);
+      }
+    }
+  }
+
+  // The BIC needs a variance, so k stays below n
+  int max_k = static_cast<int>(std::min<size_t>(opts.max_k, n > 1 ? n - 1 : 1));
+  std::vector<Clustering> best(max_k + 1);
+  std::vector<double> bic(max_k + 1);
+  std::mt19937_64 rng(opts.seed);
+  for (int k = 1; k <= max_k; k++) {
+    for (int r = 0; r < opts.restarts; r++) {
+      Clustering c = KMeans(pts, w, k, &rng, opts.max_iters);
+      if (r == 0 || c.sse < best[k].sse) best[k] = std::move(c);
+    }
+    bic[k] = n > 1 ? Bic(best[k], n, k, dims) : 0;
+  }
+
+  double lo = *std::min_element(bic.begin() + 1, bic.end());
+  double hi = *std::max_element(bic.begin() + 1, bic.end());
+  int k = 1;
+  while (k < max_k && bic[k] < lo + opts.bic_frac * (hi - lo)) k++;
+  const Clustering& c = best[k];
+
+  std::vector<SimPoint> points;
+  for (int j = 0; j < k; j++) {
+    double cw = 0;
+    size_t rep = n;
+    double rep_d = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < n; i++) {
+      if (c.assign[i] != j) continue;
+      cw += w[i];
+      double d = Dist2(pts[i], c.centers[j]);
+      if (d < rep_d) {
+        rep_d = d;
+        rep = i;
+      }
+    }
+    if (rep == n) continue;
+    points.push_back({rep, total > 0 ? cw / total : 0});
+  }
+  std::sort(points.begin(), points.end(),
+            [](const SimPoint& a, const SimPoint& b) { return a.interval < b.interval; });
+  if (k_out != nullptr) *k_out = k;
+  return points;
+}
+
+bool WriteSimPoints(const std::string& path, const std::vector<SimPoint>& points, std::string* err) {
+  FILE* f = std::fopen(path.c_str(), "w");
+  if (f == nullptr) {
+    *err = "cannot write " + path;
+    return false;
+  }
+  std::fprintf(f, "# interval weight\n");
+  for (const SimPoint& p : points) {
+    std::fprintf(f, "%llu %.6f\n", static_cast<unsigned long long>(p.interval), p.weight);
+  }
+  std::fclose(f);
+  return true;
+}
+
+bool ReadSimPoints(const std::string& path, std::vector<SimPoint>* points, std::string* err) {
+  std::ifstream in(path);
+  if (!in) {
+    *err = "cannot open " + path;
+    return false;
+  }
+  points->clear();
+  std::string line;
+  int lineno = 0;
+  while (std::getline(in, line)) {
+    lineno++;
+    if (line.empty() || line[0] == '#') continue;
+    unsigned long long iv = 0;
+    double weight = 0;
+    if (std::sscanf(line.c_str(), "%llu %lf", &iv, &weight) != 2) {
+      *err = path + ": bad line " + std::to_string(lineno);
+      return false;
+    }
+    points->push_back({iv, weight});
+  }
+  if (points->empty()) {
+    *err = path + ": no point";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace e203sim
@@ -0,0 +1,49 @@
+// The representative interval picking of the sampled simulation, after
+// SimPoint: the basic-block vectors are projected onto a few random
+// dimensions, clustered with k-means for k = 1..max_k, the smallest k whose
+// BIC score is close enough to the best one is kept, and each cluster is
+// represented by the interval nearest to its centroid, weighted by the
+// share of the instructions the cluster holds.
+#ifndef E203SIM_SIMPOINT_H
+#define E203SIM_SIMPOINT_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace e203sim {
+
+struct BbvInterval {
+  std::vector<std::pair<uint32_t, uint64_t>> counts;  // Block id, instructions
+  uint64_t insts = 0;
+};
+
+// Read a .bb file written by BbvProfiler
+bool ReadBbv(const std::string& path, std::vector<BbvInterval>* intervals, std::string* err);
+
+struct SimPoint {
+  uint64_t interval;  // The interval index in the .bb file
+  double weight;      // The weights of all the points sum to 1
+};
+
+struct SimPointOptions {
+  int max_k = 10;
+  int dims = 15;
+  int restarts = 5;        // k-means runs per k, from different seeds
+  int max_iters = 100;
+  double bic_frac = 0.9;   // The smallest k scoring within this of the BIC range
+  uint64_t seed = 1;
+};
+
+// Pick the points, sorted by interval, k_out gets the number of clusters
+std::vector<SimPoint> PickSimPoints(const std::vector<BbvInterval>& intervals,
+                                    const SimPointOptions& opts, int* k_out);
+
+// The points file: one "interval weight" line per point, '#' comments
+bool WriteSimPoints(const std::string& path, const std::vector<SimPoint>& points, std::string* err);
+bool ReadSimPoints(const std::string& path, std::vector<SimPoint>* points, std::string* err);
+
+}  // namespace e203sim
+
+#endif  // E203SIM_SIMPOINT_H
@@ -0,0 +1,68 @@
+// e203simpoint: pick the representative intervals of a .bb profile written
+// by e203sim --bbv, with their weights.
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "simpoint.h"
+
+namespace {
+
+void Usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [options] prog.bb prog.simpts\n"
+               "  --max-k N      the most clusters tried (default 10)\n"
+               "  --dims N       the random projection dimensions (default 15)\n"
+               "  --seed N       the projection and k-means seed (default 1)\n",
+               argv0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  e203sim::SimPointOptions opts;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    if ((a == "--max-k" || a == "--dims" || a == "--seed") && i + 1 < argc) {
+      char* end = nullptr;
+      unsigned long long v = std::strtoull(argv[++i], &end, 0);
+      if (*end != '\0' || v == 0 || (a != "--seed" && v > 1000)) {
+        std::fprintf(stderr, "bad %s %s\n", a.c_str(), argv[i]);
+        return 2;
+      }
+      if (a == "--max-k") opts.max_k = static_cast<int>(v);
+      if (a == "--dims") opts.dims = static_cast<int>(v);
+      if (a == "--seed") opts.seed = v;
+    } else if (a[0] != '-') {
+      files.push_back(a);
+    } else {
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+  if (files.size() != 2) {
+    Usage(argv[0]);
+    return 2;
+  }
+
+  std::string err;
+  std::vector<e203sim::BbvInterval> intervals;
+  if (!e203sim::ReadBbv(files[0], &intervals, &err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 2;
+  }
+  int k = 0;
+  std::vector<e203sim::SimPoint> points = e203sim::PickSimPoints(intervals, opts, &k);
+  if (!e203sim::WriteSimPoints(files[1], points, &err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 2;
+  }
+  std::fprintf(stderr, "%zu intervals, k = %d\n", intervals.size(), k);
+  for (const e203sim::SimPoint& p : points) {
+    std::fprintf(stderr, "  interval %6llu  weight %.4f\n", static_cast<unsigned long long>(p.interval),
+                 p.weight);
+  }
+  return 0;
+}
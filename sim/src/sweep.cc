@@ -0,0 +1,154 @@
+#include "sweep.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace e203sim {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+bool ParseSetting(const std::string& s, SweepValue* v) {
+  static const std::string kDefine = "+define+";
+  if (s.compare(0, kDefine.size(), kDefine) == 0 && s.size() > kDefine.size()) {
+    v->defines.push_back(s.substr(kDefine.size()));
+    return true;
+  }
+  size_t eq = s.find('=');
+  if (eq == std::string::npos || eq == 0) return false;
+  v->model_opts.push_back({s.substr(0, eq), s.substr(eq + 1)});
+  return true;
+}
+
+}  // namespace
+
+bool ReadSweepSpec(const std::string& path, SweepSpec* spec, std::string* err) {
+  std::ifstream in(path);
+  if (!in) {
+    *err = "cannot open " + path;
+    return false;
+  }
+  *spec = SweepSpec();
+  std::string line;
+  int lineno = 0;
+  while (std::getline(in, line)) {
+    lineno++;
+    size_t hash = line.find('#');
+    if (hash != std::string::npos) line.resize(hash);
+    std::istringstream ls(line);
+    std::vector<std::string> tok;
+    for (std::string t; ls >> t;) tok.push_back(t);
+    if (tok.empty()) continue;
+
+    std::string where = path + ":" + std::to_string(lineno) + ": ";
+    bool indented = line[0] == ' ' || line[0] == '\t';
+    if (indented) {
+      if (spec->axes.empty()) {
+        *err = where + "a value outside an axis";
+        return false;
+      }
+      SweepValue v;
+      v.name = tok[0];
+      for (size_t i = 1; i < tok.size(); i++) {
+        if (!ParseSetting(tok[i], &v)) {
+          *err = where + "bad setting " + tok[i] + ", expected KEY=VALUE or +define+MACRO";
+          return false;
+        }
+      }
+      spec->axes.back().values.push_back(v);
+    } else if (tok[0] == "axis" && tok.size() == 2) {
+      spec->axes.push_back({tok[1], {}});
+    } else if (tok[0] == "workload" && (tok.size() == 3 || tok.size() == 4)) {
+      SweepWorkload w;
+      w.name = tok[1];
+      w.elf = tok[2];
+      if (tok.size() == 4) w.itcm_image = tok[3];
+      spec->workloads.push_back(w);
+    } else {
+      *err = where + "expected axis NAME, workload NAME ELF [ITCM_IMAGE] or an indented value";
+      return false;
+    }
+  }
+  for (const SweepAxis& a : spec->axes) {
+    if (a.values.empty()) {
+      *err = path + ": axis " + a.name + " has no value";
+      return false;
+    }
+  }
+  if (spec->workloads.empty()) {
+    *err = path + ": no workload";
+    return false;
+  }
+  return true;
+}
+
+std::vector<SweepVariant> ExpandSweep(const SweepSpec& spec) {
+  std::vector<SweepVariant> out(1);
+  for (const SweepAxis& a : spec.axes) {
+    std::vector<SweepVariant> next;
+    for (const SweepVariant& base : out) {
+      for (const SweepValue& v : a.values) {
+        SweepVariant var = base;
+        var.name += (var.name.empty() ? "" : ",") + a.name + "=" + v.name;
+        var.model_opts.insert(var.model_opts.end(), v.model_opts.begin(), v.model_opts.end());
+        var.defines.insert(var.defines.end(), v.defines.begin(), v.defines.end());
+        next.push_back(var);
+      }
+    }
+    out.swap(next);
+  }
+  for (SweepVariant& v : out) {
+    if (v.name.empty()) v.name = "base";
+    std::sort(v.defines.begin(), v.defines.end());
+    v.defines.erase(std::unique(v.defines.begin(), v.defines.end()), v.defines.end());
+  }
+  return out;
+}
+
+void Fnv64::Update(const void* data, size_t n) {
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < n; i++) {
+    h_ ^= p[i];
+    h_ *= 0x100000001b3ull;
+  }
+}
+
+void Fnv64::Update(const std::string& s) {
+  // The length first, so that "ab" "c" and "a" "bc" differ
+  uint64_t n = s.size();
+  Update(&n, sizeof(n));
+  Update(s.data(), s.size());
+}
+
+std::string Fnv64::Hex() const {
+  char buf[17];
+  std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h_));
+  return buf;
+}
+
+bool HashTree(const std::string& dir, Fnv64* h, std::string* err) {
+  std::error_code ec;
+  std::vector<fs::path> files;
+  for (fs::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+    if (it->is_regular_file(ec)) files.push_back(it->path());
+  }
+  if (ec) {
+    *err = "cannot read " + dir + ": " + ec.message();
+    return false;
+  }
+  std::sort(files.begin(), files.end());
+  for (const fs::path& f : files) {
+    std::ifstream in(f, std::ios::binary);
+    std::ostringstream data;
+    data << in.rdbuf();
+    h->Update(fs::relative(f, dir).generic_string());
+    h->Update(data.str());
+  }
+  return true;
+}
+
+}  // namespace e203sim
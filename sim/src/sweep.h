@@ -0,0 +1,85 @@
+// The design-space sweeps of e203sweep.
+//
+// A sweep spec names axes, each with its values, and the workloads. A value
+// is a set of settings: e203sim timing model options (KEY=VALUE) and
+// defines of the RTL model (+define+MACRO[=VALUE]). The variants are the
+// cartesian product of the axes, and every workload runs on every variant:
+//
+//   # comment
+//   axis fwd
+//     comb  fwd=comb
+//     off   fwd=off +define+E203_NO_LOAD_FWD
+//   axis l0d
+//     off
+//     on    +define+E203_HAS_L0D
+//   workload coremark coremark.elf coremark.verilog
+//
+// The value lines are indented under their axis. A workload is an ELF and,
+// optionally, its ITCM image as built for tb_top, which the RTL runs
+// instead of loading the ELF.
+#ifndef E203SIM_SWEEP_H
+#define E203SIM_SWEEP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "timing.h"
+
+namespace e203sim {
+
+struct SweepValue {
+  std::string name;
+  ModelOptions model_opts;
+  std::vector<std::string> defines;  // MACRO or MACRO=VALUE
+};
+
+struct SweepAxis {
+  std::string name;
+  std::vector<SweepValue> values;
+};
+
+struct SweepWorkload {
+  std::string name;
+  std::string elf;
+  std::string itcm_image;  // Empty: the RTL loads the ELF
+};
+
+struct SweepSpec {
+  std::vector<SweepAxis> axes;
+  std::vector<SweepWorkload> workloads;
+};
+
+bool ReadSweepSpec(const std::string& path, SweepSpec* spec, std::string* err);
+
+// One point of the sweep: "axis=value,..." and the settings of its values,
+// the defines sorted
+struct SweepVariant {
+  std::string name;
+  ModelOptions model_opts;
+  std::vector<std::string> defines;
+};
+
+// The variants, the first axis varying slowest; one variant named "base"
+// without an axis
+std::vector<SweepVariant> ExpandSweep(const SweepSpec& spec);
+
+// 64-bit FNV-1a, the key of the RTL build cache
+class Fnv64 {
+ public:
+  void Update(const void* data, size_t n);
+  void Update(const std::string& s);
+  uint64_t value() const { return h_; }
+  std::string Hex() const;
+
+ private:
+  uint64_t h_ = 0xcbf29ce484222325ull;
+};
+
+// Hash the relative path and the contents of every regular file under dir,
+// in path order, false with err set if dir cannot be read
+bool HashTree(const std::string& dir, Fnv64* h, std::string* err);
+
+}  // namespace e203sim
+
+#endif  // E203SIM_SWEEP_H
@@ -0,0 +1,255 @@
+// e203sweep: run the workloads of a sweep spec (see sweep.h) on every
+// variant and write one table of the cycles, the instructions, the CPI and
+// the self-check of each run.
+//
+//   e203sweep [--engine iss|rtl] [--jobs N] sweep.txt
+//
+// iss: the e203 timing model with the options of the variant, the runs
+// spread over the host cores in this process. The +define+ settings are
+// ignored.
+// rtl: one Verilator model (e203_ckpt) per distinct set of defines, built in
+// parallel into the build cache. A build is keyed on the hash of its
+// defines, of sim/ and core/ and of the HBirdv2 RTL, so an unchanged
+// variant is never rebuilt. Each run is an e203_ckpt run of the ITCM image
+// of the workload, or of its ELF loaded straight into the TCMs without
+// one; the variants differing only in model options share it.
+//
+// The counts are those between the markers 1 and 2 when the workload
+// writes them (CoreMark built with CFG_SIM_MARK), else those of the whole
+// run. The check is the marker 3 (pass) or 4 (fail) the workload writes
+// after its self-check, "-" without one. On the RTL a workload stops at
+// that marker, so it needs CFG_SIM_MARK.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "batch.h"
+#include "elf_image.h"
+#include "proc.h"
+#include "sweep.h"
+#include "timing.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+using e203sim::RtlBuild;
+using e203sim::RunResult;
+using e203sim::SweepVariant;
+using e203sim::SweepWorkload;
+
+struct Options {
+  bool rtl = false;
+  unsigned jobs = e203sim::HostCores();
+  std::string cache = "sweep-cache";
+  std::string rtl_dir;
+  uint64_t max_insts = ~uint64_t{0};
+  uint64_t max_cycles = 1000000000;
+  std::string csv;
+  const char* spec = nullptr;
+};
+
+void Usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [options] sweep.txt\n"
+               "  --engine iss|rtl      run on the e203 timing model (default) or the RTL\n"
+               "  --jobs N              parallel builds and runs (default: the host cores)\n"
+               "  --csv FILE            also write the table as CSV\n"
+               "  --max-insts N         iss: stop a run after N instructions\n"
+               "rtl:\n"
+               "  --rtl-dir DIR         the rtl/e203 directory of e203_hbirdv2\n"
+               "  --cache DIR           the build cache (default sweep-cache)\n"
+               "  --max-cycles N        stop a run after N cycles (default 1000000000)\n",
+               argv0);
+}
+
+bool ParseCount(const char* s, uint64_t* v) {
+  char* end = nullptr;
+  *v = std::strtoull(s, &end, 0);
+  return *s != '\0' && *end == '\0';
+}
+
+// 0 on success, else the exit code
+int ParseArgs(int argc, char** argv, Options* o) {
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool has_next = i + 1 < argc;
+    uint64_t n = 0;
+    if (a == "--engine" && has_next) {
+      std::string e = argv[++i];
+      if (e != "iss" && e != "rtl") {
+        std::fprintf(stderr, "bad --engine %s\n", e.c_str());
+        return 2;
+      }
+      o->rtl = e == "rtl";
+    } else if ((a == "--jobs" || a == "--max-insts" || a == "--max-cycles") && has_next) {
+      if (!ParseCount(argv[++i], &n) || n == 0) {
+        std::fprintf(stderr, "bad %s %s\n", a.c_str(), argv[i]);
+        return 2;
+      }
+      if (a == "--jobs") o->jobs = static_cast<unsigned>(n);
+      if (a == "--max-insts") o->max_insts = n;
+      if (a == "--max-cycles") o->max_cycles = n;
+    } else if (a == "--rtl-dir" && has_next) {
+      o->rtl_dir = argv[++i];
+    } else if (a == "--cache" && has_next) {
+      o->cache = argv[++i];
+    } else if (a == "--csv" && has_next) {
+      o->csv = argv[++i];
+    } else if (a == "-h" || a == "--help") {
+      Usage(argv[0]);
+      return 1;
+    } else if (a[0] != '-' && o->spec == nullptr) {
+      o->spec = argv[i];
+    } else {
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+  if (o->spec == nullptr) {
+    Usage(argv[0]);
+    return 2;
+  }
+  if (o->rtl && o->rtl_dir.empty()) {
+    std::fprintf(stderr, "--engine rtl needs --rtl-dir\n");
+    return 2;
+  }
+  return 0;
+}
+
+double Seconds(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+std::string Join(const std::vector<std::string>& v, const char* sep) {
+  std::string s;
+  for (const std::string& e : v) s += (s.empty() ? "" : sep) + e;
+  return s;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options o;
+  if (int rc = ParseArgs(argc, argv, &o)) return rc == 1 ? 0 : rc;
+
+  std::string err;
+  e203sim::SweepSpec spec;
+  if (!e203sim::ReadSweepSpec(o.spec, &spec, &err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 2;
+  }
+  std::vector<SweepVariant> variants = e203sim::ExpandSweep(spec);
+  const std::vector<SweepWorkload>& workloads = spec.workloads;
+  for (const SweepVariant& v : variants) {
+    if (!e203sim::MakeTimingModel("e203", v.model_opts, &err)) {
+      std::fprintf(stderr, "%s: %s\n", v.name.c_str(), err.c_str());
+      return 2;
+    }
+  }
+  auto t0 = std::chrono::steady_clock::now();
+
+  // results[variant * workloads + workload]
+  std::vector<RunResult> results(variants.size() * workloads.size());
+  if (!o.rtl) {
+    std::vector<e203sim::ElfImage> elfs(workloads.size());
+    for (size_t i = 0; i < workloads.size(); i++) {
+      if (!elfs[i].Open(workloads[i].elf, &err)) {
+        std::fprintf(stderr, "%s: %s\n", workloads[i].elf.c_str(), err.c_str());
+        return 2;
+      }
+    }
+    e203sim::ParallelFor(results.size(), o.jobs, [&](size_t i) {
+      results[i] = e203sim::RunIss(elfs[i % workloads.size()], {}, "e203",
+                                   variants[i / workloads.size()].model_opts, o.max_insts,
+                                   nullptr);
+    });
+  } else {
+    e203sim::Fnv64 sources;
+    if (!e203sim::HashRtlSources(o.rtl_dir, &sources, &err)) {
+      std::fprintf(stderr, "%s\n", err.c_str());
+      return 2;
+    }
+
+    // One build per distinct set of defines
+    std::vector<RtlBuild> builds;
+    std::vector<size_t> build_of(variants.size());
+    std::map<std::vector<std::string>, size_t> by_defines;
+    for (size_t v = 0; v < variants.size(); v++) {
+      auto it = by_defines.find(variants[v].defines);
+      if (it == by_defines.end()) {
+        it = by_defines.emplace(variants[v].defines, builds.size()).first;
+        builds.push_back(e203sim::CachedRtlBuild(o.cache, sources, variants[v].defines));
+      }
+      build_of[v] = it->second;
+    }
+    size_t missing = 0;
+    for (const RtlBuild& b : builds) missing += !b.cached;
+    // The host cores shared among the builds running together
+    size_t together = std::max<size_t>(std::min<size_t>(missing, o.jobs), 1);
+    unsigned make_jobs = std::max(1u, o.jobs / static_cast<unsigned>(together));
+    std::fprintf(stderr, "%zu models, %zu to build\n", builds.size(), missing);
+    e203sim::ParallelFor(builds.size(), o.jobs,
+                         [&](size_t i) { BuildRtlModel(o.rtl_dir, make_jobs, &builds[i]); });
+    for (const RtlBuild& b : builds) {
+      std::string state = b.cached ? "cached" : b.ok ? "built" : "FAILED";
+      if (!b.cached) state += " in " + std::to_string(static_cast<int>(b.secs)) + " s";
+      std::fprintf(stderr, "  %s %-14s %s\n", b.dir.c_str(), state.c_str(),
+                   b.defines.empty() ? "(no define)" : Join(b.defines, " ").c_str());
+    }
+
+    std::vector<RunResult> model_results(builds.size() * workloads.size());
+    e203sim::ParallelFor(model_results.size(), o.jobs, [&](size_t i) {
+      const RtlBuild& b = builds[i / workloads.size()];
+      const SweepWorkload& w = workloads[i % workloads.size()];
+      std::string image = w.itcm_image.empty() ? "+ELF=" + fs::absolute(w.elf).string()
+                                               : "+ITCM=" + fs::absolute(w.itcm_image).string();
+      model_results[i] = e203sim::RunRtl(b, {image}, o.max_cycles,
+                                         (fs::path(b.dir) / (w.name + ".log")).string());
+    });
+    for (size_t i = 0; i < results.size(); i++) {
+      size_t w = i % workloads.size();
+      results[i] = model_results[build_of[i / workloads.size()] * workloads.size() + w];
+    }
+  }
+  double secs = Seconds(t0);
+
+  size_t name_w = 7;
+  for (const SweepVariant& v : variants) name_w = std::max(name_w, v.name.size());
+  std::FILE* csv = nullptr;
+  if (!o.csv.empty() && (csv = std::fopen(o.csv.c_str(), "w")) == nullptr) {
+    std::fprintf(stderr, "cannot write %s\n", o.csv.c_str());
+  }
+  if (csv) std::fprintf(csv, "variant,workload,cycles,instret,cpi,check,note\n");
+  std::printf("%-*s %-12s %14s %14s %7s %5s  %s\n", static_cast<int>(name_w), "variant",
+              "workload", "cycles", "instret", "CPI", "check", "note");
+  bool all_ok = true;
+  uint64_t total_insts = 0;
+  for (size_t i = 0; i < results.size(); i++) {
+    const SweepVariant& v = variants[i / workloads.size()];
+    const SweepWorkload& w = workloads[i % workloads.size()];
+    const RunResult& r = results[i];
+    double cpi = r.insts ? static_cast<double>(r.cycles) / r.insts : 0.0;
+    all_ok &= r.ok && r.note.empty() && r.check != e203sim::RunCheck::kFail;
+    total_insts += r.insts;
+    std::printf("%-*s %-12s %14llu %14llu %7.3f %5s  %s\n", static_cast<int>(name_w),
+                v.name.c_str(), w.name.c_str(), static_cast<unsigned long long>(r.cycles),
+                static_cast<unsigned long long>(r.insts), cpi, e203sim::RunCheckName(r), r.note.c_str());
+    if (csv) {
+      std::fprintf(csv, "\"%s\",%s,%llu,%llu,%.4f,%s,\"%s\"\n", v.name.c_str(), w.name.c_str(),
+                   static_cast<unsigned long long>(r.cycles),
+                   static_cast<unsigned long long>(r.insts), cpi, e203sim::RunCheckName(r), r.note.c_str());
+    }
+  }
+  if (csv) std::fclose(csv);
+  std::fflush(stdout);
+  std::fprintf(stderr, "%zu runs (%zu variants x %zu workloads) in %.1f s, %.1fM instructions\n",
+               results.size(), variants.size(), workloads.size(), secs, total_insts / 1e6);
+  return all_ok ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#include "timing.h"
+
+#include <cstdlib>
+#include <map>
+
+#include "timing_e203.h"
+
+namespace e203sim {
+
+namespace {
+
+// One instruction per cycle, the bound of any scalar pipeline
+class IdealTiming : public TimingModel {
+ public:
+  void Retire(const RetireInfo&) override { cycles_++; }
+  void Trap(uint32_t, uint32_t) override {}
+  uint64_t Cycles() const override { return cycles_; }
+
+ private:
+  uint64_t cycles_ = 0;
+};
+
+std::map<std::string, TimingModelFactory>& Registry() {
+  static std::map<std::string, TimingModelFactory>* registry = [] {
+    auto* r = new std::map<std::string, TimingModelFactory>;
+    (*r)["ideal"] = [](const ModelOptions& opts, std::string* err) -> std::unique_ptr<TimingModel> {
+      if (!opts.empty()) {
+        *err = "the ideal model takes no option";
+        return nullptr;
+      }
+      return std::unique_ptr<TimingModel>(new IdealTiming);
+    };
+    (*r)["e203"] = [](const ModelOptions& opts, std::string* err) -> std::unique_ptr<TimingModel> {
+      E203TimingConfig cfg;
+      if (!ParseE203TimingConfig(opts, &cfg, err)) return nullptr;
+      return MakeE203Timing(cfg);
+    };
+    return r;
+  }();
+  return *registry;
+}
+
+}  // namespace
+
+std::unique_ptr<TimingModel> MakeTimingModel(const std::string& name, const ModelOptions& opts,
+                                             std::string* err) {
+  auto it = Registry().find(name);
+  if (it == Registry().end()) {
+    *err = "unknown timing model " + name;
+    return nullptr;
+  }
+  return it->second(opts, err);
+}
+
+std::vector<std::string> TimingModelNames() {
+  std::vector<std::string> names;
+  for (const auto& kv : Registry()) names.push_back(kv.first);
+  return names;
+}
+
+bool RegisterTimingModel(const std::string& name, TimingModelFactory factory) {
+  return Registry().emplace(name, std::move(factory)).second;
+}
+
+bool ParseUnsigned(const ModelOption& opt, uint32_t* v, std::string* err) {
+  char* end = nullptr;
+  unsigned long n = std::strtoul(opt.value.c_str(), &end, 0);
+  if (opt.value.empty() || *end != '\0' || n > 0xffffffffUL) {
+    *err = "bad value of " + opt.key + ": " + opt.value;
+    return false;
+  }
+  *v = static_cast<uint32_t>(n);
+  return true;
+}
+
+}  // namespace e203sim
@@ -0,0 +1,97 @@
+// The pluggable timing model interface of the E203 simulator.
+//
+// The functional simulator (Hart) executes the program and hands every
+// retired instruction, in order, to the timing model, which only keeps
+// the time: the cycle count the core would take, read back by the program
+// through mcycle. A model is created by name from the registry, with its
+// options given as key=value strings, so a new model (or a variant of the
+// E203 one) is added without touching the simulator.
+#ifndef E203SIM_TIMING_H
+#define E203SIM_TIMING_H
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "decode.h"
+
+namespace e203sim {
+
+struct RetireInfo {
+  const Inst* inst;
+  uint32_t pc;
+  uint32_t next_pc;
+  uint32_t mem_addr;  // The address of a load/store/AMO
+  bool taken;         // A branch taken, or a jump
+};
+
+// Why the dispatch of an instruction waited, as the model attributes it
+enum class StallCause : uint8_t {
+  kNone,
+  kRaw,       // A source still pending in the OITF
+  kWaw,       // The destination still pending in the OITF
+  kOitfFull,
+  kLsuBusy,   // No free LSU outstanding command
+  kDrain,     // The OITF draining before a CSR/fence/system instruction
+};
+
+// The cycles an instruction waited at the dispatch, not counting the
+// fetch bubbles before it (taken jumps, mispredicts, flushes)
+struct DispatchStall {
+  uint32_t cycles = 0;
+  StallCause cause = StallCause::kNone;
+};
+
+class TimingModel {
+ public:
+  virtual ~TimingModel() = default;
+
+  // One instruction retired
+  virtual void Retire(const RetireInfo& r) = 0;
+
+  // A trap or an interrupt redirects the fetch to the handler, the
+  // instruction at pc is not retired
+  virtual void Trap(uint32_t pc, uint32_t handler) = 0;
+
+  // The current cycle, as read by mcycle
+  virtual uint64_t Cycles() const = 0;
+
+  // The dispatch stall of the instruction retired last, none for a model
+  // that does not attribute its stalls
+  virtual DispatchStall LastStall() const { return {}; }
+
+  // The model's own counters, at the end of the run
+  virtual void PrintStats(FILE* out) const { (void)out; }
+};
+
+// A model option, "key=value"
+struct ModelOption {
+  std::string key;
+  std::string value;
+};
+
+using ModelOptions = std::vector<ModelOption>;
+
+// Create a model by name, nullptr with err set if the name or an option is
+// unknown
+std::unique_ptr<TimingModel> MakeTimingModel(const std::string& name, const ModelOptions& opts,
+                                             std::string* err);
+
+// The names of the registered models, for the usage message
+std::vector<std::string> TimingModelNames();
+
+using TimingModelFactory =
+    std::function<std::unique_ptr<TimingModel>(const ModelOptions& opts, std::string* err)>;
+
+// Register a model in addition to the built-in ones ("ideal", "e203")
+bool RegisterTimingModel(const std::string& name, TimingModelFactory factory);
+
+// Parse an unsigned option value, false with err set on failure
+bool ParseUnsigned(const ModelOption& opt, uint32_t* v, std::string* err);
+
+}  // namespace e203sim
+
+#endif  // E203SIM_TIMING_H
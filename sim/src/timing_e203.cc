@@ -0,0 +1,351 @@
+#include "timing_e203.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace e203sim {
+
+namespace {
+
+// The cause a dispatch waited for, or the bubble after an instruction
+enum Cause {
+  kRaw,
+  kWaw,
+  kOitfFull,
+  kLsuBusy,
+  kDrain,
+  kMulDiv,
+  kTaken,
+  kMispredict,
+  kJalr,
+  kFence,
+  kTrap,
+  kMisalign,
+  kCauseNum,
+};
+
+const char* const kCauseName[kCauseNum] = {
+    "raw_dep (source in OITF)",
+    "waw_dep (destination in OITF)",
+    "OITF full",
+    "LSU outstanding full",
+    "OITF drain (CSR/fence/system)",
+    "MUL/DIV busy",
+    "taken jump/branch bubble",
+    "branch mispredict",
+    "jalr register read",
+    "fence flush",
+    "trap/mret flush",
+    "misaligned jump target",
+};
+
+// The causes a dispatch waits for, as the commit trace records them; the
+// others are bubbles after an instruction
+StallCause DispatchCause(Cause c) {
+  switch (c) {
+    case kRaw: return StallCause::kRaw;
+    case kWaw: return StallCause::kWaw;
+    case kOitfFull: return StallCause::kOitfFull;
+    case kLsuBusy: return StallCause::kLsuBusy;
+    case kDrain: return StallCause::kDrain;
+    default: return StallCause::kNone;
+  }
+}
+
+constexpr uint32_t kMaxQueue = 64;
+
+class E203Timing : public TimingModel {
+ public:
+  explicit E203Timing(const E203TimingConfig& cfg) : cfg_(cfg) {}
+
+  void Retire(const RetireInfo& r) override;
+  void Trap(uint32_t pc, uint32_t handler) override;
+  uint64_t Cycles() const override { return t_; }
+  DispatchStall LastStall() const override { return last_stall_; }
+  void PrintStats(FILE* out) const override;
+
+ private:
+  uint32_t LoadLat(uint32_t addr) const {
+    for (const E203TimingConfig::Region& rg : cfg_.regions) {
+      if (addr - rg.base < rg.size) return rg.lat;
+    }
+    return cfg_.lsu_lat;
+  }
+
+  void Bubble(uint64_t n, Cause c) {
+    t_ += n;
+    stall_[c] += n;
+  }
+
+  E203TimingConfig cfg_;
+
+  uint64_t t_ = 0;  // The earliest dispatch cycle of the next instruction
+
+  // The earliest cycle a register can be read by the EXU (with the
+  // forwarding), from the regfile, and the earliest dispatch of a write to
+  // it (the pending long-pipe write retired)
+  uint64_t reg_exu_[32] = {};
+  uint64_t reg_rf_[32] = {};
+  uint64_t reg_waw_[32] = {};
+
+  // The OITF and the LSU outstanding commands are freed in order, so each
+  // is a ring of the cycles its entries are free again
+  uint64_t oitf_free_[kMaxQueue] = {};
+  uint32_t oitf_head_ = 0;
+  uint64_t oitf_drain_ = 0;
+  uint64_t lsu_free_[kMaxQueue] = {};
+  uint32_t lsu_head_ = 0;
+
+  bool redirect_misalign_ = false;
+
+  uint64_t stall_[kCauseNum] = {};
+  DispatchStall last_stall_;
+  uint64_t long_pipe_ = 0;
+  uint64_t fwd_hits_ = 0;
+  uint64_t mispredicts_ = 0;
+};
+
+void E203Timing::Retire(const RetireInfo& r) {
+  const Inst& in = *r.inst;
+  uint64_t t = t_;
+  Cause cause = kRaw;
+  auto need = [&t, &cause](uint64_t c, Cause k) {
+    if (c > t) {
+      t = c;
+      cause = k;
+    }
+  };
+
+  if (redirect_misalign_ && in.len == 4) Bubble(cfg_.misalign_bubble, kMisalign);
+  redirect_misalign_ = false;
+  t = t_;
+
+  // The jalr source is read by the IFU, not the EXU, see below
+  if (in.cls != Cls::kJalr) {
+    if (in.rs1_en && in.rs1 != 0) need(reg_exu_[in.rs1], kRaw);
+    if (in.rs2_en && in.rs2 != 0) need(reg_exu_[in.rs2], kRaw);
+  }
+  if (in.rd_wen) need(reg_waw_[in.rd], kWaw);
+
+  // Count the loads consumed right at their write-back through the bypass
+  if (cfg_.fwd == E203TimingConfig::Fwd::kComb) {
+    if ((in.rs1_en && in.rs1 != 0 && reg_exu_[in.rs1] == t && reg_rf_[in.rs1] == t + 1) ||
+        (in.rs2_en && in.rs2 != 0 && reg_exu_[in.rs2] == t && reg_rf_[in.rs2] == t + 1)) {
+      fwd_hits_++;
+    }
+  }
+
+  uint64_t next = 0;
+
+  switch (in.cls) {
+    case Cls::kLoad:
+    case Cls::kStore:
+    case Cls::kAmo: {
+      uint32_t oitf_idx = oitf_head_ % cfg_.oitf;
+      uint32_t lsu_idx = lsu_head_ % cfg_.lsu_outs;
+      need(oitf_free_[oitf_idx], kOitfFull);
+      need(lsu_free_[lsu_idx], kLsuBusy);
+
+      uint64_t lat = LoadLat(r.mem_addr);
+      // The AMO is a read and a write of the AGU, back-to-back, the LR/SC
+      // a single access
+      if (in.cls == Cls::kAmo && in.op != Op::kLrW && in.op != Op::kScW) lat = 2 * lat + 1;
+      uint64_t wb = t + lat;
+
+      oitf_free_[oitf_idx] = wb + 1;
+      oitf_head_++;
+      oitf_drain_ = wb + 1;
+      lsu_free_[lsu_idx] = wb + 1;
+      lsu_head_++;
+      long_pipe_++;
+
+      if (in.rd_wen) {
+        reg_exu_[in.rd] = (cfg_.fwd == E203TimingConfig::Fwd::kComb) ? wb : wb + 1;
+        reg_rf_[in.rd] = wb + 1;
+        reg_waw_[in.rd] = wb + 1;
+      }
+      next = t + 1;
+      break;
+    }
+
+    case Cls::kMul:
+    case Cls::kDiv: {
+      uint64_t lat = (in.cls == Cls::kMul) ? cfg_.mul_lat : cfg_.div_lat;
+      if (in.rd_wen) {
+        reg_exu_[in.rd] = t + lat;
+        reg_rf_[in.rd] = t + lat;
+      }
+      stall_[kMulDiv] += lat - 1;
+      next = t + lat;
+      break;
+    }
+
+    case Cls::kCsr:
+    case Cls::kFence:
+    case Cls::kFenceI:
+    case Cls::kSystem:
+      need(oitf_drain_, kDrain);
+      if (in.rd_wen) {
+        reg_exu_[in.rd] = t + 1;
+        reg_rf_[in.rd] = t + 1;
+      }
+      next = t + 1;
+      break;
+
+    default:  // ALU, branches, jumps
+      if (in.rd_wen) {
+        reg_exu_[in.rd] = t + 1;
+        reg_rf_[in.rd] = t + 1;
+      }
+      next = t + 1;
+      break;
+  }
+
+  stall_[cause] += t - t_;
+  last_stall_ = DispatchStall{};
+  if (t > t_) {
+    last_stall_.cycles = static_cast<uint32_t>(std::min<uint64_t>(t - t_, UINT32_MAX));
+    last_stall_.cause = DispatchCause(cause);
+  }
+  t_ = next;
+
+  // The fetch bubbles after this instruction
+  switch (in.cls) {
+    case Cls::kBranch: {
+      bool prdt_taken = in.imm < 0;
+      if (prdt_taken != r.taken) {
+        mispredicts_++;
+        Bubble(cfg_.mispredict, kMispredict);
+      } else if (r.taken) {
+        Bubble(cfg_.taken_bubble, kTaken);
+      }
+      break;
+    }
+    case Cls::kJal:
+      Bubble(cfg_.taken_bubble, kTaken);
+      break;
+    case Cls::kJalr:
+      if (in.rs1 != 0) {
+        // The IFU reads the register from the regfile, without the
+        // forwarding, once nothing in flight writes it
+        uint64_t ready = reg_rf_[in.rs1];
+        if (ready > t_) Bubble(ready - t_, kJalr);
+        if (in.rs1 != 1) Bubble(cfg_.jalr_bubble, kJalr);
+      }
+      Bubble(cfg_.taken_bubble, kTaken);
+      break;
+    case Cls::kFence:
+    case Cls::kFenceI:
+      Bubble(cfg_.fence_flush, kFence);
+      break;
+    case Cls::kSystem:
+      Bubble(cfg_.trap_flush, kTrap);
+      break;
+    default:
+      break;
+  }
+
+  if (r.next_pc != r.pc + in.len) redirect_misalign_ = (r.next_pc & 2) != 0;
+}
+
+void E203Timing::Trap(uint32_t pc, uint32_t handler) {
+  (void)pc;
+  if (oitf_drain_ > t_) {
+    stall_[kDrain] += oitf_drain_ - t_;
+    t_ = oitf_drain_;
+  }
+  Bubble(cfg_.trap_flush, kTrap);
+  redirect_misalign_ = (handler & 2) != 0;
+}
+
+void E203Timing::PrintStats(FILE* out) const {
+  std::fprintf(out, "e203: fwd=%s oitf=%u lsu_outs=%u lsu_lat=%u mul_lat=%u div_lat=%u\n",
+               cfg_.fwd == E203TimingConfig::Fwd::kComb ? "comb" : "off", cfg_.oitf,
+               cfg_.lsu_outs, cfg_.lsu_lat, cfg_.mul_lat, cfg_.div_lat);
+  std::fprintf(out, "  long-pipe instructions      : %llu\n",
+               static_cast<unsigned long long>(long_pipe_));
+  std::fprintf(out, "  load-use forwarding hits    : %llu\n",
+               static_cast<unsigned long long>(fwd_hits_));
+  std::fprintf(out, "  branch mispredicts          : %llu\n",
+               static_cast<unsigned long long>(mispredicts_));
+  std::fprintf(out, "  lost cycles by cause:\n");
+  for (int c = 0; c < kCauseNum; c++) {
+    if (stall_[c] == 0) continue;
+    std::fprintf(out, "    %-30s: %llu\n", kCauseName[c],
+                 static_cast<unsigned long long>(stall_[c]));
+  }
+}
+
+bool ParseNum(const std::string& s, uint32_t* v) {
+  if (s.empty()) return false;
+  char* end = nullptr;
+  unsigned long n = std::strtoul(s.c_str(), &end, 0);
+  if (*end != '\0' || n > 0xffffffffUL) return false;
+  *v = static_cast<uint32_t>(n);
+  return true;
+}
+
+}  // namespace
+
+bool ParseE203TimingConfig(const ModelOptions& opts, E203TimingConfig* cfg, std::string* err) {
+  for (const ModelOption& o : opts) {
+    uint32_t* field = nullptr;
+    if (o.key == "fwd") {
+      if (o.value == "off") {
+        cfg->fwd = E203TimingConfig::Fwd::kOff;
+      } else if (o.value == "comb") {
+        cfg->fwd = E203TimingConfig::Fwd::kComb;
+      } else {
+        *err = "fwd must be off or comb";
+        return false;
+      }
+      continue;
+    }
+    if (o.key == "region") {
+      // base:size:lat
+      E203TimingConfig::Region rg;
+      size_t c1 = o.value.find(':');
+      size_t c2 = (c1 == std::string::npos) ? c1 : o.value.find(':', c1 + 1);
+      if (c2 == std::string::npos || !ParseNum(o.value.substr(0, c1), &rg.base) ||
+          !ParseNum(o.value.substr(c1 + 1, c2 - c1 - 1), &rg.size) ||
+          !ParseNum(o.value.substr(c2 + 1), &rg.lat)) {
+        *err = "region must be base:size:lat";
+        return false;
+      }
+      cfg->regions.push_back(rg);
+      continue;
+    }
+    if (o.key == "oitf") field = &cfg->oitf;
+    else if (o.key == "lsu_outs") field = &cfg->lsu_outs;
+    else if (o.key == "lsu_lat") field = &cfg->lsu_lat;
+    else if (o.key == "mul_lat") field = &cfg->mul_lat;
+    else if (o.key == "div_lat") field = &cfg->div_lat;
+    else if (o.key == "taken_bubble") field = &cfg->taken_bubble;
+    else if (o.key == "mispredict") field = &cfg->mispredict;
+    else if (o.key == "jalr_bubble") field = &cfg->jalr_bubble;
+    else if (o.key == "fence_flush") field = &cfg->fence_flush;
+    else if (o.key == "trap_flush") field = &cfg->trap_flush;
+    else if (o.key == "misalign_bubble") field = &cfg->misalign_bubble;
+    if (field == nullptr) {
+      *err = "unknown e203 option " + o.key;
+      return false;
+    }
+    if (!ParseUnsigned(o, field, err)) return false;
+  }
+
+  if (cfg->oitf < 1 || cfg->oitf > kMaxQueue || cfg->lsu_outs < 1 || cfg->lsu_outs > kMaxQueue) {
+    *err = "oitf and lsu_outs must be 1.." + std::to_string(kMaxQueue);
+    return false;
+  }
+  if (cfg->mul_lat < 1 || cfg->div_lat < 1) {
+    *err = "mul_lat and div_lat must be at least 1";
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<TimingModel> MakeE203Timing(const E203TimingConfig& cfg) {
+  return std::unique_ptr<TimingModel>(new E203Timing(cfg));
+}
+
+}  // namespace e203sim
@@ -0,0 +1,72 @@
+// The timing model of the E203 2-stage pipeline.
+//
+// The instructions dispatch in order, one per cycle at most, from the IFU
+// into the EXU, and each dispatch is delayed by the same rules as in
+// e203_exu_disp and e203_exu_oitf:
+//   * raw_dep: a source written by a long-pipe instruction (a load, AMO)
+//     still in the OITF waits for it, until its write-back with the
+//     load-use forwarding (fwd=comb), or until it retires (fwd=off).
+//   * waw_dep: a destination still pending in the OITF waits for it to
+//     retire.
+//   * The OITF has oitf entries, one per long-pipe instruction (all the
+//     loads/stores/AMOs) until its write-back, and the LSU takes lsu_outs
+//     outstanding commands, a load/store waits for a free one of both.
+//   * The CSR access, fence/fence.i, ecall/ebreak/mret/wfi wait for the
+//     OITF to drain, the fences and traps also flush the fetch.
+//   * MUL/DIV run in the shared ALU datapath, which is blocked for
+//     mul_lat/div_lat cycles.
+//   * The IFU predicts the backward branches taken (BTFN) and the jumps
+//     with a taken_bubble each, a mispredicted branch costs mispredict
+//     cycles, a jalr on a register other than x0/x1 waits for it in the
+//     regfile and costs jalr_bubble more.
+// The load latency (command to response) is lsu_lat cycles, or the one of
+// the region the address is in.
+//
+// The defaults below follow the pipeline description, none of them is
+// measured on the RTL, so the model is not calibrated (see README.md).
+#ifndef E203SIM_TIMING_E203_H
+#define E203SIM_TIMING_E203_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "timing.h"
+
+namespace e203sim {
+
+struct E203TimingConfig {
+  enum class Fwd { kOff, kComb };
+
+  struct Region {
+    uint32_t base;
+    uint32_t size;
+    uint32_t lat;
+  };
+
+  Fwd fwd = Fwd::kComb;
+  uint32_t oitf = 2;            // E203_OITF_DEPTH
+  uint32_t lsu_outs = 1;        // E203_LSU_OUTS_NUM
+  uint32_t lsu_lat = 1;         // ITCM/DTCM: the response in the next cycle
+  std::vector<Region> regions;  // The latency of the other memories
+  uint32_t mul_lat = 17;        // The radix-4 Booth multiplier
+  uint32_t div_lat = 33;        // The radix-2 divider
+  uint32_t taken_bubble = 1;
+  uint32_t mispredict = 2;
+  uint32_t jalr_bubble = 1;
+  uint32_t fence_flush = 2;
+  uint32_t trap_flush = 2;
+  uint32_t misalign_bubble = 1;  // A 32-bit instruction at a jump target of 4n+2
+};
+
+// Parse the options (fwd=, oitf=, lsu_outs=, lsu_lat=, region=base:size:lat,
+// mul_lat=, div_lat=, taken_bubble=, mispredict=, jalr_bubble=,
+// fence_flush=, trap_flush=, misalign_bubble=) over the defaults
+bool ParseE203TimingConfig(const ModelOptions& opts, E203TimingConfig* cfg, std::string* err);
+
+std::unique_ptr<TimingModel> MakeE203Timing(const E203TimingConfig& cfg);
+
+}  // namespace e203sim
+
+#endif  // E203SIM_TIMING_E203_H
@@ -0,0 +1,45 @@
+// The checks of the e203sim unit tests, with no test framework to depend
+// on: a failed check prints its location and the values, and the test
+// returns non-zero from CheckResult() at the end of main.
+#ifndef E203SIM_TESTS_CHECK_H
+#define E203SIM_TESTS_CHECK_H
+
+#include <cstdio>
+
+namespace e203sim_test {
+
+inline int& Failures() {
+  static int n = 0;
+  return n;
+}
+
+inline int CheckResult() {
+  if (Failures() == 0) return 0;
+  std::fprintf(stderr, "%d check(s) failed\n", Failures());
+  return 1;
+}
+
+}  // namespace e203sim_test
+
+#define CHECK(cond)                                                        \
+  do {                                                                     \
+    if (!(cond)) {                                                         \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+                   #cond);                                                 \
+      e203sim_test::Failures()++;                                          \
+    }                                                                      \
+  } while (0)
+
+// For the integer values, printed as long long
+#define CHECK_EQ(a, b)                                                          \
+  do {                                                                          \
+    long long va = static_cast<long long>(a);                                   \
+    long long vb = static_cast<long long>(b);                                   \
+    if (va != vb) {                                                             \
+      std::fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",    \
+                   __FILE__, __LINE__, #a, #b, va, vb);                         \
+      e203sim_test::Failures()++;                                               \
+    }                                                                           \
+  } while (0)
+
+#endif  // E203SIM_TESTS_CHECK_H
@@ -0,0 +1,138 @@
+// The checkpoints: the .ckpt file and the RTL restore stub bring back the
+// registers, the CSRs and the CLINT, and the program after the stub reads
+// the counters of the checkpoint, with mstatus (and its MIE) set last.
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "check.h"
+#include "checkpoint.h"
+#include "machine.h"
+#include "timing_e203.h"
+
+namespace {
+
+using e203sim::HartCsrs;
+using e203sim::Machine;
+
+constexpr uint32_t kRtcDiv = 1000;
+constexpr uint32_t kPc = 0x80000200;
+constexpr uint32_t kReset = 0x80000000;
+constexpr uint32_t kResetWord = 0x00000013;  // nop
+constexpr uint32_t kSelfLoop = 0x0000006f;   // j .
+
+constexpr uint64_t kMcycle = 0x00000001fffffff0ull;
+constexpr uint64_t kMinstret = 0x0000000100000123ull;
+constexpr uint64_t kMtimecmp = 0x0000123400005678ull;
+constexpr uint64_t kMtime = 0x0000000200000010ull;
+
+uint32_t X(int i) { return 0x1000 * static_cast<uint32_t>(i) + 0x90000000; }
+
+// The checkpoint state, on a machine with no timing model (its cycles are
+// its instructions, none)
+void Setup(Machine* m) {
+  m->mem.Write<uint32_t>(kReset, kResetWord);
+  m->mem.Write<uint32_t>(kPc, kSelfLoop);
+  m->hart.Reset(kPc);
+  for (int i = 1; i < 32; i++) m->hart.set_x(i, X(i));
+  HartCsrs c;
+  c.mstatus = 0x88;    // MPIE, MIE
+  c.mie = 0x80;        // MTIE, the msip below stays pending
+  c.mtvec = 0x80000100;
+  c.mscratch = 0x11;
+  c.mepc = 0x22;
+  c.mcause = 0x33;
+  c.mtval = 0x44;
+  c.mcycle_ofs = kMcycle;
+  c.minstret_ofs = kMinstret;
+  m->hart.set_csrs(c);
+  m->clint.Write(0x0000, 4, 1);
+  m->clint.Write(0x4000, 4, static_cast<uint32_t>(kMtimecmp));
+  m->clint.Write(0x4004, 4, static_cast<uint32_t>(kMtimecmp >> 32));
+  m->clint.Write(0xbff8, 4, static_cast<uint32_t>(kMtime));
+  m->clint.Write(0xbffc, 4, static_cast<uint32_t>(kMtime >> 32));
+}
+
+void CheckState(const Machine& m) {
+  const e203sim::Hart& h = m.hart;
+  CHECK_EQ(h.pc(), kPc);
+  for (int i = 1; i < 32; i++) CHECK_EQ(h.x(i), X(i));
+  const HartCsrs& c = h.csrs();
+  CHECK_EQ(c.mstatus, 0x88);
+  CHECK_EQ(c.mie, 0x80);
+  CHECK_EQ(c.mtvec, 0x80000100);
+  CHECK_EQ(c.mscratch, 0x11);
+  CHECK_EQ(c.mepc, 0x22);
+  CHECK_EQ(c.mcause, 0x33);
+  CHECK_EQ(c.mtval, 0x44);
+  CHECK_EQ(h.Cycles() + c.mcycle_ofs, kMcycle);
+  CHECK_EQ(h.instret() + c.minstret_ofs, kMinstret);
+  CHECK(m.clint.msip());
+  CHECK_EQ(m.clint.mtimecmp(), kMtimecmp);
+  CHECK_EQ(m.clint.mtime(), kMtime);
+}
+
+std::string TmpDir() {
+  char dir[] = "/tmp/e203sim_ckpt_XXXXXX";
+  return mkdtemp(dir) != nullptr ? dir : "";
+}
+
+void TestFile() {
+  std::string dir = TmpDir();
+  CHECK(!dir.empty());
+  std::string path = dir + "/a.ckpt";
+  std::string err;
+  Machine a(kRtcDiv, nullptr);
+  Setup(&a);
+  CHECK(e203sim::SaveCheckpoint(path, a, 7, &err));
+
+  Machine b(kRtcDiv, nullptr);
+  uint64_t position = 0;
+  CHECK(e203sim::LoadCheckpoint(path, &b, &position, &err));
+  CHECK_EQ(position, 7);
+  CheckState(b);
+  unlink(path.c_str());
+  rmdir(dir.c_str());
+}
+
+void TestRtlStub() {
+  std::string dir = TmpDir();
+  CHECK(!dir.empty());
+  std::string prefix = dir + "/a";
+  std::string err;
+  e203sim::RtlLayout layout;
+  Machine a(kRtcDiv, nullptr);
+  Setup(&a);
+  uint32_t jal_pc = 0;
+  CHECK(e203sim::WriteRtlImages(prefix, a, layout, &jal_pc, &err));
+
+  // Booted with the e203 model, as the stub counters are timed with it
+  Machine b(kRtcDiv, nullptr);
+  std::unique_ptr<e203sim::TimingModel> t = e203sim::MakeE203Timing(e203sim::E203TimingConfig());
+  b.hart.set_timing(t.get());
+  CHECK(e203sim::LoadRtlImages(prefix, &b, layout, &err));
+  for (int n = 0; n < 200 && b.hart.pc() != jal_pc; n++) {
+    b.hart.Run(1);
+    // The interrupts stay off until the end of the stub
+    if (b.hart.pc() != jal_pc) CHECK_EQ(b.hart.csrs().mstatus & 0x8, 0);
+  }
+  CHECK_EQ(b.hart.pc(), jal_pc);
+  b.hart.Run(1);
+  CheckState(b);
+  CHECK_EQ(b.mem.Read<uint32_t>(kReset), kResetWord);
+
+  for (const char* ext : {".itcm.verilog", ".dtcm.verilog"}) unlink((prefix + ext).c_str());
+  rmdir(dir.c_str());
+}
+
+}  // namespace
+
+int main() {
+  TestFile();
+  TestRtlStub();
+  return e203sim_test::CheckResult();
+}
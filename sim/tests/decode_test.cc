@@ -0,0 +1,101 @@
+// The decoder: the fields of each class of instruction, and the RVC
+// expansion. The encodings are from llvm-mc -triple=riscv32
+// -mattr=+m,+a,+c -show-encoding.
+#include <cstdint>
+
+#include "check.h"
+#include "decode.h"
+
+namespace {
+
+using e203sim::Cls;
+using e203sim::Decode;
+using e203sim::Inst;
+using e203sim::Op;
+
+struct Expect {
+  uint32_t raw;
+  Op op;
+  Cls cls;
+  int rd;  // -1: no rd written
+  int rs1;  // -1: rs1 not read
+  int rs2;  // -1: rs2 not read
+  int32_t imm;
+  int len;
+};
+
+void CheckInst(const Expect& e) {
+  Inst d = Decode(e.raw);
+  CHECK_EQ(d.op, e.op);
+  CHECK_EQ(d.cls, e.cls);
+  CHECK_EQ(d.len, e.len);
+  CHECK_EQ(d.rd_wen, e.rd >= 0);
+  if (e.rd >= 0) CHECK_EQ(d.rd, e.rd);
+  CHECK_EQ(d.rs1_en, e.rs1 >= 0);
+  if (e.rs1 >= 0) CHECK_EQ(d.rs1, e.rs1);
+  CHECK_EQ(d.rs2_en, e.rs2 >= 0);
+  if (e.rs2 >= 0) CHECK_EQ(d.rs2, e.rs2);
+  CHECK_EQ(d.imm, e.imm);
+  if (d.op != e.op) std::fprintf(stderr, "  of 0x%08x (%s)\n", e.raw, e203sim::OpName(d.op));
+}
+
+const Expect kInsts[] = {
+    // addi ra, sp, -1
+    {0xfff10093, Op::kAddi, Cls::kAlu, 1, 2, -1, -1, 4},
+    // lw a0, 4(sp)
+    {0x00412503, Op::kLw, Cls::kLoad, 10, 2, -1, 4, 4},
+    // sw a1, -8(s0)
+    {0xfeb42c23, Op::kSw, Cls::kStore, -1, 8, 11, -8, 4},
+    // beq a0, a1, -16
+    {0xfeb508e3, Op::kBeq, Cls::kBranch, -1, 10, 11, -16, 4},
+    // jal ra, 2048
+    {0x001000ef, Op::kJal, Cls::kJal, 1, -1, -1, 2048, 4},
+    // jalr x0, 0(t0)
+    {0x00028067, Op::kJalr, Cls::kJalr, -1, 5, -1, 0, 4},
+    // lui a5, 0x12345
+    {0x123457b7, Op::kLui, Cls::kAlu, 15, -1, -1, 0x12345000, 4},
+    // mul t0, t1, t2
+    {0x027302b3, Op::kMul, Cls::kMul, 5, 6, 7, 0, 4},
+    // divu a0, a1, a2
+    {0x02c5d533, Op::kDivu, Cls::kDiv, 10, 11, 12, 0, 4},
+    // lr.w a0, (a1)
+    {0x1005a52f, Op::kLrW, Cls::kAmo, 10, 11, -1, 0, 4},
+    // sc.w a2, a3, (a1)
+    {0x18d5a62f, Op::kScW, Cls::kAmo, 12, 11, 13, 0, 4},
+    // amoadd.w a4, a5, (a6)
+    {0x00f8272f, Op::kAmoaddW, Cls::kAmo, 14, 16, 15, 0, 4},
+    // c.li a0, 5 -> addi a0, x0, 5
+    {0x4515, Op::kAddi, Cls::kAlu, 10, 0, -1, 5, 2},
+    // c.lwsp a0, 4(sp) -> lw a0, 4(sp)
+    {0x4512, Op::kLw, Cls::kLoad, 10, 2, -1, 4, 2},
+    // c.beqz a0, -8 -> beq a0, x0, -8
+    {0xdd65, Op::kBeq, Cls::kBranch, -1, 10, 0, -8, 2},
+    // c.j 64 -> jal x0, 64
+    {0xa081, Op::kJal, Cls::kJal, -1, -1, -1, 64, 2},
+    // c.add a0, a1 -> add a0, a0, a1
+    {0x952e, Op::kAdd, Cls::kAlu, 10, 10, 11, 0, 2},
+    // c.jr ra -> jalr x0, 0(ra)
+    {0x8082, Op::kJalr, Cls::kJalr, -1, 1, -1, 0, 2},
+};
+
+}  // namespace
+
+int main() {
+  for (const Expect& e : kInsts) CheckInst(e);
+
+  // The system instructions and the CSR
+  Inst csr = Decode(0xb0002573);  // csrr a0, mcycle
+  CHECK_EQ(csr.op, Op::kCsrrs);
+  CHECK_EQ(csr.cls, Cls::kCsr);
+  CHECK_EQ(csr.csr, 0xb00);
+  CHECK_EQ(csr.rd, 10);
+  CHECK_EQ(Decode(0x0ff0000f).cls, Cls::kFence);   // fence
+  CHECK_EQ(Decode(0x30200073).op, Op::kMret);      // mret
+  CHECK_EQ(Decode(0x30200073).cls, Cls::kSystem);
+
+  // The illegal ones: all zeros, a reserved RVC, an unknown opcode
+  CHECK_EQ(Decode(0x00000000).cls, Cls::kIllegal);
+  CHECK_EQ(e203sim::ExpandRvc(0x0000), 0u);
+  CHECK_EQ(Decode(0x0000007f).cls, Cls::kIllegal);
+  return e203sim_test::CheckResult();
+}
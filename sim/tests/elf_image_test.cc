@@ -0,0 +1,147 @@
+// The ELF loader: the symbol table read stays inside the file whatever its
+// section headers say, and .bss is zeroed where the segment runs.
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "elf_image.h"
+#include "memory.h"
+
+namespace {
+
+constexpr uint32_t kPaddr = 0x80001000;  // The load address, in the ITCM
+constexpr uint32_t kVaddr = 0x90000000;  // The run address, in the DTCM
+
+constexpr uint32_t kPhOff = 52;
+constexpr uint32_t kDataOff = kPhOff + 32;
+constexpr uint32_t kStrOff = kDataOff + 8;
+constexpr uint32_t kSymOff = kStrOff + 9;
+constexpr uint32_t kShOff = kSymOff + 48;
+
+void Put16(std::vector<uint8_t>* f, uint32_t off, uint32_t v) {
+  if (f->size() < off + 2) f->resize(off + 2);
+  (*f)[off] = static_cast<uint8_t>(v);
+  (*f)[off + 1] = static_cast<uint8_t>(v >> 8);
+}
+
+void Put32(std::vector<uint8_t>* f, uint32_t off, uint32_t v) {
+  Put16(f, off, v & 0xffff);
+  Put16(f, off + 2, v >> 16);
+}
+
+// One segment of 8 bytes of data and 8 of .bss, and a symbol table with
+// "good" and "bad", the latter running off the end of the string table
+std::vector<uint8_t> MakeElf() {
+  std::vector<uint8_t> f(kShOff + 3 * 40);
+  const uint8_t ident[16] = {0x7f, 'E', 'L', 'F', 1, 1, 1};
+  std::memcpy(f.data(), ident, sizeof(ident));
+  Put16(&f, 16, 2);     // e_type: EXEC
+  Put16(&f, 18, 243);   // e_machine: RISC-V
+  Put32(&f, 20, 1);
+  Put32(&f, 24, kPaddr);
+  Put32(&f, 28, kPhOff);
+  Put32(&f, 32, kShOff);
+  Put16(&f, 40, 52);
+  Put16(&f, 42, 32);
+  Put16(&f, 44, 1);
+  Put16(&f, 46, 40);
+  Put16(&f, 48, 3);
+
+  Put32(&f, kPhOff + 0, 1);  // PT_LOAD
+  Put32(&f, kPhOff + 4, kDataOff);
+  Put32(&f, kPhOff + 8, kVaddr);
+  Put32(&f, kPhOff + 12, kPaddr);
+  Put32(&f, kPhOff + 16, 8);
+  Put32(&f, kPhOff + 20, 16);
+  for (uint32_t i = 0; i < 8; i++) f[kDataOff + i] = static_cast<uint8_t>(0x11 + i);
+
+  std::memcpy(&f[kStrOff], "\0good\0bad", 9);
+  Put32(&f, kSymOff + 16 + 0, 1);
+  Put32(&f, kSymOff + 16 + 4, 0x1234);
+  Put32(&f, kSymOff + 32 + 0, 6);
+  Put32(&f, kSymOff + 32 + 4, 0x5678);
+
+  Put32(&f, kShOff + 40 + 4, 2);  // [1] SHT_SYMTAB
+  Put32(&f, kShOff + 40 + 16, kSymOff);
+  Put32(&f, kShOff + 40 + 20, 48);
+  Put32(&f, kShOff + 40 + 24, 2);
+  Put32(&f, kShOff + 80 + 4, 3);  // [2] SHT_STRTAB
+  Put32(&f, kShOff + 80 + 16, kStrOff);
+  Put32(&f, kShOff + 80 + 20, 9);
+  return f;
+}
+
+bool Open(const std::vector<uint8_t>& f, e203sim::ElfImage* elf) {
+  char path[] = "/tmp/e203sim_elf_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) return false;
+  bool wrote = write(fd, f.data(), f.size()) == static_cast<ssize_t>(f.size());
+  close(fd);
+  std::string err;
+  bool ok = wrote && elf->Open(path, &err);
+  unlink(path);
+  if (!ok) std::fprintf(stderr, "open: %s\n", err.c_str());
+  return ok;
+}
+
+void TestSymbols() {
+  e203sim::ElfImage elf;
+  CHECK(Open(MakeElf(), &elf));
+  uint32_t addr = 0;
+  CHECK(elf.Symbol("good", &addr));
+  CHECK_EQ(addr, 0x1234);
+  CHECK(!elf.Symbol("bad", &addr));
+}
+
+void TestBadStrtab() {
+  // The string table header past the end of the file
+  std::vector<uint8_t> f = MakeElf();
+  f.resize(kShOff + 2 * 40);
+  e203sim::ElfImage elf;
+  uint32_t addr = 0;
+  CHECK(Open(f, &elf));
+  CHECK(!elf.Symbol("good", &addr));
+
+  // The string table itself past the end of the file
+  f = MakeElf();
+  Put32(&f, kShOff + 80 + 16, 0xfffffff0);
+  e203sim::ElfImage elf2;
+  CHECK(Open(f, &elf2));
+  CHECK(!elf2.Symbol("good", &addr));
+}
+
+void TestLoad() {
+  e203sim::ElfImage elf;
+  CHECK(Open(MakeElf(), &elf));
+  e203sim::Memory mem;
+  const uint32_t fill[4] = {0xaaaaaaaa, 0xaaaaaaaa, 0xaaaaaaaa, 0xaaaaaaaa};
+  mem.WriteBlock(kPaddr, fill, sizeof(fill));
+  mem.WriteBlock(kVaddr, fill, sizeof(fill));
+  elf.Load(&mem);
+
+  // The load image, and nothing past it
+  CHECK_EQ(mem.Read<uint32_t>(kPaddr), 0x14131211);
+  CHECK_EQ(mem.Read<uint32_t>(kPaddr + 4), 0x18171615);
+  CHECK_EQ(mem.Read<uint32_t>(kPaddr + 8), 0xaaaaaaaa);
+  CHECK_EQ(mem.Read<uint32_t>(kPaddr + 12), 0xaaaaaaaa);
+  // The run image, with its .bss zeroed
+  CHECK_EQ(mem.Read<uint32_t>(kVaddr), 0x14131211);
+  CHECK_EQ(mem.Read<uint32_t>(kVaddr + 4), 0x18171615);
+  CHECK_EQ(mem.Read<uint32_t>(kVaddr + 8), 0);
+  CHECK_EQ(mem.Read<uint32_t>(kVaddr + 12), 0);
+}
+
+}  // namespace
+
+int main() {
+  TestSymbols();
+  TestBadStrtab();
+  TestLoad();
+  return e203sim_test::CheckResult();
+}
@@ -0,0 +1,75 @@
+// The trigger windows of the RTL trace (rtl/e203_rtl_trace.h): a window
+// from each trigger, and the pre-trigger windows of the second run.
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+
+#include "check.h"
+#include "e203_rtl_trace.h"
+
+namespace {
+
+using e203sim::RtlTraceSpec;
+using e203sim::RtlTraceTriggers;
+
+constexpr uint32_t kFailMark = 4;
+
+// Marker kFailMark written at each of the cycles, over n cycles
+uint64_t Run(RtlTraceTriggers* t, uint64_t n, std::initializer_list<uint64_t> at) {
+  uint64_t traced = 0;
+  for (uint64_t c = 0; c < n; c++) {
+    bool mark = std::find(at.begin(), at.end(), c) != at.end();
+    traced += t->Update(c, false, 0, mark, kFailMark, false);
+  }
+  return traced;
+}
+
+void TestForward() {
+  RtlTraceSpec spec;
+  spec.marks = {kFailMark};
+  spec.window = 10;
+  RtlTraceTriggers t(spec);
+  CHECK_EQ(Run(&t, 100, {50, 55, 80}), 15 + 10);
+  CHECK_EQ(t.windows(), 2);
+}
+
+void TestPreTrigger() {
+  RtlTraceSpec spec;
+  spec.marks = {kFailMark};
+  spec.window = 10;
+  spec.before = 20;
+  spec.cycles = {{0, 1}};
+  RtlTraceTriggers first(spec);
+  Run(&first, 100, {5, 50, 55, 70});
+
+  // The first window starts at the reset, the next two merge
+  RtlTraceSpec again = first.PreTriggerSpec();
+  CHECK(again.marks.empty());
+  CHECK_EQ(again.cycles.size(), 3);
+  CHECK_EQ(again.cycles[0].first, 0);
+  CHECK_EQ(again.cycles[0].second, 1);
+  CHECK_EQ(again.cycles[1].first, 0);
+  CHECK_EQ(again.cycles[1].second, 14);
+  CHECK_EQ(again.cycles[2].first, 30);
+  CHECK_EQ(again.cycles[2].second, 79);
+
+  RtlTraceTriggers second(again);
+  CHECK_EQ(Run(&second, 100, {}), 15 + 50);
+  CHECK_EQ(second.windows(), 0);
+
+  // Nothing fired, nothing to trace
+  RtlTraceSpec quiet;
+  quiet.marks = {kFailMark};
+  quiet.before = 20;
+  RtlTraceTriggers none(quiet);
+  Run(&none, 100, {});
+  CHECK(none.PreTriggerSpec().empty());
+}
+
+}  // namespace
+
+int main() {
+  TestForward();
+  TestPreTrigger();
+  return e203sim_test::CheckResult();
+}
@@ -0,0 +1,176 @@
+// The E203 timing model: the cycles of the hazard sequences of the micro
+// suite (benchmark/micro), the latency of each memory access class, and
+// the dispatch stalls it records for the commit trace.
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "check.h"
+#include "decode.h"
+#include "timing_e203.h"
+
+namespace {
+
+using e203sim::E203TimingConfig;
+using e203sim::Inst;
+using e203sim::RetireInfo;
+
+// The encodings, from llvm-mc -triple=riscv32 -mattr=+m,+a -show-encoding
+constexpr uint32_t kAddiT1T3 = 0x001e0313;  // addi t1, t3, 1
+constexpr uint32_t kLwT0 = 0x00c5a283;      // lw t0, 12(a1)
+constexpr uint32_t kAddiT1T0 = 0x00128313;  // addi t1, t0, 1
+constexpr uint32_t kAddiT0T3 = 0x001e0293;  // addi t0, t3, 1
+constexpr uint32_t kLrW = 0x1005a52f;       // lr.w a0, (a1)
+constexpr uint32_t kScW = 0x18d5a62f;       // sc.w a2, a3, (a1)
+constexpr uint32_t kAmoaddW = 0x00f8272f;   // amoadd.w a4, a5, (a6)
+constexpr uint32_t kAddiT1A0 = 0x00150313;  // addi t1, a0, 1
+constexpr uint32_t kAddiT1A2 = 0x00160313;  // addi t1, a2, 1
+constexpr uint32_t kAddiT1A4 = 0x00170313;  // addi t1, a4, 1
+constexpr uint32_t kMulT0 = 0x026282b3;     // mul t0, t0, t1
+constexpr uint32_t kBeqBack = 0xfeb508e3;   // beq a0, a1, -16
+constexpr uint32_t kBeqFwd = 0x00b50863;    // beq a0, a1, 16
+constexpr uint32_t kLwA1A1 = 0x0005a583;    // lw a1, 0(a1)
+constexpr uint32_t kLwT0Ofs4 = 0x0045a283;  // lw t0, 4(a1)
+constexpr uint32_t kSwT0 = 0x0055a623;      // sw t0, 12(a1)
+constexpr uint32_t kLwT0Ofs8 = 0x0085a283;  // lw t0, 8(a1)
+constexpr uint32_t kJalrT0 = 0x00028067;    // jalr x0, 0(t0)
+constexpr uint32_t kFence = 0x0ff0000f;     // fence
+
+constexpr uint32_t kDtcm = 0x90000000;
+
+struct Step {
+  uint32_t raw;
+  uint32_t mem_addr;
+  bool taken;
+};
+
+// The cycles of the steps run n times, in a straight line from 0x80000000
+uint64_t Cycles(const E203TimingConfig& cfg, const std::vector<Step>& steps, int n) {
+  std::unique_ptr<e203sim::TimingModel> m = e203sim::MakeE203Timing(cfg);
+  std::vector<Inst> insts;
+  for (const Step& s : steps) insts.push_back(e203sim::Decode(s.raw));
+  uint32_t pc = 0x80000000;
+  for (int i = 0; i < n; i++) {
+    for (size_t k = 0; k < steps.size(); k++) {
+      const Inst& in = insts[k];
+      uint32_t next = steps[k].taken ? pc + static_cast<uint32_t>(in.imm) : pc + in.len;
+      m->Retire(RetireInfo{&in, pc, next, steps[k].mem_addr, steps[k].taken});
+      pc += in.len;  // The taken ones only matter for the bubbles
+    }
+  }
+  return m->Cycles();
+}
+
+// The dispatch stall of the last of the steps, run once
+e203sim::DispatchStall LastStall(const E203TimingConfig& cfg, const std::vector<Step>& steps) {
+  std::unique_ptr<e203sim::TimingModel> m = e203sim::MakeE203Timing(cfg);
+  uint32_t pc = 0x80000000;
+  for (const Step& s : steps) {
+    Inst in = e203sim::Decode(s.raw);
+    uint32_t next = s.taken ? pc + static_cast<uint32_t>(in.imm) : pc + in.len;
+    m->Retire(RetireInfo{&in, pc, next, s.mem_addr, s.taken});
+    pc += in.len;
+  }
+  return m->LastStall();
+}
+
+void TestAlu() {
+  E203TimingConfig cfg;
+  CHECK_EQ(Cycles(cfg, {{kAddiT1T3, 0, false}}, 8), 8);
+}
+
+void TestLoadUse() {
+  E203TimingConfig cfg;
+  std::vector<Step> lu0 = {{kLwT0, kDtcm, false}, {kAddiT1T0, 0, false}};
+  // With the forwarding the use takes the load data at its write-back
+  CHECK_EQ(Cycles(cfg, lu0, 8), 16);
+  cfg.fwd = E203TimingConfig::Fwd::kOff;
+  CHECK_EQ(Cycles(cfg, lu0, 8), 24);
+}
+
+void TestWaw() {
+  E203TimingConfig cfg;
+  // The ALU write of the rd of a load in flight waits for it to retire
+  CHECK_EQ(Cycles(cfg, {{kLwT0, kDtcm, false}, {kAddiT0T3, 0, false}}, 8), 24);
+}
+
+// The rows of the micro suite table that the LSU outstanding slot, the
+// OITF drain and the fetch bubbles set (benchmark/micro/micro.c)
+void TestMicroRows() {
+  E203TimingConfig cfg;
+  // The next load waits for the single LSU outstanding slot, the last one
+  // overlaps the loop
+  CHECK_EQ(Cycles(cfg, {{kLwA1A1, kDtcm, false}}, 8), 15);
+  // The store waits for the load data, and then for the slot
+  CHECK_EQ(Cycles(cfg, {{kLwT0Ofs4, kDtcm, false}, {kSwT0, kDtcm + 12, false}}, 8), 31);
+  // The IFU reads t0 from the regfile once the load retired, then the
+  // jalr and taken bubbles
+  CHECK_EQ(Cycles(cfg, {{kLwT0Ofs8, kDtcm, false}, {kJalrT0, 0, false}}, 1), 4);
+  // Nothing to drain, only the flush
+  CHECK_EQ(Cycles(cfg, {{kFence, 0, false}}, 8), 24);
+}
+
+void TestRegionLatency() {
+  E203TimingConfig cfg;
+  cfg.regions.push_back({kDtcm, 0x10000, 3});
+  CHECK_EQ(Cycles(cfg, {{kLwT0, kDtcm, false}, {kAddiT1T0, 0, false}}, 8), 32);
+  CHECK_EQ(Cycles(cfg, {{kLwT0, kDtcm + 0x10000, false}, {kAddiT1T0, 0, false}}, 8), 16);
+}
+
+void TestAtomic() {
+  E203TimingConfig cfg;
+  // The LR and the SC are a single access each, like a load
+  CHECK_EQ(Cycles(cfg, {{kLrW, kDtcm, false}, {kAddiT1A0, 0, false}}, 8), 16);
+  CHECK_EQ(Cycles(cfg, {{kScW, kDtcm, false}, {kAddiT1A2, 0, false}}, 8), 16);
+  // The AMO reads and writes back-to-back: 2 * lat + 1
+  CHECK_EQ(Cycles(cfg, {{kAmoaddW, kDtcm, false}, {kAddiT1A4, 0, false}}, 8), 32);
+}
+
+void TestMulDiv() {
+  E203TimingConfig cfg;
+  CHECK_EQ(Cycles(cfg, {{kMulT0, 0, false}}, 8), 8 * 17);
+  cfg.mul_lat = 5;
+  CHECK_EQ(Cycles(cfg, {{kMulT0, 0, false}}, 8), 8 * 5);
+}
+
+void TestBranch() {
+  E203TimingConfig cfg;
+  // BTFN: the backward taken and the forward not taken are predicted
+  CHECK_EQ(Cycles(cfg, {{kBeqBack, 0, true}}, 1), 1 + cfg.taken_bubble);
+  CHECK_EQ(Cycles(cfg, {{kBeqFwd, 0, false}}, 1), 1);
+  CHECK_EQ(Cycles(cfg, {{kBeqFwd, 0, true}}, 1), 1 + cfg.mispredict);
+  CHECK_EQ(Cycles(cfg, {{kBeqBack, 0, false}}, 1), 1 + cfg.mispredict);
+}
+
+void TestDispatchStall() {
+  using e203sim::StallCause;
+  E203TimingConfig cfg;
+  cfg.fwd = E203TimingConfig::Fwd::kOff;
+  e203sim::DispatchStall s = LastStall(cfg, {{kLwT0, kDtcm, false}, {kAddiT1T0, 0, false}});
+  CHECK_EQ(s.cycles, 1);
+  CHECK(s.cause == StallCause::kRaw);
+  s = LastStall(cfg, {{kLwT0, kDtcm, false}, {kAddiT0T3, 0, false}});
+  CHECK_EQ(s.cycles, 1);
+  CHECK(s.cause == StallCause::kWaw);
+  // The bubbles of a mispredict and the MUL latency are not dispatch stalls
+  s = LastStall(cfg, {{kBeqFwd, 0, true}, {kAddiT1T3, 0, false}});
+  CHECK_EQ(s.cycles, 0);
+  CHECK(s.cause == StallCause::kNone);
+  s = LastStall(cfg, {{kMulT0, 0, false}, {kAddiT1T3, 0, false}});
+  CHECK_EQ(s.cycles, 0);
+}
+
+}  // namespace
+
+int main() {
+  TestAlu();
+  TestLoadUse();
+  TestWaw();
+  TestMicroRows();
+  TestRegionLatency();
+  TestAtomic();
+  TestMulDiv();
+  TestBranch();
+  TestDispatchStall();
+  return e203sim_test::CheckResult();
+}